@@ -0,0 +1,151 @@
+// Benchmark harness: repeats the common tool pipeline on one input and prints the phase report.
+//
+//   vasp_bench --input POSCAR --iterations 1000 --memstats [--workspace]
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include "instrumentation.h"
+#include "poscar_file.h"
+#include "symmetry.h"
+#include "workspace.h"
+
+bool readInput(int argc, char* argv[], std::string& inputFile, int& iterations, double& symprec, bool& reportSet,
+               bool& useWorkspace) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            return false;
+        } else if (arg == "--input") {
+            if (i + 1 >= argc)
+                return false;
+            inputFile = argv[++i];
+        } else if (arg == "--iterations") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                iterations = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--symprec") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                symprec = std::stod(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--workspace") {
+            useWorkspace = true;
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+            reportSet = true;
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+            reportSet = true;
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+            reportSet = true;
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+            reportSet = true;
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+        }
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  vasp_bench [options]\n\n"
+                 "Options:\n"
+                 "  --input      input POSCAR file name (default: POSCAR)\n"
+                 "  --iterations number of repetitions of the pipeline (default: 100)\n"
+                 "  --symprec    symmetry tolerance (spglib symprec) (default: 1e-5)\n"
+                 "  --workspace  reuse one Workspace and output POSCAR across iterations\n"
+                 "  --timings    phase timing report (default when no report is requested)\n"
+                 "  --timings-json phase timing report as JSON\n"
+                 "  --memstats   add per-phase allocations and peak memory to the report\n"
+                 "  --memstats-json memory report as JSON\n"
+                 "  --help       show this help message\n\n"
+                 "Example:\n"
+                 "  vasp_bench --input POSCAR --iterations 1000 --memstats\n"
+                 "  vasp_bench --input POSCAR --iterations 1000 --memstats --workspace\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputFile{"POSCAR"};
+    int iterations{100};
+    double symprec{1e-5};
+    bool reportSet{false};
+    bool useWorkspace{false};
+
+    if (!readInput(argc, argv, inputFile, iterations, symprec, reportSet, useWorkspace)) {
+        printHelp();
+        return 1;
+    }
+
+    if (iterations <= 0) {
+        std::cerr << "Error: number of iterations must be positive!\n";
+        return 1;
+    }
+
+    if (!reportSet)
+        enableTimings(TimingFormat::Text);
+
+    const std::string outputFile = "vasp_bench_output.vasp";
+
+    // With --workspace the structures and spglib scratch arrays are reused, as in a batch tool
+    Workspace workspace;
+    POSCAR poscar;
+    POSCAR primitive;
+
+    for (int it = 0; it < iterations; ++it) {
+        if (!useWorkspace)
+            poscar = POSCAR();
+        if (!poscar.readPOSCAR(inputFile)) {
+            std::cerr << "Error: reading POSCAR file " << inputFile << "\n";
+            return 1;
+        }
+
+        poscar.toCartesian();
+        poscar.toDirect();
+
+        bool made = false;
+        if (useWorkspace) {
+            workspace.reset();
+            auto dataset = analyzeSymmetry(poscar, symprec, workspace);
+            if (!dataset) {
+                std::cerr << "Error: failed to analyze symmetry.\n";
+                return 1;
+            }
+            made = makePrimitiveCell(poscar, symprec, workspace, primitive);
+        } else {
+            auto dataset = analyzeSymmetry(poscar, symprec);
+            if (!dataset) {
+                std::cerr << "Error: failed to analyze symmetry.\n";
+                return 1;
+            }
+            auto cell = makePrimitiveCell(poscar, symprec);
+            if (cell) {
+                primitive = std::move(*cell);
+                made = true;
+            }
+        }
+        if (!made) {
+            std::cerr << "Error: failed to create primitive cell.\n";
+            return 1;
+        }
+
+        if (!primitive.writePOSCAR(outputFile))
+            return 1;
+        std::remove(outputFile.c_str());
+    }
+
+    return 0;
+}
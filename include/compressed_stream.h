@@ -0,0 +1,58 @@
+#ifndef COMPRESSED_STREAM_H_INCLUDED
+#define COMPRESSED_STREAM_H_INCLUDED
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+// gzip is available when built with zlib (VASP_UTILS_HAVE_ZLIB), xz with liblzma (VASP_UTILS_HAVE_LZMA)
+// and zstd with libzstd (VASP_UTILS_HAVE_ZSTD)
+enum class Compression { None, Gzip, Xz, Zstd };
+
+const char* compressionName(Compression compression);
+bool compressionSupported(Compression compression);
+
+// Compression implied by a .gz, .xz or .zst suffix, and the file name without it
+Compression compressionFromName(const std::string& filename);
+std::string stripCompressionSuffix(const std::string& filename);
+// Compression identified by the first n (up to 6) bytes of a file
+Compression compressionFromMagic(const unsigned char* magic, std::size_t n);
+
+// Reads a plain or compressed file; the compression is detected from the leading magic bytes. Compressed
+// data is decoded on a separate thread a few blocks ahead of the reader, so parsing overlaps decompression.
+class InputFileStream : public std::istream {
+public:
+    explicit InputFileStream(const std::string& filename);
+    ~InputFileStream() override;
+
+    Compression compression() const {
+        return compression_;
+    }
+
+private:
+    std::unique_ptr<std::streambuf> buffer_;
+    Compression compression_{Compression::None};
+};
+
+// Writes a plain file, or a compressed one when the name ends in .gz, .xz or .zst. close() finishes the
+// compressed stream and reports whether everything reached the file; the destructor closes silently.
+class OutputFileStream : public std::ostream {
+public:
+    explicit OutputFileStream(const std::string& filename);
+    ~OutputFileStream() override;
+
+    bool close();
+
+    Compression compression() const {
+        return compression_;
+    }
+
+private:
+    std::unique_ptr<std::streambuf> buffer_;
+    Compression compression_{Compression::None};
+    bool closed_{false};
+};
+
+#endif  // COMPRESSED_STREAM_H_INCLUDED
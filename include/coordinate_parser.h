@@ -0,0 +1,18 @@
+#ifndef COORDINATE_PARSER_H_INCLUDED
+#define COORDINATE_PARSER_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+struct Atom;
+
+// Parses the first count lines of [begin, end) as POSCAR coordinate lines "x y z" (followed by three T/F
+// flags when flags is not null; anything else after them is ignored) into atoms[0..count). The text is cut
+// into chunks at line boundaries; the lines of every chunk are counted in parallel, a prefix sum gives each
+// chunk its first atom, and the chunks are then parsed in parallel straight into atoms. Chunks are at
+// least min_chunk_bytes long. Prints an error naming the first bad atom and returns false on malformed or
+// missing lines.
+bool parseCoordinateBlock(const char* begin, const char* end, std::size_t count, Atom* atoms, std::uint8_t* flags,
+                          int n_threads = 0, std::size_t min_chunk_bytes = std::size_t{1} << 20);
+
+#endif  // COORDINATE_PARSER_H_INCLUDED
@@ -0,0 +1,44 @@
+#ifndef DAEMON_PROTOCOL_H_INCLUDED
+#define DAEMON_PROTOCOL_H_INCLUDED
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+// Wire protocol of vasp_utilsd. Every message is a frame: a 4-byte big-endian payload length followed by
+// the payload. A request payload is a command line "command key=value ..." ending in '\n' followed by the
+// structure text; a response payload is "ok\n" or "error\n" followed by the result or the error message.
+
+constexpr std::size_t kMaxFrameSize = std::size_t{1} << 28;
+
+struct DaemonRequest {
+    std::string command;
+    std::map<std::string, std::string> options;
+    std::string structure;
+};
+
+struct DaemonResponse {
+    bool ok{false};
+    std::string body;
+};
+
+// Serialization into a reusable buffer, and parsing; parse functions return false on a malformed payload
+void formatRequest(const DaemonRequest& request, std::string& payload);
+bool parseRequest(const std::string& payload, DaemonRequest& request);
+void formatResponse(const DaemonResponse& response, std::string& payload);
+bool parseResponse(const std::string& payload, DaemonResponse& response);
+
+// Blocking frame I/O on a connected socket, retried on EINTR and short transfers. readFrame returns false
+// on end of stream, an I/O error or a frame above kMaxFrameSize; payload keeps its capacity between calls.
+bool writeFrame(int fd, const std::string& payload);
+bool readFrame(int fd, std::string& payload);
+
+// $VASP_UTILSD_SOCKET, or a per-user path in /tmp
+std::string defaultSocketPath();
+
+// Unix domain sockets; -1 on failure. listenUnixSocket prints the reason and replaces a stale socket file
+// left by a server that did not shut down cleanly.
+int listenUnixSocket(const std::string& path, int backlog = 64);
+int connectUnixSocket(const std::string& path);
+
+#endif  // DAEMON_PROTOCOL_H_INCLUDED
@@ -0,0 +1,55 @@
+#ifndef DERIVATIVE_ENUMERATION_H_INCLUDED
+#define DERIVATIVE_ENUMERATION_H_INCLUDED
+
+#include <cstdint>
+#include <vector>
+
+struct POSCAR;
+
+// Occupation of the active sublattice: bit i set means site i carries the substituent (or vacancy)
+using Occupation = std::uint64_t;
+constexpr int kMaxActiveSites = 64;
+
+std::uint64_t binomial(int n, int k);
+
+// Permutations of the active sites induced by space-group operations x' = R x + t of the (super)cell,
+// e.g. rotations/translations of the SpglibDataset from analyzeSymmetry. Duplicate permutations are
+// removed, so the result is the group acting on the active sites.
+std::vector<std::vector<int>> activeSitePermutations(const POSCAR& supercell, const int (*rotations)[3][3],
+                                                     const double (*translations)[3], int n_operations,
+                                                     const std::vector<int>& active_sites, double tolerance);
+
+// Applies site permutations to bitset occupations with 4-bit lookup tables (16 lookups per permutation)
+// and decides whether an occupation is the lexicographically smallest member of its orbit.
+class OccupationCanonicalizer {
+public:
+    OccupationCanonicalizer(const std::vector<std::vector<int>>& permutations, int n_sites);
+
+    Occupation apply(std::size_t perm, Occupation config) const;
+
+    // True if no permutation maps config to a smaller bitset. orbit_size (optional) receives the number
+    // of distinct configurations equivalent to config; it is only filled for canonical ones.
+    bool isCanonical(Occupation config, std::uint64_t* orbit_size = nullptr) const;
+
+    std::size_t groupOrder() const {
+        return n_perms_;
+    }
+
+private:
+    int n_nibbles_;
+    std::size_t n_perms_;
+    std::vector<Occupation> tables_;  // [perm][nibble][16]
+};
+
+struct EnumeratedConfiguration {
+    Occupation occupation;
+    std::uint64_t degeneracy;
+};
+
+// Streams over all C(n_sites, n_substituted) occupations in bounded batches of chunks on n_threads threads
+// and keeps only the canonical ones, so memory grows with the number of inequivalent configurations only.
+std::vector<EnumeratedConfiguration> enumerateInequivalent(int n_sites, int n_substituted,
+                                                           const OccupationCanonicalizer& canonicalizer,
+                                                           int n_threads);
+
+#endif  // DERIVATIVE_ENUMERATION_H_INCLUDED
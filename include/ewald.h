@@ -0,0 +1,86 @@
+#ifndef EWALD_H_INCLUDED
+#define EWALD_H_INCLUDED
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "poscar_file.h"
+
+constexpr double kCoulombEVAngstrom = 14.399645;  // e^2 / (4 pi eps0) in eV * Angstrom
+
+struct EwaldOptions {
+    double accuracy{1e-8};  // relative size of the neglected real and reciprocal terms
+    double alpha{0.0};      // splitting parameter in 1/Angstrom, <= 0 chooses it from cell volume and atom count
+    int threads{1};         // <= 0 means all hardware threads
+};
+
+// Splitting parameter and cutoffs balancing the cost of the real- and reciprocal-space sums
+struct EwaldParameters {
+    double alpha;
+    double real_cutoff;   // Angstrom
+    double recip_cutoff;  // 1/Angstrom, including the 2 pi factor
+};
+
+struct EwaldEnergy {
+    double real{0.0};
+    double reciprocal{0.0};
+    double self{0.0};
+    double background{0.0};  // neutralizing background for charged cells
+    double total{0.0};       // eV
+};
+
+EwaldParameters ewaldParameters(const double lattice[3][3], int n_atoms, const EwaldOptions& options);
+
+// Charge of every atom from per-element oxidation states; false (with a message) if an element is missing
+bool atomCharges(const POSCAR& poscar, const std::map<std::string, double>& oxidation_states,
+                 std::vector<double>& charges);
+
+// Parses "Na:1,Cl:-1" into per-element oxidation states
+bool parseOxidationStates(const std::string& text, std::map<std::string, double>& oxidation_states);
+
+// Point-charge Ewald energy in O(N K + N^2 images), without storing pair interactions
+EwaldEnergy ewaldEnergy(const POSCAR& poscar, const std::vector<double>& charges,
+                        const EwaldOptions& options = EwaldOptions{});
+
+// Ewald energy kept as E = 1/2 q^T Phi q with the full pair matrix Phi and site potentials V = Phi q,
+// so exchanging the charges of two sites or removing a charge (the site stays with charge 0) changes the
+// energy in O(1) and updates the potentials in O(N). Memory is N^2 doubles.
+class EwaldModel {
+public:
+    EwaldModel(const POSCAR& poscar, const std::vector<double>& charges,
+               const EwaldOptions& options = EwaldOptions{});
+
+    double energy() const {
+        return energy_;
+    }
+    double sitePotential(int i) const {
+        return potentials_[i];
+    }
+    double charge(int i) const {
+        return charges_[i];
+    }
+    int size() const {
+        return n_;
+    }
+
+    double swapDelta(int i, int j) const;
+    double removalDelta(int i) const;
+    void applySwap(int i, int j);
+    void applyRemoval(int i);
+
+private:
+    int n_;
+    std::vector<double> phi_;  // row-major N x N, eV per e^2
+    std::vector<double> charges_;
+    std::vector<double> potentials_;
+    double energy_{0.0};
+
+    double pair(int i, int j) const {
+        return phi_[static_cast<size_t>(i) * n_ + j];
+    }
+    double changeDelta(int i, double di, int j, double dj) const;
+    void applyChange(int i, double di, int j, double dj);
+};
+
+#endif  // EWALD_H_INCLUDED
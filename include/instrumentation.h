@@ -0,0 +1,117 @@
+#ifndef INSTRUMENTATION_H_INCLUDED
+#define INSTRUMENTATION_H_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum class TimingFormat { Text, Json };
+
+struct PhaseStats {
+    std::string name;
+    long long calls{0};
+    double seconds{0.0};
+    std::size_t atoms{0};  // atoms processed, summed over calls
+    std::size_t bytes{0};  // bytes read or written, summed over calls
+    unsigned long long allocations{0};      // heap allocations made inside the phase
+    unsigned long long allocated_bytes{0};  // heap bytes requested inside the phase
+    long long retained_bytes{0};            // heap growth still live when the phase ended
+};
+
+// Counters maintained by the global allocator hook (allocation_hook.cpp) while memory stats are enabled
+struct MemoryCounters {
+    unsigned long long allocations{0};
+    unsigned long long allocated_bytes{0};
+    long long live_bytes{0};       // relative to the moment memory stats were enabled
+    long long peak_live_bytes{0};  // high-water mark of live_bytes
+};
+
+enum InstrumentationFlags : unsigned { kInstrumentTimings = 1u, kInstrumentMemory = 2u };
+
+// Global switch, kept as a plain atomic so a disabled ScopedTimer costs one relaxed load
+extern std::atomic<unsigned> g_instrumentation;
+
+inline bool instrumentationEnabled() {
+    return g_instrumentation.load(std::memory_order_relaxed) != 0;
+}
+inline bool timingsEnabled() {
+    return (g_instrumentation.load(std::memory_order_relaxed) & kInstrumentTimings) != 0;
+}
+inline bool memoryStatsEnabled() {
+    return (g_instrumentation.load(std::memory_order_relaxed) & kInstrumentMemory) != 0;
+}
+
+void setTimingsEnabled(bool enabled);
+void enableTimings(TimingFormat format);  // enable and print the report to stderr at program exit
+void resetTimings();
+void recordPhase(const char* phase, double seconds, std::size_t atoms, std::size_t bytes,
+                 const MemoryCounters& memory_delta = MemoryCounters{});
+std::vector<PhaseStats> timingSnapshot();
+void printTimings(std::ostream& out, TimingFormat format);
+
+void enableInstrumentationReport(unsigned flag, TimingFormat format);
+
+// Memory accounting: allocations are counted by the replaced global operator new/delete in
+// allocation_hook.cpp, which also defines the two functions below. That file is not in vasp_core; link
+// the vasp_allocation_hook object library into an executable to get them. Programs and libraries built on
+// vasp_core alone keep the default allocator (or their own replacement).
+void setMemoryStatsEnabled(bool enabled);
+void enableMemoryStats(TimingFormat format);  // enable and print the report to stderr at program exit
+void noteAllocation(std::size_t bytes);
+void noteDeallocation(std::size_t bytes);
+MemoryCounters memoryCounters();
+long long peakRSSBytes();  // 0 where getrusage is unavailable (Windows)
+
+// Times the enclosing scope and adds it to the registry under the given phase name.
+// The phase name must be a string literal (or otherwise outlive the timer).
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char* phase, std::size_t atoms = 0, std::size_t bytes = 0)
+        : phase_(phase), atoms_(atoms), bytes_(bytes), active_(instrumentationEnabled()) {
+        if (active_) {
+            if (memoryStatsEnabled())
+                memory_start_ = memoryCounters();
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedTimer() {
+        if (active_) {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_;
+            MemoryCounters delta;
+            if (memoryStatsEnabled()) {
+                MemoryCounters now = memoryCounters();
+                delta.allocations = now.allocations - memory_start_.allocations;
+                delta.allocated_bytes = now.allocated_bytes - memory_start_.allocated_bytes;
+                delta.live_bytes = now.live_bytes - memory_start_.live_bytes;
+            }
+            recordPhase(phase_, elapsed.count(), atoms_, bytes_, delta);
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    bool active() const {
+        return active_;
+    }
+    void setAtoms(std::size_t atoms) {
+        atoms_ = atoms;
+    }
+    void setBytes(std::size_t bytes) {
+        bytes_ = bytes;
+    }
+
+private:
+    const char* phase_;
+    std::size_t atoms_;
+    std::size_t bytes_;
+    bool active_;
+    std::chrono::steady_clock::time_point start_;
+    MemoryCounters memory_start_;
+};
+
+#endif  // INSTRUMENTATION_H_INCLUDED
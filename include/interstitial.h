@@ -0,0 +1,31 @@
+#ifndef INTERSTITIAL_H_INCLUDED
+#define INTERSTITIAL_H_INCLUDED
+
+#include <vector>
+
+#include "poscar_file.h"
+
+struct InterstitialOptions {
+    double grid_spacing{0.2};    // Angstrom between grid points along each lattice vector
+    double min_distance{1.0};    // sites closer than this to a host atom are dropped, Angstrom
+    double cluster_radius{0.5};  // maxima closer than this are merged into one site, Angstrom
+    int threads{0};              // <= 0 means all hardware threads
+};
+
+struct InterstitialSite {
+    Atom position;        // fractional, wrapped into [0, 1)
+    double distance{0.0};  // to the nearest host atom, Angstrom
+    int multiplicity{1};   // symmetry-equivalent copies in the cell
+};
+
+// Local maxima of the distance to the nearest host atom on a periodic fractional grid, clustered and
+// sorted by decreasing distance
+std::vector<InterstitialSite> findInterstitials(const POSCAR& host, const InterstitialOptions& options);
+
+// Keeps one site per orbit of the space-group operations (fractional rotations and translations of the
+// host cell) and records the orbit size as multiplicity. tolerance is in Angstrom.
+std::vector<InterstitialSite> symmetryReduceSites(const std::vector<InterstitialSite>& sites,
+                                                  const double lattice[3][3], const int (*rotations)[3][3],
+                                                  const double (*translations)[3], int n_ops, double tolerance);
+
+#endif  // INTERSTITIAL_H_INCLUDED
@@ -0,0 +1,38 @@
+#ifndef KPOINT_MESH_H_INCLUDED
+#define KPOINT_MESH_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+struct KMesh {
+    int mesh[3]{1, 1, 1};
+    bool gamma_centered{true};  // false: Monkhorst-Pack, shifted by half a step along even subdivisions
+    int irreducible{0};         // filled in by the symmetry reduction
+
+    int total() const {
+        return mesh[0] * mesh[1] * mesh[2];
+    }
+    void shift(int is_shift[3]) const;  // spglib convention, 1 = half-step shift along that axis
+};
+
+// Smallest subdivisions with a k-point spacing of at most kspacing along every reciprocal vector
+// (1/Angstrom including the 2 pi factor, like VASP's KSPACING)
+void meshForSpacing(const double lattice[3][3], double kspacing, int mesh[3]);
+
+// Indices of the distinct rotation matrices among space-group operations (the point group)
+std::vector<int> uniqueRotations(const int (*rotations)[3][3], int n_ops);
+
+// True if every rotation maps the (shifted) grid onto itself, so the symmetry reduction is valid
+bool meshCompatible(const KMesh& mesh, const int (*rotations)[3][3], int n_rot);
+
+// Gamma-centred and Monkhorst-Pack meshes with 0..extra subdivisions added to the minimal mesh along each
+// axis, keeping only those compatible with the rotations
+std::vector<KMesh> candidateMeshes(const double lattice[3][3], double kspacing, int extra,
+                                   const int (*rotations)[3][3], int n_rot, bool gamma_only);
+
+// Lowest irreducible count first; ties go to the denser mesh, then to the Gamma-centred one
+void rankMeshes(std::vector<KMesh>& meshes);
+
+bool writeKPOINTS(const std::string& filename, const KMesh& mesh, const std::string& comment);
+
+#endif  // KPOINT_MESH_H_INCLUDED
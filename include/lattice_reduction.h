@@ -0,0 +1,21 @@
+#ifndef LATTICE_REDUCTION_H_INCLUDED
+#define LATTICE_REDUCTION_H_INCLUDED
+
+#include "poscar_file.h"
+
+enum class CellReduction { None, Niggli, Delaunay };
+
+// Reduced bases of the lattice spanned by the rows of lattice. transform receives the unimodular integer
+// matrix with reduced = transform * lattice (det +1, so handedness is kept). tolerance is relative to the
+// cell size. Return false only for a singular lattice or if the iteration fails to converge.
+bool niggliReduce(const double lattice[3][3], double reduced[3][3], int transform[3][3], double tolerance = 1e-5);
+bool delaunayReduce(const double lattice[3][3], double reduced[3][3], int transform[3][3],
+                    double tolerance = 1e-5);
+bool reduceLattice(CellReduction method, const double lattice[3][3], double reduced[3][3], int transform[3][3],
+                   double tolerance = 1e-5);
+
+// Replaces the cell of poscar by its reduced basis and remaps the atoms into it (fractional, wrapped into
+// [0, 1)). Atom order is unchanged; Cartesian input stays Cartesian.
+bool reduceCell(POSCAR& poscar, CellReduction method, double tolerance = 1e-5);
+
+#endif  // LATTICE_REDUCTION_H_INCLUDED
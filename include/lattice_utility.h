@@ -0,0 +1,28 @@
+#ifndef LATTICE_UTILITY_H_INCLUDED
+#define LATTICE_UTILITY_H_INCLUDED
+
+// Small fixed-size geometry helpers. Lattices are stored row-wise like POSCAR::lattice
+// (lattice[i] is the i-th lattice vector), so Cartesian = fractional * lattice.
+
+double determinant3(const double m[3][3]);
+double cellVolume(const double lattice[3][3]);
+bool invert3(const double m[3][3], double inv[3][3]);
+
+void fractionalToCartesian(const double lattice[3][3], const double frac[3], double cart[3]);
+void cartesianToFractional(const double inverse_lattice[3][3], const double cart[3], double frac[3]);
+
+// Reciprocal lattice rows b_i with a_i . b_j = delta_ij (no 2*pi factor)
+void reciprocalLattice(const double lattice[3][3], double reciprocal[3][3]);
+
+// Distance between opposite faces of the cell for each lattice direction
+void perpendicularHeights(const double lattice[3][3], double heights[3]);
+
+// Lengths a, b, c and angles alpha, beta, gamma in degrees
+void latticeParameters(const double lattice[3][3], double lengths[3], double angles[3]);
+
+double wrapFractional(double x);  // into [0, 1)
+
+// Shortest Cartesian length of a fractional difference vector over all periodic images
+double minimumImageDistance(const double lattice[3][3], const double frac_delta[3]);
+
+#endif  // LATTICE_UTILITY_H_INCLUDED
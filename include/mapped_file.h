@@ -0,0 +1,32 @@
+#ifndef MAPPED_FILE_H_INCLUDED
+#define MAPPED_FILE_H_INCLUDED
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory map of a whole file. Evaluates to false when the file cannot be mapped (missing, empty,
+// or a platform without mmap); callers then read it as a stream.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    explicit operator bool() const {
+        return data_ != nullptr;
+    }
+    const char* data() const {
+        return data_;
+    }
+    std::size_t size() const {
+        return size_;
+    }
+
+private:
+    const char* data_{nullptr};
+    std::size_t size_{0};
+};
+
+#endif  // MAPPED_FILE_H_INCLUDED
@@ -0,0 +1,44 @@
+#ifndef MEMORY_STREAM_H_INCLUDED
+#define MEMORY_STREAM_H_INCLUDED
+
+#include <cstddef>
+#include <streambuf>
+#include <string>
+
+// Read-only stream buffer over memory owned by the caller, so text can be parsed without a copy
+class MemoryInputBuffer : public std::streambuf {
+public:
+    void reset(const char* data, std::size_t size) {
+        char* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
+    }
+
+    // Bytes consumed so far, i.e. the offset of the next character to be read
+    std::size_t position() const {
+        return static_cast<std::size_t>(gptr() - eback());
+    }
+};
+
+// Appends to a string owned by the caller; clearing the string between uses keeps its capacity
+class StringOutputBuffer : public std::streambuf {
+public:
+    void reset(std::string& target) {
+        target_ = &target;
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        if (c != traits_type::eof())
+            target_->push_back(traits_type::to_char_type(c));
+        return traits_type::not_eof(c);
+    }
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        target_->append(s, static_cast<std::size_t>(n));
+        return n;
+    }
+
+private:
+    std::string* target_{nullptr};
+};
+
+#endif  // MEMORY_STREAM_H_INCLUDED
@@ -0,0 +1,47 @@
+#ifndef NEB_H_INCLUDED
+#define NEB_H_INCLUDED
+
+#include <vector>
+
+#include "poscar_file.h"
+
+struct IdppOptions {
+    int max_iterations{1000};
+    double force_tolerance{0.01};  // largest atomic force, 1/Angstrom^3 on the IDPP surface
+    double spring{5.0};            // NEB spring constant between neighbouring images
+    double step{0.05};             // steepest-descent step, Angstrom^4
+    double max_move{0.05};         // cap on the displacement of one atom per iteration, Angstrom
+    int threads{0};                // <= 0 means all hardware threads
+};
+
+struct IdppResult {
+    int iterations{0};
+    double max_force{0.0};
+    bool converged{false};
+};
+
+// For every atom of initial the index of the atom of final with the same element and the shortest
+// minimum-image distance; pairs are assigned greedily from the closest. Both structures must be
+// fractional with the same elements and counts.
+std::vector<int> matchAtoms(const POSCAR& initial, const POSCAR& final);
+
+// final reordered by order and shifted by lattice vectors so every atom is at the periodic image
+// closest to its partner in initial
+std::vector<Atom> alignEndpoint(const std::vector<Atom>& initial, const std::vector<Atom>& final,
+                                const std::vector<int>& order);
+
+// n_images intermediate images linearly interpolated in fractional coordinates, with both endpoints:
+// n_images + 2 entries
+std::vector<std::vector<Atom>> linearPath(const std::vector<Atom>& initial, const std::vector<Atom>& final,
+                                          int n_images);
+
+// IDPP objective of one image: sum over pairs of (d_target - d)^2 / d^4, with d_target linearly
+// interpolated between the endpoint distances. Pair vectors use the rounded minimum image.
+double idppObjective(const double lattice[3][3], const std::vector<std::vector<Atom>>& path, size_t image);
+
+// Relaxes the intermediate images of path on the IDPP surface with a nudged elastic band; the
+// endpoints are kept. Images are updated in parallel.
+IdppResult idppOptimize(const double lattice[3][3], std::vector<std::vector<Atom>>& path,
+                        const IdppOptions& options = IdppOptions{});
+
+#endif  // NEB_H_INCLUDED
@@ -0,0 +1,122 @@
+#ifndef NEIGHBOR_LIST_H_INCLUDED
+#define NEIGHBOR_LIST_H_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "poscar_file.h"
+
+struct Neighbor {
+    int index;        // atom index in the structure
+    double distance;  // Angstrom, to this particular periodic image
+};
+
+// Cell-linked list over a periodic cell. The cell is Niggli-reduced first and atoms are binned by
+// fractional coordinate of the reduced cell, with the number of bins per axis chosen from its
+// perpendicular heights, so a radius query visits only nearby bins (and their periodic images, however
+// many the radius needs). Positions are kept as separate x/y/z
+// arrays sorted by bin so the distance loop over a bin is a plain contiguous kernel.
+class PeriodicCellIndex {
+public:
+    // fractional: atom positions in fractional coordinates of lattice (any range, they are wrapped)
+    PeriodicCellIndex(const double lattice[3][3], const std::vector<Atom>& fractional, double bin_size);
+
+    // Calls visit(atom_index, distance) for every periodic image of every atom with distance <= radius
+    // from the Cartesian point. The same atom can be reported several times through different images.
+    template <typename Visit>
+    void forEachWithin(const double point[3], double radius, Visit&& visit) const;
+
+    // Distance from the Cartesian point to the nearest atom image (searching up to max_radius);
+    // returns max_radius when nothing is closer
+    double nearestDistance(const double point[3], double max_radius) const;
+
+    // Distance kernels over count points of the x/y/z arrays: explicit SSE2 on x86-64, scalar elsewhere.
+    // squaredDistances writes r2[0, count); minSquaredDistance returns the smallest one, at most bound.
+    static void squaredDistances(const double* x, const double* y, const double* z, int count, double px,
+                                 double py, double pz, double* r2);
+    static double minSquaredDistance(const double* x, const double* y, const double* z, int count, double px,
+                                     double py, double pz, double bound);
+
+    int size() const {
+        return static_cast<int>(order_.size());
+    }
+
+private:
+    double lattice_[3][3];
+    double inverse_[3][3];
+    double heights_[3];
+    int bins_[3];
+    std::vector<int> bin_start_;  // CSR offsets, size n_bins + 1
+    std::vector<int> order_;      // atom index of each sorted slot
+    std::vector<double> x_, y_, z_;  // wrapped Cartesian positions, sorted by bin
+
+    void pointBin(const double point[3], double frac[3], int bin[3]) const;
+
+    // Calls visit(begin, end, px, py, pz) for every run of bin images within radius: slots [begin, end) of
+    // the sorted arrays and the query point shifted into that image
+    template <typename BinVisit>
+    void forEachBinImage(const double point[3], double radius, BinVisit&& visit) const;
+};
+
+// For every atom, all neighbour images within cutoff (excluding the atom itself at zero shift),
+// sorted by distance.
+std::vector<std::vector<Neighbor>> buildNeighborList(const POSCAR& poscar, double cutoff);
+
+template <typename BinVisit>
+void PeriodicCellIndex::forEachBinImage(const double point[3], double radius, BinVisit&& visit) const {
+    double frac[3];
+    int bin[3];
+    pointBin(point, frac, bin);
+
+    int range[3];
+    for (int k = 0; k < 3; ++k)
+        range[k] = static_cast<int>(std::ceil(radius * bins_[k] / heights_[k]));
+
+    for (int o0 = -range[0]; o0 <= range[0]; ++o0) {
+        int c0 = bin[0] + o0;
+        int i0 = ((c0 % bins_[0]) + bins_[0]) % bins_[0];
+        int s0 = (c0 - i0) / bins_[0];
+        for (int o1 = -range[1]; o1 <= range[1]; ++o1) {
+            int c1 = bin[1] + o1;
+            int i1 = ((c1 % bins_[1]) + bins_[1]) % bins_[1];
+            int s1 = (c1 - i1) / bins_[1];
+            // Along the last axis, neighbouring bins with the same image shift are adjacent in the sorted
+            // arrays, so each such run is visited once as one contiguous slot range
+            const int row = (i0 * bins_[1] + i1) * bins_[2];
+            const int first = bin[2] - range[2], last = bin[2] + range[2];
+            const int i_first = ((first % bins_[2]) + bins_[2]) % bins_[2];
+            for (int s2 = (first - i_first) / bins_[2]; s2 * bins_[2] <= last; ++s2) {
+                const int lo = std::max(first - s2 * bins_[2], 0);
+                const int hi = std::min(last - s2 * bins_[2], bins_[2] - 1);
+
+                // Image shift of this run of bin copies, in Cartesian coordinates
+                double shift[3];
+                for (int j = 0; j < 3; ++j)
+                    shift[j] = s0 * lattice_[0][j] + s1 * lattice_[1][j] + s2 * lattice_[2][j];
+
+                visit(bin_start_[row + lo], bin_start_[row + hi + 1], point[0] - shift[0], point[1] - shift[1],
+                      point[2] - shift[2]);
+            }
+        }
+    }
+}
+
+template <typename Visit>
+void PeriodicCellIndex::forEachWithin(const double point[3], double radius, Visit&& visit) const {
+    constexpr int kBlock = 64;
+    const double r2max = radius * radius;
+    forEachBinImage(point, radius, [&](int begin, int end, double px, double py, double pz) {
+        // Distances of a block of slots in one kernel call, then the (rarely taken) visits
+        double r2[kBlock];
+        for (int block = begin; block < end; block += kBlock) {
+            const int n = std::min(kBlock, end - block);
+            squaredDistances(x_.data() + block, y_.data() + block, z_.data() + block, n, px, py, pz, r2);
+            for (int i = 0; i < n; ++i)
+                if (r2[i] <= r2max)
+                    visit(order_[block + i], std::sqrt(r2[i]));
+        }
+    });
+}
+
+#endif  // NEIGHBOR_LIST_H_INCLUDED
@@ -0,0 +1,60 @@
+#ifndef PARALLEL_UTILITY_H_INCLUDED
+#define PARALLEL_UTILITY_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+int hardwareThreads();
+int resolveThreadCount(int requested);  // <= 0 means all hardware threads
+
+// Calls body(i) for every i in [0, n) on up to n_threads threads. Work is handed out one index at a
+// time, so uneven items (files of different size, candidates of different cost) balance themselves.
+// The first exception thrown by body is rethrown on the calling thread.
+template <typename Body>
+void parallelFor(std::size_t n, int n_threads, Body&& body) {
+    n_threads = resolveThreadCount(n_threads);
+    if (n == 0)
+        return;
+
+    if (n_threads == 1 || n == 1) {
+        for (std::size_t i = 0; i < n; ++i)
+            body(i);
+        return;
+    }
+
+    std::atomic<std::size_t> next{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&]() {
+        for (std::size_t i = next.fetch_add(1); i < n; i = next.fetch_add(1)) {
+            try {
+                body(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error)
+                    error = std::current_exception();
+                next.store(n);
+            }
+        }
+    };
+
+    std::size_t count = std::min<std::size_t>(static_cast<std::size_t>(n_threads), n);
+    std::vector<std::thread> threads;
+    threads.reserve(count - 1);
+    for (std::size_t t = 1; t < count; ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+#endif  // PARALLEL_UTILITY_H_INCLUDED
@@ -0,0 +1,28 @@
+#ifndef POINT_DEFECTS_H_INCLUDED
+#define POINT_DEFECTS_H_INCLUDED
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "poscar_file.h"
+
+// One representative atom per symmetry orbit of the host
+struct DefectSite {
+    int atom;              // index of the representative in the host
+    std::string element;
+    int multiplicity{1};   // atoms of the host equivalent to the representative
+};
+
+// Groups atoms by their equivalent_atoms entry (as returned by spglib); sites are in order of first appearance
+std::vector<DefectSite> inequivalentSites(const std::vector<std::string>& species,
+                                          const std::vector<int>& equivalent_atoms);
+
+// Host with the given atom removed, or replaced by dopant; element order of the host is kept
+POSCAR makeVacancy(const POSCAR& host, int atom, const std::string& comment);
+POSCAR makeSubstitution(const POSCAR& host, int atom, const std::string& dopant, const std::string& comment);
+
+// Parses "Na:K,Na:Li,Cl:Br" into (host element, dopant) pairs
+bool parseSubstitutions(const std::string& text, std::vector<std::pair<std::string, std::string>>& substitutions);
+
+#endif  // POINT_DEFECTS_H_INCLUDED
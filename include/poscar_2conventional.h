@@ -3,7 +3,10 @@
 
 #include <string>
 
-bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outputFile, double& symprec);
+#include "lattice_reduction.h"
+
+bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outputFile, double& symprec,
+               CellReduction& reduction);
 bool validateInput(const std::string& inputFile, const std::string& outputFile, double& symprec);
 void printHelp();
 
@@ -3,7 +3,8 @@
 
 #include <string>
 
-bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outputFile);
+bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outputFile, std::string& inputDir,
+               std::string& prefix, std::string& outputDir, bool& toPoscar, int& threads);
 void printHelp();
 
 #endif  // POSCAR_2CTRLS_INCLUDED
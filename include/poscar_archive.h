@@ -0,0 +1,12 @@
+#ifndef POSCAR_ARCHIVE_H_INCLUDED
+#define POSCAR_ARCHIVE_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+bool readInput(int argc, char* argv[], std::string& archiveFile, std::string& outputDir,
+               std::vector<std::string>& members, bool& extract);
+bool validateInput(const std::string& archiveFile);
+void printHelp();
+
+#endif  // POSCAR_ARCHIVE_H_INCLUDED
@@ -3,9 +3,10 @@
 
 #include <string>
 
-bool readInput(int argc, char* argv[], std::string& filename, int& n_files, int& n_atoms, double& amplitude);
+bool readInput(int argc, char* argv[], std::string& filename, int& n_files, int& n_atoms, double& amplitude,
+               bool& allAtoms, std::string& archiveFile);
 
-bool validateInput(const std::string& filename, int n_files, int n_atoms, double amplitude);
+bool validateInput(const std::string& filename, int n_files, int n_atoms, double amplitude, bool archive);
 
 void printHelp();
 
@@ -0,0 +1,10 @@
+#ifndef POSCAR_CONVERT_H_INCLUDED
+#define POSCAR_CONVERT_H_INCLUDED
+
+#include <string>
+
+bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outputFile, std::string& inputFormat,
+               std::string& outputFormat, bool& allFrames, bool& listFormats);
+void printHelp();
+
+#endif  // POSCAR_CONVERT_H_INCLUDED
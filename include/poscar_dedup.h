@@ -0,0 +1,13 @@
+#ifndef POSCAR_DEDUP_H_INCLUDED
+#define POSCAR_DEDUP_H_INCLUDED
+
+#include <string>
+
+struct MatchOptions;
+
+bool readInput(int argc, char* argv[], std::string& inputDir, std::string& prefix, std::string& outputFile,
+               MatchOptions& options, double& histogramTolerance, int& threads);
+bool validateInput(const std::string& inputDir, const MatchOptions& options, double histogramTolerance);
+void printHelp();
+
+#endif  // POSCAR_DEDUP_H_INCLUDED
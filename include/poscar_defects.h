@@ -0,0 +1,12 @@
+#ifndef POSCAR_DEFECTS_H_INCLUDED
+#define POSCAR_DEFECTS_H_INCLUDED
+
+#include <string>
+
+bool readInput(int argc, char* argv[], std::string& inputFile, int supercell[3], std::string& substitute,
+               bool& vacancies, double& symprec, std::string& outputPrefix, int& threads);
+bool validateInput(const std::string& inputFile, const int supercell[3], const std::string& substitute,
+                   bool vacancies, double symprec);
+void printHelp();
+
+#endif  // POSCAR_DEFECTS_H_INCLUDED
@@ -0,0 +1,13 @@
+#ifndef POSCAR_ENUMERATE_H_INCLUDED
+#define POSCAR_ENUMERATE_H_INCLUDED
+
+#include <string>
+
+bool readInput(int argc, char* argv[], std::string& inputFile, int supercell[3], std::string& site,
+               std::string& substitute, int& countMin, int& countMax, double& symprec, std::string& outputPrefix,
+               int& maxOutput, long long& maxRaw, int& threads);
+bool validateInput(const std::string& inputFile, const int supercell[3], const std::string& site,
+                   const std::string& substitute, int countMin, int countMax, double symprec, long long maxRaw);
+void printHelp();
+
+#endif  // POSCAR_ENUMERATE_H_INCLUDED
@@ -0,0 +1,15 @@
+#ifndef POSCAR_EWALD_H_INCLUDED
+#define POSCAR_EWALD_H_INCLUDED
+
+#include <map>
+#include <string>
+
+struct EwaldOptions;
+
+bool readInput(int argc, char* argv[], std::string& inputDir, std::string& prefix, std::string& outputFile,
+               std::map<std::string, double>& oxidationStates, EwaldOptions& options, int& threads);
+bool validateInput(const std::string& inputDir, const std::map<std::string, double>& oxidationStates,
+                   const EwaldOptions& options);
+void printHelp();
+
+#endif  // POSCAR_EWALD_H_INCLUDED
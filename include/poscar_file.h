@@ -1,13 +1,24 @@
 #ifndef POSCAR_FILE_H_INCLUDED
 #define POSCAR_FILE_H_INCLUDED
 
+#include <cstddef>
+#include <cstdint>
+#include <istream>
 #include <string>
 #include <vector>
 
+class TextWriter;
+
 struct Atom {
     double x, y, z;  // fractional or Cartesian
 };
 
+// Selective-dynamics bits of POSCAR::selective_flags; a set bit is written as T (coordinate relaxes)
+constexpr std::uint8_t kMoveX = 1;
+constexpr std::uint8_t kMoveY = 2;
+constexpr std::uint8_t kMoveZ = 4;
+constexpr std::uint8_t kMoveAll = kMoveX | kMoveY | kMoveZ;
+
 struct POSCAR {
     std::string comment{"System"};      // first line
     double scale{1.000000};             // scaling factor
@@ -17,20 +28,41 @@ struct POSCAR {
     bool selective_dynamics = false;    // optional
     bool is_direct = true;              // true = Direct, false = Cartesian
     std::vector<Atom> coordinates;      // Nx3 coordinates
+    // Per-atom kMove* bits, used when selective_dynamics is set
+    std::vector<std::uint8_t> selective_flags;
     int total_atoms{0};
+    // Interned species: distinct element symbols (repeated element blocks share one entry) and the index
+    // of every atom into them, following elements/num_atoms. Readers and builders keep them in sync; code
+    // that edits elements or num_atoms directly calls updateSpecies().
+    std::vector<std::string> species;
+    std::vector<std::uint16_t> atom_types;
 
+    // File readers accept gzip/xz/zstd compressed input; writers compress when the name ends in .gz/.xz/.zst.
+    // readPOSCAR maps large plain files and parses their coordinates on all cores.
     bool readPOSCAR(const std::string& filename);
     bool writePOSCAR(const std::string& filenameOut);
     void displaceAtoms(int n_atoms, double amplitude);
     void toDirect();
     void toCartesian();
+    void updateSpecies();
+    bool speciesConsistent() const;  // cheap size check of atom_types against num_atoms and coordinates
     bool writeCtrlsFile(const std::string& filenameOut);
+    bool readCtrlsFile(const std::string& filename);
+    // Comment, lattice (scale applied), elements and counts only; coordinates are left empty
+    bool readHeader(const std::string& filename);
+
+    // Stream variants used by the format registry; source only names the input in error messages
+    bool readPOSCAR(std::istream& in, const std::string& source);
+    void writePOSCAR(TextWriter& out) const;
+    bool readCtrls(std::istream& in, const std::string& source);
+    void writeCtrls(TextWriter& out) const;
 
 private:
-    bool readPOSCARHeader(const std::string& filename);
-    bool readPOSCAROptional(const std::string& filename);
-    bool skipLines(std::ifstream& file, int n);
-    bool readPOSCARCoordinates(const std::string& filename);
+    bool readPOSCARHeader(std::istream& file);
+    bool readPOSCAROptional(std::istream& file);
+    bool readPOSCARPreamble(std::istream& in, const std::string& source);  // header and keyword lines
+    bool readPOSCARMapped(const char* data, std::size_t size, const std::string& source);
+    bool readPOSCARCoordinates(std::istream& file);
     void displaceAtom(size_t atom_index, double amplitude);
     void setScaleTo1();
 };
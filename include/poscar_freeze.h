@@ -0,0 +1,24 @@
+#ifndef POSCAR_FREEZE_H_INCLUDED
+#define POSCAR_FREEZE_H_INCLUDED
+
+#include <cstdint>
+#include <string>
+
+#include "poscar_file.h"
+
+struct FreezeRegions {
+    int axis{2};                   // lattice vector normal to the surfaces for --bottom/--top
+    double bottom{0.0};            // Angstrom, 0 = unused
+    double top{0.0};               // Angstrom, 0 = unused
+    double center[3]{};            // fractional centre of the mobile sphere
+    int center_atom{0};            // 1-based atom used as centre, 0 = use center
+    double radius{0.0};            // Angstrom, 0 = unused
+    std::uint8_t fixed{kMoveAll};  // kMove* bits cleared on frozen atoms
+    bool reset{false};             // discard flags read from the input first
+};
+
+bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outputFile, FreezeRegions& regions);
+bool validateInput(const std::string& inputFile, const FreezeRegions& regions);
+void printHelp();
+
+#endif  // POSCAR_FREEZE_H_INCLUDED
@@ -0,0 +1,13 @@
+#ifndef POSCAR_INDEX_H_INCLUDED
+#define POSCAR_INDEX_H_INCLUDED
+
+#include <string>
+
+struct IndexQuery;
+
+bool readInput(int argc, char* argv[], std::string& inputDir, std::string& prefix, std::string& indexFile,
+               IndexQuery& query, bool& update, bool& hasQuery, int& threads);
+bool validateInput(const std::string& inputDir, const std::string& indexFile, const IndexQuery& query, bool update);
+void printHelp();
+
+#endif  // POSCAR_INDEX_H_INCLUDED
@@ -0,0 +1,14 @@
+#ifndef POSCAR_INTERSTITIAL_H_INCLUDED
+#define POSCAR_INTERSTITIAL_H_INCLUDED
+
+#include <string>
+
+struct InterstitialOptions;
+
+bool readInput(int argc, char* argv[], std::string& inputFile, std::string& element, InterstitialOptions& options,
+               double& symprec, std::string& outputPrefix, int& maxOutput);
+bool validateInput(const std::string& inputFile, const std::string& element, const InterstitialOptions& options,
+                   double symprec);
+void printHelp();
+
+#endif  // POSCAR_INTERSTITIAL_H_INCLUDED
@@ -0,0 +1,11 @@
+#ifndef POSCAR_KPOINTS_H_INCLUDED
+#define POSCAR_KPOINTS_H_INCLUDED
+
+#include <string>
+
+bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outputFile, double& kspacing,
+               int& extra, double& symprec, bool& gammaOnly, int& threads);
+bool validateInput(const std::string& inputFile, double kspacing, int extra, double symprec);
+void printHelp();
+
+#endif  // POSCAR_KPOINTS_H_INCLUDED
@@ -0,0 +1,14 @@
+#ifndef POSCAR_NEB_H_INCLUDED
+#define POSCAR_NEB_H_INCLUDED
+
+#include <string>
+
+struct IdppOptions;
+
+bool readInput(int argc, char* argv[], std::string& initialFile, std::string& finalFile, int& images,
+               bool& idpp, bool& match, IdppOptions& options, std::string& outputDir);
+bool validateInput(const std::string& initialFile, const std::string& finalFile, int images,
+                   const IdppOptions& options);
+void printHelp();
+
+#endif  // POSCAR_NEB_H_INCLUDED
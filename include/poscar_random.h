@@ -0,0 +1,17 @@
+#ifndef POSCAR_RANDOM_H_INCLUDED
+#define POSCAR_RANDOM_H_INCLUDED
+
+#include <cstdint>
+#include <string>
+
+struct RandomStructureOptions;
+
+bool readInput(int argc, char* argv[], RandomStructureOptions& options, int& minGroup, int& maxGroup,
+               int& n_structures, std::uint64_t& seed, bool& seedSet, int& threads, std::string& archiveFile);
+
+bool validateInput(const RandomStructureOptions& options, int minGroup, int maxGroup, int n_structures,
+                   bool archive);
+
+void printHelp();
+
+#endif  // POSCAR_RANDOM_H_INCLUDED
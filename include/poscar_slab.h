@@ -0,0 +1,15 @@
+#ifndef POSCAR_SLAB_H_INCLUDED
+#define POSCAR_SLAB_H_INCLUDED
+
+#include <array>
+#include <string>
+#include <vector>
+
+bool readInput(int argc, char* argv[], std::string& inputFile, std::vector<std::array<int, 3>>& millers,
+               int& maxIndex, double& thickness, double& vacuum, double& layerTolerance, double& symprec,
+               std::string& outputPrefix, int& threads);
+bool validateInput(const std::string& inputFile, const std::vector<std::array<int, 3>>& millers, int maxIndex,
+                   double thickness, double vacuum, double layerTolerance, double symprec);
+void printHelp();
+
+#endif  // POSCAR_SLAB_H_INCLUDED
@@ -0,0 +1,14 @@
+#ifndef POSCAR_SQS_H_INCLUDED
+#define POSCAR_SQS_H_INCLUDED
+
+#include <string>
+
+#include "sqs.h"
+
+bool readInput(int argc, char* argv[], std::string& inputFile, int supercell[3], std::string& site,
+               std::string& substitute, int& count, SqsOptions& options, std::string& outputFile);
+bool validateInput(const std::string& inputFile, const int supercell[3], const std::string& site,
+                   const std::string& substitute, int count, const SqsOptions& options);
+void printHelp();
+
+#endif  // POSCAR_SQS_H_INCLUDED
@@ -0,0 +1,14 @@
+#ifndef POSCAR_XRD_H_INCLUDED
+#define POSCAR_XRD_H_INCLUDED
+
+#include <string>
+
+struct XrdOptions;
+
+bool readInput(int argc, char* argv[], std::string& inputFile, std::string& inputDir, std::string& prefix,
+               std::string& outputDir, XrdOptions& options, double& step, double& fwhm);
+bool validateInput(const std::string& inputFile, const std::string& inputDir, const XrdOptions& options, double step,
+                   double fwhm);
+void printHelp();
+
+#endif  // POSCAR_XRD_H_INCLUDED
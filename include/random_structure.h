@@ -0,0 +1,48 @@
+#ifndef RANDOM_STRUCTURE_H_INCLUDED
+#define RANDOM_STRUCTURE_H_INCLUDED
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct POSCAR;
+
+// Space group operation acting on fractional coordinates: x' = rotation * x + translation
+struct SymmetryOperation {
+    int rotation[3][3];
+    double translation[3];
+};
+
+struct SpaceGroupChoice {
+    int number{1};
+    std::vector<SymmetryOperation> operations;  // conventional setting, centring translations included
+};
+
+struct RandomStructureOptions {
+    std::vector<std::pair<std::string, int>> composition;  // atoms per cell for every species
+    double min_volume{0.0};                                // cell volume range in Angstrom^3
+    double max_volume{0.0};
+    double min_distance{1.5};  // minimum distance between any two atoms in Angstrom
+    // Overrides of min_distance for species pairs, keyed by the two symbols in sorted order
+    std::map<std::pair<std::string, std::string>, double> pair_distance;
+    // Space groups to draw from for every cell; empty means P1
+    std::vector<SpaceGroupChoice> spacegroups;
+    int placement_attempts{200};  // random points tried for one orbit before the cell is redrawn
+    int cell_attempts{200};       // cells (and space groups) drawn before giving up
+};
+
+// Builds a random structure in the AIRSS manner: a cell of the drawn space group's lattice family with a
+// random volume in range, filled species by species with random orbits. Images of a point that fall
+// closer than the minimum distance are merged, which lands atoms on special (Wyckoff) positions. Distances
+// to atoms already placed are checked through a spatial hash that grows with the structure. The result
+// depends only on options and seed. Returns false if no structure was found within the attempt limits;
+// spacegroup receives the number of the group that was imposed.
+bool generateRandomStructure(const RandomStructureOptions& options, std::uint64_t seed, POSCAR& out,
+                             int* spacegroup = nullptr);
+
+// Independent, reproducible seed for candidate index of a run started with seed (splitmix64)
+std::uint64_t candidateSeed(std::uint64_t seed, std::uint64_t index);
+
+#endif  // RANDOM_STRUCTURE_H_INCLUDED
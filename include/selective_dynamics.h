@@ -0,0 +1,21 @@
+#ifndef SELECTIVE_DYNAMICS_H_INCLUDED
+#define SELECTIVE_DYNAMICS_H_INCLUDED
+
+#include <cstdint>
+#include <vector>
+
+#include "poscar_file.h"
+
+// Atoms within thickness (Angstrom, measured perpendicular to the other two lattice vectors) of the bottom
+// or top surface along lattice vector axis. The surfaces border the largest empty gap along that axis, so a
+// slab crossing the cell boundary is handled.
+std::vector<int> atomsInSurfaceRegion(const POSCAR& poscar, int axis, double thickness, bool top);
+
+// Atoms with no periodic image within radius (Angstrom) of the fractional point
+std::vector<int> atomsOutsideSphere(const POSCAR& poscar, const double center[3], double radius);
+
+// Clears the fixed kMove* bits of the given atoms and turns on selective dynamics; atoms without stored
+// flags start fully mobile
+void freezeAtoms(POSCAR& poscar, const std::vector<int>& atoms, std::uint8_t fixed);
+
+#endif  // SELECTIVE_DYNAMICS_H_INCLUDED
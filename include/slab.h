@@ -0,0 +1,30 @@
+#ifndef SLAB_H_INCLUDED
+#define SLAB_H_INCLUDED
+
+#include <vector>
+
+#include "poscar_file.h"
+
+// Unimodular integer transform (rows in units of the bulk lattice vectors) whose first two rows span the
+// (hkl) plane and whose third row has h.v3 = 1, built from extended gcds. hkl is reduced by its gcd first.
+// Returns false for hkl = 0 0 0.
+bool millerTransform(const int hkl[3], int transform[3][3]);
+
+// Bulk cell re-expressed in the (hkl) basis: a and b in the surface plane (Gauss-reduced), c the shortest
+// lattice vector with one interplanar step of normal component
+bool orientedCell(const POSCAR& bulk, const int hkl[3], POSCAR& oriented);
+
+// Atomic planes of an oriented cell, as heights along the surface normal within one repeat [0, d)
+struct SlabLayers {
+    double repeat{0.0};          // interplanar repeat d along the normal, Angstrom
+    std::vector<double> height;  // one entry per layer, ascending
+    std::vector<int> atom_layer;  // layer index of every atom
+};
+
+SlabLayers findLayers(const POSCAR& oriented, double tolerance);
+
+// Slab of n_cells stacked repeats starting at layer `termination` at the bottom, with c along the
+// surface normal and the slab centred in vacuum
+POSCAR buildSlab(const POSCAR& oriented, const SlabLayers& layers, int termination, int n_cells, double vacuum);
+
+#endif  // SLAB_H_INCLUDED
@@ -0,0 +1,73 @@
+#ifndef SQS_H_INCLUDED
+#define SQS_H_INCLUDED
+
+#include <vector>
+
+#include "poscar_file.h"
+
+struct SqsOptions {
+    int pair_shells{3};
+    int triplet_shells{1};
+    long long steps{100000};        // Monte Carlo swap attempts per chain
+    int chains{0};                  // independent chains, <= 0 means one per thread
+    int threads{0};                 // <= 0 means all hardware threads
+    unsigned long long seed{12345};  // chain c is seeded with seed + c
+    double temperature{0.05};       // initial annealing temperature in objective units, cooled by 1e3
+};
+
+struct SqsResult {
+    std::vector<signed char> spins;  // per active site: +1 host, -1 substituent
+    double objective{0.0};
+    std::vector<double> pair_correlations;
+    std::vector<double> triplet_correlations;
+    int chain{-1};
+};
+
+// Cluster expansion bookkeeping for a binary sublattice with spins +-1. Pair shells are the distinct
+// distances between active sites (all periodic images within the outermost shell); triplet shell t holds
+// triangles of distinct sites whose longest edge belongs to pair shell t. Per-site neighbour and triplet
+// lists allow flipping one site to update all correlation sums in O(neighbours).
+class SqsModel {
+public:
+    SqsModel(const POSCAR& supercell, const std::vector<int>& active_sites, int pair_shells, int triplet_shells);
+
+    int siteCount() const {
+        return n_sites_;
+    }
+    int pairShellCount() const {
+        return static_cast<int>(pair_offsets_.size());
+    }
+    int tripletShellCount() const {
+        return static_cast<int>(triplet_offsets_.size());
+    }
+    const std::vector<double>& shellDistances() const {
+        return shell_distances_;
+    }
+
+    // Raw sums S_s = sum_i sum_{j in shell s of i} s_i s_j and T_t = sum over triplets of s_a s_b s_c
+    void clusterSums(const std::vector<signed char>& spins, std::vector<double>& pair_sums,
+                     std::vector<double>& triplet_sums) const;
+
+    // Adds to the sums the change caused by flipping site (spins are the values before the flip)
+    void applyFlip(const std::vector<signed char>& spins, int site, std::vector<double>& pair_sums,
+                   std::vector<double>& triplet_sums) const;
+
+    void correlations(const std::vector<double>& pair_sums, const std::vector<double>& triplet_sums,
+                      std::vector<double>& pair, std::vector<double>& triplet) const;
+
+private:
+    int n_sites_;
+    std::vector<double> shell_distances_;
+    std::vector<std::vector<int>> pair_offsets_;  // per shell, CSR offsets over sites
+    std::vector<std::vector<int>> pair_indices_;
+    std::vector<double> pair_terms_;                 // number of ordered pair terms per shell
+    std::vector<std::vector<int>> triplet_offsets_;  // per shell, CSR offsets over sites
+    std::vector<std::vector<int>> triplet_partners_;  // two partner sites per incident triplet
+    std::vector<double> triplet_terms_;              // number of triplets per shell
+};
+
+// Runs independent annealing chains in parallel and returns the configuration whose pair and triplet
+// correlations are closest (sum of absolute deviations) to those of the ideal random alloy.
+SqsResult runSqs(const SqsModel& model, int n_substituted, const SqsOptions& options);
+
+#endif  // SQS_H_INCLUDED
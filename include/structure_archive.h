@@ -0,0 +1,63 @@
+#ifndef STRUCTURE_ARCHIVE_H_INCLUDED
+#define STRUCTURE_ARCHIVE_H_INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "compressed_stream.h"
+
+struct ArchiveEntry {
+    std::string name;
+    std::string contents;
+};
+
+// Writes a POSIX ustar archive of regular files, so many small structures end up in one file that tar can
+// also read. Entries are handed to a dedicated writer thread through a queue of at most queue_depth
+// entries; add() blocks while the queue is full. Names ending in .gz, .xz or .zst compress the archive.
+class ArchiveWriter {
+public:
+    explicit ArchiveWriter(const std::string& filename, std::size_t queue_depth = 64);
+    ~ArchiveWriter();
+
+    ArchiveWriter(const ArchiveWriter&) = delete;
+    ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+    // False if the file could not be created
+    explicit operator bool() const;
+
+    // Queues an entry; false for a name ustar cannot store or once writing has failed
+    bool add(std::string name, std::string contents);
+
+    // Writes the end-of-archive marker and waits for the writer thread; true if everything reached the file
+    bool close();
+
+private:
+    struct State;
+    std::unique_ptr<State> state_;
+};
+
+// Reads the regular files of a tar archive in order, plain or compressed. Directories, links and extended
+// headers are skipped.
+class ArchiveReader {
+public:
+    explicit ArchiveReader(const std::string& filename);
+
+    explicit operator bool() const {
+        return static_cast<bool>(in_);
+    }
+
+    // Next regular file; false at the end of the archive or on a damaged header (see error())
+    bool next(ArchiveEntry& entry);
+
+    const std::string& error() const {
+        return error_;
+    }
+
+private:
+    InputFileStream in_;
+    std::string filename_;
+    std::string error_;
+};
+
+#endif  // STRUCTURE_ARCHIVE_H_INCLUDED
@@ -0,0 +1,35 @@
+#ifndef STRUCTURE_FINGERPRINT_H_INCLUDED
+#define STRUCTURE_FINGERPRINT_H_INCLUDED
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct POSCAR;
+
+struct FingerprintOptions {
+    double cutoff{6.0};     // pair distances up to this radius (Angstrom) enter the histogram
+    double bin_width{0.1};  // histogram bin width (Angstrom)
+};
+
+// Cheap invariants of a periodic structure. Equivalent structures always have equal composition and
+// near-equal volume and histogram, so these filter candidate pairs before any expensive matching.
+struct StructureFingerprint {
+    std::vector<std::pair<std::string, int>> composition;  // element -> count, sorted by element
+    int total_atoms{0};
+    double volume_per_atom{0.0};
+    std::vector<double> distance_histogram;  // neighbours per atom in each distance bin
+    std::size_t composition_hash{0};         // hash of composition, used as bucket key
+};
+
+StructureFingerprint computeFingerprint(const POSCAR& poscar, const FingerprintOptions& options = FingerprintOptions{});
+
+// Relative L1 difference of the cumulative histograms (0 = identical). Working on the cumulative
+// distribution keeps tiny distance changes that cross a bin edge from looking like a large difference.
+double histogramDifference(const std::vector<double>& a, const std::vector<double>& b);
+
+bool fingerprintsCompatible(const StructureFingerprint& a, const StructureFingerprint& b, double volume_tolerance,
+                            double histogram_tolerance);
+
+#endif  // STRUCTURE_FINGERPRINT_H_INCLUDED
@@ -0,0 +1,53 @@
+#ifndef STRUCTURE_FORMATS_H_INCLUDED
+#define STRUCTURE_FORMATS_H_INCLUDED
+
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "poscar_file.h"
+#include "text_writer.h"
+
+// A structure file format. Readers parse one structure from the stream (source only names the input in
+// error messages); writers append one structure. Either may be empty when the direction is unsupported.
+struct StructureFormat {
+    std::string name;
+    std::vector<std::string> extensions;  // lower case with the dot, e.g. ".xyz"
+    std::vector<std::string> prefixes;    // file name prefixes, e.g. "POSCAR" for POSCAR_Si
+    bool multi_frame{false};              // several structures may follow each other in one file
+    std::function<bool(std::istream& in, const std::string& source, POSCAR& poscar)> read;
+    std::function<void(TextWriter& out, const POSCAR& poscar)> write;
+};
+
+// Adds a format, replacing a registered one of the same name. Register before using the registry from
+// several threads; the built-in formats are always present.
+void registerStructureFormat(StructureFormat format);
+
+// Format by name, or by the extension or prefix of the file name (ignoring a compression suffix);
+// nullptr if none matches
+const StructureFormat* structureFormatByName(const std::string& name);
+const StructureFormat* findStructureFormat(const std::string& filename);
+std::vector<const StructureFormat*> structureFormats();
+
+// Read and write through the registry. An empty format picks one from the file name. Files ending in
+// .gz, .xz or .zst are compressed on writing; compressed input is detected by content.
+bool readStructure(const std::string& filename, POSCAR& poscar, const std::string& format = "");
+bool readStructures(const std::string& filename, std::vector<POSCAR>& frames, const std::string& format = "");
+bool writeStructure(const std::string& filename, const POSCAR& poscar, const std::string& format = "");
+bool writeStructures(const std::string& filename, const std::vector<POSCAR>& frames,
+                     const std::string& format = "");
+
+// Extended XYZ with Lattice, Properties (species, pos and the selective dynamics move_mask) and pbc.
+// Atoms are grouped by species in order of first appearance.
+bool readExtxyz(std::istream& in, const std::string& source, POSCAR& poscar);
+void writeExtxyz(TextWriter& out, const POSCAR& poscar);
+
+// LAMMPS data file (atom_style atomic) in the lower triangular cell LAMMPS requires. The structure is
+// rotated into that frame; a left-handed cell comes out mirrored. Types follow the element order.
+void writeLammpsData(TextWriter& out, const POSCAR& poscar);
+
+// CIF in space group P1 with cell parameters and fractional coordinates; the cell orientation is lost
+void writeCif(TextWriter& out, const POSCAR& poscar);
+
+#endif  // STRUCTURE_FORMATS_H_INCLUDED
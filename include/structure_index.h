@@ -0,0 +1,63 @@
+#ifndef STRUCTURE_INDEX_H_INCLUDED
+#define STRUCTURE_INDEX_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Column-wise index of POSCAR headers. Entry i owns composition_species/counts in
+// [composition_offsets[i], composition_offsets[i + 1]); species ids index the interned species table.
+struct StructureIndex {
+    std::vector<std::string> species;
+    std::vector<std::string> paths;
+    std::vector<std::int64_t> mtimes;  // file modification time, filesystem clock ticks
+    std::vector<std::uint64_t> file_sizes;
+    std::vector<std::int32_t> natoms;
+    std::vector<double> volumes;  // Angstrom^3
+    std::vector<std::uint32_t> composition_offsets{0};
+    std::vector<std::uint16_t> composition_species;
+    std::vector<std::int32_t> composition_counts;
+
+    std::size_t size() const {
+        return paths.size();
+    }
+};
+
+struct IndexUpdateStats {
+    std::size_t reused{0};   // unchanged since the last update
+    std::size_t parsed{0};   // new or modified files read
+    std::size_t failed{0};   // files whose header could not be read, left out of the index
+    std::size_t removed{0};  // entries whose file is gone
+};
+
+// Binary index file: a small header followed by the columns as raw arrays (native byte order, which the
+// header records). Load returns false for a missing, foreign or truncated file.
+bool saveStructureIndex(const std::string& filename, const StructureIndex& index);
+bool loadStructureIndex(const std::string& filename, StructureIndex& index);
+
+// Brings the index up to date with the files under directory (recursively) whose names start with
+// prefix. Entries with an unchanged modification time and size are kept; the rest are re-read header
+// only, in parallel. The result is sorted by path.
+IndexUpdateStats updateStructureIndex(StructureIndex& index, const std::string& directory, const std::string& prefix,
+                                      int threads);
+
+struct IndexQuery {
+    std::vector<std::string> contains;                  // every one of these elements must be present
+    std::vector<std::string> exclude;                   // none of these may be present
+    std::vector<std::pair<std::string, int>> formula;   // same reduced composition, if not empty
+    int min_atoms{0};
+    int max_atoms{std::numeric_limits<int>::max()};
+    double min_volume{0.0};
+    double max_volume{std::numeric_limits<double>::infinity()};
+};
+
+// Entries matching every condition, in index order
+std::vector<std::size_t> queryStructureIndex(const StructureIndex& index, const IndexQuery& query);
+
+// "Fe2O3" -> {Fe 2, O 3}; repeated elements add up. False on malformed input.
+bool parseFormula(const std::string& text, std::vector<std::pair<std::string, int>>& composition);
+
+#endif  // STRUCTURE_INDEX_H_INCLUDED
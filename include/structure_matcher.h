@@ -0,0 +1,26 @@
+#ifndef STRUCTURE_MATCHER_H_INCLUDED
+#define STRUCTURE_MATCHER_H_INCLUDED
+
+#include <optional>
+
+struct POSCAR;
+
+struct MatchOptions {
+    double symprec{1e-3};          // spglib tolerance used for standardization
+    double length_tolerance{0.02};  // relative tolerance on lattice lengths (metric and volume)
+    double site_tolerance{0.1};     // Angstrom, maximal distance between matched atoms
+};
+
+// Conventional standardized cell (makeConventionalCell) used as the common frame for matching.
+// Falls back to a fractional copy of the input when spglib cannot standardize it.
+POSCAR standardizeForMatching(const POSCAR& poscar, double symprec);
+
+// Compares two structures that were already passed through standardizeForMatching. Tries every
+// lattice basis change with entries in {-1, 0, 1} that maps one metric onto the other, then every
+// translation that puts an atom of the rarest species onto a partner, and accepts when all atoms
+// find a same-species partner within site_tolerance under periodic boundary conditions.
+bool standardizedStructuresMatch(const POSCAR& a, const POSCAR& b, const MatchOptions& options);
+
+bool structuresEquivalent(const POSCAR& a, const POSCAR& b, const MatchOptions& options = MatchOptions{});
+
+#endif  // STRUCTURE_MATCHER_H_INCLUDED
@@ -0,0 +1,25 @@
+#ifndef STRUCTURE_UTILITY_H_INCLUDED
+#define STRUCTURE_UTILITY_H_INCLUDED
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "poscar_file.h"
+
+// Supercell with lattice rows transform * lattice. The transform must be a non-singular integer matrix;
+// the result is in fractional coordinates and keeps the element grouping of the input.
+POSCAR makeSupercell(const POSCAR& poscar, const int transform[3][3]);
+POSCAR makeSupercell(const POSCAR& poscar, int na, int nb, int nc);
+
+// Element symbol of every atom, expanded from elements/num_atoms
+std::vector<std::string> atomSpecies(const POSCAR& poscar);
+
+// Builds a POSCAR from per-atom species and fractional coordinates, grouping the atoms by species.
+// Species are ordered as in element_order; species not listed there follow in order of first appearance.
+// Non-empty flags (per atom, kMove* bits) turn on selective dynamics and follow the atoms.
+POSCAR buildPOSCAR(const std::string& comment, const double lattice[3][3], const std::vector<std::string>& species,
+                   const std::vector<Atom>& fractional, const std::vector<std::string>& element_order = {},
+                   const std::vector<std::uint8_t>& flags = {});
+
+#endif  // STRUCTURE_UTILITY_H_INCLUDED
@@ -3,17 +3,41 @@
 
 #include <spglib.h>
 
+#include <iostream>
 #include <memory>
 #include <optional>
+#include <vector>
 
 struct POSCAR;
+class Workspace;
+struct SymmetryOperation;
 
 using SpglibDatasetPtr = std::unique_ptr<SpglibDataset, void (*)(SpglibDataset*)>;
 
 SpglibDatasetPtr analyzeSymmetry(const POSCAR& poscar, const double& symprec);
-void printSymmetryInfo(const SpglibDataset& dataset, const bool& wyckoff, const bool& symoperation);
-void printSymmetryOperations(const SpglibDataset& dataset);
+void printSymmetryInfo(const SpglibDataset& dataset, const bool& wyckoff, const bool& symoperation,
+                       std::ostream& out = std::cout);
+void printSymmetryOperations(const SpglibDataset& dataset, std::ostream& out = std::cout);
+// Selective dynamics flags are kept: atoms of one species with different flags count as different kinds
+// for spglib, so flags that break the symmetry give the (larger) cell that still respects them.
 std::optional<POSCAR> makePrimitiveCell(const POSCAR& poscar, const double& symprec);
 std::optional<POSCAR> makeConventionalCell(const POSCAR& poscar, const double& symprec);
 
+// Batch variants: spglib input arrays come from the workspace arena and the cell is written into an
+// existing POSCAR whose storage is reused, so a loop that resets the workspace per structure stays off the
+// heap (apart from spglib's own dataset). The input is not copied in either variant; the output may be the
+// input itself, e.g. makePrimitiveCell(p, symprec, workspace, p).
+SpglibDatasetPtr analyzeSymmetry(const POSCAR& poscar, const double& symprec, Workspace& workspace);
+bool makePrimitiveCell(const POSCAR& poscar, const double& symprec, Workspace& workspace, POSCAR& primitive);
+bool makeConventionalCell(const POSCAR& poscar, const double& symprec, Workspace& workspace,
+                          POSCAR& conventional);
+
+// Operations of space group number (1-230) in its standard setting from the spglib database, centring
+// translations included; false for an unknown number
+bool spacegroupOperations(int number, std::vector<SymmetryOperation>& operations);
+
+// Number of irreducible points of a (shifted) k-point mesh under the given real-space rotations, with
+// time reversal. The rotations must map the mesh onto itself.
+int countIrreducibleKpoints(const int mesh[3], const int is_shift[3], const int (*rotations)[3][3], int n_rot);
+
 #endif  // SYMMETRY_H_INCLUDED
@@ -0,0 +1,41 @@
+#ifndef TEXT_WRITER_H_INCLUDED
+#define TEXT_WRITER_H_INCLUDED
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Buffered text output for structure writers. Numbers are formatted with std::to_chars straight into
+// the buffer (no locale, no stream state), and the buffer goes to the stream in large blocks, so writing
+// large structures is limited by the stream rather than by formatting.
+class TextWriter {
+public:
+    explicit TextWriter(std::ostream& out, std::size_t capacity = 1 << 16);
+    ~TextWriter();
+
+    TextWriter(const TextWriter&) = delete;
+    TextWriter& operator=(const TextWriter&) = delete;
+
+    TextWriter& text(std::string_view s);
+    TextWriter& character(char c);
+    TextWriter& integer(long long value);
+    TextWriter& fixed(double value, int precision);  // like std::fixed << std::setprecision(precision)
+    TextWriter& general(double value);               // shortest representation that reads back exactly
+
+    // Writes the buffer to the stream; false if the stream failed
+    bool flush();
+    std::size_t bytesWritten() const {
+        return written_ + used_;
+    }
+
+private:
+    std::ostream& out_;
+    std::string buffer_;
+    std::size_t used_{0};
+    std::size_t written_{0};
+
+    char* reserve(std::size_t n);
+};
+
+#endif  // TEXT_WRITER_H_INCLUDED
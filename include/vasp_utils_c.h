@@ -0,0 +1,114 @@
+#ifndef VASP_UTILS_C_H_INCLUDED
+#define VASP_UTILS_C_H_INCLUDED
+
+/* C interface of the vasp_utils shared library, for embedding in C, Fortran (iso_c_binding) or Python
+ * (ctypes/cffi) drivers without starting the command line tools. Structures are opaque handles. Functions
+ * work in memory and only touch the file system in the *_file calls. Distinct handles may be used from
+ * different threads at the same time; vu_last_error is per thread. The ABI only grows: new functions may
+ * be added, existing ones keep their signature, and VU_API_VERSION is raised when anything is added. */
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#if defined(VASP_UTILS_BUILDING_LIBRARY)
+#define VU_API __declspec(dllexport)
+#else
+#define VU_API __declspec(dllimport)
+#endif
+#else
+#define VU_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VU_API_VERSION 1
+
+typedef struct vu_structure vu_structure;
+
+typedef enum vu_status {
+    VU_OK = 0,
+    VU_ERROR_ARGUMENT = 1,          /* null handle or pointer, value out of range */
+    VU_ERROR_PARSE = 2,             /* input text is not a valid structure */
+    VU_ERROR_FORMAT = 3,            /* unknown format, or the format cannot be read or written */
+    VU_ERROR_SYMMETRY = 4,          /* spglib found no symmetry for the structure */
+    VU_ERROR_IO = 5,                /* file could not be read or written */
+    VU_ERROR_BUFFER_TOO_SMALL = 6,  /* output did not fit; the required size is reported */
+    VU_ERROR_INTERNAL = 7           /* out of memory or another unexpected failure */
+} vu_status;
+
+/* Version of the library actually loaded, to compare against VU_API_VERSION at run time */
+VU_API int vu_api_version(void);
+VU_API const char* vu_status_string(vu_status status);
+/* Details of the last failed call on this thread; empty after a successful call */
+VU_API const char* vu_last_error(void);
+
+/* ----- Creating and releasing structures ----- */
+
+/* Builds a structure from arrays. lattice rows are the cell vectors in Angstrom; positions holds 3 * n_atoms
+ * fractional (fractional != 0) or Cartesian coordinates; types[i] indexes species. Atoms may be in any
+ * order, the structure groups them by species. */
+VU_API vu_status vu_structure_create(const double lattice[3][3], size_t n_atoms, const double* positions,
+                                     int fractional, const int* types, const char* const* species, size_t n_species,
+                                     vu_structure** out);
+
+/* Parses text in the given format ("poscar", "ctrls", "extxyz"; NULL means "poscar"). The buffer is read in
+ * place, is not copied, and need not be NUL terminated. */
+VU_API vu_status vu_structure_parse(const char* data, size_t size, const char* format, vu_structure** out);
+
+/* Writes the structure as text ("poscar", "ctrls", "extxyz", "lammps", "cif"; NULL means "poscar"). *size
+ * receives the length (without a terminator). If capacity is too small nothing is written and
+ * VU_ERROR_BUFFER_TOO_SMALL is returned; call with buffer NULL and capacity 0 to query the size. */
+VU_API vu_status vu_structure_serialize(const vu_structure* structure, const char* format, char* buffer,
+                                        size_t capacity, size_t* size);
+
+/* File variants; a NULL format is chosen from the file name, and .gz/.xz/.zst files are (de)compressed */
+VU_API vu_status vu_structure_read_file(const char* path, const char* format, vu_structure** out);
+VU_API vu_status vu_structure_write_file(const vu_structure* structure, const char* path, const char* format);
+
+VU_API vu_status vu_structure_clone(const vu_structure* structure, vu_structure** out);
+VU_API void vu_structure_free(vu_structure* structure);
+
+/* ----- Inspecting structures ----- */
+
+VU_API size_t vu_structure_atom_count(const vu_structure* structure);
+VU_API void vu_structure_lattice(const vu_structure* structure, double lattice[3][3]);
+VU_API int vu_structure_is_fractional(const vu_structure* structure);
+/* 3 * atom_count coordinates in the current mode, grouped by species. The pointer stays valid until the
+ * structure is modified or freed. */
+VU_API const double* vu_structure_positions(const vu_structure* structure);
+VU_API size_t vu_structure_species_count(const vu_structure* structure);
+VU_API const char* vu_structure_species_name(const vu_structure* structure, size_t index);
+/* Species index of every atom, atom_count entries */
+VU_API const unsigned short* vu_structure_types(const vu_structure* structure);
+
+/* ----- Transformations ----- */
+
+VU_API vu_status vu_structure_to_fractional(vu_structure* structure);
+VU_API vu_status vu_structure_to_cartesian(vu_structure* structure);
+/* Moves n_atoms randomly chosen atoms (all if n_atoms exceeds the count) by random vectors of length up to
+ * amplitude Angstrom. The same seed gives the same displacement. */
+VU_API vu_status vu_structure_displace(vu_structure* structure, int n_atoms, double amplitude,
+                                       unsigned long seed);
+
+/* ----- Symmetry (spglib) ----- */
+
+typedef struct vu_symmetry_info {
+    int spacegroup_number;
+    int n_operations;
+    int n_independent_atoms; /* symmetrically distinct atoms (Wyckoff orbits) */
+    char international_symbol[11];
+    char hall_symbol[17];
+    char pointgroup_symbol[6];
+} vu_symmetry_info;
+
+VU_API vu_status vu_symmetry(const vu_structure* structure, double symprec, vu_symmetry_info* info);
+VU_API vu_status vu_primitive(const vu_structure* structure, double symprec, vu_structure** out);
+VU_API vu_status vu_conventional(const vu_structure* structure, double symprec, vu_structure** out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VASP_UTILS_C_H_INCLUDED */
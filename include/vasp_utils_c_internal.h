@@ -0,0 +1,36 @@
+#ifndef VASP_UTILS_C_INTERNAL_H_INCLUDED
+#define VASP_UTILS_C_INTERNAL_H_INCLUDED
+
+// Shared by the translation units implementing vasp_utils_c.h; not installed
+
+#include <exception>
+#include <new>
+#include <string>
+
+#include "poscar_file.h"
+#include "vasp_utils_c.h"
+
+struct vu_structure {
+    POSCAR poscar;
+};
+
+// Records the message returned by vu_last_error and passes the status through
+vu_status vuFail(vu_status status, const std::string& message);
+void vuClearError();
+
+// Runs body, turning exceptions into status codes so none crosses the C boundary
+template <typename Body>
+vu_status vuGuard(Body&& body) {
+    vuClearError();
+    try {
+        return body();
+    } catch (const std::bad_alloc&) {
+        return vuFail(VU_ERROR_INTERNAL, "out of memory");
+    } catch (const std::exception& e) {
+        return vuFail(VU_ERROR_INTERNAL, e.what());
+    } catch (...) {
+        return vuFail(VU_ERROR_INTERNAL, "unknown exception");
+    }
+}
+
+#endif  // VASP_UTILS_C_INTERNAL_H_INCLUDED
@@ -0,0 +1,13 @@
+#ifndef VASP_UTILS_CLIENT_H_INCLUDED
+#define VASP_UTILS_CLIENT_H_INCLUDED
+
+#include <string>
+
+struct DaemonRequest;
+
+bool readInput(int argc, char* argv[], std::string& socketPath, std::string& inputFile, std::string& outputFile,
+               DaemonRequest& request, int& repeat);
+bool validateInput(const DaemonRequest& request, int repeat);
+void printHelp();
+
+#endif  // VASP_UTILS_CLIENT_H_INCLUDED
@@ -0,0 +1,9 @@
+#ifndef VASP_UTILSD_H_INCLUDED
+#define VASP_UTILSD_H_INCLUDED
+
+#include <string>
+
+bool readInput(int argc, char* argv[], std::string& socketPath, int& threads);
+void printHelp();
+
+#endif  // VASP_UTILSD_H_INCLUDED
@@ -0,0 +1,50 @@
+#ifndef WORKSPACE_H_INCLUDED
+#define WORKSPACE_H_INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+// Scratch memory for loops over many structures. Temporaries are taken from a monotonic arena with
+// std::pmr containers; reset() between inputs rewinds the arena instead of freeing it. Whatever an input
+// had to take from the heap on top of the arena is added to the arena at the next reset, so once the
+// largest input has been seen the loop makes no per-structure allocations. Not thread safe: use one
+// workspace per thread.
+class Workspace {
+public:
+    explicit Workspace(std::size_t initial_bytes = 64 * 1024);
+    Workspace(const Workspace&) = delete;
+    Workspace& operator=(const Workspace&) = delete;
+
+    std::pmr::memory_resource* resource() { return &*arena_; }
+
+    // Invalidates everything allocated from resource() since the last reset
+    void reset();
+
+    std::size_t capacity() const { return capacity_; }
+    // Bytes taken from the heap since the last reset because the arena was full
+    std::size_t overflowBytes() const { return overflow_.bytes(); }
+
+private:
+    // Upstream of the arena: the default heap, counting what it hands out
+    class OverflowResource : public std::pmr::memory_resource {
+    public:
+        std::size_t bytes() const { return bytes_; }
+        void clear() { bytes_ = 0; }
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        std::size_t bytes_{0};
+    };
+
+    std::size_t capacity_;
+    std::unique_ptr<std::byte[]> buffer_;
+    OverflowResource overflow_;
+    std::optional<std::pmr::monotonic_buffer_resource> arena_;
+};
+
+#endif  // WORKSPACE_H_INCLUDED
@@ -0,0 +1,52 @@
+#ifndef XRD_H_INCLUDED
+#define XRD_H_INCLUDED
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "poscar_file.h"
+
+constexpr double kCuKalpha = 1.54184;  // Angstrom, weighted K-alpha1/alpha2
+
+struct XrdOptions {
+    double wavelength{kCuKalpha};  // Angstrom
+    double two_theta_min{5.0};     // degrees
+    double two_theta_max{90.0};    // degrees
+    double merge_tolerance{1e-3};  // reflections closer than this in 2 theta form one peak, degrees
+    double min_intensity{1e-3};    // peaks weaker than this percentage of the strongest are dropped
+    int threads{0};                // <= 0 means all hardware threads
+};
+
+// Cromer-Mann parametrization f(s) = sum_i a_i exp(-b_i s^2) + c with s = sin(theta) / lambda
+struct FormFactor {
+    double a[4];
+    double b[4];
+    double c;
+};
+
+struct XrdPeak {
+    double two_theta{0.0};  // degrees
+    double d_spacing{0.0};  // Angstrom
+    double intensity{0.0};  // percent of the strongest peak, Lorentz-polarization corrected
+    std::array<int, 3> hkl{};  // representative reflection
+    int multiplicity{0};       // reflections merged into the peak, Friedel pairs included
+};
+
+// Coefficients for an element symbol (suffixes like "_pv" are ignored). Elements missing from the table
+// use the nearest tabulated element scaled by Z; substitute then names it, otherwise it is empty.
+// Returns false for unknown symbols.
+bool formFactor(const std::string& element, FormFactor& factor, std::string& substitute);
+double scatteringFactor(const FormFactor& factor, double s);
+
+// Powder pattern of a fractional structure, peaks sorted by 2 theta. The structure factor sums use
+// per-atom phase tables, so every reflection costs two complex products per atom and no trigonometry.
+// No Debye-Waller factor is applied.
+std::vector<XrdPeak> simulateXrd(const POSCAR& poscar, const std::vector<FormFactor>& species_factors,
+                                 const XrdOptions& options = XrdOptions{});
+
+// Sum of Gaussians of the given FWHM (degrees) with the peak heights, sampled on [min, max] with step
+std::vector<double> broadenPattern(const std::vector<XrdPeak>& peaks, double two_theta_min, double two_theta_max,
+                                   double step, double fwhm);
+
+#endif  // XRD_H_INCLUDED
@@ -0,0 +1,182 @@
+// Replacement of the global allocation functions used for --memstats.
+//
+// Built as the vasp_allocation_hook object library, which CMake links into the command line tools,
+// vasp_bench and the tests only. It is not part of vasp_core, so neither the static libraries nor the
+// vasp_utils shared library replace the allocator of the program that uses them. While memory stats are
+// disabled the replacements cost a single relaxed load on top of malloc/free.
+
+#include <cstdlib>
+#include <new>
+
+#include "instrumentation.h"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#define VASP_UTILS_USABLE_SIZE(ptr) malloc_usable_size(ptr)
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#define VASP_UTILS_USABLE_SIZE(ptr) malloc_size(ptr)
+#endif
+
+namespace {
+
+void* countedAllocate(std::size_t size) noexcept {
+    if (size == 0)
+        size = 1;
+
+    void* ptr = std::malloc(size);
+    if (ptr && memoryStatsEnabled()) {
+#ifdef VASP_UTILS_USABLE_SIZE
+        noteAllocation(VASP_UTILS_USABLE_SIZE(ptr));
+#else
+        noteAllocation(size);
+#endif
+    }
+    return ptr;
+}
+
+#if !defined(_WIN32)
+// Over-aligned requests (std::pmr resources and alignas types); memory from posix_memalign goes to free
+void* countedAllocateAligned(std::size_t size, std::size_t alignment) noexcept {
+    if (size == 0)
+        size = 1;
+    if (alignment < sizeof(void*))
+        alignment = sizeof(void*);
+
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, alignment, size) != 0)
+        return nullptr;
+    if (memoryStatsEnabled()) {
+#ifdef VASP_UTILS_USABLE_SIZE
+        noteAllocation(VASP_UTILS_USABLE_SIZE(ptr));
+#else
+        noteAllocation(size);
+#endif
+    }
+    return ptr;
+}
+#endif
+
+template <typename Allocate>
+void* allocateOrThrow(Allocate allocate) {
+    void* ptr = allocate();
+    while (!ptr) {
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+        ptr = allocate();
+    }
+    return ptr;
+}
+
+void* countedAllocateOrThrow(std::size_t size) {
+    return allocateOrThrow([size] { return countedAllocate(size); });
+}
+
+void countedFree(void* ptr) noexcept {
+    if (!ptr)
+        return;
+#ifdef VASP_UTILS_USABLE_SIZE
+    if (memoryStatsEnabled())
+        noteDeallocation(VASP_UTILS_USABLE_SIZE(ptr));
+#endif
+    std::free(ptr);
+}
+
+}  // namespace
+
+void setMemoryStatsEnabled(bool enabled) {
+    if (enabled)
+        g_instrumentation.fetch_or(kInstrumentMemory, std::memory_order_relaxed);
+    else
+        g_instrumentation.fetch_and(~kInstrumentMemory, std::memory_order_relaxed);
+}
+
+void enableMemoryStats(TimingFormat format) {
+    enableInstrumentationReport(kInstrumentMemory, format);
+}
+
+void* operator new(std::size_t size) {
+    return countedAllocateOrThrow(size);
+}
+
+void* operator new[](std::size_t size) {
+    return countedAllocateOrThrow(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    countedFree(ptr);
+}
+
+#if !defined(_WIN32)
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return allocateOrThrow(
+        [size, alignment] { return countedAllocateAligned(size, static_cast<std::size_t>(alignment)); });
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return allocateOrThrow(
+        [size, alignment] { return countedAllocateAligned(size, static_cast<std::size_t>(alignment)); });
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocateAligned(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocateAligned(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    countedFree(ptr);
+}
+#endif
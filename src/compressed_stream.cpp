@@ -0,0 +1,629 @@
+#include "compressed_stream.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef VASP_UTILS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef VASP_UTILS_HAVE_LZMA
+#include <lzma.h>
+#endif
+#ifdef VASP_UTILS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+constexpr std::size_t kBlockSize = 1 << 18;
+constexpr std::size_t kQueueDepth = 4;  // decoded blocks the worker may run ahead of the reader
+
+bool endsWith(const std::string& s, const char* suffix) {
+    const std::size_t n = std::strlen(suffix);
+    return s.size() > n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+// Bounded hand-over of decoded blocks from the decoding thread to the reader. Blocks are recycled, so a
+// long file needs only kQueueDepth + 2 block allocations.
+class BlockQueue {
+public:
+    // Empty block of kBlockSize bytes for the decoder to fill
+    std::vector<char> spare() {
+        std::vector<char> block;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!spare_.empty()) {
+                block = std::move(spare_.back());
+                spare_.pop_back();
+            }
+        }
+        block.resize(kBlockSize);
+        return block;
+    }
+
+    // Hands the first n bytes to the reader; false once the reader has gone away
+    bool push(std::vector<char>& block, std::size_t n) {
+        block.resize(n);
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [&] { return ready_.size() < kQueueDepth || stopped_; });
+        if (stopped_)
+            return false;
+        ready_.push_back(std::move(block));
+        changed_.notify_all();
+        return true;
+    }
+
+    void finish(std::string error) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = std::move(error);
+        finished_ = true;
+        changed_.notify_all();
+    }
+
+    // Next decoded block, returning the previous one for reuse; false at the end of the data
+    bool pop(std::vector<char>& block) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (block.capacity() > 0)
+            spare_.push_back(std::move(block));
+        changed_.wait(lock, [&] { return !ready_.empty() || finished_; });
+        if (ready_.empty())
+            return false;
+        block = std::move(ready_.front());
+        ready_.pop_front();
+        changed_.notify_all();
+        return true;
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+        changed_.notify_all();
+    }
+
+    std::string error() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return error_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::deque<std::vector<char>> ready_;
+    std::vector<std::vector<char>> spare_;
+    std::string error_;
+    bool finished_{false};
+    bool stopped_{false};
+};
+
+// Decoders run on the worker thread: they read raw from the file and push decoded blocks. They return an
+// error message, empty on success or when the reader stopped early.
+
+#ifdef VASP_UTILS_HAVE_ZLIB
+std::string decodeGzip(std::istream& raw, BlockQueue& queue) {
+    z_stream z{};
+    if (inflateInit2(&z, 15 + 32) != Z_OK)  // +32: accept gzip and zlib headers
+        return "cannot initialise zlib";
+
+    std::vector<char> in(kBlockSize);
+    std::vector<char> out = queue.spare();
+    std::size_t used = 0;
+    bool ended = false;
+    bool stopped = false;
+    std::string error;
+    while (true) {
+        if (z.avail_in == 0) {
+            raw.read(in.data(), static_cast<std::streamsize>(in.size()));
+            z.avail_in = static_cast<uInt>(raw.gcount());
+            z.next_in = reinterpret_cast<Bytef*>(in.data());
+            if (z.avail_in == 0)
+                break;
+        }
+        if (ended) {
+            // Another gzip member follows (concatenated files, as written by pigz or cat)
+            inflateReset(&z);
+            ended = false;
+        }
+        z.next_out = reinterpret_cast<Bytef*>(out.data() + used);
+        z.avail_out = static_cast<uInt>(kBlockSize - used);
+        int ret = inflate(&z, Z_NO_FLUSH);
+        used = kBlockSize - z.avail_out;
+        if (ret == Z_STREAM_END) {
+            ended = true;
+        } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            error = std::string("corrupt gzip data") + (z.msg ? std::string(" (") + z.msg + ")" : "");
+            break;
+        }
+        if (used == kBlockSize) {
+            if (!queue.push(out, used)) {
+                stopped = true;
+                break;
+            }
+            out = queue.spare();
+            used = 0;
+        }
+    }
+    inflateEnd(&z);
+    if (!error.empty() || stopped)
+        return error;
+    if (used > 0)
+        queue.push(out, used);
+    return ended ? "" : "truncated gzip data";
+}
+#endif
+
+#ifdef VASP_UTILS_HAVE_LZMA
+std::string decodeXz(std::istream& raw, BlockQueue& queue) {
+    lzma_stream s = LZMA_STREAM_INIT;
+    if (lzma_stream_decoder(&s, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK)
+        return "cannot initialise liblzma";
+
+    std::vector<char> in(kBlockSize);
+    std::vector<char> out = queue.spare();
+    std::size_t used = 0;
+    lzma_action action = LZMA_RUN;
+    std::string error;
+    while (true) {
+        if (s.avail_in == 0 && action == LZMA_RUN) {
+            raw.read(in.data(), static_cast<std::streamsize>(in.size()));
+            s.avail_in = static_cast<std::size_t>(raw.gcount());
+            s.next_in = reinterpret_cast<const uint8_t*>(in.data());
+            if (s.avail_in == 0)
+                action = LZMA_FINISH;
+        }
+        s.next_out = reinterpret_cast<uint8_t*>(out.data() + used);
+        s.avail_out = kBlockSize - used;
+        lzma_ret ret = lzma_code(&s, action);
+        used = kBlockSize - s.avail_out;
+        if (ret != LZMA_OK && ret != LZMA_STREAM_END) {
+            error = ret == LZMA_BUF_ERROR ? "truncated xz data" : "corrupt xz data";
+            break;
+        }
+        if (used == kBlockSize || ret == LZMA_STREAM_END) {
+            if (!queue.push(out, used))
+                break;
+            out = queue.spare();
+            used = 0;
+        }
+        if (ret == LZMA_STREAM_END)
+            break;
+    }
+    lzma_end(&s);
+    return error;
+}
+#endif
+
+#ifdef VASP_UTILS_HAVE_ZSTD
+std::string decodeZstd(std::istream& raw, BlockQueue& queue) {
+    ZSTD_DCtx* context = ZSTD_createDCtx();
+    if (!context)
+        return "cannot initialise libzstd";
+
+    std::vector<char> in(kBlockSize);
+    std::vector<char> out = queue.spare();
+    ZSTD_outBuffer output{out.data(), kBlockSize, 0};
+    std::size_t remaining = 0;  // non-zero while a frame is incomplete
+    std::string error;
+    bool stopped = false;
+    bool eof = false;
+    while (!stopped && error.empty() && !eof) {
+        raw.read(in.data(), static_cast<std::streamsize>(in.size()));
+        ZSTD_inBuffer input{in.data(), static_cast<std::size_t>(raw.gcount()), 0};
+        eof = input.size == 0;
+        if (eof && remaining == 0)
+            break;
+        // zstd may hold decoded data back, so keep calling until the input is used up and the output was not
+        // filled. At end of file the input is empty: drain what zstd still holds until the frame is complete
+        // or a call makes no progress.
+        for (;;) {
+            const std::size_t produced = output.pos;
+            remaining = ZSTD_decompressStream(context, &output, &input);
+            if (ZSTD_isError(remaining)) {
+                error = std::string("corrupt zstd data (") + ZSTD_getErrorName(remaining) + ")";
+                break;
+            }
+            if (output.pos == output.size) {
+                if (!queue.push(out, output.pos)) {
+                    stopped = true;
+                    break;
+                }
+                out = queue.spare();
+                output = ZSTD_outBuffer{out.data(), kBlockSize, 0};
+            } else if (input.pos == input.size && (!eof || remaining == 0 || output.pos == produced)) {
+                break;
+            }
+        }
+    }
+    if (error.empty() && !stopped && output.pos > 0)
+        queue.push(out, output.pos);
+    ZSTD_freeDCtx(context);
+    if (error.empty() && !stopped && remaining != 0)
+        error = "truncated zstd data";
+    return error;
+}
+#endif
+
+class DecompressingBuffer : public std::streambuf {
+public:
+    DecompressingBuffer(std::unique_ptr<std::ifstream> raw, Compression compression, std::string filename)
+        : raw_(std::move(raw)), filename_(std::move(filename)) {
+        worker_ = std::thread([this, compression] {
+            std::string error;
+            switch (compression) {
+#ifdef VASP_UTILS_HAVE_ZLIB
+                case Compression::Gzip:
+                    error = decodeGzip(*raw_, queue_);
+                    break;
+#endif
+#ifdef VASP_UTILS_HAVE_LZMA
+                case Compression::Xz:
+                    error = decodeXz(*raw_, queue_);
+                    break;
+#endif
+#ifdef VASP_UTILS_HAVE_ZSTD
+                case Compression::Zstd:
+                    error = decodeZstd(*raw_, queue_);
+                    break;
+#endif
+                default:
+                    error = "unsupported compression";
+            }
+            queue_.finish(std::move(error));
+        });
+    }
+
+    ~DecompressingBuffer() override {
+        queue_.stop();
+        worker_.join();
+    }
+
+protected:
+    int_type underflow() override {
+        if (gptr() < egptr())
+            return traits_type::to_int_type(*gptr());
+        if (!queue_.pop(current_)) {
+            std::string error = queue_.error();
+            if (!error.empty() && !reported_) {
+                std::cerr << "Error: " << error << " in " << filename_ << "\n";
+                reported_ = true;
+            }
+            return traits_type::eof();
+        }
+        setg(current_.data(), current_.data(), current_.data() + current_.size());
+        return current_.empty() ? underflow() : traits_type::to_int_type(*gptr());
+    }
+
+private:
+    std::unique_ptr<std::ifstream> raw_;
+    std::string filename_;
+    BlockQueue queue_;
+    std::vector<char> current_;
+    bool reported_{false};
+    std::thread worker_;  // last, so it starts after the other members exist
+};
+
+// Compression on the writing thread; the output side is cheap next to formatting, so no worker is used
+class Encoder {
+public:
+    virtual ~Encoder() = default;
+    // Compresses n bytes and writes what is ready; finish ends the compressed stream
+    virtual bool encode(const char* data, std::size_t n, bool finish, std::ostream& file) = 0;
+};
+
+#ifdef VASP_UTILS_HAVE_ZLIB
+class GzipEncoder : public Encoder {
+public:
+    GzipEncoder() {
+        ok_ = deflateInit2(&z_, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;  // +16: gzip header
+    }
+    ~GzipEncoder() override {
+        if (ok_)
+            deflateEnd(&z_);
+    }
+
+    bool encode(const char* data, std::size_t n, bool finish, std::ostream& file) override {
+        if (!ok_)
+            return false;
+        z_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        z_.avail_in = static_cast<uInt>(n);
+        int ret;
+        do {
+            z_.next_out = reinterpret_cast<Bytef*>(out_);
+            z_.avail_out = sizeof(out_);
+            ret = deflate(&z_, finish ? Z_FINISH : Z_NO_FLUSH);
+            if (ret == Z_STREAM_ERROR)
+                return false;
+            file.write(out_, static_cast<std::streamsize>(sizeof(out_) - z_.avail_out));
+        } while (z_.avail_out == 0 || (finish && ret != Z_STREAM_END));
+        return static_cast<bool>(file);
+    }
+
+private:
+    z_stream z_{};
+    bool ok_{false};
+    char out_[1 << 16];
+};
+#endif
+
+#ifdef VASP_UTILS_HAVE_LZMA
+class XzEncoder : public Encoder {
+public:
+    XzEncoder() {
+        ok_ = lzma_easy_encoder(&s_, 6, LZMA_CHECK_CRC64) == LZMA_OK;
+    }
+    ~XzEncoder() override {
+        lzma_end(&s_);
+    }
+
+    bool encode(const char* data, std::size_t n, bool finish, std::ostream& file) override {
+        if (!ok_)
+            return false;
+        s_.next_in = reinterpret_cast<const uint8_t*>(data);
+        s_.avail_in = n;
+        lzma_ret ret;
+        do {
+            s_.next_out = reinterpret_cast<uint8_t*>(out_);
+            s_.avail_out = sizeof(out_);
+            ret = lzma_code(&s_, finish ? LZMA_FINISH : LZMA_RUN);
+            if (ret != LZMA_OK && ret != LZMA_STREAM_END)
+                return false;
+            file.write(out_, static_cast<std::streamsize>(sizeof(out_) - s_.avail_out));
+        } while (s_.avail_out == 0 || (finish && ret != LZMA_STREAM_END));
+        return static_cast<bool>(file);
+    }
+
+private:
+    lzma_stream s_ = LZMA_STREAM_INIT;
+    bool ok_{false};
+    char out_[1 << 16];
+};
+#endif
+
+#ifdef VASP_UTILS_HAVE_ZSTD
+class ZstdEncoder : public Encoder {
+public:
+    ZstdEncoder() : context_(ZSTD_createCCtx()) {}
+    ~ZstdEncoder() override {
+        ZSTD_freeCCtx(context_);
+    }
+
+    bool encode(const char* data, std::size_t n, bool finish, std::ostream& file) override {
+        if (!context_)
+            return false;
+        ZSTD_inBuffer input{data, n, 0};
+        std::size_t remaining;
+        do {
+            ZSTD_outBuffer output{out_, sizeof(out_), 0};
+            remaining = ZSTD_compressStream2(context_, &output, &input, finish ? ZSTD_e_end : ZSTD_e_continue);
+            if (ZSTD_isError(remaining))
+                return false;
+            file.write(out_, static_cast<std::streamsize>(output.pos));
+        } while (finish ? remaining != 0 : input.pos < input.size);
+        return static_cast<bool>(file);
+    }
+
+private:
+    ZSTD_CCtx* context_;
+    char out_[1 << 16];
+};
+#endif
+
+std::unique_ptr<Encoder> makeEncoder(Compression compression) {
+    switch (compression) {
+#ifdef VASP_UTILS_HAVE_ZLIB
+        case Compression::Gzip:
+            return std::make_unique<GzipEncoder>();
+#endif
+#ifdef VASP_UTILS_HAVE_LZMA
+        case Compression::Xz:
+            return std::make_unique<XzEncoder>();
+#endif
+#ifdef VASP_UTILS_HAVE_ZSTD
+        case Compression::Zstd:
+            return std::make_unique<ZstdEncoder>();
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+class CompressingBuffer : public std::streambuf {
+public:
+    CompressingBuffer(std::unique_ptr<std::ofstream> file, std::unique_ptr<Encoder> encoder)
+        : file_(std::move(file)), encoder_(std::move(encoder)), buffer_(kBlockSize) {
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+    }
+
+    // Ends the compressed stream and closes the file
+    bool finish() {
+        bool ok = ok_ && encoder_->encode(pbase(), static_cast<std::size_t>(pptr() - pbase()), true, *file_);
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+        file_->close();
+        ok_ = false;  // nothing more may be written
+        return ok && !file_->fail();
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        if (!drain())
+            return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override {
+        return drain() ? 0 : -1;
+    }
+
+private:
+    std::unique_ptr<std::ofstream> file_;
+    std::unique_ptr<Encoder> encoder_;
+    std::vector<char> buffer_;
+    bool ok_{true};
+
+    bool drain() {
+        if (ok_ && pptr() > pbase())
+            ok_ = encoder_->encode(pbase(), static_cast<std::size_t>(pptr() - pbase()), false, *file_);
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+        return ok_;
+    }
+};
+
+}  // namespace
+
+Compression compressionFromMagic(const unsigned char* magic, std::size_t n) {
+    if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+        return Compression::Gzip;
+    if (n >= 6 && std::memcmp(magic, "\xfd" "7zXZ\0", 6) == 0)
+        return Compression::Xz;
+    if (n >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+        return Compression::Zstd;
+    return Compression::None;
+}
+
+const char* compressionName(Compression compression) {
+    switch (compression) {
+        case Compression::Gzip:
+            return "gzip";
+        case Compression::Xz:
+            return "xz";
+        case Compression::Zstd:
+            return "zstd";
+        default:
+            return "none";
+    }
+}
+
+bool compressionSupported(Compression compression) {
+    switch (compression) {
+        case Compression::None:
+            return true;
+#ifdef VASP_UTILS_HAVE_ZLIB
+        case Compression::Gzip:
+            return true;
+#endif
+#ifdef VASP_UTILS_HAVE_LZMA
+        case Compression::Xz:
+            return true;
+#endif
+#ifdef VASP_UTILS_HAVE_ZSTD
+        case Compression::Zstd:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+Compression compressionFromName(const std::string& filename) {
+    if (endsWith(filename, ".gz"))
+        return Compression::Gzip;
+    if (endsWith(filename, ".xz"))
+        return Compression::Xz;
+    if (endsWith(filename, ".zst"))
+        return Compression::Zstd;
+    return Compression::None;
+}
+
+std::string stripCompressionSuffix(const std::string& filename) {
+    switch (compressionFromName(filename)) {
+        case Compression::Gzip:
+        case Compression::Xz:
+            return filename.substr(0, filename.size() - 3);
+        case Compression::Zstd:
+            return filename.substr(0, filename.size() - 4);
+        default:
+            return filename;
+    }
+}
+
+InputFileStream::InputFileStream(const std::string& filename) : std::istream(nullptr) {
+    auto raw = std::make_unique<std::ifstream>(filename, std::ios::binary);
+    if (!raw->is_open()) {
+        setstate(std::ios::failbit);
+        return;
+    }
+    unsigned char magic[6] = {};
+    raw->read(reinterpret_cast<char*>(magic), sizeof(magic));
+    compression_ = compressionFromMagic(magic, static_cast<std::size_t>(raw->gcount()));
+
+    if (compression_ == Compression::None) {
+        // Plain text goes through a filebuf like std::ifstream
+        auto file = std::make_unique<std::filebuf>();
+        if (!file->open(filename, std::ios::in)) {
+            setstate(std::ios::failbit);
+            return;
+        }
+        buffer_ = std::move(file);
+    } else if (!compressionSupported(compression_)) {
+        std::cerr << "Error: " << filename << " is " << compressionName(compression_)
+                  << " compressed, but this build has no " << compressionName(compression_) << " support\n";
+        setstate(std::ios::failbit);
+        return;
+    } else {
+        raw->clear();
+        raw->seekg(0);
+        buffer_ = std::make_unique<DecompressingBuffer>(std::move(raw), compression_, filename);
+    }
+    rdbuf(buffer_.get());
+}
+
+InputFileStream::~InputFileStream() {
+    rdbuf(nullptr);
+}
+
+OutputFileStream::OutputFileStream(const std::string& filename)
+    : std::ostream(nullptr), compression_(compressionFromName(filename)) {
+    if (compression_ == Compression::None) {
+        auto file = std::make_unique<std::filebuf>();
+        if (!file->open(filename, std::ios::out | std::ios::trunc)) {
+            setstate(std::ios::failbit);
+            return;
+        }
+        buffer_ = std::move(file);
+    } else if (!compressionSupported(compression_)) {
+        std::cerr << "Error: cannot write " << filename << ", this build has no " << compressionName(compression_)
+                  << " support\n";
+        setstate(std::ios::failbit);
+        return;
+    } else {
+        auto file = std::make_unique<std::ofstream>(filename, std::ios::binary | std::ios::trunc);
+        if (!*file) {
+            setstate(std::ios::failbit);
+            return;
+        }
+        buffer_ = std::make_unique<CompressingBuffer>(std::move(file), makeEncoder(compression_));
+    }
+    rdbuf(buffer_.get());
+}
+
+OutputFileStream::~OutputFileStream() {
+    close();
+    rdbuf(nullptr);
+}
+
+bool OutputFileStream::close() {
+    if (closed_ || !buffer_)
+        return !fail();
+    closed_ = true;
+
+    bool ok;
+    if (compression_ == Compression::None) {
+        auto* file = static_cast<std::filebuf*>(buffer_.get());
+        ok = file->close() != nullptr;
+    } else {
+        ok = static_cast<CompressingBuffer*>(buffer_.get())->finish();
+    }
+    if (!ok)
+        setstate(std::ios::badbit);
+    return ok && !fail();
+}
@@ -0,0 +1,125 @@
+#include "coordinate_parser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "parallel_utility.h"
+#include "poscar_file.h"
+
+namespace {
+
+constexpr std::size_t kNoError = std::numeric_limits<std::size_t>::max();
+
+const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        ++p;
+    return p;
+}
+
+bool parseValue(const char*& p, const char* end, double& value) {
+    p = skipBlanks(p, end);
+    if (p < end && *p == '+')
+        ++p;
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc())
+        return false;
+    p = result.ptr;
+    return true;
+}
+
+// One T/F flag token; only its first character matters
+bool parseFlag(const char*& p, const char* end, bool& set) {
+    p = skipBlanks(p, end);
+    if (p == end || (*p != 'T' && *p != 't' && *p != 'F' && *p != 'f'))
+        return false;
+    set = *p == 'T' || *p == 't';
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\r')
+        ++p;
+    return true;
+}
+
+bool parseLine(const char* p, const char* end, Atom& atom, std::uint8_t* flags) {
+    if (!parseValue(p, end, atom.x) || !parseValue(p, end, atom.y) || !parseValue(p, end, atom.z))
+        return false;
+    if (flags) {
+        std::uint8_t bits = 0;
+        for (std::uint8_t bit : {kMoveX, kMoveY, kMoveZ}) {
+            bool set = false;
+            if (!parseFlag(p, end, set))
+                return false;
+            if (set)
+                bits |= bit;
+        }
+        *flags = bits;
+    }
+    return true;
+}
+
+std::size_t countLines(const char* begin, const char* end) {
+    std::size_t lines = 0;
+    for (const char* p = begin; p < end; ++lines) {
+        const void* newline = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+        if (!newline)
+            return lines + 1;  // last line without a terminator
+        p = static_cast<const char*>(newline) + 1;
+    }
+    return lines;
+}
+
+}  // namespace
+
+bool parseCoordinateBlock(const char* begin, const char* end, std::size_t count, Atom* atoms, std::uint8_t* flags,
+                          int n_threads, std::size_t min_chunk_bytes) {
+    n_threads = resolveThreadCount(n_threads);
+    const std::size_t size = static_cast<std::size_t>(end - begin);
+
+    // A few chunks per thread so uneven lines balance; each chunk boundary moves to the next line start
+    std::size_t n_chunks = std::max<std::size_t>(1, size / std::max<std::size_t>(min_chunk_bytes, 1));
+    n_chunks = std::min(n_chunks, static_cast<std::size_t>(n_threads) * 4);
+    std::vector<const char*> bounds(n_chunks + 1, end);
+    bounds[0] = begin;
+    for (std::size_t c = 1; c < n_chunks; ++c) {
+        const char* p = std::max(begin + c * size / n_chunks, bounds[c - 1]);
+        const void* newline = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+        bounds[c] = newline ? static_cast<const char*>(newline) + 1 : end;
+    }
+
+    std::vector<std::size_t> first(n_chunks + 1, 0);
+    parallelFor(n_chunks, n_threads, [&](std::size_t c) { first[c + 1] = countLines(bounds[c], bounds[c + 1]); });
+    for (std::size_t c = 0; c < n_chunks; ++c)
+        first[c + 1] += first[c];
+    if (first[n_chunks] < count) {
+        std::cerr << "Error: not enough coordinate lines in POSCAR\n";
+        return false;
+    }
+
+    // Lines past count (velocities, a trailing block) are left alone
+    std::vector<std::size_t> bad(n_chunks, kNoError);
+    parallelFor(n_chunks, n_threads, [&](std::size_t c) {
+        const char* p = bounds[c];
+        for (std::size_t i = first[c]; i < std::min(first[c + 1], count); ++i) {
+            const void* newline = std::memchr(p, '\n', static_cast<std::size_t>(bounds[c + 1] - p));
+            const char* line_end = newline ? static_cast<const char*>(newline) : bounds[c + 1];
+            if (!parseLine(p, line_end, atoms[i], flags ? flags + i : nullptr)) {
+                bad[c] = i;
+                return;
+            }
+            p = line_end + 1;
+        }
+    });
+
+    for (std::size_t c = 0; c < n_chunks; ++c) {
+        if (bad[c] == kNoError)
+            continue;
+        if (flags)
+            std::cerr << "Error: failed to parse coordinates or selective dynamics flags for atom " << bad[c] << "\n";
+        else
+            std::cerr << "Error: failed to parse coordinates for atom " << bad[c] << "\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,186 @@
+#include "daemon_protocol.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+bool socketAddress(const std::string& path, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: invalid socket path " << path << "\n";
+        return false;
+    }
+    std::memcpy(address.sun_path, path.data(), path.size());
+    return true;
+}
+
+bool writeAll(int fd, const char* data, std::size_t n) {
+    while (n > 0) {
+        ssize_t written = ::send(fd, data, n, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+        data += written;
+        n -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool readAll(int fd, char* data, std::size_t n) {
+    while (n > 0) {
+        ssize_t received = ::recv(fd, data, n, 0);
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received <= 0)
+            return false;
+        data += received;
+        n -= static_cast<std::size_t>(received);
+    }
+    return true;
+}
+
+}  // namespace
+
+void formatRequest(const DaemonRequest& request, std::string& payload) {
+    payload.clear();
+    payload += request.command;
+    for (const auto& [key, value] : request.options) {
+        payload += ' ';
+        payload += key;
+        payload += '=';
+        payload += value;
+    }
+    payload += '\n';
+    payload += request.structure;
+}
+
+bool parseRequest(const std::string& payload, DaemonRequest& request) {
+    std::size_t end = payload.find('\n');
+    if (end == std::string::npos)
+        return false;
+
+    request.command.clear();
+    request.options.clear();
+    for (std::size_t pos = 0; pos < end;) {
+        if (payload[pos] == ' ') {
+            ++pos;
+            continue;
+        }
+        std::size_t stop = std::min(payload.find(' ', pos), end);
+        if (request.command.empty()) {
+            request.command.assign(payload, pos, stop - pos);
+        } else {
+            std::size_t eq = payload.find('=', pos);
+            if (eq >= stop || eq == pos)
+                return false;
+            request.options[payload.substr(pos, eq - pos)] = payload.substr(eq + 1, stop - eq - 1);
+        }
+        pos = stop;
+    }
+    if (request.command.empty())
+        return false;
+    request.structure.assign(payload, end + 1, std::string::npos);
+    return true;
+}
+
+void formatResponse(const DaemonResponse& response, std::string& payload) {
+    payload.assign(response.ok ? "ok\n" : "error\n");
+    payload += response.body;
+}
+
+bool parseResponse(const std::string& payload, DaemonResponse& response) {
+    std::size_t end = payload.find('\n');
+    if (end == std::string::npos)
+        return false;
+    if (payload.compare(0, end, "ok") == 0)
+        response.ok = true;
+    else if (payload.compare(0, end, "error") == 0)
+        response.ok = false;
+    else
+        return false;
+    response.body.assign(payload, end + 1, std::string::npos);
+    return true;
+}
+
+bool writeFrame(int fd, const std::string& payload) {
+    if (payload.size() > kMaxFrameSize)
+        return false;
+    const std::uint32_t n = static_cast<std::uint32_t>(payload.size());
+    const unsigned char length[4] = {static_cast<unsigned char>(n >> 24), static_cast<unsigned char>(n >> 16),
+                                     static_cast<unsigned char>(n >> 8), static_cast<unsigned char>(n)};
+    return writeAll(fd, reinterpret_cast<const char*>(length), 4) && writeAll(fd, payload.data(), payload.size());
+}
+
+bool readFrame(int fd, std::string& payload) {
+    unsigned char length[4];
+    if (!readAll(fd, reinterpret_cast<char*>(length), 4))
+        return false;
+    const std::size_t n = (std::size_t{length[0]} << 24) | (std::size_t{length[1]} << 16) |
+                          (std::size_t{length[2]} << 8) | std::size_t{length[3]};
+    if (n > kMaxFrameSize)
+        return false;
+    payload.resize(n);
+    return n == 0 || readAll(fd, &payload[0], n);
+}
+
+std::string defaultSocketPath() {
+    if (const char* path = std::getenv("VASP_UTILSD_SOCKET"))
+        return path;
+    return "/tmp/vasp_utilsd." + std::to_string(::getuid()) + ".sock";
+}
+
+int listenUnixSocket(const std::string& path, int backlog) {
+    sockaddr_un address;
+    if (!socketAddress(path, address))
+        return -1;
+
+    // A socket file nobody accepts on is left over from a server that did not shut down cleanly
+    int probe = connectUnixSocket(path);
+    if (probe >= 0) {
+        ::close(probe);
+        std::cerr << "Error: a server is already listening on " << path << "\n";
+        return -1;
+    }
+    ::unlink(path.c_str());
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::cerr << "Error: cannot create socket: " << std::strerror(errno) << "\n";
+        return -1;
+    }
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, backlog) != 0) {
+        std::cerr << "Error: cannot listen on " << path << ": " << std::strerror(errno) << "\n";
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int connectUnixSocket(const std::string& path) {
+    sockaddr_un address;
+    if (!socketAddress(path, address))
+        return -1;
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    int rc;
+    do {
+        rc = ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    } while (rc != 0 && errno == EINTR);
+    if (rc != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
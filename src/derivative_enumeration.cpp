@@ -0,0 +1,176 @@
+#include "derivative_enumeration.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "lattice_utility.h"
+#include "parallel_utility.h"
+#include "poscar_file.h"
+
+namespace {
+
+constexpr std::uint64_t kChunkSize = 1u << 16;
+// Chunks handed to the thread pool at once; bounds the per-chunk bookkeeping for huge C(n, k)
+constexpr std::uint64_t kChunksPerBatch = 1024;
+
+// Next larger integer with the same number of set bits (Gosper's hack)
+inline Occupation nextCombination(Occupation x) {
+    Occupation u = x & (~x + 1);
+    Occupation v = u + x;
+    return v + (((v ^ x) / u) >> 2);
+}
+
+// Combination with the given rank in colexicographic order, which is the numeric order of the bitsets
+Occupation unrankCombination(std::uint64_t rank, int n_sites, int k) {
+    Occupation config = 0;
+    int upper = n_sites;
+    for (int i = k; i >= 1; --i) {
+        int c = i - 1;
+        while (c + 1 < upper && binomial(c + 1, i) <= rank)
+            ++c;
+        rank -= binomial(c, i);
+        config |= Occupation{1} << c;
+        upper = c;
+    }
+    return config;
+}
+
+}  // namespace
+
+std::uint64_t binomial(int n, int k) {
+    if (k < 0 || k > n)
+        return 0;
+    k = std::min(k, n - k);
+    std::uint64_t result = 1;
+    for (int i = 1; i <= k; ++i) {
+        // result * (n - k + i) / i stays exact because result is C(n - k + i - 1, i - 1)
+        result = result / i * (n - k + i) + result % i * (n - k + i) / i;
+    }
+    return result;
+}
+
+std::vector<std::vector<int>> activeSitePermutations(const POSCAR& supercell, const int (*rotations)[3][3],
+                                                     const double (*translations)[3], int n_operations,
+                                                     const std::vector<int>& active_sites, double tolerance) {
+    POSCAR direct = supercell;
+    direct.toDirect();
+
+    const int n = static_cast<int>(active_sites.size());
+    std::vector<std::vector<int>> perms;
+
+    for (int op = 0; op < n_operations; ++op) {
+        const int(*rot)[3] = rotations[op];
+        const double* trans = translations[op];
+
+        std::vector<int> perm(n, -1);
+        bool ok = true;
+        for (int a = 0; a < n && ok; ++a) {
+            const Atom& atom = direct.coordinates[active_sites[a]];
+            const double x[3] = {atom.x, atom.y, atom.z};
+            double y[3];
+            for (int i = 0; i < 3; ++i)
+                y[i] = rot[i][0] * x[0] + rot[i][1] * x[1] + rot[i][2] * x[2] + trans[i];
+
+            int best = -1;
+            double best_dist = std::numeric_limits<double>::max();
+            for (int b = 0; b < n; ++b) {
+                const Atom& other = direct.coordinates[active_sites[b]];
+                const double d[3] = {y[0] - other.x, y[1] - other.y, y[2] - other.z};
+                double dist = minimumImageDistance(direct.lattice, d);
+                if (dist < best_dist) {
+                    best_dist = dist;
+                    best = b;
+                }
+            }
+            if (best < 0 || best_dist > tolerance)
+                ok = false;
+            else
+                perm[a] = best;
+        }
+        if (ok)
+            perms.push_back(perm);
+    }
+
+    std::sort(perms.begin(), perms.end());
+    perms.erase(std::unique(perms.begin(), perms.end()), perms.end());
+    return perms;
+}
+
+OccupationCanonicalizer::OccupationCanonicalizer(const std::vector<std::vector<int>>& permutations, int n_sites)
+    : n_nibbles_((n_sites + 3) / 4), n_perms_(permutations.size()) {
+    tables_.assign(n_perms_ * n_nibbles_ * 16, 0);
+
+    for (std::size_t p = 0; p < n_perms_; ++p) {
+        for (int q = 0; q < n_nibbles_; ++q) {
+            Occupation* table = &tables_[(p * n_nibbles_ + q) * 16];
+            for (int v = 0; v < 16; ++v) {
+                Occupation image = 0;
+                for (int b = 0; b < 4; ++b) {
+                    int site = 4 * q + b;
+                    if ((v & (1 << b)) && site < n_sites)
+                        image |= Occupation{1} << permutations[p][site];
+                }
+                table[v] = image;
+            }
+        }
+    }
+}
+
+Occupation OccupationCanonicalizer::apply(std::size_t perm, Occupation config) const {
+    const Occupation* table = &tables_[perm * n_nibbles_ * 16];
+    Occupation image = 0;
+    for (int q = 0; q < n_nibbles_; ++q, table += 16)
+        image |= table[(config >> (4 * q)) & 0xF];
+    return image;
+}
+
+bool OccupationCanonicalizer::isCanonical(Occupation config, std::uint64_t* orbit_size) const {
+    std::uint64_t stabilizer = 0;
+    for (std::size_t p = 0; p < n_perms_; ++p) {
+        Occupation image = apply(p, config);
+        if (image < config)
+            return false;
+        if (image == config)
+            stabilizer++;
+    }
+    if (orbit_size)
+        *orbit_size = stabilizer > 0 ? n_perms_ / stabilizer : 1;
+    return true;
+}
+
+std::vector<EnumeratedConfiguration> enumerateInequivalent(int n_sites, int n_substituted,
+                                                           const OccupationCanonicalizer& canonicalizer,
+                                                           int n_threads) {
+    std::vector<EnumeratedConfiguration> result;
+    if (n_sites <= 0 || n_sites > kMaxActiveSites || n_substituted < 0 || n_substituted > n_sites)
+        return result;
+
+    const std::uint64_t total = binomial(n_sites, n_substituted);
+    const std::uint64_t n_chunks = (total + kChunkSize - 1) / kChunkSize;
+    std::vector<std::vector<EnumeratedConfiguration>> chunks(std::min(n_chunks, kChunksPerBatch));
+
+    for (std::uint64_t first = 0; first < n_chunks; first += kChunksPerBatch) {
+        const std::uint64_t batch = std::min(kChunksPerBatch, n_chunks - first);
+        parallelFor(batch, n_threads, [&](std::size_t c) {
+            const std::uint64_t begin = (first + c) * kChunkSize;
+            const std::uint64_t count = std::min(kChunkSize, total - begin);
+
+            Occupation config = unrankCombination(begin, n_sites, n_substituted);
+            for (std::uint64_t i = 0; i < count; ++i) {
+                std::uint64_t orbit = 0;
+                if (canonicalizer.isCanonical(config, &orbit))
+                    chunks[c].push_back({config, orbit});
+                if (i + 1 < count && n_substituted > 0)
+                    config = nextCombination(config);
+            }
+        });
+
+        // Merged in chunk order, so the result stays sorted by occupation
+        for (std::uint64_t c = 0; c < batch; ++c) {
+            result.insert(result.end(), chunks[c].begin(), chunks[c].end());
+            chunks[c].clear();
+        }
+    }
+    return result;
+}
@@ -0,0 +1,369 @@
+#include "ewald.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "lattice_utility.h"
+#include "parallel_utility.h"
+#include "structure_utility.h"
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Cartesian positions, image shifts and half-space k-vectors in separate arrays so the inner loops are
+// contiguous. Only the charge-weighted structure-factor sums and the Phi row updates vectorize; the
+// image loop in realPair (cutoff branch, erfc) and the sin/cos table stay scalar library calls.
+struct EwaldSetup {
+    int n{0};
+    double volume{0.0};
+    EwaldParameters params{};
+    double lattice[3][3]{};
+    double inverse[3][3]{};
+    std::vector<double> fx, fy, fz;  // fractional, wrapped into [0, 1)
+    std::vector<double> sx, sy, sz;  // real-space image shifts covering the real cutoff
+    std::vector<double> kx, ky, kz;  // one of each +-k pair
+    std::vector<double> kweight;     // exp(-k^2 / 4 alpha^2) / k^2
+};
+
+EwaldSetup makeSetup(const POSCAR& poscar, const EwaldOptions& options) {
+    POSCAR direct = poscar;
+    direct.toDirect();
+
+    EwaldSetup setup;
+    setup.n = direct.total_atoms;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            setup.lattice[i][j] = direct.lattice[i][j];
+    invert3(setup.lattice, setup.inverse);
+    setup.volume = cellVolume(setup.lattice);
+    setup.params = ewaldParameters(setup.lattice, setup.n, options);
+
+    for (const auto& atom : direct.coordinates) {
+        setup.fx.push_back(wrapFractional(atom.x));
+        setup.fy.push_back(wrapFractional(atom.y));
+        setup.fz.push_back(wrapFractional(atom.z));
+    }
+
+    // Pair differences are wrapped into [-0.5, 0.5), so half a cell more than the cutoff is enough
+    double heights[3];
+    perpendicularHeights(setup.lattice, heights);
+    int range[3];
+    for (int k = 0; k < 3; ++k)
+        range[k] = static_cast<int>(std::ceil(setup.params.real_cutoff / heights[k] + 0.5));
+    for (int a = -range[0]; a <= range[0]; ++a)
+        for (int b = -range[1]; b <= range[1]; ++b)
+            for (int c = -range[2]; c <= range[2]; ++c) {
+                const double f[3] = {double(a), double(b), double(c)};
+                double s[3];
+                fractionalToCartesian(setup.lattice, f, s);
+                setup.sx.push_back(s[0]);
+                setup.sy.push_back(s[1]);
+                setup.sz.push_back(s[2]);
+            }
+
+    double reciprocal[3][3];
+    reciprocalLattice(setup.lattice, reciprocal);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            reciprocal[i][j] *= 2.0 * kPi;
+
+    // Spacing of reciprocal planes is 2 pi / |a_i|
+    const double gmax = setup.params.recip_cutoff;
+    int krange[3];
+    for (int k = 0; k < 3; ++k) {
+        double length = std::sqrt(setup.lattice[k][0] * setup.lattice[k][0] + setup.lattice[k][1] * setup.lattice[k][1] +
+                                  setup.lattice[k][2] * setup.lattice[k][2]);
+        krange[k] = static_cast<int>(std::ceil(gmax * length / (2.0 * kPi)));
+    }
+    const double inv4a2 = 1.0 / (4.0 * setup.params.alpha * setup.params.alpha);
+    for (int a = 0; a <= krange[0]; ++a)
+        for (int b = (a == 0 ? 0 : -krange[1]); b <= krange[1]; ++b)
+            for (int c = (a == 0 && b == 0 ? 1 : -krange[2]); c <= krange[2]; ++c) {
+                double g[3];
+                for (int j = 0; j < 3; ++j)
+                    g[j] = a * reciprocal[0][j] + b * reciprocal[1][j] + c * reciprocal[2][j];
+                double g2 = g[0] * g[0] + g[1] * g[1] + g[2] * g[2];
+                if (g2 > gmax * gmax)
+                    continue;
+                setup.kx.push_back(g[0]);
+                setup.ky.push_back(g[1]);
+                setup.kz.push_back(g[2]);
+                setup.kweight.push_back(std::exp(-g2 * inv4a2) / g2);
+            }
+    return setup;
+}
+
+// Cartesian minimum-convention difference r_j - r_i (fractional difference wrapped into [-0.5, 0.5))
+void pairDelta(const EwaldSetup& setup, int i, int j, double d[3]) {
+    double f[3] = {setup.fx[j] - setup.fx[i], setup.fy[j] - setup.fy[i], setup.fz[j] - setup.fz[i]};
+    for (double& x : f)
+        x -= std::round(x);
+    fractionalToCartesian(setup.lattice, f, d);
+}
+
+// Sum over images of erfc(alpha r) / r, skipping r = 0 (an atom with itself in the home cell). Scalar:
+// most images fall outside the cutoff, and erfc has no vector form without a fast-math libm.
+double realPair(const EwaldSetup& setup, int i, int j) {
+    double d[3];
+    pairDelta(setup, i, j, d);
+
+    const double alpha = setup.params.alpha;
+    const double rc2 = setup.params.real_cutoff * setup.params.real_cutoff;
+    const size_t n_images = setup.sx.size();
+    double sum = 0.0;
+    for (size_t s = 0; s < n_images; ++s) {
+        const double x = d[0] + setup.sx[s];
+        const double y = d[1] + setup.sy[s];
+        const double z = d[2] + setup.sz[s];
+        const double r2 = x * x + y * y + z * z;
+        if (r2 > rc2 || r2 < 1e-20)
+            continue;
+        const double r = std::sqrt(r2);
+        sum += std::erfc(alpha * r) / r;
+    }
+    return sum;
+}
+
+// cos(k . r_i) and sin(k . r_i), stored k-major so a row over atoms is contiguous
+void structureFactors(const EwaldSetup& setup, std::vector<double>& cosines, std::vector<double>& sines,
+                      int threads) {
+    const size_t n_k = setup.kx.size();
+    const int n = setup.n;
+    std::vector<double> x(n), y(n), z(n);
+    for (int i = 0; i < n; ++i) {
+        const double f[3] = {setup.fx[i], setup.fy[i], setup.fz[i]};
+        double r[3];
+        fractionalToCartesian(setup.lattice, f, r);
+        x[i] = r[0];
+        y[i] = r[1];
+        z[i] = r[2];
+    }
+
+    cosines.resize(n_k * n);
+    sines.resize(n_k * n);
+    parallelFor(n_k, threads, [&](size_t k) {
+        double* c = &cosines[k * n];
+        double* s = &sines[k * n];
+        for (int i = 0; i < n; ++i) {
+            const double phase = setup.kx[k] * x[i] + setup.ky[k] * y[i] + setup.kz[k] * z[i];
+            c[i] = std::cos(phase);
+            s[i] = std::sin(phase);
+        }
+    });
+}
+
+}  // namespace
+
+EwaldParameters ewaldParameters(const double lattice[3][3], int n_atoms, const EwaldOptions& options) {
+    const double volume = cellVolume(lattice);
+    const double p = -std::log(options.accuracy > 0.0 && options.accuracy < 1.0 ? options.accuracy : 1e-8);
+
+    // Real-space work grows with the cutoff volume per atom pair, reciprocal work with the k-sphere per atom;
+    // this alpha balances the two (the weight accounts for erfc being costlier than sin/cos)
+    double alpha = options.alpha;
+    if (alpha <= 0.0) {
+        const double weight = 1.0 / std::sqrt(2.0);
+        alpha = std::sqrt(kPi * std::cbrt(std::max(n_atoms, 1) * weight / (volume * volume)));
+    }
+
+    EwaldParameters params;
+    params.alpha = alpha;
+    params.real_cutoff = std::sqrt(p) / alpha;
+    params.recip_cutoff = 2.0 * alpha * std::sqrt(p);
+    return params;
+}
+
+bool atomCharges(const POSCAR& poscar, const std::map<std::string, double>& oxidation_states,
+                 std::vector<double>& charges) {
+    charges.clear();
+    POSCAR typed;
+    const POSCAR* source = &poscar;
+    if (!poscar.speciesConsistent()) {
+        typed = poscar;
+        typed.updateSpecies();
+        source = &typed;
+    }
+
+    // One lookup per species instead of per atom
+    std::vector<double> species_charge;
+    for (const std::string& element : source->species) {
+        auto it = oxidation_states.find(element);
+        if (it == oxidation_states.end()) {
+            std::cerr << "Error: no oxidation state given for element " << element << "\n";
+            return false;
+        }
+        species_charge.push_back(it->second);
+    }
+    charges.reserve(source->atom_types.size());
+    for (std::uint16_t type : source->atom_types)
+        charges.push_back(species_charge[type]);
+    return true;
+}
+
+bool parseOxidationStates(const std::string& text, std::map<std::string, double>& oxidation_states) {
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t colon = item.find(':');
+        if (colon == std::string::npos || colon == 0)
+            return false;
+        try {
+            oxidation_states[item.substr(0, colon)] = std::stod(item.substr(colon + 1));
+        } catch (...) {
+            return false;
+        }
+    }
+    return !oxidation_states.empty();
+}
+
+EwaldEnergy ewaldEnergy(const POSCAR& poscar, const std::vector<double>& charges, const EwaldOptions& options) {
+    EwaldSetup setup = makeSetup(poscar, options);
+    const int n = setup.n;
+    const double alpha = setup.params.alpha;
+
+    EwaldEnergy energy;
+    if (n == 0 || static_cast<int>(charges.size()) != n)
+        return energy;
+
+    // Real space: one partial sum per row keeps the result independent of the thread count
+    std::vector<double> rows(n, 0.0);
+    parallelFor(static_cast<size_t>(n), options.threads, [&](size_t i) {
+        double sum = 0.5 * charges[i] * realPair(setup, static_cast<int>(i), static_cast<int>(i));
+        for (int j = static_cast<int>(i) + 1; j < n; ++j)
+            sum += charges[j] * realPair(setup, static_cast<int>(i), j);
+        rows[i] = charges[i] * sum;
+    });
+    for (double r : rows)
+        energy.real += r;
+
+    // Reciprocal space: (2 pi / V) sum_k w(k) |S(k)|^2, each +-k pair counted once
+    std::vector<double> cosines, sines;
+    structureFactors(setup, cosines, sines, options.threads);
+    const size_t n_k = setup.kx.size();
+    std::vector<double> terms(n_k, 0.0);
+    parallelFor(n_k, options.threads, [&](size_t k) {
+        double re = 0.0, im = 0.0;
+        const double* c = &cosines[k * n];
+        const double* s = &sines[k * n];
+        for (int i = 0; i < n; ++i) {
+            re += charges[i] * c[i];
+            im += charges[i] * s[i];
+        }
+        terms[k] = setup.kweight[k] * (re * re + im * im);
+    });
+    for (double t : terms)
+        energy.reciprocal += t;
+    energy.reciprocal *= 4.0 * kPi / setup.volume;
+
+    double q2 = 0.0, q = 0.0;
+    for (double c : charges) {
+        q2 += c * c;
+        q += c;
+    }
+    energy.self = -alpha / std::sqrt(kPi) * q2;
+    energy.background = -kPi * q * q / (2.0 * setup.volume * alpha * alpha);
+
+    energy.real *= kCoulombEVAngstrom;
+    energy.reciprocal *= kCoulombEVAngstrom;
+    energy.self *= kCoulombEVAngstrom;
+    energy.background *= kCoulombEVAngstrom;
+    energy.total = energy.real + energy.reciprocal + energy.self + energy.background;
+    return energy;
+}
+
+EwaldModel::EwaldModel(const POSCAR& poscar, const std::vector<double>& charges, const EwaldOptions& options)
+    : n_(poscar.total_atoms), charges_(charges) {
+    EwaldSetup setup = makeSetup(poscar, options);
+    n_ = setup.n;
+    charges_.resize(n_, 0.0);
+    phi_.assign(static_cast<size_t>(n_) * n_, 0.0);
+
+    std::vector<double> cosines, sines;
+    structureFactors(setup, cosines, sines, options.threads);
+
+    const double alpha = setup.params.alpha;
+    const double recip_scale = 8.0 * kPi / setup.volume;  // 4 pi / V, doubled for the -k partner
+    const double diagonal = -2.0 * alpha / std::sqrt(kPi);
+    const double background = -kPi / (setup.volume * alpha * alpha);
+    const size_t n_k = setup.kx.size();
+
+    parallelFor(static_cast<size_t>(n_), options.threads, [&](size_t i) {
+        double* row = &phi_[i * n_];
+        for (size_t k = 0; k < n_k; ++k) {
+            const double a = recip_scale * setup.kweight[k] * cosines[k * n_ + i];
+            const double b = recip_scale * setup.kweight[k] * sines[k * n_ + i];
+            const double* c = &cosines[k * n_];
+            const double* s = &sines[k * n_];
+            for (int j = 0; j < n_; ++j)
+                row[j] += a * c[j] + b * s[j];
+        }
+        for (int j = 0; j < n_; ++j) {
+            row[j] += realPair(setup, static_cast<int>(i), j) + background;
+            row[j] *= kCoulombEVAngstrom;
+        }
+        row[i] += diagonal * kCoulombEVAngstrom;
+    });
+
+    potentials_.assign(n_, 0.0);
+    energy_ = 0.0;
+    for (int i = 0; i < n_; ++i) {
+        const double* row = &phi_[static_cast<size_t>(i) * n_];
+        double v = 0.0;
+        for (int j = 0; j < n_; ++j)
+            v += row[j] * charges_[j];
+        potentials_[i] = v;
+        energy_ += 0.5 * charges_[i] * v;
+    }
+}
+
+double EwaldModel::changeDelta(int i, double di, int j, double dj) const {
+    double delta = di * potentials_[i] + 0.5 * di * di * pair(i, i);
+    if (j >= 0)
+        delta += dj * potentials_[j] + 0.5 * dj * dj * pair(j, j) + di * dj * pair(i, j);
+    return delta;
+}
+
+void EwaldModel::applyChange(int i, double di, int j, double dj) {
+    energy_ += changeDelta(i, di, j, dj);
+
+    // Phi is symmetric, so row i is also column i
+    const double* row_i = &phi_[static_cast<size_t>(i) * n_];
+    for (int k = 0; k < n_; ++k)
+        potentials_[k] += di * row_i[k];
+    charges_[i] += di;
+    if (j >= 0) {
+        const double* row_j = &phi_[static_cast<size_t>(j) * n_];
+        for (int k = 0; k < n_; ++k)
+            potentials_[k] += dj * row_j[k];
+        charges_[j] += dj;
+    }
+}
+
+double EwaldModel::swapDelta(int i, int j) const {
+    if (i == j)
+        return 0.0;
+    const double d = charges_[j] - charges_[i];
+    return changeDelta(i, d, j, -d);
+}
+
+double EwaldModel::removalDelta(int i) const {
+    return changeDelta(i, -charges_[i], -1, 0.0);
+}
+
+void EwaldModel::applySwap(int i, int j) {
+    if (i == j)
+        return;
+    const double d = charges_[j] - charges_[i];
+    applyChange(i, d, j, -d);
+}
+
+void EwaldModel::applyRemoval(int i) {
+    applyChange(i, -charges_[i], -1, 0.0);
+}
@@ -0,0 +1,210 @@
+#include "instrumentation.h"
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+std::atomic<unsigned> g_instrumentation{0};
+
+namespace {
+
+struct TimingRegistry {
+    std::mutex mutex;
+    std::vector<PhaseStats> phases;  // kept in order of first appearance
+    TimingFormat report_format{TimingFormat::Text};
+};
+
+TimingRegistry& registry() {
+    static TimingRegistry instance;
+    return instance;
+}
+
+// Updated from inside operator new/delete, so these must never allocate
+std::atomic<unsigned long long> g_allocations{0};
+std::atomic<unsigned long long> g_allocated_bytes{0};
+std::atomic<long long> g_live_bytes{0};
+std::atomic<long long> g_peak_live_bytes{0};
+
+void reportAtExit() {
+    printTimings(std::cerr, registry().report_format);
+}
+
+double perSecond(double amount, double seconds) {
+    if (seconds <= 0.0 || amount == 0.0)
+        return 0.0;
+    return amount / seconds;
+}
+
+void setFlag(unsigned flag, bool enabled) {
+    // Construct the registry before anything can be recorded into it
+    registry();
+    if (enabled)
+        g_instrumentation.fetch_or(flag, std::memory_order_relaxed);
+    else
+        g_instrumentation.fetch_and(~flag, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+void setTimingsEnabled(bool enabled) {
+    setFlag(kInstrumentTimings, enabled);
+}
+
+void enableTimings(TimingFormat format) {
+    enableInstrumentationReport(kInstrumentTimings, format);
+}
+
+void enableInstrumentationReport(unsigned flag, TimingFormat format) {
+    static bool registered = false;
+
+    TimingRegistry& reg = registry();
+    reg.report_format = format;
+    setFlag(flag, true);
+
+    // Registry is constructed above, so it is still alive when the handler runs
+    if (!registered) {
+        std::atexit(reportAtExit);
+        registered = true;
+    }
+}
+
+void resetTimings() {
+    TimingRegistry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.phases.clear();
+}
+
+void recordPhase(const char* phase, double seconds, std::size_t atoms, std::size_t bytes,
+                 const MemoryCounters& memory_delta) {
+    TimingRegistry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    for (auto& stats : reg.phases) {
+        if (std::strcmp(stats.name.c_str(), phase) == 0) {
+            stats.calls++;
+            stats.seconds += seconds;
+            stats.atoms += atoms;
+            stats.bytes += bytes;
+            stats.allocations += memory_delta.allocations;
+            stats.allocated_bytes += memory_delta.allocated_bytes;
+            stats.retained_bytes += memory_delta.live_bytes;
+            return;
+        }
+    }
+
+    PhaseStats stats;
+    stats.name = phase;
+    stats.calls = 1;
+    stats.seconds = seconds;
+    stats.atoms = atoms;
+    stats.bytes = bytes;
+    stats.allocations = memory_delta.allocations;
+    stats.allocated_bytes = memory_delta.allocated_bytes;
+    stats.retained_bytes = memory_delta.live_bytes;
+    reg.phases.push_back(stats);
+}
+
+std::vector<PhaseStats> timingSnapshot() {
+    TimingRegistry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.phases;
+}
+
+void noteAllocation(std::size_t bytes) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+    long long live = g_live_bytes.fetch_add(static_cast<long long>(bytes), std::memory_order_relaxed) +
+                     static_cast<long long>(bytes);
+    long long peak = g_peak_live_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !g_peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void noteDeallocation(std::size_t bytes) {
+    g_live_bytes.fetch_sub(static_cast<long long>(bytes), std::memory_order_relaxed);
+}
+
+MemoryCounters memoryCounters() {
+    MemoryCounters counters;
+    counters.allocations = g_allocations.load(std::memory_order_relaxed);
+    counters.allocated_bytes = g_allocated_bytes.load(std::memory_order_relaxed);
+    counters.live_bytes = g_live_bytes.load(std::memory_order_relaxed);
+    counters.peak_live_bytes = g_peak_live_bytes.load(std::memory_order_relaxed);
+    return counters;
+}
+
+long long peakRSSBytes() {
+#if defined(_WIN32)
+    return 0;
+#else
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return static_cast<long long>(usage.ru_maxrss);  // bytes on macOS
+#else
+    return static_cast<long long>(usage.ru_maxrss) * 1024;  // KiB on Linux
+#endif
+#endif
+}
+
+void printTimings(std::ostream& out, TimingFormat format) {
+    std::vector<PhaseStats> phases = timingSnapshot();
+    const bool memory = memoryStatsEnabled();
+    const MemoryCounters counters = memoryCounters();
+
+    if (format == TimingFormat::Json) {
+        out << "{\"phases\": [";
+        for (size_t i = 0; i < phases.size(); ++i) {
+            const PhaseStats& p = phases[i];
+            out << (i > 0 ? ", " : "") << "{\"name\": \"" << p.name << "\", \"calls\": " << p.calls
+                << ", \"seconds\": " << std::setprecision(9) << p.seconds << ", \"atoms\": " << p.atoms
+                << ", \"bytes\": " << p.bytes << ", \"atoms_per_second\": " << perSecond(p.atoms, p.seconds)
+                << ", \"bytes_per_second\": " << perSecond(p.bytes, p.seconds);
+            if (memory)
+                out << ", \"allocations\": " << p.allocations << ", \"allocated_bytes\": " << p.allocated_bytes
+                    << ", \"retained_bytes\": " << p.retained_bytes;
+            out << "}";
+        }
+        out << "]";
+        if (memory)
+            out << ", \"total_allocations\": " << counters.allocations
+                << ", \"peak_heap_bytes\": " << counters.peak_live_bytes << ", \"peak_rss_bytes\": " << peakRSSBytes();
+        out << "}\n";
+        return;
+    }
+
+    out << (memory ? "=== Phase timings and memory ===\n" : "=== Phase timings ===\n");
+    out << std::left << std::setw(22) << "phase" << std::right << std::setw(8) << "calls" << std::setw(14)
+        << "wall [ms]" << std::setw(16) << "atoms/s" << std::setw(12) << "MB/s";
+    if (memory)
+        out << std::setw(12) << "allocs" << std::setw(12) << "alloc MB" << std::setw(14) << "retained MB";
+    out << "\n";
+
+    for (const auto& p : phases) {
+        out << std::left << std::setw(22) << p.name << std::right << std::setw(8) << p.calls << std::setw(14)
+            << std::fixed << std::setprecision(3) << p.seconds * 1e3 << std::setw(16) << std::setprecision(0)
+            << perSecond(p.atoms, p.seconds) << std::setw(12) << std::setprecision(2)
+            << perSecond(p.bytes, p.seconds) / 1e6;
+        if (memory)
+            out << std::setw(12) << p.allocations << std::setw(12) << p.allocated_bytes / 1e6 << std::setw(14)
+                << p.retained_bytes / 1e6;
+        out << "\n";
+    }
+
+    if (memory) {
+        out << "Heap allocations: " << counters.allocations << "\n";
+        out << "Peak heap growth: " << counters.peak_live_bytes / 1e6 << " MB\n";
+        out << "Peak RSS: " << peakRSSBytes() / 1e6 << " MB\n";
+    }
+    out.unsetf(std::ios::floatfield);
+}
@@ -0,0 +1,156 @@
+#include "interstitial.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "instrumentation.h"
+#include "lattice_utility.h"
+#include "neighbor_list.h"
+#include "parallel_utility.h"
+
+namespace {
+
+double siteSeparation(const double lattice[3][3], const Atom& a, const Atom& b) {
+    const double delta[3] = {a.x - b.x, a.y - b.y, a.z - b.z};
+    return minimumImageDistance(lattice, delta);
+}
+
+}  // namespace
+
+std::vector<InterstitialSite> findInterstitials(const POSCAR& host, const InterstitialOptions& options) {
+    POSCAR direct = host;
+    direct.toDirect();
+
+    std::vector<InterstitialSite> sites;
+    if (direct.total_atoms == 0)
+        return sites;
+
+    int n[3];
+    for (int k = 0; k < 3; ++k) {
+        const double length = std::sqrt(direct.lattice[k][0] * direct.lattice[k][0] +
+                                        direct.lattice[k][1] * direct.lattice[k][1] +
+                                        direct.lattice[k][2] * direct.lattice[k][2]);
+        n[k] = std::max(2, static_cast<int>(std::ceil(length / options.grid_spacing)));
+    }
+    const size_t n_points = static_cast<size_t>(n[0]) * n[1] * n[2];
+
+    // Bins about the mean atomic spacing; the first search radius covers most of the empty space
+    const double spacing = std::cbrt(cellVolume(direct.lattice) / direct.total_atoms);
+    PeriodicCellIndex index(direct.lattice, direct.coordinates, spacing);
+
+    std::vector<float> field(n_points);
+    {
+        ScopedTimer phase("interstitial_grid", n_points);
+        parallelFor(static_cast<size_t>(n[0]), options.threads, [&](size_t i) {
+            for (int j = 0; j < n[1]; ++j)
+                for (int k = 0; k < n[2]; ++k) {
+                    const double f[3] = {double(i) / n[0], double(j) / n[1], double(k) / n[2]};
+                    double r[3];
+                    fractionalToCartesian(direct.lattice, f, r);
+                    double radius = 2.0 * spacing;
+                    double d = index.nearestDistance(r, radius);
+                    while (d >= radius) {
+                        radius *= 2.0;
+                        d = index.nearestDistance(r, radius);
+                    }
+                    field[(i * n[1] + j) * n[2] + k] = static_cast<float>(d);
+                }
+        });
+    }
+
+    // Grid points not below any of their 26 periodic neighbours
+    std::vector<std::vector<InterstitialSite>> maxima(n[0]);
+    {
+        ScopedTimer phase("interstitial_maxima", n_points);
+        parallelFor(static_cast<size_t>(n[0]), options.threads, [&](size_t i) {
+            for (int j = 0; j < n[1]; ++j)
+                for (int k = 0; k < n[2]; ++k) {
+                    const float value = field[(i * n[1] + j) * n[2] + k];
+                    if (value < options.min_distance)
+                        continue;
+                    bool is_max = true;
+                    for (int di = -1; di <= 1 && is_max; ++di)
+                        for (int dj = -1; dj <= 1 && is_max; ++dj)
+                            for (int dk = -1; dk <= 1 && is_max; ++dk) {
+                                const int ii = (static_cast<int>(i) + di + n[0]) % n[0];
+                                const int jj = (j + dj + n[1]) % n[1];
+                                const int kk = (k + dk + n[2]) % n[2];
+                                is_max = field[(static_cast<size_t>(ii) * n[1] + jj) * n[2] + kk] <= value;
+                            }
+                    if (is_max) {
+                        InterstitialSite site;
+                        site.position = {double(i) / n[0], double(j) / n[1], double(k) / n[2]};
+                        site.distance = value;
+                        maxima[i].push_back(site);
+                    }
+                }
+        });
+    }
+
+    std::vector<InterstitialSite> candidates;
+    for (auto& slab : maxima)
+        candidates.insert(candidates.end(), slab.begin(), slab.end());
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const InterstitialSite& a, const InterstitialSite& b) { return a.distance > b.distance; });
+
+    // Greedy clustering: plateaus and near-degenerate maxima collapse onto their best point
+    for (const InterstitialSite& candidate : candidates) {
+        bool merged = false;
+        for (const InterstitialSite& kept : sites)
+            if (siteSeparation(direct.lattice, candidate.position, kept.position) < options.cluster_radius) {
+                merged = true;
+                break;
+            }
+        if (!merged)
+            sites.push_back(candidate);
+    }
+    return sites;
+}
+
+std::vector<InterstitialSite> symmetryReduceSites(const std::vector<InterstitialSite>& sites,
+                                                  const double lattice[3][3], const int (*rotations)[3][3],
+                                                  const double (*translations)[3], int n_ops, double tolerance) {
+    std::vector<InterstitialSite> unique;
+    std::vector<char> assigned(sites.size(), 0);
+
+    for (size_t s = 0; s < sites.size(); ++s) {
+        if (assigned[s])
+            continue;
+        assigned[s] = 1;
+
+        // Distinct images of the site under all operations
+        std::vector<Atom> orbit;
+        const double x[3] = {sites[s].position.x, sites[s].position.y, sites[s].position.z};
+        for (int op = 0; op < n_ops; ++op) {
+            double y[3];
+            for (int i = 0; i < 3; ++i)
+                y[i] = wrapFractional(rotations[op][i][0] * x[0] + rotations[op][i][1] * x[1] +
+                                      rotations[op][i][2] * x[2] + translations[op][i]);
+            const Atom image{y[0], y[1], y[2]};
+            bool seen = false;
+            for (const Atom& o : orbit)
+                if (siteSeparation(lattice, image, o) < tolerance) {
+                    seen = true;
+                    break;
+                }
+            if (!seen)
+                orbit.push_back(image);
+        }
+
+        for (size_t t = s + 1; t < sites.size(); ++t) {
+            if (assigned[t])
+                continue;
+            for (const Atom& o : orbit)
+                if (siteSeparation(lattice, sites[t].position, o) < tolerance) {
+                    assigned[t] = 1;
+                    break;
+                }
+        }
+
+        InterstitialSite site = sites[s];
+        site.multiplicity = static_cast<int>(orbit.size());
+        unique.push_back(site);
+    }
+    return unique;
+}
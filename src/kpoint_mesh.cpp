@@ -0,0 +1,128 @@
+#include "kpoint_mesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "lattice_utility.h"
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+}  // namespace
+
+void KMesh::shift(int is_shift[3]) const {
+    for (int k = 0; k < 3; ++k)
+        is_shift[k] = (!gamma_centered && mesh[k] % 2 == 0) ? 1 : 0;
+}
+
+void meshForSpacing(const double lattice[3][3], double kspacing, int mesh[3]) {
+    double reciprocal[3][3];
+    reciprocalLattice(lattice, reciprocal);
+    for (int k = 0; k < 3; ++k) {
+        const double length = 2.0 * kPi * std::sqrt(reciprocal[k][0] * reciprocal[k][0] +
+                                                    reciprocal[k][1] * reciprocal[k][1] +
+                                                    reciprocal[k][2] * reciprocal[k][2]);
+        mesh[k] = std::max(1, static_cast<int>(std::ceil(length / kspacing - 1e-8)));
+    }
+}
+
+std::vector<int> uniqueRotations(const int (*rotations)[3][3], int n_ops) {
+    std::vector<int> unique;
+    for (int op = 0; op < n_ops; ++op) {
+        bool seen = false;
+        for (int u : unique) {
+            seen = true;
+            for (int i = 0; i < 3 && seen; ++i)
+                for (int j = 0; j < 3 && seen; ++j)
+                    seen = rotations[op][i][j] == rotations[u][i][j];
+            if (seen)
+                break;
+        }
+        if (!seen)
+            unique.push_back(op);
+    }
+    return unique;
+}
+
+bool meshCompatible(const KMesh& mesh, const int (*rotations)[3][3], int n_rot) {
+    int is_shift[3];
+    mesh.shift(is_shift);
+    const int* n = mesh.mesh;
+
+    // Reciprocal fractional coordinates transform with R^T: k'_i = sum_j R_ji k_j with
+    // k_j = (m_j + s_j / 2) / N_j must land on a grid point (m'_i + s_i / 2) / N_i for every integer m
+    for (int r = 0; r < n_rot; ++r) {
+        for (int i = 0; i < 3; ++i) {
+            double offset = 0.0;
+            for (int j = 0; j < 3; ++j) {
+                const int a = rotations[r][j][i];
+                if ((a * n[i]) % n[j] != 0)
+                    return false;
+                offset += a * 0.5 * is_shift[j] * n[i] / n[j];
+            }
+            offset -= 0.5 * is_shift[i];
+            if (std::abs(offset - std::round(offset)) > 1e-9)
+                return false;
+        }
+    }
+    return true;
+}
+
+std::vector<KMesh> candidateMeshes(const double lattice[3][3], double kspacing, int extra,
+                                   const int (*rotations)[3][3], int n_rot, bool gamma_only) {
+    int base[3];
+    meshForSpacing(lattice, kspacing, base);
+
+    std::vector<KMesh> meshes;
+    for (int a = 0; a <= extra; ++a)
+        for (int b = 0; b <= extra; ++b)
+            for (int c = 0; c <= extra; ++c)
+                for (int type = 0; type < (gamma_only ? 1 : 2); ++type) {
+                    KMesh m;
+                    m.mesh[0] = base[0] + a;
+                    m.mesh[1] = base[1] + b;
+                    m.mesh[2] = base[2] + c;
+                    m.gamma_centered = type == 0;
+
+                    // A Monkhorst-Pack mesh with only odd subdivisions is the Gamma-centred one
+                    if (!m.gamma_centered && m.mesh[0] % 2 && m.mesh[1] % 2 && m.mesh[2] % 2)
+                        continue;
+                    if (meshCompatible(m, rotations, n_rot))
+                        meshes.push_back(m);
+                }
+    return meshes;
+}
+
+void rankMeshes(std::vector<KMesh>& meshes) {
+    std::stable_sort(meshes.begin(), meshes.end(), [](const KMesh& a, const KMesh& b) {
+        if (a.irreducible != b.irreducible)
+            return a.irreducible < b.irreducible;
+        if (a.total() != b.total())
+            return a.total() > b.total();
+        return a.gamma_centered && !b.gamma_centered;
+    });
+}
+
+bool writeKPOINTS(const std::string& filename, const KMesh& mesh, const std::string& comment) {
+    std::ofstream file(filename);
+    if (!file) {
+        std::cerr << "Error: cannot create file " << filename << "\n";
+        return false;
+    }
+    file << comment << "\n";
+    file << "0\n";
+    file << (mesh.gamma_centered ? "Gamma" : "Monkhorst-Pack") << "\n";
+    file << "  " << mesh.mesh[0] << " " << mesh.mesh[1] << " " << mesh.mesh[2] << "\n";
+    file << "  0 0 0\n";
+    file.close();
+    if (!file) {
+        std::cerr << "Error: failed writing to " << filename << "\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,251 @@
+#include "lattice_reduction.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "instrumentation.h"
+#include "lattice_utility.h"
+
+namespace {
+
+constexpr int kMaxIterations = 10000;
+
+double dot(const double a[3], const double b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// basis = m * lattice
+void applyTransform(const int m[3][3], const double lattice[3][3], double basis[3][3]) {
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            basis[i][j] = m[i][0] * lattice[0][j] + m[i][1] * lattice[1][j] + m[i][2] * lattice[2][j];
+}
+
+// m = step * m
+void compose(const int step[3][3], int m[3][3]) {
+    int r[3][3];
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            r[i][j] = step[i][0] * m[0][j] + step[i][1] * m[1][j] + step[i][2] * m[2][j];
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            m[i][j] = r[i][j];
+}
+
+void setIdentity(int m[3][3]) {
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            m[i][j] = i == j;
+}
+
+}  // namespace
+
+bool niggliReduce(const double lattice[3][3], double reduced[3][3], int transform[3][3], double tolerance) {
+    const double volume = cellVolume(lattice);
+    if (volume < 1e-12)
+        return false;
+    const double eps = tolerance * std::cbrt(volume) * std::cbrt(volume);
+
+    auto lt = [eps](double x, double y) { return x < y - eps; };
+    auto gt = [eps](double x, double y) { return x > y + eps; };
+    auto eq = [eps](double x, double y) { return std::abs(x - y) <= eps; };
+    auto sign = [eps](double x) { return x > eps ? 1 : (x < -eps ? -1 : 0); };
+
+    int m[3][3];
+    setIdentity(m);
+    double b[3][3];
+
+    // Krivy-Gruber steps N1-N8 on A = a.a, B = b.b, C = c.c, xi = 2 b.c, eta = 2 a.c, zeta = 2 a.b,
+    // with the comparisons of Grosse-Kunstleve et al. (2004) so nearly degenerate cells terminate
+    for (int iteration = 0; iteration < kMaxIterations; ++iteration) {
+        applyTransform(m, lattice, b);
+        const double A = dot(b[0], b[0]), B = dot(b[1], b[1]), C = dot(b[2], b[2]);
+        const double xi = 2.0 * dot(b[1], b[2]), eta = 2.0 * dot(b[0], b[2]), zeta = 2.0 * dot(b[0], b[1]);
+
+        if (gt(A, B) || (eq(A, B) && gt(std::abs(xi), std::abs(eta)))) {
+            const int step[3][3] = {{0, 1, 0}, {1, 0, 0}, {0, 0, -1}};
+            compose(step, m);
+            continue;
+        }
+        if (gt(B, C) || (eq(B, C) && gt(std::abs(eta), std::abs(zeta)))) {
+            const int step[3][3] = {{-1, 0, 0}, {0, 0, 1}, {0, 1, 0}};
+            compose(step, m);
+            continue;
+        }
+
+        const int l = sign(xi), mm = sign(eta), n = sign(zeta);
+        if (l * mm * n == 1) {
+            // All angles acute
+            const int step[3][3] = {{l, 0, 0}, {0, mm, 0}, {0, 0, n}};
+            compose(step, m);
+        } else {
+            // All angles non-acute; a zero parameter absorbs the sign needed to keep det = +1
+            int s[3] = {l == 1 ? -1 : 1, mm == 1 ? -1 : 1, n == 1 ? -1 : 1};
+            if (s[0] * s[1] * s[2] == -1) {
+                if (l == 0)
+                    s[0] = -1;
+                else if (mm == 0)
+                    s[1] = -1;
+                else if (n == 0)
+                    s[2] = -1;
+            }
+            if (s[0] != 1 || s[1] != 1 || s[2] != 1) {
+                const int step[3][3] = {{s[0], 0, 0}, {0, s[1], 0}, {0, 0, s[2]}};
+                compose(step, m);
+            }
+        }
+
+        applyTransform(m, lattice, b);
+        const double xi2 = 2.0 * dot(b[1], b[2]), eta2 = 2.0 * dot(b[0], b[2]), zeta2 = 2.0 * dot(b[0], b[1]);
+
+        if (gt(std::abs(xi2), B) || (eq(xi2, B) && lt(2.0 * eta2, zeta2)) || (eq(xi2, -B) && lt(zeta2, 0.0))) {
+            const int step[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, -(xi2 > 0 ? 1 : -1), 1}};
+            compose(step, m);
+            continue;
+        }
+        if (gt(std::abs(eta2), A) || (eq(eta2, A) && lt(2.0 * xi2, zeta2)) || (eq(eta2, -A) && lt(zeta2, 0.0))) {
+            const int step[3][3] = {{1, 0, 0}, {0, 1, 0}, {-(eta2 > 0 ? 1 : -1), 0, 1}};
+            compose(step, m);
+            continue;
+        }
+        if (gt(std::abs(zeta2), A) || (eq(zeta2, A) && lt(2.0 * xi2, eta2)) || (eq(zeta2, -A) && lt(eta2, 0.0))) {
+            const int step[3][3] = {{1, 0, 0}, {-(zeta2 > 0 ? 1 : -1), 1, 0}, {0, 0, 1}};
+            compose(step, m);
+            continue;
+        }
+        const double sum = xi2 + eta2 + zeta2 + A + B;
+        if (lt(sum, 0.0) || (eq(sum, 0.0) && gt(2.0 * (A + eta2) + zeta2, 0.0))) {
+            const int step[3][3] = {{1, 0, 0}, {0, 1, 0}, {1, 1, 1}};
+            compose(step, m);
+            continue;
+        }
+
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j) {
+                reduced[i][j] = b[i][j];
+                transform[i][j] = m[i][j];
+            }
+        return true;
+    }
+    return false;
+}
+
+bool delaunayReduce(const double lattice[3][3], double reduced[3][3], int transform[3][3], double tolerance) {
+    const double volume = cellVolume(lattice);
+    if (volume < 1e-12)
+        return false;
+    const double eps = tolerance * std::cbrt(volume) * std::cbrt(volume);
+
+    // Superbase b0..b3 with b3 = -(b0 + b1 + b2), each kept as integer coefficients of the input rows
+    int coeff[4][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {-1, -1, -1}};
+    double v[4][3];
+
+    auto update = [&]() {
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 3; ++j)
+                v[i][j] = coeff[i][0] * lattice[0][j] + coeff[i][1] * lattice[1][j] + coeff[i][2] * lattice[2][j];
+    };
+
+    // Selling: while some b_i . b_j > 0, negate b_i and add it to the two other vectors. The sum of the
+    // squared lengths strictly decreases, so this terminates.
+    bool converged = false;
+    for (int iteration = 0; iteration < kMaxIterations && !converged; ++iteration) {
+        update();
+        converged = true;
+        for (int i = 0; i < 4 && converged; ++i)
+            for (int j = i + 1; j < 4 && converged; ++j) {
+                if (dot(v[i], v[j]) <= eps)
+                    continue;
+                for (int k = 0; k < 4; ++k) {
+                    if (k == i || k == j)
+                        continue;
+                    for (int c = 0; c < 3; ++c)
+                        coeff[k][c] += coeff[i][c];
+                }
+                for (int c = 0; c < 3; ++c)
+                    coeff[i][c] = -coeff[i][c];
+                converged = false;
+            }
+    }
+    if (!converged)
+        return false;
+    update();
+
+    // Any three vectors of the superbase form a basis; keep the three shortest
+    int order[4] = {0, 1, 2, 3};
+    std::stable_sort(order, order + 4, [&](int a, int b) { return dot(v[a], v[a]) < dot(v[b], v[b]) - eps; });
+
+    int m[3][3];
+    for (int i = 0; i < 3; ++i)
+        for (int c = 0; c < 3; ++c)
+            m[i][c] = coeff[order[i]][c];
+
+    double dm[3][3];
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            dm[i][j] = m[i][j];
+    if (determinant3(dm) < 0)
+        for (int i = 0; i < 3; ++i)
+            for (int c = 0; c < 3; ++c)
+                m[i][c] = -m[i][c];
+
+    applyTransform(m, lattice, reduced);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            transform[i][j] = m[i][j];
+    return true;
+}
+
+bool reduceLattice(CellReduction method, const double lattice[3][3], double reduced[3][3], int transform[3][3],
+                   double tolerance) {
+    switch (method) {
+        case CellReduction::Niggli:
+            return niggliReduce(lattice, reduced, transform, tolerance);
+        case CellReduction::Delaunay:
+            return delaunayReduce(lattice, reduced, transform, tolerance);
+        case CellReduction::None:
+            break;
+    }
+    setIdentity(transform);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            reduced[i][j] = lattice[i][j];
+    return true;
+}
+
+bool reduceCell(POSCAR& poscar, CellReduction method, double tolerance) {
+    ScopedTimer phase("reduce_cell", poscar.total_atoms);
+
+    const bool was_cartesian = !poscar.is_direct;
+    poscar.toDirect();
+
+    double reduced[3][3];
+    int transform[3][3];
+    if (!reduceLattice(method, poscar.lattice, reduced, transform, tolerance)) {
+        std::cerr << "Error: lattice reduction failed.\n";
+        return false;
+    }
+
+    // r = f * L = f' * (M * L), so f' = f * M^-1
+    double m[3][3], m_inv[3][3];
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            m[i][j] = transform[i][j];
+    invert3(m, m_inv);
+
+    for (Atom& atom : poscar.coordinates) {
+        const double f[3] = {atom.x, atom.y, atom.z};
+        double g[3];
+        for (int k = 0; k < 3; ++k)
+            g[k] = wrapFractional(f[0] * m_inv[0][k] + f[1] * m_inv[1][k] + f[2] * m_inv[2][k]);
+        atom = {g[0], g[1], g[2]};
+    }
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            poscar.lattice[i][j] = reduced[i][j];
+
+    if (was_cartesian)
+        poscar.toCartesian();
+    return true;
+}
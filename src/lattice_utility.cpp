@@ -0,0 +1,109 @@
+#include "lattice_utility.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+double determinant3(const double m[3][3]) {
+    return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+           m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+}
+
+double cellVolume(const double lattice[3][3]) {
+    return std::abs(determinant3(lattice));
+}
+
+bool invert3(const double m[3][3], double inv[3][3]) {
+    double det = determinant3(m);
+    if (std::abs(det) < 1e-14)
+        return false;
+
+    inv[0][0] = (m[1][1] * m[2][2] - m[1][2] * m[2][1]) / det;
+    inv[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) / det;
+    inv[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) / det;
+    inv[1][0] = (m[1][2] * m[2][0] - m[1][0] * m[2][2]) / det;
+    inv[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) / det;
+    inv[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) / det;
+    inv[2][0] = (m[1][0] * m[2][1] - m[1][1] * m[2][0]) / det;
+    inv[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) / det;
+    inv[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) / det;
+    return true;
+}
+
+void fractionalToCartesian(const double lattice[3][3], const double frac[3], double cart[3]) {
+    for (int j = 0; j < 3; ++j)
+        cart[j] = frac[0] * lattice[0][j] + frac[1] * lattice[1][j] + frac[2] * lattice[2][j];
+}
+
+void cartesianToFractional(const double inverse_lattice[3][3], const double cart[3], double frac[3]) {
+    for (int j = 0; j < 3; ++j)
+        frac[j] = cart[0] * inverse_lattice[0][j] + cart[1] * inverse_lattice[1][j] + cart[2] * inverse_lattice[2][j];
+}
+
+void reciprocalLattice(const double lattice[3][3], double reciprocal[3][3]) {
+    double inv[3][3];
+    if (!invert3(lattice, inv)) {
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                reciprocal[i][j] = 0.0;
+        return;
+    }
+
+    // Columns of the inverse are the reciprocal vectors
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            reciprocal[i][j] = inv[j][i];
+}
+
+void perpendicularHeights(const double lattice[3][3], double heights[3]) {
+    double reciprocal[3][3];
+    reciprocalLattice(lattice, reciprocal);
+
+    for (int i = 0; i < 3; ++i) {
+        double norm = std::sqrt(reciprocal[i][0] * reciprocal[i][0] + reciprocal[i][1] * reciprocal[i][1] +
+                                reciprocal[i][2] * reciprocal[i][2]);
+        heights[i] = norm > 0.0 ? 1.0 / norm : 0.0;
+    }
+}
+
+void latticeParameters(const double lattice[3][3], double lengths[3], double angles[3]) {
+    for (int i = 0; i < 3; ++i)
+        lengths[i] = std::sqrt(lattice[i][0] * lattice[i][0] + lattice[i][1] * lattice[i][1] +
+                               lattice[i][2] * lattice[i][2]);
+
+    const double rad_to_deg = 180.0 / M_PI;
+    for (int i = 0; i < 3; ++i) {
+        int j = (i + 1) % 3;
+        int k = (i + 2) % 3;
+        double dot = lattice[j][0] * lattice[k][0] + lattice[j][1] * lattice[k][1] + lattice[j][2] * lattice[k][2];
+        double c = dot / (lengths[j] * lengths[k]);
+        c = std::max(-1.0, std::min(1.0, c));
+        angles[i] = std::acos(c) * rad_to_deg;
+    }
+}
+
+double wrapFractional(double x) {
+    double w = x - std::floor(x);
+    // floor of a tiny negative number can round back up to exactly 1.0
+    return w >= 1.0 ? 0.0 : w;
+}
+
+double minimumImageDistance(const double lattice[3][3], const double frac_delta[3]) {
+    double d[3];
+    for (int i = 0; i < 3; ++i)
+        d[i] = frac_delta[i] - std::round(frac_delta[i]);
+
+    // Rounding is exact only for orthogonal cells; check the neighbouring images for skewed ones
+    double best = std::numeric_limits<double>::max();
+    for (int i = -1; i <= 1; ++i)
+        for (int j = -1; j <= 1; ++j)
+            for (int k = -1; k <= 1; ++k) {
+                double f[3] = {d[0] + i, d[1] + j, d[2] + k};
+                double cart[3];
+                fractionalToCartesian(lattice, f, cart);
+                double r2 = cart[0] * cart[0] + cart[1] * cart[1] + cart[2] * cart[2];
+                if (r2 < best)
+                    best = r2;
+            }
+    return std::sqrt(best);
+}
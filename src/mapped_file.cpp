@@ -0,0 +1,38 @@
+#include "mapped_file.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        const std::size_t size = static_cast<std::size_t>(info.st_size);
+        void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            // Chunks are read by several threads at once, so ask for the whole file rather than read-ahead
+            ::madvise(data, size, MADV_WILLNEED);
+            data_ = static_cast<const char*>(data);
+            size_ = size;
+        }
+    }
+    ::close(fd);  // the mapping stays valid
+}
+
+MappedFile::~MappedFile() {
+    if (data_)
+        ::munmap(const_cast<char*>(data_), size_);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string&) {}
+
+MappedFile::~MappedFile() = default;
+
+#endif
@@ -0,0 +1,352 @@
+#include "neb.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <vector>
+
+#include "instrumentation.h"
+#include "lattice_utility.h"
+#include "parallel_utility.h"
+#include "structure_utility.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VASP_UTILS_SSE2
+#endif
+
+namespace {
+
+// Cartesian positions of one image in structure-of-arrays form for the pair loops
+struct Image {
+    std::vector<double> x, y, z;
+};
+
+struct PairFrame {
+    double lattice[3][3];
+    double inverse[3][3];
+};
+
+Image toCartesian(const PairFrame& frame, const std::vector<Atom>& atoms) {
+    Image image;
+    const size_t n = atoms.size();
+    image.x.resize(n);
+    image.y.resize(n);
+    image.z.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const double f[3] = {atoms[i].x, atoms[i].y, atoms[i].z};
+        double c[3];
+        fractionalToCartesian(frame.lattice, f, c);
+        image.x[i] = c[0];
+        image.y[i] = c[1];
+        image.z[i] = c[2];
+    }
+    return image;
+}
+
+std::vector<Atom> toFractional(const PairFrame& frame, const Image& image) {
+    std::vector<Atom> atoms(image.x.size());
+    for (size_t i = 0; i < atoms.size(); ++i) {
+        const double c[3] = {image.x[i], image.y[i], image.z[i]};
+        double f[3];
+        cartesianToFractional(frame.inverse, c, f);
+        atoms[i] = {f[0], f[1], f[2]};
+    }
+    return atoms;
+}
+
+#ifdef VASP_UTILS_SSE2
+inline double horizontalSum(__m128d v) {
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+#endif
+
+// Pair vectors from atom i to every atom j, folded to the rounded minimum image. nearbyint, sqrt and the
+// lattice products are done two pairs at a time with SSE2; the rounding goes through cvtpd_epi32, which
+// uses the same round-to-nearest-even mode (fractional differences are far inside the int32 range).
+void pairVectors(const PairFrame& frame, const Image& image, size_t i, double* dx, double* dy, double* dz,
+                 double* r) {
+    const size_t n = image.x.size();
+    const double xi = image.x[i], yi = image.y[i], zi = image.z[i];
+    const auto& L = frame.lattice;
+    const auto& inv = frame.inverse;
+    size_t j = 0;
+#ifdef VASP_UTILS_SSE2
+    __m128d m[3][3], l[3][3];
+    for (int a = 0; a < 3; ++a)
+        for (int b = 0; b < 3; ++b) {
+            m[a][b] = _mm_set1_pd(inv[a][b]);
+            l[a][b] = _mm_set1_pd(L[a][b]);
+        }
+    const __m128d qx = _mm_set1_pd(xi), qy = _mm_set1_pd(yi), qz = _mm_set1_pd(zi);
+    for (; j + 2 <= n; j += 2) {
+        const __m128d cx = _mm_sub_pd(_mm_loadu_pd(&image.x[j]), qx);
+        const __m128d cy = _mm_sub_pd(_mm_loadu_pd(&image.y[j]), qy);
+        const __m128d cz = _mm_sub_pd(_mm_loadu_pd(&image.z[j]), qz);
+        __m128d f[3];
+        for (int b = 0; b < 3; ++b) {
+            f[b] = _mm_add_pd(_mm_add_pd(_mm_mul_pd(cx, m[0][b]), _mm_mul_pd(cy, m[1][b])), _mm_mul_pd(cz, m[2][b]));
+            f[b] = _mm_sub_pd(f[b], _mm_cvtepi32_pd(_mm_cvtpd_epi32(f[b])));
+        }
+        __m128d d[3];
+        for (int b = 0; b < 3; ++b)
+            d[b] = _mm_add_pd(_mm_add_pd(_mm_mul_pd(f[0], l[0][b]), _mm_mul_pd(f[1], l[1][b])),
+                              _mm_mul_pd(f[2], l[2][b]));
+        _mm_storeu_pd(dx + j, d[0]);
+        _mm_storeu_pd(dy + j, d[1]);
+        _mm_storeu_pd(dz + j, d[2]);
+        const __m128d r2 =
+            _mm_add_pd(_mm_add_pd(_mm_mul_pd(d[0], d[0]), _mm_mul_pd(d[1], d[1])), _mm_mul_pd(d[2], d[2]));
+        _mm_storeu_pd(r + j, _mm_sqrt_pd(r2));
+    }
+#endif
+    for (; j < n; ++j) {
+        const double cx = image.x[j] - xi, cy = image.y[j] - yi, cz = image.z[j] - zi;
+        double fa = cx * inv[0][0] + cy * inv[1][0] + cz * inv[2][0];
+        double fb = cx * inv[0][1] + cy * inv[1][1] + cz * inv[2][1];
+        double fc = cx * inv[0][2] + cy * inv[1][2] + cz * inv[2][2];
+        fa -= std::nearbyint(fa);
+        fb -= std::nearbyint(fb);
+        fc -= std::nearbyint(fc);
+        dx[j] = fa * L[0][0] + fb * L[1][0] + fc * L[2][0];
+        dy[j] = fa * L[0][1] + fb * L[1][1] + fc * L[2][1];
+        dz[j] = fa * L[0][2] + fb * L[1][2] + fc * L[2][2];
+        r[j] = std::sqrt(dx[j] * dx[j] + dy[j] * dy[j] + dz[j] * dz[j]);
+    }
+}
+
+// Row-major N x N minimum-image distances of one image
+std::vector<double> distanceMatrix(const PairFrame& frame, const Image& image, int threads) {
+    const size_t n = image.x.size();
+    std::vector<double> d(n * n);
+    parallelFor(n, threads, [&](size_t i) {
+        std::vector<double> dx(n), dy(n), dz(n);
+        pairVectors(frame, image, i, dx.data(), dy.data(), dz.data(), d.data() + i * n);
+    });
+    return d;
+}
+
+// Adds the IDPP terms of the pairs (i, j), j in [begin, end), to sum and to the gradient g of atom i
+void idppPairTerms(const double* dx, const double* dy, const double* dz, const double* r, const double* t0,
+                   const double* t1, double s, size_t begin, size_t end, double& sum, double g[3]) {
+    size_t j = begin;
+#ifdef VASP_UTILS_SSE2
+    const __m128d vs = _mm_set1_pd(s), one = _mm_set1_pd(1.0), two = _mm_set1_pd(2.0), four = _mm_set1_pd(4.0);
+    __m128d acc = _mm_setzero_pd(), ax = acc, ay = acc, az = acc;
+    for (; j + 2 <= end; j += 2) {
+        const __m128d rj = _mm_loadu_pd(r + j);
+        const __m128d a = _mm_loadu_pd(t0 + j);
+        const __m128d inv = _mm_div_pd(one, rj);
+        const __m128d inv2 = _mm_mul_pd(inv, inv);
+        const __m128d inv4 = _mm_mul_pd(inv2, inv2);
+        const __m128d diff = _mm_sub_pd(_mm_add_pd(a, _mm_mul_pd(vs, _mm_sub_pd(_mm_loadu_pd(t1 + j), a))), rj);
+        const __m128d term = _mm_mul_pd(_mm_mul_pd(diff, diff), inv4);
+        acc = _mm_add_pd(acc, term);
+        // Negated coef of the scalar loop below, so the gradient update is an add
+        const __m128d coef =
+            _mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_mul_pd(two, diff), inv4), _mm_mul_pd(_mm_mul_pd(four, term), inv)),
+                       inv);
+        ax = _mm_add_pd(ax, _mm_mul_pd(coef, _mm_loadu_pd(dx + j)));
+        ay = _mm_add_pd(ay, _mm_mul_pd(coef, _mm_loadu_pd(dy + j)));
+        az = _mm_add_pd(az, _mm_mul_pd(coef, _mm_loadu_pd(dz + j)));
+    }
+    sum += horizontalSum(acc);
+    g[0] += horizontalSum(ax);
+    g[1] += horizontalSum(ay);
+    g[2] += horizontalSum(az);
+#endif
+    for (; j < end; ++j) {
+        const double inv = 1.0 / r[j];
+        const double inv4 = inv * inv * inv * inv;
+        const double diff = t0[j] + s * (t1[j] - t0[j]) - r[j];
+        sum += diff * diff * inv4;
+        // d/dr of (t - r)^2 / r^4, divided by r to scale the pair vector r_j - r_i
+        const double coef = (-2.0 * diff * inv4 - 4.0 * diff * diff * inv4 * inv) * inv;
+        g[0] -= coef * dx[j];
+        g[1] -= coef * dy[j];
+        g[2] -= coef * dz[j];
+    }
+}
+
+// IDPP objective and its gradient for one image; targets interpolate d0 -> d1 at fraction s
+double idppGradient(const PairFrame& frame, const Image& image, const std::vector<double>& d0,
+                    const std::vector<double>& d1, double s, Image* gradient) {
+    const size_t n = image.x.size();
+    std::vector<double> dx(n), dy(n), dz(n), r(n);
+    double objective = 0.0;
+    if (gradient) {
+        gradient->x.assign(n, 0.0);
+        gradient->y.assign(n, 0.0);
+        gradient->z.assign(n, 0.0);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        pairVectors(frame, image, i, dx.data(), dy.data(), dz.data(), r.data());
+        const double* t0 = d0.data() + i * n;
+        const double* t1 = d1.data() + i * n;
+        // The self pair is skipped by splitting the range, so the kernel needs no mask
+        double sum = 0.0, g[3] = {0.0, 0.0, 0.0};
+        idppPairTerms(dx.data(), dy.data(), dz.data(), r.data(), t0, t1, s, 0, i, sum, g);
+        idppPairTerms(dx.data(), dy.data(), dz.data(), r.data(), t0, t1, s, i + 1, n, sum, g);
+        objective += 0.5 * sum;
+        if (gradient) {
+            gradient->x[i] = g[0];
+            gradient->y[i] = g[1];
+            gradient->z[i] = g[2];
+        }
+    }
+    return objective;
+}
+
+}  // namespace
+
+std::vector<int> matchAtoms(const POSCAR& initial, const POSCAR& final) {
+    const std::vector<std::string> si = atomSpecies(initial);
+    const std::vector<std::string> sf = atomSpecies(final);
+    const int n = static_cast<int>(si.size());
+
+    std::vector<std::tuple<double, int, int>> pairs;
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < static_cast<int>(sf.size()); ++j) {
+            if (si[i] != sf[j])
+                continue;
+            const double delta[3] = {final.coordinates[j].x - initial.coordinates[i].x,
+                                     final.coordinates[j].y - initial.coordinates[i].y,
+                                     final.coordinates[j].z - initial.coordinates[i].z};
+            pairs.emplace_back(minimumImageDistance(initial.lattice, delta), i, j);
+        }
+    std::sort(pairs.begin(), pairs.end());
+
+    std::vector<int> order(n, -1);
+    std::vector<char> taken(sf.size(), 0);
+    for (const auto& [d, i, j] : pairs) {
+        if (order[i] >= 0 || taken[j])
+            continue;
+        order[i] = j;
+        taken[j] = 1;
+    }
+    return order;
+}
+
+std::vector<Atom> alignEndpoint(const std::vector<Atom>& initial, const std::vector<Atom>& final,
+                                const std::vector<int>& order) {
+    std::vector<Atom> aligned(initial.size());
+    for (size_t i = 0; i < initial.size(); ++i) {
+        const Atom& a = initial[i];
+        const Atom& b = final[order[i]];
+        aligned[i] = {b.x - std::round(b.x - a.x), b.y - std::round(b.y - a.y), b.z - std::round(b.z - a.z)};
+    }
+    return aligned;
+}
+
+std::vector<std::vector<Atom>> linearPath(const std::vector<Atom>& initial, const std::vector<Atom>& final,
+                                          int n_images) {
+    std::vector<std::vector<Atom>> path(n_images + 2, initial);
+    for (int k = 1; k <= n_images + 1; ++k) {
+        const double s = static_cast<double>(k) / (n_images + 1);
+        for (size_t i = 0; i < initial.size(); ++i) {
+            path[k][i].x = initial[i].x + s * (final[i].x - initial[i].x);
+            path[k][i].y = initial[i].y + s * (final[i].y - initial[i].y);
+            path[k][i].z = initial[i].z + s * (final[i].z - initial[i].z);
+        }
+    }
+    return path;
+}
+
+double idppObjective(const double lattice[3][3], const std::vector<std::vector<Atom>>& path, size_t image) {
+    PairFrame frame;
+    std::copy(&lattice[0][0], &lattice[0][0] + 9, &frame.lattice[0][0]);
+    invert3(frame.lattice, frame.inverse);
+
+    const std::vector<double> d0 = distanceMatrix(frame, toCartesian(frame, path.front()), 1);
+    const std::vector<double> d1 = distanceMatrix(frame, toCartesian(frame, path.back()), 1);
+    const double s = static_cast<double>(image) / (path.size() - 1);
+    return idppGradient(frame, toCartesian(frame, path[image]), d0, d1, s, nullptr);
+}
+
+IdppResult idppOptimize(const double lattice[3][3], std::vector<std::vector<Atom>>& path,
+                        const IdppOptions& options) {
+    IdppResult result;
+    const size_t n_path = path.size();
+    if (n_path < 3 || path.front().empty())
+        return result;
+    const size_t n = path.front().size();
+
+    PairFrame frame;
+    std::copy(&lattice[0][0], &lattice[0][0] + 9, &frame.lattice[0][0]);
+    invert3(frame.lattice, frame.inverse);
+
+    ScopedTimer phase("idpp_optimize", n * (n_path - 2));
+
+    std::vector<Image> images(n_path);
+    for (size_t k = 0; k < n_path; ++k)
+        images[k] = toCartesian(frame, path[k]);
+    const std::vector<double> d0 = distanceMatrix(frame, images.front(), options.threads);
+    const std::vector<double> d1 = distanceMatrix(frame, images.back(), options.threads);
+
+    std::vector<Image> next = images;
+    std::vector<double> image_force(n_path, 0.0);
+
+    for (result.iterations = 0; result.iterations < options.max_iterations; ++result.iterations) {
+        parallelFor(n_path - 2, options.threads, [&](size_t m) {
+            const size_t k = m + 1;
+            const Image& cur = images[k];
+            const Image& prev = images[k - 1];
+            const Image& post = images[k + 1];
+            Image grad;
+            idppGradient(frame, cur, d0, d1, static_cast<double>(k) / (n_path - 1), &grad);
+
+            // Central-difference tangent and spring along it
+            double tangent_norm = 0.0, len_prev = 0.0, len_next = 0.0;
+            std::vector<double> tx(n), ty(n), tz(n);
+            for (size_t i = 0; i < n; ++i) {
+                tx[i] = post.x[i] - prev.x[i];
+                ty[i] = post.y[i] - prev.y[i];
+                tz[i] = post.z[i] - prev.z[i];
+                tangent_norm += tx[i] * tx[i] + ty[i] * ty[i] + tz[i] * tz[i];
+                const double ax = cur.x[i] - prev.x[i], ay = cur.y[i] - prev.y[i], az = cur.z[i] - prev.z[i];
+                const double bx = post.x[i] - cur.x[i], by = post.y[i] - cur.y[i], bz = post.z[i] - cur.z[i];
+                len_prev += ax * ax + ay * ay + az * az;
+                len_next += bx * bx + by * by + bz * bz;
+            }
+            tangent_norm = std::sqrt(tangent_norm);
+            const double scale = tangent_norm > 0 ? 1.0 / tangent_norm : 0.0;
+            double parallel = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                tx[i] *= scale;
+                ty[i] *= scale;
+                tz[i] *= scale;
+                parallel -= grad.x[i] * tx[i] + grad.y[i] * ty[i] + grad.z[i] * tz[i];
+            }
+            const double spring = options.spring * (std::sqrt(len_next) - std::sqrt(len_prev));
+
+            double max_force2 = 0.0;
+            Image& out = next[k];
+            for (size_t i = 0; i < n; ++i) {
+                const double fx = -grad.x[i] + (spring - parallel) * tx[i];
+                const double fy = -grad.y[i] + (spring - parallel) * ty[i];
+                const double fz = -grad.z[i] + (spring - parallel) * tz[i];
+                const double f2 = fx * fx + fy * fy + fz * fz;
+                max_force2 = std::max(max_force2, f2);
+                double move = options.step;
+                if (std::sqrt(f2) * move > options.max_move)
+                    move = options.max_move / std::sqrt(f2);
+                out.x[i] = cur.x[i] + move * fx;
+                out.y[i] = cur.y[i] + move * fy;
+                out.z[i] = cur.z[i] + move * fz;
+            }
+            image_force[k] = std::sqrt(max_force2);
+        });
+
+        result.max_force = *std::max_element(image_force.begin(), image_force.end());
+        if (result.max_force < options.force_tolerance) {
+            result.converged = true;
+            break;
+        }
+        for (size_t k = 1; k + 1 < n_path; ++k)
+            std::swap(images[k], next[k]);
+    }
+
+    for (size_t k = 1; k + 1 < n_path; ++k)
+        path[k] = toFractional(frame, images[k]);
+    return result;
+}
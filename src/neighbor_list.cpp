@@ -0,0 +1,165 @@
+#include "neighbor_list.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "lattice_reduction.h"
+#include "lattice_utility.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VASP_UTILS_SSE2
+#endif
+
+#ifdef VASP_UTILS_SSE2
+namespace {
+
+// |p - q|^2 for the two points p = (x[0..1], y[0..1], z[0..1])
+inline __m128d squaredPair(const double* x, const double* y, const double* z, __m128d qx, __m128d qy,
+                           __m128d qz) {
+    const __m128d dx = _mm_sub_pd(_mm_loadu_pd(x), qx);
+    const __m128d dy = _mm_sub_pd(_mm_loadu_pd(y), qy);
+    const __m128d dz = _mm_sub_pd(_mm_loadu_pd(z), qz);
+    return _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+}
+
+}  // namespace
+#endif
+
+PeriodicCellIndex::PeriodicCellIndex(const double lattice[3][3], const std::vector<Atom>& fractional,
+                                     double bin_size) {
+    // Work in the Niggli-reduced cell: compact cells need the fewest bins and images per query
+    int transform[3][3];
+    if (!niggliReduce(lattice, lattice_, transform)) {
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                lattice_[i][j] = lattice[i][j];
+    }
+    invert3(lattice_, inverse_);
+    perpendicularHeights(lattice_, heights_);
+
+    const int n_atoms = static_cast<int>(fractional.size());
+
+    for (int k = 0; k < 3; ++k) {
+        int n = bin_size > 0.0 ? static_cast<int>(heights_[k] / bin_size) : 1;
+        bins_[k] = std::max(1, std::min(n, 128));
+    }
+    // Keep the bin table proportional to the number of atoms for very sparse inputs
+    while (bins_[0] * bins_[1] * bins_[2] > 4 * n_atoms + 8) {
+        int k = static_cast<int>(std::max_element(bins_, bins_ + 3) - bins_);
+        bins_[k] = std::max(1, bins_[k] / 2);
+    }
+    const int n_bins = bins_[0] * bins_[1] * bins_[2];
+
+    std::vector<int> atom_bin(n_atoms);
+    std::vector<double> wrapped(3 * static_cast<size_t>(n_atoms));
+    bin_start_.assign(n_bins + 1, 0);
+
+    for (int a = 0; a < n_atoms; ++a) {
+        // Same point expressed in the (possibly reduced) internal cell
+        const double input[3] = {fractional[a].x, fractional[a].y, fractional[a].z};
+        double r[3], f[3];
+        fractionalToCartesian(lattice, input, r);
+        cartesianToFractional(inverse_, r, f);
+        for (double& x : f)
+            x = wrapFractional(x);
+        int b[3];
+        for (int k = 0; k < 3; ++k)
+            b[k] = std::min(bins_[k] - 1, static_cast<int>(f[k] * bins_[k]));
+        atom_bin[a] = (b[0] * bins_[1] + b[1]) * bins_[2] + b[2];
+        bin_start_[atom_bin[a] + 1]++;
+        fractionalToCartesian(lattice_, f, &wrapped[3 * a]);
+    }
+
+    for (int b = 0; b < n_bins; ++b)
+        bin_start_[b + 1] += bin_start_[b];
+
+    order_.resize(n_atoms);
+    x_.resize(n_atoms);
+    y_.resize(n_atoms);
+    z_.resize(n_atoms);
+    std::vector<int> fill(bin_start_.begin(), bin_start_.end() - 1);
+    for (int a = 0; a < n_atoms; ++a) {
+        int slot = fill[atom_bin[a]]++;
+        order_[slot] = a;
+        x_[slot] = wrapped[3 * a];
+        y_[slot] = wrapped[3 * a + 1];
+        z_[slot] = wrapped[3 * a + 2];
+    }
+}
+
+void PeriodicCellIndex::pointBin(const double point[3], double frac[3], int bin[3]) const {
+    cartesianToFractional(inverse_, point, frac);
+    for (int k = 0; k < 3; ++k)
+        bin[k] = static_cast<int>(std::floor(frac[k] * bins_[k]));
+}
+
+double PeriodicCellIndex::nearestDistance(const double point[3], double max_radius) const {
+    double best2 = max_radius * max_radius;
+    forEachBinImage(point, max_radius, [&](int begin, int end, double px, double py, double pz) {
+        best2 = minSquaredDistance(x_.data() + begin, y_.data() + begin, z_.data() + begin, end - begin, px, py,
+                                   pz, best2);
+    });
+    return std::sqrt(best2);
+}
+
+void PeriodicCellIndex::squaredDistances(const double* x, const double* y, const double* z, int count, double px,
+                                         double py, double pz, double* r2) {
+    int i = 0;
+#ifdef VASP_UTILS_SSE2
+    const __m128d qx = _mm_set1_pd(px), qy = _mm_set1_pd(py), qz = _mm_set1_pd(pz);
+    for (; i + 2 <= count; i += 2)
+        _mm_storeu_pd(r2 + i, squaredPair(x + i, y + i, z + i, qx, qy, qz));
+#endif
+    for (; i < count; ++i) {
+        const double dx = x[i] - px;
+        const double dy = y[i] - py;
+        const double dz = z[i] - pz;
+        r2[i] = dx * dx + dy * dy + dz * dz;
+    }
+}
+
+double PeriodicCellIndex::minSquaredDistance(const double* x, const double* y, const double* z, int count,
+                                             double px, double py, double pz, double bound) {
+    int i = 0;
+#ifdef VASP_UTILS_SSE2
+    // Two independent running minima, so consecutive minpd do not wait on each other
+    const __m128d qx = _mm_set1_pd(px), qy = _mm_set1_pd(py), qz = _mm_set1_pd(pz);
+    __m128d lo = _mm_set1_pd(bound), hi = lo;
+    for (; i + 4 <= count; i += 4) {
+        lo = _mm_min_pd(squaredPair(x + i, y + i, z + i, qx, qy, qz), lo);
+        hi = _mm_min_pd(squaredPair(x + i + 2, y + i + 2, z + i + 2, qx, qy, qz), hi);
+    }
+    lo = _mm_min_pd(lo, hi);
+    bound = std::min(_mm_cvtsd_f64(lo), _mm_cvtsd_f64(_mm_unpackhi_pd(lo, lo)));
+#endif
+    for (; i < count; ++i) {
+        const double dx = x[i] - px;
+        const double dy = y[i] - py;
+        const double dz = z[i] - pz;
+        bound = std::min(bound, dx * dx + dy * dy + dz * dz);
+    }
+    return bound;
+}
+
+std::vector<std::vector<Neighbor>> buildNeighborList(const POSCAR& poscar, double cutoff) {
+    POSCAR direct = poscar;
+    direct.toDirect();
+
+    PeriodicCellIndex index(direct.lattice, direct.coordinates, cutoff);
+    std::vector<std::vector<Neighbor>> neighbors(direct.coordinates.size());
+
+    for (size_t i = 0; i < direct.coordinates.size(); ++i) {
+        const double f[3] = {direct.coordinates[i].x, direct.coordinates[i].y, direct.coordinates[i].z};
+        double r[3];
+        fractionalToCartesian(direct.lattice, f, r);
+        index.forEachWithin(r, cutoff, [&](int j, double d) {
+            if (d > 1e-8 || j != static_cast<int>(i))
+                neighbors[i].push_back({j, d});
+        });
+        std::sort(neighbors[i].begin(), neighbors[i].end(),
+                  [](const Neighbor& a, const Neighbor& b) { return a.distance < b.distance; });
+    }
+    return neighbors;
+}
@@ -0,0 +1,12 @@
+#include "parallel_utility.h"
+
+#include <thread>
+
+int hardwareThreads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n > 0 ? static_cast<int>(n) : 1;
+}
+
+int resolveThreadCount(int requested) {
+    return requested > 0 ? requested : hardwareThreads();
+}
@@ -0,0 +1,59 @@
+#include "point_defects.h"
+
+#include <sstream>
+#include <unordered_map>
+
+#include "structure_utility.h"
+
+std::vector<DefectSite> inequivalentSites(const std::vector<std::string>& species,
+                                          const std::vector<int>& equivalent_atoms) {
+    std::vector<DefectSite> sites;
+    std::unordered_map<int, size_t> orbit;  // representative -> position in sites
+    for (size_t i = 0; i < equivalent_atoms.size() && i < species.size(); ++i) {
+        auto [it, inserted] = orbit.emplace(equivalent_atoms[i], sites.size());
+        if (inserted)
+            sites.push_back({static_cast<int>(i), species[i], 1});
+        else
+            sites[it->second].multiplicity++;
+    }
+    return sites;
+}
+
+static POSCAR replaceAtom(const POSCAR& host, int atom, const std::string& replacement, const std::string& comment) {
+    POSCAR direct = host;
+    if (!direct.is_direct)
+        direct.toDirect();
+
+    std::vector<std::string> species = atomSpecies(direct);
+    std::vector<Atom> coords = direct.coordinates;
+    std::vector<std::uint8_t> flags = direct.selective_dynamics ? direct.selective_flags : std::vector<std::uint8_t>{};
+    if (replacement.empty()) {
+        species.erase(species.begin() + atom);
+        coords.erase(coords.begin() + atom);
+        if (atom < static_cast<int>(flags.size()))
+            flags.erase(flags.begin() + atom);
+    } else {
+        species[atom] = replacement;
+    }
+    return buildPOSCAR(comment, direct.lattice, species, coords, direct.elements, flags);
+}
+
+POSCAR makeVacancy(const POSCAR& host, int atom, const std::string& comment) {
+    return replaceAtom(host, atom, "", comment);
+}
+
+POSCAR makeSubstitution(const POSCAR& host, int atom, const std::string& dopant, const std::string& comment) {
+    return replaceAtom(host, atom, dopant, comment);
+}
+
+bool parseSubstitutions(const std::string& text, std::vector<std::pair<std::string, std::string>>& substitutions) {
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t colon = item.find(':');
+        if (colon == std::string::npos || colon == 0 || colon + 1 == item.size())
+            return false;
+        substitutions.emplace_back(item.substr(0, colon), item.substr(colon + 1));
+    }
+    return !substitutions.empty();
+}
@@ -7,10 +7,13 @@
 #include <optional>
 #include <string>
 
+#include "instrumentation.h"
+#include "lattice_reduction.h"
 #include "poscar_file.h"
 #include "symmetry.h"
 
-bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outputFile, double& symprec) {
+bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outputFile, double& symprec,
+               CellReduction& reduction) {
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
 
@@ -33,6 +36,18 @@ bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outp
             } catch (...) {
                 return false;
             }
+        } else if (arg == "--niggli") {
+            reduction = CellReduction::Niggli;
+        } else if (arg == "--delaunay") {
+            reduction = CellReduction::Delaunay;
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
         } else {
             std::cerr << "Warning: unknown argument! Ignoring it!\n";
             printHelp();
@@ -73,6 +88,12 @@ void printHelp() {
                  "  --input      input POSCAR file name (default: POSCAR)\n"
                  "  --symprec    symmetry tolerance (spglib symprec) (default: 1e-5)\n"
                  "  --output     output POSCAR file name (used with --primitive) (default: POSCAR_primitive)\n"
+                 "  --niggli     Niggli-reduce the output cell\n"
+                 "  --delaunay   Delaunay-reduce the output cell\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
                  "  --help       show this help message\n\n"
                  "Example:\n"
                  "  poscar_2conventional --input POSCARin --symprec 1e-5 --outpur POSCARout\n";
@@ -82,8 +103,9 @@ int main(int argc, char* argv[]) {
     std::string inputFile{"POSCAR"};
     std::string outputFile{"POSCAR_conventional"};
     double symprec{1e-5};
+    CellReduction reduction{CellReduction::None};
 
-    if (!readInput(argc, argv, inputFile, outputFile, symprec)) {
+    if (!readInput(argc, argv, inputFile, outputFile, symprec, reduction)) {
         return 1;
     }
 
@@ -100,6 +122,11 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    if (reduction != CellReduction::None && !reduceCell(*poscar_stand, reduction)) {
+        std::cerr << "Error: failed to reduce the cell.\n";
+        return 1;
+    }
+
     if (!poscar_stand->writePOSCAR(outputFile)) {
         std::cerr << "Error: failed to write conventional cell POSCAR file to " << outputFile << "\n";
         return 1;
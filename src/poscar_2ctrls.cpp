@@ -1,11 +1,20 @@
 #include "poscar_2ctrls.h"
 
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
 #include <iostream>
 #include <string>
+#include <vector>
 
+#include "instrumentation.h"
+#include "parallel_utility.h"
 #include "poscar_file.h"
 
-bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outputFile) {
+namespace fs = std::filesystem;
+
+bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outputFile, std::string& inputDir,
+               std::string& prefix, std::string& outputDir, bool& toPoscar, int& threads) {
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
 
@@ -20,6 +29,36 @@ bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outp
             if (i + 1 >= argc)
                 return false;
             outputFile = argv[++i];
+        } else if (arg == "--input-dir") {
+            if (i + 1 >= argc)
+                return false;
+            inputDir = argv[++i];
+        } else if (arg == "--prefix") {
+            if (i + 1 >= argc)
+                return false;
+            prefix = argv[++i];
+        } else if (arg == "--output-dir") {
+            if (i + 1 >= argc)
+                return false;
+            outputDir = argv[++i];
+        } else if (arg == "--reverse") {
+            toPoscar = true;
+        } else if (arg == "--threads") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                threads = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
         } else {
             std::cerr << "Warning: unknown argument! Ignoring!\n";
             printHelp();
@@ -32,41 +71,113 @@ void printHelp() {
     std::cerr << "Usage:\n"
                  "  poscar_2ctrls [options]\n\n"
                  "Options:\n"
-                 "  --input   input POSCAR file name\n"
-                 "  --output  output POSCAR file name\n"
+                 "  --input   input POSCAR file name (default: POSCAR, ctrls.system with --reverse)\n"
+                 "  --output  output ctrls file name (default: ctrls.system, POSCAR_out with --reverse)\n"
+                 "  --reverse convert ctrls to POSCAR\n"
+                 "  --input-dir batch mode: convert every file of this directory starting with --prefix\n"
+                 "  --prefix  file name prefix in batch mode (default: POSCAR, ctrls. with --reverse)\n"
+                 "  --output-dir directory for batch output: ctrls.<name>, or POSCAR_<name> with --reverse "
+                 "(default: .)\n"
+                 "  --threads number of worker threads in batch mode (default: all cores)\n"
+                 "  --timings Print phase timing breakdown to stderr\n"
+                 "  --timings-json Print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats Print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json Print memory report to stderr as JSON\n"
                  "  --help    Show this help message\n\n"
                  "Example:\n"
-                 "  poscar_2ctrls --input POSCARin --output ctrls.system\n";
+                 "  poscar_2ctrls --input POSCARin --output ctrls.system\n"
+                 "  poscar_2ctrls --reverse --input-dir questaal --output-dir vasp\n";
+}
+
+static bool convert(const std::string& inputFile, const std::string& outputFile, bool toPoscar) {
+    POSCAR poscar;
+    if (toPoscar) {
+        if (!poscar.readCtrlsFile(inputFile)) {
+            std::cerr << "Error reading ctrls file: " << inputFile << "\n";
+            return false;
+        }
+        return poscar.writePOSCAR(outputFile);
+    }
+
+    if (!poscar.readPOSCAR(inputFile)) {
+        std::cerr << "Error reading POSCAR file: " << inputFile << "\n";
+        return false;
+    }
+    return poscar.writeCtrlsFile(outputFile);
 }
 
 int main(int argc, char* argv[]) {
-    std::string inputFile{"POSCAR"};
-    std::string outputFile{"ctrls.system"};
+    std::string inputFile;
+    std::string outputFile;
+    std::string inputDir;
+    std::string prefix;
+    std::string outputDir{"."};
+    bool toPoscar{false};
+    int threads{0};
 
-    if (!readInput(argc, argv, inputFile, outputFile)) {
+    if (!readInput(argc, argv, inputFile, outputFile, inputDir, prefix, outputDir, toPoscar, threads)) {
         if (argc > 1 && std::string(argv[1]) != "--help") {
             std::cerr << "Error parsing input arguments\n";
         }
         return 1;
     }
 
-    POSCAR poscar;
-    if (!poscar.readPOSCAR(inputFile)) {
-        std::cerr << "Error reading POSCAR file: " << inputFile << "\n";
-        return 1;
+    // Defaults depend on the direction, so they are filled in after parsing
+    if (inputFile.empty())
+        inputFile = toPoscar ? "ctrls.system" : "POSCAR";
+    if (outputFile.empty())
+        outputFile = toPoscar ? "POSCAR_out" : "ctrls.system";
+
+    if (inputDir.empty()) {
+        if (!convert(inputFile, outputFile, toPoscar)) {
+            std::cerr << "Error writing output file: " << outputFile << "\n";
+            return 1;
+        }
+        std::cout << "Output written to: " << outputFile << "\n";
+        return 0;
     }
 
-    if (poscar.is_direct) {
-        poscar.toCartesian();
-        std::cout << "Converted Direct -> Cartesian\n";
+    if (!fs::is_directory(inputDir)) {
+        std::cerr << "Error: " << inputDir << " is not a directory\n";
+        return 1;
     }
+    if (prefix.empty())
+        prefix = toPoscar ? "ctrls." : "POSCAR";
 
-    if (!poscar.writeCtrlsFile(outputFile)) {
-        std::cerr << "Error writing output ctrls file: " << outputFile << "\n";
+    std::vector<std::string> files;
+    for (const auto& entry : fs::directory_iterator(inputDir)) {
+        if (entry.is_regular_file() && entry.path().filename().string().rfind(prefix, 0) == 0)
+            files.push_back(entry.path().string());
+    }
+    std::sort(files.begin(), files.end());
+    if (files.empty()) {
+        std::cerr << "Error: no files starting with \"" << prefix << "\" in " << inputDir << "\n";
+        return 1;
+    }
+    std::error_code ec;
+    fs::create_directories(outputDir, ec);
+    if (ec) {
+        std::cerr << "Error: cannot create directory " << outputDir << ": " << ec.message() << "\n";
         return 1;
     }
 
-    std::cout << "Output written to: " << outputFile << "\n";
+    std::atomic<int> converted{0};
+    {
+        ScopedTimer phase("convert_batch", files.size());
+        parallelFor(files.size(), threads, [&](size_t i) {
+            std::string name = fs::path(files[i]).filename().string();
+            if (toPoscar) {
+                if (name.rfind("ctrls.", 0) == 0)
+                    name = name.substr(6);
+                name = "POSCAR_" + name;
+            } else {
+                name = "ctrls." + name;
+            }
+            if (convert(files[i], (fs::path(outputDir) / name).string(), toPoscar))
+                converted++;
+        });
+    }
 
-    return 0;
+    std::cout << "Converted " << converted << " of " << files.size() << " files to " << outputDir << "\n";
+    return converted == static_cast<int>(files.size()) ? 0 : 1;
 }
@@ -0,0 +1,161 @@
+#include "poscar_archive.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "instrumentation.h"
+#include "structure_archive.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Entry names that would land outside the output directory are not extracted
+bool safeEntryName(const std::string& name) {
+    fs::path path(name);
+    if (path.is_absolute() || path.has_root_name())
+        return false;
+    return std::none_of(path.begin(), path.end(), [](const fs::path& part) { return part == ".."; });
+}
+
+}  // namespace
+
+bool readInput(int argc, char* argv[], std::string& archiveFile, std::string& outputDir,
+               std::vector<std::string>& members, bool& extract) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--input") {
+            if (i + 1 >= argc)
+                return false;
+            archiveFile = argv[++i];
+        } else if (arg == "--output-dir") {
+            if (i + 1 >= argc)
+                return false;
+            outputDir = argv[++i];
+        } else if (arg == "--member") {
+            if (i + 1 >= argc)
+                return false;
+            members.push_back(argv[++i]);
+        } else if (arg == "--list") {
+            extract = false;
+        } else if (arg == "--extract") {
+            extract = true;
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+bool validateInput(const std::string& archiveFile) {
+    if (archiveFile.empty()) {
+        std::cerr << "Error: --input is required!\n";
+        return false;
+    }
+    if (!fs::exists(archiveFile)) {
+        std::cerr << "Error: cannot open file " << archiveFile << "\n";
+        return false;
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  poscar_archive [options]\n\n"
+                 "Options:\n"
+                 "  --input      tar archive, plain or .gz/.xz/.zst compressed (required)\n"
+                 "  --list       list the structures with their sizes (default)\n"
+                 "  --extract    write the structures as separate files\n"
+                 "  --output-dir directory to extract into (default: .)\n"
+                 "  --member     only list or extract this entry, may be repeated\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
+                 "  --help       show this help message\n\n"
+                 "Example:\n"
+                 "  poscar_atom_displace --input POSCAR --nfiles 50000 --amp 0.05 --archive displaced.tar\n"
+                 "  poscar_archive --input displaced.tar --list\n"
+                 "  poscar_archive --input displaced.tar --extract --member POSCAR_modified17 --output-dir run17\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string archiveFile;
+    std::string outputDir{"."};
+    std::vector<std::string> members;
+    bool extract = false;
+
+    if (!readInput(argc, argv, archiveFile, outputDir, members, extract))
+        return 1;
+
+    if (!validateInput(archiveFile))
+        return 1;
+
+    ArchiveReader archive(archiveFile);
+    if (!archive) {
+        std::cerr << "Error: cannot open file " << archiveFile << "\n";
+        return 1;
+    }
+
+    ScopedTimer timer(extract ? "archive_extract" : "archive_list");
+    std::size_t matched = 0, count = 0, bytes = 0;
+    ArchiveEntry entry;
+    while (archive.next(entry)) {
+        if (!members.empty() && std::find(members.begin(), members.end(), entry.name) == members.end())
+            continue;
+        matched++;
+
+        if (!extract) {
+            std::cout << entry.name << " " << entry.contents.size() << "\n";
+            count++;
+            bytes += entry.contents.size();
+            continue;
+        }
+        if (!safeEntryName(entry.name)) {
+            std::cerr << "Warning: skipping entry outside the output directory: " << entry.name << "\n";
+            continue;
+        }
+        fs::path target = fs::path(outputDir) / entry.name;
+        std::error_code ec;
+        fs::create_directories(target.parent_path(), ec);
+        std::ofstream out(target, std::ios::binary | std::ios::trunc);
+        out.write(entry.contents.data(), static_cast<std::streamsize>(entry.contents.size()));
+        out.close();
+        if (!out) {
+            std::cerr << "Error: failed writing to " << target.string() << "\n";
+            return 1;
+        }
+        count++;
+        bytes += entry.contents.size();
+    }
+    if (timer.active())
+        timer.setBytes(bytes);
+
+    if (!archive.error().empty()) {
+        std::cerr << "Error: " << archive.error() << "\n";
+        return 1;
+    }
+    if (matched < members.size())
+        std::cerr << "Warning: " << members.size() - matched << " requested entries are not in the archive\n";
+    if (extract)
+        std::cout << "Extracted " << count << (count == 1 ? " file" : " files") << " to " << outputDir << "\n";
+
+    return 0;
+}
@@ -3,9 +3,14 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <string>
 
+#include "instrumentation.h"
 #include "poscar_file.h"
+#include "structure_archive.h"
+#include "text_writer.h"
 
 bool testReadPOSCAR(const std::string& filename) {
     POSCAR original;
@@ -53,7 +58,7 @@ bool testReadPOSCAR(const std::string& filename) {
 }
 
 bool readInput(int argc, char* argv[], std::string& filename, int& n_files, int& n_atoms, double& amplitude,
-               bool& allAtoms) {
+               bool& allAtoms, std::string& archiveFile) {
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
 
@@ -72,6 +77,10 @@ bool readInput(int argc, char* argv[], std::string& filename, int& n_files, int&
             if (i + 1 >= argc)
                 return false;
             filename = argv[++i];
+        } else if (arg == "--archive") {
+            if (i + 1 >= argc)
+                return false;
+            archiveFile = argv[++i];
         } else if (arg == "--allatoms") {
             allAtoms = true;
         } else if (arg == "--natoms") {
@@ -90,6 +99,14 @@ bool readInput(int argc, char* argv[], std::string& filename, int& n_files, int&
             } catch (...) {
                 return false;
             }
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
         } else {
             std::cerr << "Warning: unknown argument! Ignoring it!\n";
             printHelp();
@@ -98,7 +115,7 @@ bool readInput(int argc, char* argv[], std::string& filename, int& n_files, int&
     return true;
 }
 
-bool validateInput(const std::string& filename, int n_files, int n_atoms, double amplitude) {
+bool validateInput(const std::string& filename, int n_files, int n_atoms, double amplitude, bool archive) {
     // Testing input for valid values.
     if (n_atoms < 0) {
         std::cerr << "Error: number of atoms to displace is negative!\n";
@@ -120,8 +137,9 @@ bool validateInput(const std::string& filename, int n_files, int n_atoms, double
         return false;
     }
 
-    if (n_files > 1000) {
-        std::cerr << "Error: number displaced structure files is too high!\n";
+    // One archive does not load the file system with metadata, so only separate files are limited
+    if (n_files > 1000 && !archive) {
+        std::cerr << "Error: number displaced structure files is too high! Use --archive for more.\n";
         return false;
     }
 
@@ -150,9 +168,15 @@ void printHelp() {
                  "  --natoms     number of atoms to displace\n"
                  "  --allatoms   displace all atoms in the input file\n"
                  "  --amp        maximal norm of the displacement vector in Angstroms\n"
+                 "  --archive    write all structures into this tar archive instead of separate files\n"
+                 "  --timings    Print phase timing breakdown to stderr\n"
+                 "  --timings-json Print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   Print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json Print memory report to stderr as JSON\n"
                  "  --help       Show this help message\n\n"
                  "Example:\n"
-                 "  poscar_atom_displace --input POSCAR --nfiles 10 --natoms 1 --amp 0.1\n";
+                 "  poscar_atom_displace --input POSCAR --nfiles 10 --natoms 1 --amp 0.1\n"
+                 "  poscar_atom_displace --input POSCAR --nfiles 50000 --allatoms --amp 0.05 --archive displaced.tar.zst\n";
 }
 
 int main(int argc, char* argv[]) {
@@ -162,12 +186,13 @@ int main(int argc, char* argv[]) {
     int n_files{1};
     double amplitude{0.01};
     bool allAtoms{false};
+    std::string archiveFile;
 
     // Read input arguments
-    if (!readInput(argc, argv, filename, n_files, n_atoms, amplitude, allAtoms))
+    if (!readInput(argc, argv, filename, n_files, n_atoms, amplitude, allAtoms, archiveFile))
         return 1;
 
-    if (!validateInput(filename, n_files, n_atoms, amplitude))
+    if (!validateInput(filename, n_files, n_atoms, amplitude, !archiveFile.empty()))
         return 1;
 
     // if (!testReadPOSCAR(filename)) return 1;
@@ -195,13 +220,38 @@ int main(int argc, char* argv[]) {
         std::cout << "Number of atoms to displace: " << n_atoms << "\n";
     }
 
+    // Structures go to the archive writer thread as text while the next one is generated
+    std::unique_ptr<ArchiveWriter> archive;
+    if (!archiveFile.empty()) {
+        archive = std::make_unique<ArchiveWriter>(archiveFile);
+        if (!*archive)
+            return 1;
+    }
+
     for (int j = 0; j < n_files; j++) {
-        POSCAR output(original);
         std::string filenameOut = "POSCAR_modified" + std::to_string(j + 1);
 
-        output.displaceAtoms(n_atoms, amplitude);
-        output.writePOSCAR(filenameOut);
+        POSCAR output;
+        {
+            ScopedTimer phase("displace_structure", original.total_atoms);
+            output = original;
+            output.displaceAtoms(n_atoms, amplitude);
+        }
+        if (!archive) {
+            output.writePOSCAR(filenameOut);
+            continue;
+        }
+        std::ostringstream text;
+        {
+            TextWriter writer(text);
+            output.writePOSCAR(writer);
+            writer.flush();
+        }
+        if (!archive->add(filenameOut, text.str()))
+            return 1;
     }
+    if (archive && !archive->close())
+        return 1;
 
     /*
     std::cout << "Input file: " << filename << "\n";
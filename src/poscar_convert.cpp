@@ -0,0 +1,120 @@
+#include "poscar_convert.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "instrumentation.h"
+#include "poscar_file.h"
+#include "structure_formats.h"
+
+bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outputFile, std::string& inputFormat,
+               std::string& outputFormat, bool& allFrames, bool& listFormats) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--input") {
+            if (i + 1 >= argc)
+                return false;
+            inputFile = argv[++i];
+        } else if (arg == "--output") {
+            if (i + 1 >= argc)
+                return false;
+            outputFile = argv[++i];
+        } else if (arg == "--input-format") {
+            if (i + 1 >= argc)
+                return false;
+            inputFormat = argv[++i];
+        } else if (arg == "--output-format") {
+            if (i + 1 >= argc)
+                return false;
+            outputFormat = argv[++i];
+        } else if (arg == "--all-frames") {
+            allFrames = true;
+        } else if (arg == "--list") {
+            listFormats = true;
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  poscar_convert [options]\n\n"
+                 "Options:\n"
+                 "  --input      input structure file (default: POSCAR)\n"
+                 "  --output     output structure file, format taken from its name (required)\n"
+                 "  --input-format format of the input instead of guessing it from the name\n"
+                 "  --output-format format of the output instead of guessing it from the name\n"
+                 "  --all-frames convert every frame of a multi-frame input (e.g. extxyz trajectory)\n"
+                 "  --list       list the supported formats and exit\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
+                 "  --help       show this help message\n\n"
+                 "Example:\n"
+                 "  poscar_convert --input POSCAR --output NaCl.xyz\n"
+                 "  poscar_convert --input md.extxyz --all-frames --output md_copy.xyz\n"
+                 "  poscar_convert --input CONTCAR --output data.NaCl --output-format lammps\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputFile{"POSCAR"};
+    std::string outputFile;
+    std::string inputFormat;
+    std::string outputFormat;
+    bool allFrames = false;
+    bool listFormats = false;
+
+    if (!readInput(argc, argv, inputFile, outputFile, inputFormat, outputFormat, allFrames, listFormats))
+        return 1;
+
+    if (listFormats) {
+        for (const StructureFormat* format : structureFormats()) {
+            std::cout << format->name << (format->read ? " read" : "") << (format->write ? " write" : "") << ":";
+            for (const std::string& extension : format->extensions)
+                std::cout << " *" << extension;
+            for (const std::string& prefix : format->prefixes)
+                std::cout << " " << prefix << "*";
+            std::cout << "\n";
+        }
+        return 0;
+    }
+
+    if (outputFile.empty()) {
+        std::cerr << "Error: --output is required!\n";
+        printHelp();
+        return 1;
+    }
+
+    std::vector<POSCAR> frames(1);
+    bool ok = allFrames ? readStructures(inputFile, frames, inputFormat)
+                        : readStructure(inputFile, frames.front(), inputFormat);
+    if (!ok) {
+        std::cerr << "Error: reading structure file " << inputFile << "\n";
+        return 1;
+    }
+
+    if (!writeStructures(outputFile, frames, outputFormat))
+        return 1;
+
+    std::cout << "Converted " << frames.size() << (frames.size() == 1 ? " structure" : " structures") << " to "
+              << outputFile << "\n";
+
+    return 0;
+}
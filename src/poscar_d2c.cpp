@@ -3,6 +3,7 @@
 #include <iostream>
 #include <string>
 
+#include "instrumentation.h"
 #include "poscar_file.h"
 
 bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outputFile) {
@@ -20,6 +21,14 @@ bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outp
             if (i + 1 >= argc)
                 return false;
             outputFile = argv[++i];
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
         } else {
             std::cerr << "Warning: unknown argument! Ignoring!\n";
             printHelp();
@@ -34,6 +43,10 @@ void printHelp() {
                  "Options:\n"
                  "  --input   input POSCAR file name\n"
                  "  --output  output POSCAR file name\n"
+                 "  --timings Print phase timing breakdown to stderr\n"
+                 "  --timings-json Print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats Print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json Print memory report to stderr as JSON\n"
                  "  --help    Show this help message\n\n"
                  "Example:\n"
                  "  poscar_d2c --input POSCARin --output POSCARout\n";
@@ -0,0 +1,237 @@
+#include "poscar_dedup.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "instrumentation.h"
+#include "parallel_utility.h"
+#include "poscar_file.h"
+#include "structure_fingerprint.h"
+#include "structure_matcher.h"
+
+namespace fs = std::filesystem;
+
+bool readInput(int argc, char* argv[], std::string& inputDir, std::string& prefix, std::string& outputFile,
+               MatchOptions& options, double& histogramTolerance, int& threads) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--input-dir") {
+            if (i + 1 >= argc)
+                return false;
+            inputDir = argv[++i];
+        } else if (arg == "--prefix") {
+            if (i + 1 >= argc)
+                return false;
+            prefix = argv[++i];
+        } else if (arg == "--output") {
+            if (i + 1 >= argc)
+                return false;
+            outputFile = argv[++i];
+        } else if (arg == "--symprec" || arg == "--site-tol" || arg == "--length-tol" || arg == "--hist-tol") {
+            if (i + 1 >= argc)
+                return false;
+            double value;
+            try {
+                value = std::stod(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+            if (arg == "--symprec")
+                options.symprec = value;
+            else if (arg == "--site-tol")
+                options.site_tolerance = value;
+            else if (arg == "--length-tol")
+                options.length_tolerance = value;
+            else
+                histogramTolerance = value;
+        } else if (arg == "--threads") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                threads = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+bool validateInput(const std::string& inputDir, const MatchOptions& options, double histogramTolerance) {
+    if (!fs::is_directory(inputDir)) {
+        std::cerr << "Error: " << inputDir << " is not a directory\n";
+        return false;
+    }
+    if (options.symprec <= 0) {
+        std::cerr << "Error: symprec must be positive!!!\n";
+        return false;
+    }
+    if (options.site_tolerance <= 0 || options.length_tolerance <= 0 || histogramTolerance < 0) {
+        std::cerr << "Error: tolerances must be positive!!!\n";
+        return false;
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  poscar_dedup [options]\n\n"
+                 "Options:\n"
+                 "  --input-dir  directory with candidate POSCAR files (default: .)\n"
+                 "  --prefix     only consider files whose name starts with this prefix (default: POSCAR)\n"
+                 "  --output     list of unique structures and their duplicates (default: unique_structures.txt)\n"
+                 "  --symprec    spglib tolerance used for standardization (default: 1e-3)\n"
+                 "  --site-tol   maximal distance of matched atoms in Angstrom (default: 0.1)\n"
+                 "  --length-tol relative tolerance on lattice metric and volume (default: 0.02)\n"
+                 "  --hist-tol   tolerance on the pair-distance histogram prefilter (default: 0.05)\n"
+                 "  --threads    number of worker threads (default: all cores)\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
+                 "  --help       show this help message\n\n"
+                 "Example:\n"
+                 "  poscar_dedup --input-dir candidates --prefix POSCAR_modified --threads 8\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputDir{"."};
+    std::string prefix{"POSCAR"};
+    std::string outputFile{"unique_structures.txt"};
+    MatchOptions options;
+    double histogramTolerance{0.05};
+    int threads{0};
+
+    if (!readInput(argc, argv, inputDir, prefix, outputFile, options, histogramTolerance, threads))
+        return 1;
+
+    if (!validateInput(inputDir, options, histogramTolerance))
+        return 1;
+
+    std::vector<std::string> files;
+    for (const auto& entry : fs::directory_iterator(inputDir)) {
+        if (entry.is_regular_file() && entry.path().filename().string().rfind(prefix, 0) == 0)
+            files.push_back(entry.path().string());
+    }
+    std::sort(files.begin(), files.end());
+
+    if (files.empty()) {
+        std::cerr << "Error: no files starting with \"" << prefix << "\" in " << inputDir << "\n";
+        return 1;
+    }
+
+    const size_t n = files.size();
+    std::vector<POSCAR> standardized(n);
+    std::vector<StructureFingerprint> fingerprints(n);
+    std::vector<char> valid(n, 0);
+
+    // Read, fingerprint and standardize every candidate once
+    {
+        ScopedTimer phase("dedup_prepare", 0);
+        parallelFor(n, threads, [&](size_t i) {
+            POSCAR poscar;
+            if (!poscar.readPOSCAR(files[i]))
+                return;
+            fingerprints[i] = computeFingerprint(poscar);
+            standardized[i] = standardizeForMatching(poscar, options.symprec);
+            valid[i] = 1;
+        });
+    }
+
+    // Bucket by the exact part of the fingerprint; volume and histogram filter pairs inside a bucket
+    std::unordered_map<size_t, std::vector<size_t>> bucketMap;
+    for (size_t i = 0; i < n; ++i) {
+        if (valid[i])
+            bucketMap[fingerprints[i].composition_hash].push_back(i);
+        else
+            std::cerr << "Warning: skipping unreadable file " << files[i] << "\n";
+    }
+    std::vector<std::vector<size_t>> buckets;
+    buckets.reserve(bucketMap.size());
+    for (auto& [key, members] : bucketMap)
+        buckets.push_back(std::move(members));
+
+    // representative[i] is the first structure (in file order) equivalent to structure i
+    std::vector<size_t> representative(n);
+    for (size_t i = 0; i < n; ++i)
+        representative[i] = i;
+
+    {
+        ScopedTimer phase("dedup_match", n);
+        parallelFor(buckets.size(), threads, [&](size_t b) {
+            std::vector<size_t> reps;
+            for (size_t i : buckets[b]) {
+                bool duplicate = false;
+                for (size_t r : reps) {
+                    if (!fingerprintsCompatible(fingerprints[i], fingerprints[r], 3.0 * options.length_tolerance,
+                                                histogramTolerance))
+                        continue;
+                    if (standardizedStructuresMatch(standardized[i], standardized[r], options)) {
+                        representative[i] = r;
+                        duplicate = true;
+                        break;
+                    }
+                }
+                if (!duplicate)
+                    reps.push_back(i);
+            }
+        });
+    }
+
+    std::vector<std::vector<size_t>> duplicates(n);
+    size_t unique = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (!valid[i])
+            continue;
+        if (representative[i] == i)
+            unique++;
+        else
+            duplicates[representative[i]].push_back(i);
+    }
+
+    std::ofstream out(outputFile);
+    if (!out) {
+        std::cerr << "Error: cannot create file " << outputFile << "\n";
+        return 1;
+    }
+    out << "# unique_structure  n_duplicates  duplicates...\n";
+    for (size_t i = 0; i < n; ++i) {
+        if (!valid[i] || representative[i] != i)
+            continue;
+        out << files[i] << " " << duplicates[i].size();
+        for (size_t d : duplicates[i])
+            out << " " << files[d];
+        out << "\n";
+    }
+    out.close();
+    if (!out) {
+        std::cerr << "Error: failed to write " << outputFile << "\n";
+        return 1;
+    }
+
+    std::cout << "Structures read: " << n << "\n";
+    std::cout << "Unique structures: " << unique << "\n";
+    std::cout << "Output written to: " << outputFile << "\n";
+
+    return 0;
+}
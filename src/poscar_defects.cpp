@@ -0,0 +1,230 @@
+#include "poscar_defects.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "instrumentation.h"
+#include "parallel_utility.h"
+#include "point_defects.h"
+#include "poscar_file.h"
+#include "structure_utility.h"
+#include "symmetry.h"
+
+bool readInput(int argc, char* argv[], std::string& inputFile, int supercell[3], std::string& substitute,
+               bool& vacancies, double& symprec, std::string& outputPrefix, int& threads) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--input") {
+            if (i + 1 >= argc)
+                return false;
+            inputFile = argv[++i];
+        } else if (arg == "--supercell") {
+            if (i + 3 >= argc)
+                return false;
+            try {
+                for (int k = 0; k < 3; ++k)
+                    supercell[k] = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--substitute") {
+            if (i + 1 >= argc)
+                return false;
+            substitute = argv[++i];
+        } else if (arg == "--no-vacancies") {
+            vacancies = false;
+        } else if (arg == "--symprec") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                symprec = std::stod(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--output-prefix") {
+            if (i + 1 >= argc)
+                return false;
+            outputPrefix = argv[++i];
+        } else if (arg == "--threads") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                threads = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+bool validateInput(const std::string& inputFile, const int supercell[3], const std::string& substitute,
+                   bool vacancies, double symprec) {
+    std::ifstream file(inputFile);
+    if (!file) {
+        std::cerr << "Error: cannot open file " << inputFile << "\n";
+        return false;
+    }
+    for (int k = 0; k < 3; ++k) {
+        if (supercell[k] <= 0) {
+            std::cerr << "Error: supercell multiples must be positive!\n";
+            return false;
+        }
+    }
+    std::vector<std::pair<std::string, std::string>> substitutions;
+    if (!substitute.empty() && !parseSubstitutions(substitute, substitutions)) {
+        std::cerr << "Error: --substitute expects host:dopant pairs, e.g. Na:K,Cl:Br\n";
+        return false;
+    }
+    if (!vacancies && substitutions.empty()) {
+        std::cerr << "Error: nothing to generate, give --substitute or drop --no-vacancies!\n";
+        return false;
+    }
+    if (symprec <= 0) {
+        std::cerr << "Error: symprec must be positive!!!\n";
+        return false;
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  poscar_defects [options]\n\n"
+                 "Options:\n"
+                 "  --input      host POSCAR file name (default: POSCAR)\n"
+                 "  --supercell  supercell multiples along a, b, c (default: 1 1 1)\n"
+                 "  --substitute host:dopant pairs for substitutions, e.g. Na:K,Cl:Br (default: none)\n"
+                 "  --no-vacancies do not write vacancy structures\n"
+                 "  --symprec    symmetry tolerance (spglib symprec) (default: 1e-5)\n"
+                 "  --output-prefix prefix of written structures (default: POSCAR_defect)\n"
+                 "  --threads    number of worker threads (default: all cores)\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
+                 "  --help       show this help message\n\n"
+                 "Example:\n"
+                 "  poscar_defects --input POSCAR --supercell 2 2 2 --substitute Na:K\n";
+}
+
+struct DefectJob {
+    std::string name;
+    size_t site;
+    std::string dopant;  // empty for a vacancy
+};
+
+int main(int argc, char* argv[]) {
+    std::string inputFile{"POSCAR"};
+    int supercell[3] = {1, 1, 1};
+    std::string substitute;
+    bool vacancies{true};
+    double symprec{1e-5};
+    std::string outputPrefix{"POSCAR_defect"};
+    int threads{0};
+
+    if (!readInput(argc, argv, inputFile, supercell, substitute, vacancies, symprec, outputPrefix, threads))
+        return 1;
+
+    if (!validateInput(inputFile, supercell, substitute, vacancies, symprec))
+        return 1;
+
+    std::vector<std::pair<std::string, std::string>> substitutions;
+    if (!substitute.empty())
+        parseSubstitutions(substitute, substitutions);
+
+    POSCAR parent;
+    if (!parent.readPOSCAR(inputFile)) {
+        std::cerr << "Error: reading POSCAR file " << inputFile << "\n";
+        return 1;
+    }
+
+    POSCAR host = makeSupercell(parent, supercell[0], supercell[1], supercell[2]);
+    std::vector<std::string> species = atomSpecies(host);
+
+    auto dataset = analyzeSymmetry(host, symprec);
+    if (!dataset) {
+        std::cerr << "Error: symmetry analysis failed.\n";
+        return 1;
+    }
+    std::vector<int> equivalent(dataset->equivalent_atoms, dataset->equivalent_atoms + dataset->n_atoms);
+    std::vector<DefectSite> sites = inequivalentSites(species, equivalent);
+
+    for (const auto& [el, dopant] : substitutions) {
+        bool found = false;
+        for (const auto& s : species)
+            found = found || s == el;
+        if (!found)
+            std::cerr << "Warning: element " << el << " not found in " << inputFile << ", " << el << ":" << dopant
+                      << " is skipped.\n";
+    }
+
+    std::vector<DefectJob> jobs;
+    for (size_t s = 0; s < sites.size(); ++s) {
+        const std::string label = sites[s].element + "_" + std::to_string(s + 1);
+        if (vacancies)
+            jobs.push_back({"V_" + label, s, ""});
+        for (const auto& [el, dopant] : substitutions)
+            if (el == sites[s].element)
+                jobs.push_back({dopant + "_" + label, s, dopant});
+    }
+
+    std::vector<char> written(jobs.size(), 0);
+    {
+        ScopedTimer phase("write_defects", jobs.size());
+        parallelFor(jobs.size(), threads, [&](size_t j) {
+            const DefectJob& job = jobs[j];
+            const int atom = sites[job.site].atom;
+            std::string comment = parent.comment + " " + job.name;
+            POSCAR out = job.dopant.empty() ? makeVacancy(host, atom, comment)
+                                            : makeSubstitution(host, atom, job.dopant, comment);
+            written[j] = out.writePOSCAR(outputPrefix + "_" + job.name);
+        });
+    }
+    const size_t n_written = std::count(written.begin(), written.end(), 1);
+
+    std::ofstream summary(outputPrefix + "_summary.txt");
+    summary << "# structure  atom  element  wyckoff  multiplicity\n";
+    for (size_t j = 0; j < jobs.size(); ++j) {
+        if (!written[j])
+            continue;
+        const DefectJob& job = jobs[j];
+        const DefectSite& site = sites[job.site];
+        summary << outputPrefix << "_" << job.name << " " << site.atom + 1 << " " << site.element << " "
+                << static_cast<char>('a' + dataset->wyckoffs[site.atom]) << " " << site.multiplicity << "\n";
+    }
+    summary.close();
+
+    std::cout << "Space group: " << dataset->international_symbol << " (" << dataset->spacegroup_number << ")\n";
+    std::cout << "Atoms: " << host.total_atoms << ", inequivalent sites: " << sites.size() << "\n";
+    std::cout << "Structures written: " << n_written << "\n";
+    if (!summary) {
+        std::cerr << "Error: failed to write " << outputPrefix << "_summary.txt\n";
+        return 1;
+    }
+    std::cout << "Summary written to: " << outputPrefix << "_summary.txt\n";
+
+    if (n_written != jobs.size()) {
+        std::cerr << "Error: " << jobs.size() - n_written << " structures could not be written\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,318 @@
+#include "poscar_enumerate.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "derivative_enumeration.h"
+#include "instrumentation.h"
+#include "parallel_utility.h"
+#include "poscar_file.h"
+#include "structure_utility.h"
+#include "symmetry.h"
+
+bool readInput(int argc, char* argv[], std::string& inputFile, int supercell[3], std::string& site,
+               std::string& substitute, int& countMin, int& countMax, double& symprec, std::string& outputPrefix,
+               int& maxOutput, long long& maxRaw, int& threads) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--input") {
+            if (i + 1 >= argc)
+                return false;
+            inputFile = argv[++i];
+        } else if (arg == "--supercell") {
+            if (i + 3 >= argc)
+                return false;
+            try {
+                for (int k = 0; k < 3; ++k)
+                    supercell[k] = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--site") {
+            if (i + 1 >= argc)
+                return false;
+            site = argv[++i];
+        } else if (arg == "--substitute") {
+            if (i + 1 >= argc)
+                return false;
+            substitute = argv[++i];
+        } else if (arg == "--count") {
+            // Either a single number or a range "min-max"
+            if (i + 1 >= argc)
+                return false;
+            std::string value = argv[++i];
+            try {
+                size_t dash = value.find('-');
+                if (dash == std::string::npos) {
+                    countMin = countMax = std::stoi(value);
+                } else {
+                    countMin = std::stoi(value.substr(0, dash));
+                    countMax = std::stoi(value.substr(dash + 1));
+                }
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--symprec") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                symprec = std::stod(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--output-prefix") {
+            if (i + 1 >= argc)
+                return false;
+            outputPrefix = argv[++i];
+        } else if (arg == "--max-output") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                maxOutput = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--max-raw") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                maxRaw = std::stoll(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--threads") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                threads = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+bool validateInput(const std::string& inputFile, const int supercell[3], const std::string& site,
+                   const std::string& substitute, int countMin, int countMax, double symprec, long long maxRaw) {
+    std::ifstream file(inputFile);
+    if (!file) {
+        std::cerr << "Error: cannot open file " << inputFile << "\n";
+        return false;
+    }
+    for (int k = 0; k < 3; ++k) {
+        if (supercell[k] <= 0) {
+            std::cerr << "Error: supercell multiples must be positive!\n";
+            return false;
+        }
+    }
+    if (site.empty() || substitute.empty()) {
+        std::cerr << "Error: --site and --substitute are required!\n";
+        return false;
+    }
+    if (countMin < 0 || countMax < countMin) {
+        std::cerr << "Error: invalid --count range!\n";
+        return false;
+    }
+    if (symprec <= 0) {
+        std::cerr << "Error: symprec must be positive!!!\n";
+        return false;
+    }
+    if (maxRaw <= 0) {
+        std::cerr << "Error: --max-raw must be positive!\n";
+        return false;
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  poscar_enumerate [options]\n\n"
+                 "Options:\n"
+                 "  --input      parent POSCAR file name (default: POSCAR)\n"
+                 "  --supercell  supercell multiples along a, b, c (default: 1 1 1)\n"
+                 "  --site       element whose sites are decorated (required)\n"
+                 "  --substitute substituting element, or Vac for vacancies (required)\n"
+                 "  --count      number of substituted sites, single value or range min-max (default: 1)\n"
+                 "  --symprec    symmetry tolerance (spglib symprec) (default: 1e-5)\n"
+                 "  --output-prefix prefix of written structures (default: POSCAR_enum)\n"
+                 "  --max-output maximal number of structures written, 0 only counts (default: 1000)\n"
+                 "  --max-raw    refuse to enumerate more than this many raw configurations per count "
+                 "(default: 10000000000)\n"
+                 "  --threads    number of worker threads (default: all cores)\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
+                 "  --help       show this help message\n\n"
+                 "Example:\n"
+                 "  poscar_enumerate --input POSCAR --supercell 2 2 2 --site Au --substitute Cu --count 1-4\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputFile{"POSCAR"};
+    int supercell[3] = {1, 1, 1};
+    std::string site;
+    std::string substitute;
+    int countMin{1};
+    int countMax{1};
+    double symprec{1e-5};
+    std::string outputPrefix{"POSCAR_enum"};
+    int maxOutput{1000};
+    long long maxRaw{10000000000LL};
+    int threads{0};
+
+    if (!readInput(argc, argv, inputFile, supercell, site, substitute, countMin, countMax, symprec, outputPrefix,
+                   maxOutput, maxRaw, threads))
+        return 1;
+
+    if (!validateInput(inputFile, supercell, site, substitute, countMin, countMax, symprec, maxRaw))
+        return 1;
+
+    POSCAR parent;
+    if (!parent.readPOSCAR(inputFile)) {
+        std::cerr << "Error: reading POSCAR file " << inputFile << "\n";
+        return 1;
+    }
+
+    POSCAR super = makeSupercell(parent, supercell[0], supercell[1], supercell[2]);
+    std::vector<std::string> species = atomSpecies(super);
+
+    std::vector<int> active;
+    for (int i = 0; i < super.total_atoms; ++i)
+        if (species[i] == site)
+            active.push_back(i);
+
+    if (active.empty()) {
+        std::cerr << "Error: element " << site << " not found in " << inputFile << "\n";
+        return 1;
+    }
+    if (static_cast<int>(active.size()) > kMaxActiveSites) {
+        std::cerr << "Error: " << active.size() << " active sites, at most " << kMaxActiveSites
+                  << " are supported.\n";
+        return 1;
+    }
+    const int n_sites = static_cast<int>(active.size());
+    countMax = std::min(countMax, n_sites);
+    // Every raw configuration is tested against the whole group, so refuse hopeless runs up front
+    for (int k = countMin; k <= countMax; ++k) {
+        if (binomial(n_sites, k) > static_cast<std::uint64_t>(maxRaw)) {
+            std::cerr << "Error: n = " << k << " has " << binomial(n_sites, k)
+                      << " raw configurations, more than --max-raw " << maxRaw << "\n";
+            return 1;
+        }
+    }
+
+    auto dataset = analyzeSymmetry(super, symprec);
+    if (!dataset) {
+        std::cerr << "Error: failed to analyze symmetry.\n";
+        return 1;
+    }
+
+    const double siteTolerance = std::max(3.0 * symprec, 1e-3);
+    auto perms = activeSitePermutations(super, dataset->rotations, dataset->translations, dataset->n_operations,
+                                        active, siteTolerance);
+    OccupationCanonicalizer canonicalizer(perms, n_sites);
+
+    std::cout << "Supercell atoms: " << super.total_atoms << ", active sites: " << n_sites
+              << ", symmetry permutations: " << canonicalizer.groupOrder() << "\n";
+
+    std::vector<std::string> elementOrder = super.elements;
+    elementOrder.push_back(substitute);
+
+    std::ofstream summary(outputPrefix + "_summary.txt");
+    if (!summary) {
+        std::cerr << "Error: cannot create file " << outputPrefix << "_summary.txt\n";
+        return 1;
+    }
+    summary << "# file  n_substituted  degeneracy  occupation\n";
+
+    int written = 0;
+    int failed = 0;
+    for (int k = countMin; k <= countMax; ++k) {
+        std::vector<EnumeratedConfiguration> configs;
+        {
+            ScopedTimer phase("enumerate", n_sites);
+            configs = enumerateInequivalent(n_sites, k, canonicalizer, threads);
+        }
+
+        std::cout << "n = " << k << ": " << binomial(n_sites, k) << " configurations, " << configs.size()
+                  << " inequivalent\n";
+
+        size_t n_write = std::min<size_t>(configs.size(), maxOutput > written ? maxOutput - written : 0);
+        std::vector<std::string> names(n_write);
+        std::vector<char> ok(n_write, 0);
+
+        parallelFor(n_write, threads, [&](size_t c) {
+            names[c] = outputPrefix + std::to_string(written + c + 1);
+
+            std::vector<std::string> decorated;
+            std::vector<Atom> coords;
+            std::vector<std::uint8_t> flags;
+            decorated.reserve(super.total_atoms);
+            coords.reserve(super.total_atoms);
+
+            std::vector<char> substituted(super.total_atoms, 0);
+            for (int b = 0; b < n_sites; ++b)
+                if (configs[c].occupation & (Occupation{1} << b))
+                    substituted[active[b]] = 1;
+
+            for (int i = 0; i < super.total_atoms; ++i) {
+                if (substituted[i] && substitute == "Vac")
+                    continue;
+                decorated.push_back(substituted[i] ? substitute : species[i]);
+                coords.push_back(super.coordinates[i]);
+                if (super.selective_dynamics)
+                    flags.push_back(super.selective_flags[i]);
+            }
+
+            std::string comment = super.comment + " enum n=" + std::to_string(k) + " degeneracy " +
+                                  std::to_string(configs[c].degeneracy);
+            POSCAR out = buildPOSCAR(comment, super.lattice, decorated, coords, elementOrder, flags);
+            ok[c] = out.writePOSCAR(names[c]);
+        });
+
+        for (size_t c = 0; c < configs.size(); ++c) {
+            std::string bits(n_sites, '0');
+            for (int b = 0; b < n_sites; ++b)
+                if (configs[c].occupation & (Occupation{1} << b))
+                    bits[b] = '1';
+            summary << (c < n_write && ok[c] ? names[c] : std::string("-")) << " " << k << " "
+                    << configs[c].degeneracy << " " << bits << "\n";
+        }
+        written += static_cast<int>(n_write);
+        failed += static_cast<int>(n_write) - static_cast<int>(std::count(ok.begin(), ok.end(), 1));
+    }
+    summary.close();
+
+    std::cout << "Structures written: " << written - failed << "\n";
+    if (!summary) {
+        std::cerr << "Error: failed to write " << outputPrefix << "_summary.txt\n";
+        return 1;
+    }
+    std::cout << "Summary written to: " << outputPrefix << "_summary.txt\n";
+
+    if (failed > 0) {
+        std::cerr << "Error: " << failed << " structures could not be written\n";
+        return 1;
+    }
+    return 0;
+}
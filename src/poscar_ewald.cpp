@@ -0,0 +1,202 @@
+#include "poscar_ewald.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ewald.h"
+#include "instrumentation.h"
+#include "parallel_utility.h"
+#include "poscar_file.h"
+
+namespace fs = std::filesystem;
+
+bool readInput(int argc, char* argv[], std::string& inputDir, std::string& prefix, std::string& outputFile,
+               std::map<std::string, double>& oxidationStates, EwaldOptions& options, int& threads) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--input-dir") {
+            if (i + 1 >= argc)
+                return false;
+            inputDir = argv[++i];
+        } else if (arg == "--prefix") {
+            if (i + 1 >= argc)
+                return false;
+            prefix = argv[++i];
+        } else if (arg == "--output") {
+            if (i + 1 >= argc)
+                return false;
+            outputFile = argv[++i];
+        } else if (arg == "--oxidation") {
+            if (i + 1 >= argc)
+                return false;
+            if (!parseOxidationStates(argv[++i], oxidationStates)) {
+                std::cerr << "Error: oxidation states must look like Na:1,Cl:-1\n";
+                return false;
+            }
+        } else if (arg == "--accuracy" || arg == "--alpha") {
+            if (i + 1 >= argc)
+                return false;
+            double value;
+            try {
+                value = std::stod(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+            if (arg == "--accuracy")
+                options.accuracy = value;
+            else
+                options.alpha = value;
+        } else if (arg == "--threads") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                threads = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+bool validateInput(const std::string& inputDir, const std::map<std::string, double>& oxidationStates,
+                   const EwaldOptions& options) {
+    if (!fs::is_directory(inputDir)) {
+        std::cerr << "Error: " << inputDir << " is not a directory\n";
+        return false;
+    }
+    if (oxidationStates.empty()) {
+        std::cerr << "Error: --oxidation is required!\n";
+        return false;
+    }
+    if (options.accuracy <= 0 || options.accuracy >= 1) {
+        std::cerr << "Error: accuracy must be between 0 and 1!\n";
+        return false;
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  poscar_ewald [options]\n\n"
+                 "Options:\n"
+                 "  --input-dir  directory with candidate POSCAR files (default: .)\n"
+                 "  --prefix     only consider files whose name starts with this prefix (default: POSCAR)\n"
+                 "  --oxidation  oxidation state of every element, e.g. Na:1,Cl:-1 (required)\n"
+                 "  --output     ranking of the structures by Ewald energy (default: ewald_ranking.txt)\n"
+                 "  --accuracy   relative accuracy of the Ewald sums (default: 1e-8)\n"
+                 "  --alpha      Ewald splitting parameter in 1/Angstrom (default: automatic)\n"
+                 "  --threads    number of worker threads (default: all cores)\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
+                 "  --help       show this help message\n\n"
+                 "Example:\n"
+                 "  poscar_ewald --input-dir candidates --prefix POSCAR_enum --oxidation Li:1,Co:3,O:-2\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputDir{"."};
+    std::string prefix{"POSCAR"};
+    std::string outputFile{"ewald_ranking.txt"};
+    std::map<std::string, double> oxidationStates;
+    EwaldOptions options;
+    int threads{0};
+
+    if (!readInput(argc, argv, inputDir, prefix, outputFile, oxidationStates, options, threads))
+        return 1;
+
+    if (!validateInput(inputDir, oxidationStates, options))
+        return 1;
+
+    std::vector<std::string> files;
+    for (const auto& entry : fs::directory_iterator(inputDir)) {
+        if (entry.is_regular_file() && entry.path().filename().string().rfind(prefix, 0) == 0)
+            files.push_back(entry.path().string());
+    }
+    std::sort(files.begin(), files.end());
+
+    if (files.empty()) {
+        std::cerr << "Error: no files starting with \"" << prefix << "\" in " << inputDir << "\n";
+        return 1;
+    }
+
+    const size_t n = files.size();
+    std::vector<EwaldEnergy> energies(n);
+    std::vector<int> atoms(n, 0);
+    std::vector<char> valid(n, 0);
+
+    // One structure per thread; each sum runs serially inside
+    options.threads = 1;
+    {
+        ScopedTimer phase("ewald", 0);
+        parallelFor(n, threads, [&](size_t i) {
+            POSCAR poscar;
+            if (!poscar.readPOSCAR(files[i]))
+                return;
+            std::vector<double> charges;
+            if (!atomCharges(poscar, oxidationStates, charges))
+                return;
+            energies[i] = ewaldEnergy(poscar, charges, options);
+            atoms[i] = poscar.total_atoms;
+            valid[i] = 1;
+        });
+    }
+
+    std::vector<size_t> order;
+    for (size_t i = 0; i < n; ++i) {
+        if (valid[i])
+            order.push_back(i);
+        else
+            std::cerr << "Warning: skipping file " << files[i] << "\n";
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return energies[a].total < energies[b].total; });
+
+    std::ofstream out(outputFile);
+    if (!out) {
+        std::cerr << "Error: cannot create file " << outputFile << "\n";
+        return 1;
+    }
+    out << "# rank  file  energy_eV  energy_per_atom_eV  relative_eV\n";
+    out << std::fixed << std::setprecision(6);
+    for (size_t r = 0; r < order.size(); ++r) {
+        const size_t i = order[r];
+        out << r + 1 << " " << files[i] << " " << energies[i].total << " " << energies[i].total / atoms[i] << " "
+            << energies[i].total - energies[order[0]].total << "\n";
+    }
+    out.close();
+    if (!out) {
+        std::cerr << "Error: failed to write " << outputFile << "\n";
+        return 1;
+    }
+
+    std::cout << "Structures ranked: " << order.size() << "\n";
+    if (!order.empty())
+        std::cout << "Lowest energy: " << files[order[0]] << " (" << energies[order[0]].total << " eV)\n";
+    std::cout << "Ranking written to: " << outputFile << "\n";
+
+    return order.size() == n ? 0 : 1;
+}
@@ -1,6 +1,12 @@
 #include "poscar_file.h"
 
+#include "compressed_stream.h"
+#include "coordinate_parser.h"
+#include "instrumentation.h"
+#include "mapped_file.h"
+#include "memory_stream.h"
 #include "random_utility.h"
+#include "text_writer.h"
 
 // Linear algebra
 
@@ -9,30 +15,21 @@
 
 #include <algorithm>
 #include <array>
+#include <cctype>
 #include <cmath>
+#include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <vector>
 
-bool POSCAR::skipLines(std::ifstream& file, int n) {
-    std::string tmp;
-    for (int i = 0; i < n; ++i) {
-        if (!std::getline(file, tmp))
-            return false;
-    }
-    return true;
-}
-
-bool POSCAR::readPOSCARHeader(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file) {
-        std::cerr << "Error: cannot open file " << filename << "\n";
-        return false;
-    }
+// Plain POSCAR files from this size on are read through a memory map with a parallel coordinate parser
+constexpr std::size_t kMappedReadBytes = std::size_t{8} << 20;
 
+bool POSCAR::readPOSCARHeader(std::istream& file) {
     std::string line;
 
     // Reading Line 1: comment
@@ -43,7 +40,12 @@ bool POSCAR::readPOSCARHeader(const std::string& filename) {
     if (!std::getline(file, line))
         return false;
 
-    scale = std::stod(line);
+    try {
+        scale = std::stod(line);
+    } catch (...) {
+        std::cerr << "Error: invalid scaling factor \"" << line << "\"\n";
+        return false;
+    }
     if (scale < 0) {
         std::cerr << "Error: Scaling factor is negative!.\n";
         return false;
@@ -87,29 +89,15 @@ bool POSCAR::readPOSCARHeader(const std::string& filename) {
     return true;
 }
 
-bool POSCAR::readPOSCAROptional(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file) {
-        std::cerr << "Error: cannot open file " << filename << "\n";
-        return false;
-    }
-
+bool POSCAR::readPOSCAROptional(std::istream& file) {
     std::string line;
 
-    // Skip first 7 header lines (already read)
-    if (!skipLines(file, 7))
-        return false;
-
     // Reading Optional: Selective dynamics or Direct/Cartesian
     if (!std::getline(file, line))
         return false;
     if (line[0] == 'S' || line[0] == 's') {
         selective_dynamics = true;
 
-        // For now selective dynamics is NOT supported!!! Remove if implemented with this keyword!!!
-        std::cerr << "Error: selective dynamics is NOT supported yet!\n";
-        return false;
-
         // Reading next line (Direct/Cartesian) if Selective dynamic is present
         if (!std::getline(file, line))
             return false;
@@ -125,28 +113,13 @@ bool POSCAR::readPOSCAROptional(const std::string& filename) {
     return true;
 }
 
-bool POSCAR::readPOSCARCoordinates(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file) {
-        std::cerr << "Error: cannot open file " << filename << "\n";
-        return false;
-    }
-
+bool POSCAR::readPOSCARCoordinates(std::istream& file) {
     std::string line;
 
-    // Skip first 7 header lines (already read)
-    if (!skipLines(file, 7))
-        return false;
-
-    // Skip optional line for Selective dynamics if present
-    if (selective_dynamics) {
-        if (!std::getline(file, line))
-            return false;
-    }
-
-    // Skip Direct/Cartesian line (already validated)
-    if (!std::getline(file, line))
-        return false;
+    if (selective_dynamics)
+        selective_flags.assign(coordinates.size(), kMoveAll);
+    else
+        selective_flags.clear();
 
     // Now read all coordinates
     for (size_t i = 0; i < coordinates.size(); ++i) {
@@ -160,6 +133,21 @@ bool POSCAR::readPOSCARCoordinates(const std::string& filename) {
             std::cerr << "Error: failed to parse coordinates for atom " << i << "\n";
             return false;
         }
+
+        // Selective dynamics: three T/F flags after the coordinates
+        if (selective_dynamics) {
+            std::uint8_t flags = 0;
+            for (std::uint8_t bit : {kMoveX, kMoveY, kMoveZ}) {
+                std::string flag;
+                if (!(iss >> flag) || (flag[0] != 'T' && flag[0] != 't' && flag[0] != 'F' && flag[0] != 'f')) {
+                    std::cerr << "Error: failed to parse selective dynamics flags for atom " << i << "\n";
+                    return false;
+                }
+                if (flag[0] == 'T' || flag[0] == 't')
+                    flags |= bit;
+            }
+            selective_flags[i] = flags;
+        }
     }
 
     return true;
@@ -186,40 +174,154 @@ void POSCAR::setScaleTo1() {
     scale = 1.0;
 }
 
-bool POSCAR::readPOSCAR(const std::string& filename) {
-    if (!readPOSCARHeader(filename)) {
-        std::cerr << "Error: reading POSCAR header from " << filename << "\n";
-        return false;
+void POSCAR::updateSpecies() {
+    species.clear();
+    atom_types.clear();
+    atom_types.reserve(coordinates.size());
+    for (size_t i = 0; i < elements.size() && i < num_atoms.size(); ++i) {
+        // A handful of species, so a linear search beats hashing
+        auto it = std::find(species.begin(), species.end(), elements[i]);
+        if (it == species.end())
+            it = species.insert(species.end(), elements[i]);
+        atom_types.insert(atom_types.end(), num_atoms[i], static_cast<std::uint16_t>(it - species.begin()));
     }
+}
 
-    // Compute total number of atoms
+bool POSCAR::speciesConsistent() const {
+    size_t total = 0;
     for (int count : num_atoms)
-        total_atoms += count;
+        total += count;
+    return atom_types.size() == total && total == coordinates.size() && (total == 0 || !species.empty());
+}
+
+bool POSCAR::readPOSCARPreamble(std::istream& in, const std::string& source) {
+    if (!readPOSCARHeader(in)) {
+        std::cerr << "Error: reading POSCAR header from " << source << "\n";
+        return false;
+    }
+
+    // Compute total number of atoms; negative counts or a total past int come from a damaged file
+    long long total = 0;
+    for (int count : num_atoms) {
+        total += count;
+        if (count < 0 || total > std::numeric_limits<int>::max()) {
+            std::cerr << "Error: invalid atom counts in POSCAR " << source << "\n";
+            return false;
+        }
+    }
+    total_atoms = static_cast<int>(total);
 
     coordinates.resize(total_atoms);
 
-    if (!readPOSCAROptional(filename)) {
-        std::cerr << "Error reading POSCAR structural keywords from " << filename << "\n";
+    if (!readPOSCAROptional(in)) {
+        std::cerr << "Error reading POSCAR structural keywords from " << source << "\n";
         return false;
     }
+    return true;
+}
+
+bool POSCAR::readPOSCAR(std::istream& in, const std::string& source) {
+    if (!readPOSCARPreamble(in, source))
+        return false;
 
-    if (!readPOSCARCoordinates(filename)) {
-        std::cerr << "Error reading POSCAR coordinates from " << filename << "\n";
+    if (!readPOSCARCoordinates(in)) {
+        std::cerr << "Error reading POSCAR coordinates from " << source << "\n";
         return false;
     }
 
     // To avoid future issues
     setScaleTo1();
+    updateSpecies();
 
     return true;
 }
 
-bool POSCAR::writeCtrlsFile(const std::string& filenameOut) {
-    if (is_direct) {
-        std::cerr << "Error: Only POSCAR in cartesian coordinates can be writen to ctrls format!\n";
+bool POSCAR::readHeader(const std::string& filename) {
+    InputFileStream file(filename);
+    if (!file) {
+        std::cerr << "Error: cannot open file " << filename << "\n";
+        return false;
+    }
+    if (!readPOSCARHeader(file))
+        return false;
+
+    total_atoms = 0;
+    for (int count : num_atoms)
+        total_atoms += count;
+    coordinates.clear();
+    selective_flags.clear();
+    species.clear();
+    atom_types.clear();
+    setScaleTo1();
+
+    return true;
+}
+
+bool POSCAR::readPOSCARMapped(const char* data, std::size_t size, const std::string& source) {
+    MemoryInputBuffer buffer;
+    buffer.reset(data, size);
+    std::istream in(&buffer);
+    if (!readPOSCARPreamble(in, source))
         return false;
+
+    if (selective_dynamics)
+        selective_flags.assign(coordinates.size(), kMoveAll);
+    else
+        selective_flags.clear();
+
+    {
+        ScopedTimer timer("parse_coordinates", coordinates.size(), size - buffer.position());
+        if (!parseCoordinateBlock(data + buffer.position(), data + size, coordinates.size(), coordinates.data(),
+                                  selective_dynamics ? selective_flags.data() : nullptr)) {
+            std::cerr << "Error reading POSCAR coordinates from " << source << "\n";
+            return false;
+        }
+    }
+
+    setScaleTo1();
+    updateSpecies();
+
+    return true;
+}
+
+bool POSCAR::readPOSCAR(const std::string& filename) {
+    ScopedTimer timer("read_poscar");
+
+    std::error_code ec;
+    const auto bytes = std::filesystem::file_size(filename, ec);
+
+    // Large plain files are mapped and their coordinate block is parsed on all cores
+    bool mapped_read = false;
+    if (!ec && bytes >= kMappedReadBytes) {
+        MappedFile mapped(filename);
+        const auto* magic = reinterpret_cast<const unsigned char*>(mapped.data());
+        if (mapped && compressionFromMagic(magic, std::min<std::size_t>(mapped.size(), 6)) == Compression::None) {
+            if (!readPOSCARMapped(mapped.data(), mapped.size(), filename))
+                return false;
+            mapped_read = true;
+        }
     }
 
+    if (!mapped_read) {
+        InputFileStream file(filename);
+        if (!file) {
+            std::cerr << "Error: cannot open file " << filename << "\n";
+            std::cerr << "Error: reading POSCAR header from " << filename << "\n";
+            return false;
+        }
+        if (!readPOSCAR(file, filename))
+            return false;
+    }
+
+    if (timer.active()) {
+        timer.setAtoms(coordinates.size());
+        timer.setBytes(ec ? 0 : static_cast<std::size_t>(bytes));
+    }
+
+    return true;
+}
+
+bool POSCAR::writeCtrlsFile(const std::string& filenameOut) {
     std::ifstream fileTest(filenameOut);
     if (fileTest.good()) {
         std::cerr << "Warning: file \"" << filenameOut << "\" already exists and will be overwritten.\n";
@@ -227,48 +329,206 @@ bool POSCAR::writeCtrlsFile(const std::string& filenameOut) {
 
     fileTest.close();
 
-    std::ofstream file(filenameOut);
+    ScopedTimer timer("write_ctrls", coordinates.size());
+
+    OutputFileStream file(filenameOut);
     if (!file) {
         std::cerr << "Error: cannot create file " << filenameOut << "\n";
         return false;
     }
 
+    TextWriter out(file);
+    writeCtrls(out);
+    if (!out.flush() || !file.close()) {
+        std::cerr << "Error: failed writing to " << filenameOut << "\n";
+        return false;
+    }
+
+    if (timer.active())
+        timer.setBytes(out.bytesWritten());
+
+    return true;
+}
+
+void POSCAR::writeCtrls(TextWriter& out) const {
     // Transform units from angstroms to Bohr
     const double ang_to_bohr = 1.889726125;
 
     // Writing lattice information
 
-    file << "STRUC    ALAT=" << scale * ang_to_bohr << "\n";
+    out.text("STRUC    ALAT=").fixed(scale * ang_to_bohr, 10).character('\n');
 
-    file << "         PLAT=";
+    out.text("         PLAT=");
     for (int i = 0; i < 3; ++i) {
         if (i > 0) {
-            file << "               ";
+            out.text("               ");
         } else {
-            file << " ";  // Mezera pro první řádek hned za "PLAT="
+            out.character(' ');  // Mezera pro první řádek hned za "PLAT="
         }
-        file << std::fixed << std::setprecision(10) << lattice[i][0] << " " << lattice[i][1] << " " << lattice[i][2]
-             << " \n";
+        out.fixed(lattice[i][0], 10).character(' ').fixed(lattice[i][1], 10).character(' ');
+        out.fixed(lattice[i][2], 10).text(" \n");
     }
 
-    // Writing atomic position and element
-    file << "SITE \n";
+    // Writing atomic position and element. POS is in units of ALAT (1 Angstrom here); fractional
+    // coordinates are multiplied by the lattice on the fly
+    out.text("SITE \n");
     int atom_idx = 0;
 
     for (size_t i = 0; i < elements.size(); ++i) {
         for (int j = 0; j < num_atoms[i]; ++j) {
-            if (atom_idx >= total_atoms)
+            if (atom_idx >= static_cast<int>(coordinates.size()))
                 break;
 
-            file << "      ATOM=" << std::left << std::setw(3) << elements[i] << " " << " POS=" << std::fixed
-                 << std::setprecision(10) << coordinates[atom_idx].x * ang_to_bohr << " "
-                 << coordinates[atom_idx].y * ang_to_bohr << " " << coordinates[atom_idx].z * ang_to_bohr << "\n";
+            const Atom& a = coordinates[atom_idx];
+            double pos[3] = {a.x, a.y, a.z};
+            if (is_direct)
+                for (int k = 0; k < 3; ++k)
+                    pos[k] = a.x * lattice[0][k] + a.y * lattice[1][k] + a.z * lattice[2][k];
+
+            out.text("      ATOM=").text(elements[i]);
+            for (size_t pad = elements[i].size(); pad < 3; ++pad)
+                out.character(' ');
+            out.text("  POS=").fixed(pos[0], 10).character(' ').fixed(pos[1], 10).character(' ');
+            out.fixed(pos[2], 10).character('\n');
 
             atom_idx++;
         }
     }
+}
+
+bool POSCAR::readCtrlsFile(const std::string& filename) {
+    ScopedTimer timer("read_ctrls");
+
+    InputFileStream file(filename);
+    if (!file) {
+        std::cerr << "Error: cannot open file " << filename << "\n";
+        return false;
+    }
+    if (!readCtrls(file, filename))
+        return false;
+
+    if (timer.active())
+        timer.setAtoms(coordinates.size());
+
+    return true;
+}
+
+bool POSCAR::readCtrls(std::istream& file, const std::string& source) {
+
+    // Split the file into categories: a category starts with a token in the first column and continues
+    // on indented lines. '=' is padded so "POS=1 2 3" and "POS= 1 2 3" tokenize alike.
+    std::string line, category, struc, site;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty() || line[0] == '#' || line[0] == '%')
+            continue;
+        if (!std::isspace(static_cast<unsigned char>(line[0]))) {
+            std::istringstream iss(line);
+            iss >> category;
+            line = line.substr(category.size());
+        }
+        for (size_t p = line.find('='); p != std::string::npos; p = line.find('=', p + 2))
+            line.replace(p, 1, "= ");
+        if (category == "STRUC")
+            struc += line + " ";
+        else if (category == "SITE")
+            site += line + " ";
+    }
+
+    const double ang_to_bohr = 1.889726125;
+    double alat = 0.0;
+    bool have_plat = false;
+    std::istringstream struc_tokens(struc);
+    std::string token;
+    while (struc_tokens >> token) {
+        if (token == "ALAT=") {
+            if (!(struc_tokens >> alat))
+                break;
+        } else if (token == "PLAT=") {
+            have_plat = true;
+            for (int i = 0; i < 3; ++i)
+                for (int j = 0; j < 3; ++j)
+                    have_plat = have_plat && static_cast<bool>(struc_tokens >> lattice[i][j]);
+        }
+    }
+    if (alat <= 0.0 || !have_plat) {
+        std::cerr << "Error: STRUC with numeric ALAT= and PLAT= not found in " << source << "\n";
+        return false;
+    }
+    const double unit = alat / ang_to_bohr;  // Angstrom per ALAT
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            lattice[i][j] *= unit;
+
+    // Sites in file order; POS is Cartesian in units of ALAT, XPOS fractional
+    std::vector<std::string> site_species;
+    std::vector<Atom> positions;
+    std::vector<char> fractional;
+    std::istringstream site_tokens(site);
+    while (site_tokens >> token) {
+        if (token == "ATOM=") {
+            std::string name;
+            if (!(site_tokens >> name))
+                break;
+            site_species.push_back(name);
+            positions.push_back({0.0, 0.0, 0.0});
+            fractional.push_back(0);
+        } else if ((token == "POS=" || token == "XPOS=") && !site_species.empty()) {
+            Atom& a = positions.back();
+            if (!(site_tokens >> a.x >> a.y >> a.z)) {
+                std::cerr << "Error: failed to parse " << token << " of site " << site_species.size() << "\n";
+                return false;
+            }
+            fractional.back() = token == "XPOS=";
+        }
+    }
+    if (site_species.empty()) {
+        std::cerr << "Error: no SITE entries in " << source << "\n";
+        return false;
+    }
+
+    // Cartesian Angstrom unless every site was given as XPOS
+    const bool all_fractional = std::all_of(fractional.begin(), fractional.end(), [](char f) { return f != 0; });
+    for (size_t i = 0; i < positions.size(); ++i) {
+        Atom& a = positions[i];
+        if (all_fractional)
+            continue;
+        if (fractional[i]) {
+            const double f[3] = {a.x, a.y, a.z};
+            a.x = f[0] * lattice[0][0] + f[1] * lattice[1][0] + f[2] * lattice[2][0];
+            a.y = f[0] * lattice[0][1] + f[1] * lattice[1][1] + f[2] * lattice[2][1];
+            a.z = f[0] * lattice[0][2] + f[1] * lattice[1][2] + f[2] * lattice[2][2];
+        } else {
+            a.x *= unit;
+            a.y *= unit;
+            a.z *= unit;
+        }
+    }
 
-    file.close();
+    // Group sites by species in order of first appearance
+    comment = std::filesystem::path(source).filename().string();
+    scale = 1.0;
+    is_direct = all_fractional;
+    selective_dynamics = false;
+    selective_flags.clear();
+    elements.clear();
+    num_atoms.clear();
+    coordinates.clear();
+    for (size_t i = 0; i < site_species.size(); ++i) {
+        if (std::find(elements.begin(), elements.end(), site_species[i]) != elements.end())
+            continue;
+        elements.push_back(site_species[i]);
+        int count = 0;
+        for (size_t j = i; j < site_species.size(); ++j)
+            if (site_species[j] == site_species[i]) {
+                coordinates.push_back(positions[j]);
+                count++;
+            }
+        num_atoms.push_back(count);
+    }
+    total_atoms = static_cast<int>(coordinates.size());
+    updateSpecies();
 
     return true;
 }
@@ -279,56 +539,70 @@ bool POSCAR::writePOSCAR(const std::string& filenameOut) {
         std::cerr << "Warning: file \"" << filenameOut << "\" already exists and will be overwritten.\n";
     }
 
-    std::ofstream file(filenameOut);
+    ScopedTimer timer("write_poscar", coordinates.size());
+
+    OutputFileStream file(filenameOut);
     if (!file) {
         std::cerr << "Error: cannot create file " << filenameOut << "\n";
         return false;
     }
 
+    TextWriter out(file);
+    writePOSCAR(out);
+    if (!out.flush() || !file.close()) {
+        std::cerr << "Error: failed writing to " << filenameOut << "\n";
+        return false;
+    }
+
+    if (timer.active())
+        timer.setBytes(out.bytesWritten());
+
+    return true;
+}
+
+void POSCAR::writePOSCAR(TextWriter& out) const {
     // Writing Line 1: comment
-    file << comment << "\n";
+    out.text(comment).character('\n');
 
     // Writing Line 2: scale
-    file << std::fixed << std::setprecision(10) << scale << "\n";
+    out.fixed(scale, 10).character('\n');
 
     // Writing Lines 3-5: lattice vectors
-    for (int i = 0; i < 3; ++i)
-        file << std::fixed << std::setprecision(10) << lattice[i][0] << " " << lattice[i][1] << " " << lattice[i][2]
-             << "\n";
+    for (int i = 0; i < 3; ++i) {
+        out.fixed(lattice[i][0], 10).character(' ').fixed(lattice[i][1], 10).character(' ');
+        out.fixed(lattice[i][2], 10).character('\n');
+    }
 
     // Writing Line 6: element symbols
     for (size_t i = 0; i < elements.size(); ++i)
-        file << elements[i] << " ";
-    file << "\n";
+        out.text(elements[i]).character(' ');
+    out.character('\n');
 
     // Writing Line 7: number of atoms
     for (size_t i = 0; i < num_atoms.size(); ++i)
-        file << num_atoms[i] << " ";
-    file << "\n";
+        out.integer(num_atoms[i]).character(' ');
+    out.character('\n');
 
     // Writing Optional: selective dynamics
     if (selective_dynamics)
-        file << "Selective Dynamics\n";
+        out.text("Selective Dynamics\n");
 
     // Writing Direct/Cartesian
-    file << (is_direct ? "Direct" : "Cartesian") << "\n";
+    out.text(is_direct ? "Direct\n" : "Cartesian\n");
 
     // Writing Atomic coordinates
-    for (size_t i = 0; i < coordinates.size(); ++i)
-        file << std::fixed << std::setprecision(10) << coordinates[i].x << " " << coordinates[i].y << " "
-             << coordinates[i].z << "\n";
-
-    // TO DO for Selective dynamics: include selective dynamics flags if needed
-
-    file.flush();
-    if (!file) {
-        std::cerr << "Error: failed writing to " << filenameOut << "\n";
-        return false;
+    for (size_t i = 0; i < coordinates.size(); ++i) {
+        out.fixed(coordinates[i].x, 10).character(' ').fixed(coordinates[i].y, 10).character(' ');
+        out.fixed(coordinates[i].z, 10);
+
+        // Selective dynamics flags, atoms without stored flags relax freely
+        if (selective_dynamics) {
+            const std::uint8_t flags = i < selective_flags.size() ? selective_flags[i] : kMoveAll;
+            out.text(flags & kMoveX ? " T" : " F").text(flags & kMoveY ? " T" : " F");
+            out.text(flags & kMoveZ ? " T" : " F");
+        }
+        out.character('\n');
     }
-
-    file.close();
-
-    return true;
 }
 
 void POSCAR::displaceAtom(size_t atom_index, double amplitude) {
@@ -412,6 +686,8 @@ void POSCAR::toDirect() {
     if (is_direct)
         return;
 
+    ScopedTimer timer("to_direct", coordinates.size());
+
     double A[9];
 
     // Copy lattice
@@ -452,6 +728,8 @@ void POSCAR::toCartesian() {
     if (!is_direct)
         return;
 
+    ScopedTimer timer("to_cartesian", coordinates.size());
+
     double A[9];
 
     // Flatten lattice (row-major)
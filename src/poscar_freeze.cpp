@@ -0,0 +1,211 @@
+#include "poscar_freeze.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "instrumentation.h"
+#include "poscar_file.h"
+#include "selective_dynamics.h"
+
+bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outputFile, FreezeRegions& regions) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--input") {
+            if (i + 1 >= argc)
+                return false;
+            inputFile = argv[++i];
+        } else if (arg == "--output") {
+            if (i + 1 >= argc)
+                return false;
+            outputFile = argv[++i];
+        } else if (arg == "--axis") {
+            if (i + 1 >= argc)
+                return false;
+            std::string axis = argv[++i];
+            if (axis == "a")
+                regions.axis = 0;
+            else if (axis == "b")
+                regions.axis = 1;
+            else if (axis == "c")
+                regions.axis = 2;
+            else
+                return false;
+        } else if (arg == "--bottom" || arg == "--top" || arg == "--radius") {
+            if (i + 1 >= argc)
+                return false;
+            double value;
+            try {
+                value = std::stod(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+            if (arg == "--bottom")
+                regions.bottom = value;
+            else if (arg == "--top")
+                regions.top = value;
+            else
+                regions.radius = value;
+        } else if (arg == "--center") {
+            if (i + 3 >= argc)
+                return false;
+            try {
+                for (int k = 0; k < 3; ++k)
+                    regions.center[k] = std::stod(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--center-atom") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                regions.center_atom = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--fix") {
+            if (i + 1 >= argc)
+                return false;
+            std::string axes = argv[++i];
+            regions.fixed = 0;
+            for (char c : axes) {
+                if (c == 'x')
+                    regions.fixed |= kMoveX;
+                else if (c == 'y')
+                    regions.fixed |= kMoveY;
+                else if (c == 'z')
+                    regions.fixed |= kMoveZ;
+                else
+                    return false;
+            }
+        } else if (arg == "--reset") {
+            regions.reset = true;
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+bool validateInput(const std::string& inputFile, const FreezeRegions& regions) {
+    std::ifstream file(inputFile);
+    if (!file) {
+        std::cerr << "Error: cannot open file " << inputFile << "\n";
+        return false;
+    }
+    if (regions.bottom < 0 || regions.top < 0 || regions.radius < 0 || regions.center_atom < 0) {
+        std::cerr << "Error: region sizes and atom index must not be negative!\n";
+        return false;
+    }
+    if (regions.bottom == 0 && regions.top == 0 && regions.radius == 0) {
+        std::cerr << "Error: give at least one of --bottom, --top or --radius!\n";
+        return false;
+    }
+    if (regions.fixed == 0) {
+        std::cerr << "Error: --fix needs at least one of x, y, z!\n";
+        return false;
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  poscar_freeze [options]\n\n"
+                 "Options:\n"
+                 "  --input      POSCAR file name (default: POSCAR)\n"
+                 "  --output     output POSCAR with selective dynamics (default: POSCAR_frozen)\n"
+                 "  --bottom     freeze atoms within this distance of the bottom surface, Angstrom\n"
+                 "  --top        freeze atoms within this distance of the top surface, Angstrom\n"
+                 "  --axis       lattice vector normal to the surfaces: a, b or c (default: c)\n"
+                 "  --radius     freeze atoms farther than this from the centre, Angstrom\n"
+                 "  --center     fractional coordinates of the centre (default: 0 0 0)\n"
+                 "  --center-atom use this atom (1-based) as the centre\n"
+                 "  --fix        coordinates fixed on frozen atoms (default: xyz)\n"
+                 "  --reset      ignore selective dynamics flags of the input\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
+                 "  --help       show this help message\n\n"
+                 "Example:\n"
+                 "  poscar_freeze --input POSCAR_slab1 --bottom 4.0\n"
+                 "  poscar_freeze --input POSCAR_defect --center-atom 17 --radius 6.0\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputFile{"POSCAR"};
+    std::string outputFile{"POSCAR_frozen"};
+    FreezeRegions regions;
+
+    if (!readInput(argc, argv, inputFile, outputFile, regions))
+        return 1;
+
+    if (!validateInput(inputFile, regions))
+        return 1;
+
+    POSCAR poscar;
+    if (!poscar.readPOSCAR(inputFile)) {
+        std::cerr << "Error: reading POSCAR file " << inputFile << "\n";
+        return 1;
+    }
+    if (regions.center_atom > poscar.total_atoms) {
+        std::cerr << "Error: --center-atom exceeds the number of atoms (" << poscar.total_atoms << ")!\n";
+        return 1;
+    }
+    if (regions.reset) {
+        poscar.selective_dynamics = false;
+        poscar.selective_flags.clear();
+    }
+
+    std::vector<int> frozen;
+    {
+        ScopedTimer phase("select_regions", poscar.total_atoms);
+        if (regions.bottom > 0) {
+            std::vector<int> atoms = atomsInSurfaceRegion(poscar, regions.axis, regions.bottom, false);
+            frozen.insert(frozen.end(), atoms.begin(), atoms.end());
+        }
+        if (regions.top > 0) {
+            std::vector<int> atoms = atomsInSurfaceRegion(poscar, regions.axis, regions.top, true);
+            frozen.insert(frozen.end(), atoms.begin(), atoms.end());
+        }
+        if (regions.radius > 0) {
+            double center[3] = {regions.center[0], regions.center[1], regions.center[2]};
+            if (regions.center_atom > 0) {
+                POSCAR direct = poscar;
+                direct.toDirect();
+                const Atom& a = direct.coordinates[regions.center_atom - 1];
+                center[0] = a.x;
+                center[1] = a.y;
+                center[2] = a.z;
+            }
+            std::vector<int> atoms = atomsOutsideSphere(poscar, center, regions.radius);
+            frozen.insert(frozen.end(), atoms.begin(), atoms.end());
+        }
+    }
+
+    freezeAtoms(poscar, frozen, regions.fixed);
+    if (!poscar.writePOSCAR(outputFile))
+        return 1;
+
+    int n_frozen = 0;
+    for (std::uint8_t flags : poscar.selective_flags)
+        n_frozen += flags != kMoveAll;
+    std::cout << "Atoms with fixed coordinates: " << n_frozen << " of " << poscar.total_atoms << "\n";
+    std::cout << "Output written to: " << outputFile << "\n";
+
+    return 0;
+}
@@ -0,0 +1,201 @@
+#include "poscar_index.h"
+
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "instrumentation.h"
+#include "structure_index.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// "Na,Cl" -> {Na, Cl}
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty())
+            items.push_back(item);
+    return items;
+}
+
+// "min:max" with either side optional, e.g. "8:" or ":64"; a single number means exactly that value
+template <typename T, typename Parse>
+bool parseRange(const std::string& text, T& lower, T& upper, Parse parse) {
+    try {
+        size_t colon = text.find(':');
+        if (colon == std::string::npos) {
+            lower = upper = parse(text);
+            return true;
+        }
+        if (colon > 0)
+            lower = parse(text.substr(0, colon));
+        if (colon + 1 < text.size())
+            upper = parse(text.substr(colon + 1));
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+bool readInput(int argc, char* argv[], std::string& inputDir, std::string& prefix, std::string& indexFile,
+               IndexQuery& query, bool& update, bool& hasQuery, int& threads) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--input-dir") {
+            if (i + 1 >= argc)
+                return false;
+            inputDir = argv[++i];
+        } else if (arg == "--prefix") {
+            if (i + 1 >= argc)
+                return false;
+            prefix = argv[++i];
+        } else if (arg == "--index") {
+            if (i + 1 >= argc)
+                return false;
+            indexFile = argv[++i];
+        } else if (arg == "--no-update") {
+            update = false;
+        } else if (arg == "--contains" || arg == "--exclude") {
+            if (i + 1 >= argc)
+                return false;
+            std::vector<std::string> elements = splitList(argv[++i]);
+            auto& target = arg == "--contains" ? query.contains : query.exclude;
+            target.insert(target.end(), elements.begin(), elements.end());
+            hasQuery = true;
+        } else if (arg == "--formula") {
+            if (i + 1 >= argc)
+                return false;
+            if (!parseFormula(argv[++i], query.formula)) {
+                std::cerr << "Error: cannot parse formula \"" << argv[i] << "\"\n";
+                return false;
+            }
+            hasQuery = true;
+        } else if (arg == "--natoms") {
+            if (i + 1 >= argc)
+                return false;
+            if (!parseRange(argv[++i], query.min_atoms, query.max_atoms,
+                            [](const std::string& s) { return std::stoi(s); }))
+                return false;
+            hasQuery = true;
+        } else if (arg == "--volume") {
+            if (i + 1 >= argc)
+                return false;
+            if (!parseRange(argv[++i], query.min_volume, query.max_volume,
+                            [](const std::string& s) { return std::stod(s); }))
+                return false;
+            hasQuery = true;
+        } else if (arg == "--threads") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                threads = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+bool validateInput(const std::string& inputDir, const std::string& indexFile, const IndexQuery& query, bool update) {
+    if (update && !fs::is_directory(inputDir)) {
+        std::cerr << "Error: " << inputDir << " is not a directory\n";
+        return false;
+    }
+    if (!update && !fs::exists(indexFile)) {
+        std::cerr << "Error: index file " << indexFile << " does not exist\n";
+        return false;
+    }
+    if (query.min_atoms > query.max_atoms || query.min_volume > query.max_volume) {
+        std::cerr << "Error: empty atom count or volume range!!!\n";
+        return false;
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  poscar_index [options]\n\n"
+                 "Options:\n"
+                 "  --input-dir  directory searched recursively for POSCAR files (default: .)\n"
+                 "  --prefix     only index files whose name starts with this prefix (default: POSCAR)\n"
+                 "  --index      binary index file, updated for new and modified files (default: structures.idx)\n"
+                 "  --no-update  query the index as it is without scanning the directory\n"
+                 "  --contains   comma separated elements that must all be present, e.g. Li,O\n"
+                 "  --exclude    comma separated elements that must be absent\n"
+                 "  --formula    reduced composition to match, e.g. Fe2O3 also finds Fe4O6\n"
+                 "  --natoms     atom count range min:max, either side may be left out\n"
+                 "  --volume     cell volume range min:max in Angstrom^3\n"
+                 "  --threads    number of worker threads reading headers (default: all cores)\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
+                 "  --help       show this help message\n\n"
+                 "Matching paths are printed to stdout, one per line.\n\n"
+                 "Example:\n"
+                 "  poscar_index --input-dir database --index database.idx\n"
+                 "  poscar_index --index database.idx --no-update --contains Li --exclude Co --natoms :64\n"
+                 "  poscar_index --input-dir database --formula NaCl --volume 100:400\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputDir{"."};
+    std::string prefix{"POSCAR"};
+    std::string indexFile{"structures.idx"};
+    IndexQuery query;
+    bool update = true;
+    bool hasQuery = false;
+    int threads{0};
+
+    if (!readInput(argc, argv, inputDir, prefix, indexFile, query, update, hasQuery, threads))
+        return 1;
+
+    if (!validateInput(inputDir, indexFile, query, update))
+        return 1;
+
+    StructureIndex index;
+    bool loaded = fs::exists(indexFile) && loadStructureIndex(indexFile, index);
+    if (!loaded && !update)
+        return 1;
+
+    if (update) {
+        IndexUpdateStats stats = updateStructureIndex(index, inputDir, prefix, threads);
+        if ((stats.parsed > 0 || stats.removed > 0 || !loaded) && !saveStructureIndex(indexFile, index))
+            return 1;
+        std::cerr << "Indexed " << index.size() << " structures: " << stats.parsed << " read, " << stats.reused
+                  << " unchanged, " << stats.removed << " removed, " << stats.failed << " unreadable\n";
+    }
+
+    if (hasQuery) {
+        std::vector<std::size_t> matches = queryStructureIndex(index, query);
+        for (std::size_t i : matches)
+            std::cout << index.paths[i] << "\n";
+        std::cerr << matches.size() << " of " << index.size() << " structures match\n";
+    }
+
+    return 0;
+}
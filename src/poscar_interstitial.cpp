@@ -0,0 +1,200 @@
+#include "poscar_interstitial.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "instrumentation.h"
+#include "interstitial.h"
+#include "parallel_utility.h"
+#include "poscar_file.h"
+#include "structure_utility.h"
+#include "symmetry.h"
+
+bool readInput(int argc, char* argv[], std::string& inputFile, std::string& element, InterstitialOptions& options,
+               double& symprec, std::string& outputPrefix, int& maxOutput) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--input") {
+            if (i + 1 >= argc)
+                return false;
+            inputFile = argv[++i];
+        } else if (arg == "--element") {
+            if (i + 1 >= argc)
+                return false;
+            element = argv[++i];
+        } else if (arg == "--grid-spacing" || arg == "--min-distance" || arg == "--cluster-radius" ||
+                   arg == "--symprec") {
+            if (i + 1 >= argc)
+                return false;
+            double value;
+            try {
+                value = std::stod(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+            if (arg == "--grid-spacing")
+                options.grid_spacing = value;
+            else if (arg == "--min-distance")
+                options.min_distance = value;
+            else if (arg == "--cluster-radius")
+                options.cluster_radius = value;
+            else
+                symprec = value;
+        } else if (arg == "--output-prefix") {
+            if (i + 1 >= argc)
+                return false;
+            outputPrefix = argv[++i];
+        } else if (arg == "--max-output" || arg == "--threads") {
+            if (i + 1 >= argc)
+                return false;
+            int value;
+            try {
+                value = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+            if (arg == "--max-output")
+                maxOutput = value;
+            else
+                options.threads = value;
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+bool validateInput(const std::string& inputFile, const std::string& element, const InterstitialOptions& options,
+                   double symprec) {
+    std::ifstream file(inputFile);
+    if (!file) {
+        std::cerr << "Error: cannot open file " << inputFile << "\n";
+        return false;
+    }
+    if (element.empty()) {
+        std::cerr << "Error: --element cannot be empty!\n";
+        return false;
+    }
+    if (options.grid_spacing <= 0 || options.cluster_radius <= 0 || options.min_distance < 0) {
+        std::cerr << "Error: grid spacing and cluster radius must be positive, minimal distance non-negative!\n";
+        return false;
+    }
+    if (symprec <= 0) {
+        std::cerr << "Error: symprec must be positive!!!\n";
+        return false;
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  poscar_interstitial [options]\n\n"
+                 "Options:\n"
+                 "  --input      host POSCAR file name (default: POSCAR)\n"
+                 "  --element    element placed on the interstitial site (default: H)\n"
+                 "  --grid-spacing grid spacing in Angstrom (default: 0.2)\n"
+                 "  --min-distance drop sites closer than this to a host atom, Angstrom (default: 1.0)\n"
+                 "  --cluster-radius merge maxima closer than this, Angstrom (default: 0.5)\n"
+                 "  --symprec    symmetry tolerance (spglib symprec) (default: 1e-3)\n"
+                 "  --output-prefix prefix of written structures (default: POSCAR_interstitial)\n"
+                 "  --max-output maximal number of structures written, 0 only lists sites (default: 100)\n"
+                 "  --threads    number of worker threads (default: all cores)\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
+                 "  --help       show this help message\n\n"
+                 "Example:\n"
+                 "  poscar_interstitial --input POSCAR --element Li --grid-spacing 0.1\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputFile{"POSCAR"};
+    std::string element{"H"};
+    InterstitialOptions options;
+    double symprec{1e-3};
+    std::string outputPrefix{"POSCAR_interstitial"};
+    int maxOutput{100};
+
+    if (!readInput(argc, argv, inputFile, element, options, symprec, outputPrefix, maxOutput))
+        return 1;
+
+    if (!validateInput(inputFile, element, options, symprec))
+        return 1;
+
+    POSCAR host;
+    if (!host.readPOSCAR(inputFile)) {
+        std::cerr << "Error: reading POSCAR file " << inputFile << "\n";
+        return 1;
+    }
+    host.toDirect();
+
+    std::vector<InterstitialSite> sites = findInterstitials(host, options);
+
+    auto dataset = analyzeSymmetry(host, symprec);
+    if (dataset) {
+        ScopedTimer phase("interstitial_symmetry", sites.size());
+        sites = symmetryReduceSites(sites, host.lattice, dataset->rotations, dataset->translations,
+                                    dataset->n_operations, options.cluster_radius);
+    } else {
+        std::cerr << "Warning: symmetry analysis failed, sites are not symmetry-reduced.\n";
+    }
+
+    std::vector<std::string> species = atomSpecies(host);
+    species.push_back(element);
+
+    const size_t n_write = std::min<size_t>(sites.size(), static_cast<size_t>(std::max(0, maxOutput)));
+    std::vector<char> written(n_write, 0);
+    parallelFor(n_write, options.threads, [&](size_t s) {
+        std::vector<Atom> coords = host.coordinates;
+        coords.push_back(sites[s].position);
+        std::vector<std::uint8_t> flags;
+        if (host.selective_dynamics) {
+            flags = host.selective_flags;
+            flags.resize(coords.size(), kMoveAll);
+        }
+        std::string comment = host.comment + " + " + element + " interstitial " + std::to_string(s + 1);
+        POSCAR out = buildPOSCAR(comment, host.lattice, species, coords, host.elements, flags);
+        written[s] = out.writePOSCAR(outputPrefix + std::to_string(s + 1));
+    });
+    const size_t n_written = std::count(written.begin(), written.end(), 1);
+
+    std::ofstream summary(outputPrefix + "_summary.txt");
+    summary << "# site  x  y  z  distance_A  multiplicity\n";
+    summary << std::fixed << std::setprecision(6);
+    for (size_t s = 0; s < sites.size(); ++s)
+        summary << s + 1 << " " << sites[s].position.x << " " << sites[s].position.y << " " << sites[s].position.z
+                << " " << sites[s].distance << " " << sites[s].multiplicity << "\n";
+    summary.close();
+
+    std::cout << "Inequivalent interstitial sites: " << sites.size() << "\n";
+    std::cout << "Structures written: " << n_written << "\n";
+    if (!summary) {
+        std::cerr << "Error: failed to write " << outputPrefix << "_summary.txt\n";
+        return 1;
+    }
+    std::cout << "Summary written to: " << outputPrefix << "_summary.txt\n";
+
+    if (n_written != n_write) {
+        std::cerr << "Error: " << n_write - n_written << " structures could not be written\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,190 @@
+#include "poscar_kpoints.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "instrumentation.h"
+#include "kpoint_mesh.h"
+#include "parallel_utility.h"
+#include "poscar_file.h"
+#include "symmetry.h"
+
+bool readInput(int argc, char* argv[], std::string& inputFile, std::string& outputFile, double& kspacing,
+               int& extra, double& symprec, bool& gammaOnly, int& threads) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--input") {
+            if (i + 1 >= argc)
+                return false;
+            inputFile = argv[++i];
+        } else if (arg == "--output") {
+            if (i + 1 >= argc)
+                return false;
+            outputFile = argv[++i];
+        } else if (arg == "--kspacing" || arg == "--symprec") {
+            if (i + 1 >= argc)
+                return false;
+            double value;
+            try {
+                value = std::stod(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+            if (arg == "--kspacing")
+                kspacing = value;
+            else
+                symprec = value;
+        } else if (arg == "--extra" || arg == "--threads") {
+            if (i + 1 >= argc)
+                return false;
+            int value;
+            try {
+                value = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+            if (arg == "--extra")
+                extra = value;
+            else
+                threads = value;
+        } else if (arg == "--gamma") {
+            gammaOnly = true;
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+bool validateInput(const std::string& inputFile, double kspacing, int extra, double symprec) {
+    std::ifstream file(inputFile);
+    if (!file) {
+        std::cerr << "Error: cannot open file " << inputFile << "\n";
+        return false;
+    }
+    if (kspacing <= 0) {
+        std::cerr << "Error: kspacing must be positive!!!\n";
+        return false;
+    }
+    if (extra < 0) {
+        std::cerr << "Error: --extra cannot be negative!!!\n";
+        return false;
+    }
+    if (symprec <= 0) {
+        std::cerr << "Error: symprec must be positive!!!\n";
+        return false;
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  poscar_kpoints [options]\n\n"
+                 "Options:\n"
+                 "  --input      input POSCAR file name (default: POSCAR)\n"
+                 "  --output     output KPOINTS file name (default: KPOINTS)\n"
+                 "  --kspacing   largest allowed k-point spacing in 1/Angstrom, 2 pi included (default: 0.25)\n"
+                 "  --extra      subdivisions added to the minimal mesh per axis when searching (default: 2)\n"
+                 "  --gamma      only consider Gamma-centred meshes\n"
+                 "  --symprec    symmetry tolerance (spglib symprec) (default: 1e-5)\n"
+                 "  --threads    number of worker threads (default: all cores)\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
+                 "  --help       show this help message\n\n"
+                 "Example:\n"
+                 "  poscar_kpoints --input POSCAR --kspacing 0.2 --extra 3\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputFile{"POSCAR"};
+    std::string outputFile{"KPOINTS"};
+    double kspacing{0.25};
+    int extra{2};
+    double symprec{1e-5};
+    bool gammaOnly{false};
+    int threads{0};
+
+    if (!readInput(argc, argv, inputFile, outputFile, kspacing, extra, symprec, gammaOnly, threads))
+        return 1;
+
+    if (!validateInput(inputFile, kspacing, extra, symprec))
+        return 1;
+
+    POSCAR poscar;
+    if (!poscar.readPOSCAR(inputFile)) {
+        std::cerr << "Error: reading POSCAR file " << inputFile << "\n";
+        return 1;
+    }
+
+    auto dataset = analyzeSymmetry(poscar, symprec);
+    if (!dataset) {
+        std::cerr << "Error: failed to analyze symmetry.\n";
+        return 1;
+    }
+
+    // Point group of the input cell, packed for spglib
+    std::vector<int> unique = uniqueRotations(dataset->rotations, dataset->n_operations);
+    std::vector<int> packed(9 * unique.size());
+    for (size_t r = 0; r < unique.size(); ++r)
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                packed[9 * r + 3 * i + j] = dataset->rotations[unique[r]][i][j];
+    const auto* rotations = reinterpret_cast<const int(*)[3][3]>(packed.data());
+    const int n_rot = static_cast<int>(unique.size());
+
+    std::vector<KMesh> meshes = candidateMeshes(poscar.lattice, kspacing, extra, rotations, n_rot, gammaOnly);
+    if (meshes.empty()) {
+        std::cerr << "Error: no symmetry-compatible mesh found, try a larger --extra.\n";
+        return 1;
+    }
+
+    {
+        ScopedTimer phase("kpoint_candidates", meshes.size());
+        parallelFor(meshes.size(), threads, [&](size_t c) {
+            int is_shift[3];
+            meshes[c].shift(is_shift);
+            meshes[c].irreducible = countIrreducibleKpoints(meshes[c].mesh, is_shift, rotations, n_rot);
+        });
+    }
+    rankMeshes(meshes);
+
+    std::cout << "Space group: " << dataset->international_symbol << " (" << dataset->spacegroup_number
+              << "), point group order " << n_rot << "\n";
+    std::cout << "Candidates (irreducible / total):\n";
+    for (const KMesh& m : meshes)
+        std::cout << "  " << std::setw(3) << m.mesh[0] << std::setw(4) << m.mesh[1] << std::setw(4) << m.mesh[2]
+                  << "  " << std::left << std::setw(15) << (m.gamma_centered ? "Gamma" : "Monkhorst-Pack")
+                  << std::right << std::setw(7) << m.irreducible << " / " << m.total() << "\n";
+
+    const KMesh& best = meshes.front();
+    std::ostringstream comment;
+    comment << "kspacing " << kspacing << " 1/A, " << best.irreducible << " irreducible k-points";
+    if (!writeKPOINTS(outputFile, best, comment.str()))
+        return 1;
+
+    std::cout << "Selected: " << best.mesh[0] << "x" << best.mesh[1] << "x" << best.mesh[2] << " "
+              << (best.gamma_centered ? "Gamma" : "Monkhorst-Pack") << " with " << best.irreducible
+              << " irreducible k-points\n";
+    std::cout << "KPOINTS written to: " << outputFile << "\n";
+
+    return 0;
+}
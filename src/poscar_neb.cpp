@@ -0,0 +1,232 @@
+#include "poscar_neb.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "instrumentation.h"
+#include "lattice_utility.h"
+#include "neb.h"
+#include "parallel_utility.h"
+#include "poscar_file.h"
+
+namespace fs = std::filesystem;
+
+bool readInput(int argc, char* argv[], std::string& initialFile, std::string& finalFile, int& images,
+               bool& idpp, bool& match, IdppOptions& options, std::string& outputDir) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--initial") {
+            if (i + 1 >= argc)
+                return false;
+            initialFile = argv[++i];
+        } else if (arg == "--final") {
+            if (i + 1 >= argc)
+                return false;
+            finalFile = argv[++i];
+        } else if (arg == "--images" || arg == "--max-iter" || arg == "--threads") {
+            if (i + 1 >= argc)
+                return false;
+            int value;
+            try {
+                value = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+            if (arg == "--images")
+                images = value;
+            else if (arg == "--max-iter")
+                options.max_iterations = value;
+            else
+                options.threads = value;
+        } else if (arg == "--ftol" || arg == "--spring" || arg == "--step") {
+            if (i + 1 >= argc)
+                return false;
+            double value;
+            try {
+                value = std::stod(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+            if (arg == "--ftol")
+                options.force_tolerance = value;
+            else if (arg == "--spring")
+                options.spring = value;
+            else
+                options.step = value;
+        } else if (arg == "--linear") {
+            idpp = false;
+        } else if (arg == "--no-match") {
+            match = false;
+        } else if (arg == "--output-dir") {
+            if (i + 1 >= argc)
+                return false;
+            outputDir = argv[++i];
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+bool validateInput(const std::string& initialFile, const std::string& finalFile, int images,
+                   const IdppOptions& options) {
+    for (const auto& name : {initialFile, finalFile}) {
+        std::ifstream file(name);
+        if (!file) {
+            std::cerr << "Error: cannot open file " << name << "\n";
+            return false;
+        }
+    }
+    if (images < 1 || images > 98) {
+        std::cerr << "Error: number of images must be between 1 and 98!\n";
+        return false;
+    }
+    if (options.max_iterations < 0 || options.force_tolerance <= 0 || options.spring < 0 || options.step <= 0) {
+        std::cerr << "Error: IDPP parameters must be positive!\n";
+        return false;
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  poscar_neb [options]\n\n"
+                 "Options:\n"
+                 "  --initial    initial POSCAR file name (default: POSCAR_initial)\n"
+                 "  --final      final POSCAR file name (default: POSCAR_final)\n"
+                 "  --images     number of intermediate images (default: 5)\n"
+                 "  --linear     linear interpolation only, skip the IDPP optimization\n"
+                 "  --no-match   keep the atom order of the final structure instead of matching atoms\n"
+                 "  --max-iter   maximal number of IDPP iterations (default: 1000)\n"
+                 "  --ftol       IDPP force tolerance (default: 0.01)\n"
+                 "  --spring     NEB spring constant on the IDPP surface (default: 5.0)\n"
+                 "  --step       IDPP steepest-descent step (default: 0.05)\n"
+                 "  --output-dir directory receiving 00 .. NN/POSCAR (default: .)\n"
+                 "  --threads    number of worker threads (default: all cores)\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
+                 "  --help       show this help message\n\n"
+                 "Example:\n"
+                 "  poscar_neb --initial POSCAR_is --final POSCAR_fs --images 7\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string initialFile{"POSCAR_initial"};
+    std::string finalFile{"POSCAR_final"};
+    int images{5};
+    bool idpp{true};
+    bool match{true};
+    IdppOptions options;
+    std::string outputDir{"."};
+
+    if (!readInput(argc, argv, initialFile, finalFile, images, idpp, match, options, outputDir))
+        return 1;
+
+    if (!validateInput(initialFile, finalFile, images, options))
+        return 1;
+
+    POSCAR initial, final;
+    if (!initial.readPOSCAR(initialFile)) {
+        std::cerr << "Error: reading POSCAR file " << initialFile << "\n";
+        return 1;
+    }
+    if (!final.readPOSCAR(finalFile)) {
+        std::cerr << "Error: reading POSCAR file " << finalFile << "\n";
+        return 1;
+    }
+    initial.toDirect();
+    final.toDirect();
+
+    if (initial.elements != final.elements || initial.num_atoms != final.num_atoms) {
+        std::cerr << "Error: initial and final structures must contain the same elements and atom counts!\n";
+        return 1;
+    }
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            if (std::abs(initial.lattice[i][j] - final.lattice[i][j]) > 1e-4) {
+                std::cerr << "Error: initial and final lattices differ, variable-cell paths are not supported!\n";
+                return 1;
+            }
+
+    std::vector<int> order(initial.total_atoms);
+    if (match) {
+        ScopedTimer phase("match_atoms", initial.total_atoms);
+        order = matchAtoms(initial, final);
+    } else {
+        std::iota(order.begin(), order.end(), 0);
+    }
+    std::vector<Atom> aligned = alignEndpoint(initial.coordinates, final.coordinates, order);
+
+    int reordered = 0;
+    double max_displacement = 0.0;
+    for (int i = 0; i < initial.total_atoms; ++i) {
+        reordered += order[i] != i;
+        const double delta[3] = {aligned[i].x - initial.coordinates[i].x, aligned[i].y - initial.coordinates[i].y,
+                                 aligned[i].z - initial.coordinates[i].z};
+        max_displacement = std::max(max_displacement, minimumImageDistance(initial.lattice, delta));
+    }
+
+    std::vector<std::vector<Atom>> path = linearPath(initial.coordinates, aligned, images);
+    if (idpp) {
+        IdppResult result = idppOptimize(initial.lattice, path, options);
+        std::cout << "IDPP " << (result.converged ? "converged" : "not converged") << " after " << result.iterations
+                  << " iterations, max force " << result.max_force << "\n";
+    }
+
+    std::vector<char> written(path.size(), 0);
+    {
+        ScopedTimer phase("write_images", path.size());
+        parallelFor(path.size(), options.threads, [&](size_t k) {
+            char name[8];
+            std::snprintf(name, sizeof(name), "%02zu", k);
+            const fs::path dir = fs::path(outputDir) / name;
+            std::error_code ec;
+            fs::create_directories(dir, ec);
+            if (ec) {
+                std::cerr << "Error: cannot create directory " << dir.string() << ": " << ec.message() << "\n";
+                return;
+            }
+
+            POSCAR image = initial;
+            image.comment = initial.comment + " image " + name;
+            image.coordinates = path[k];
+            for (auto& atom : image.coordinates)
+                atom = {wrapFractional(atom.x), wrapFractional(atom.y), wrapFractional(atom.z)};
+            written[k] = image.writePOSCAR((dir / "POSCAR").string());
+        });
+    }
+    const size_t failed = std::count(written.begin(), written.end(), 0);
+    if (failed > 0) {
+        std::cerr << "Error: " << failed << " of " << path.size() << " images could not be written\n";
+        return 1;
+    }
+
+    std::cout << "Reordered atoms: " << reordered << "\n";
+    std::cout << "Largest endpoint displacement: " << max_displacement << " A\n";
+    std::cout << "Images written: 00 .. " << (path.size() - 1 < 10 ? "0" : "") << path.size() - 1 << " in "
+              << outputDir << "\n";
+
+    return 0;
+}
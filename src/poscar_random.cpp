@@ -0,0 +1,324 @@
+#include "poscar_random.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "instrumentation.h"
+#include "parallel_utility.h"
+#include "poscar_file.h"
+#include "random_structure.h"
+#include "structure_archive.h"
+#include "structure_index.h"
+#include "symmetry.h"
+#include "text_writer.h"
+
+namespace {
+
+// "min:max" with either side optional; a single number means exactly that value
+template <typename T, typename Parse>
+bool parseRange(const std::string& text, T& lower, T& upper, Parse parse) {
+    try {
+        size_t colon = text.find(':');
+        if (colon == std::string::npos) {
+            lower = upper = parse(text);
+            return true;
+        }
+        if (colon > 0)
+            lower = parse(text.substr(0, colon));
+        if (colon + 1 < text.size())
+            upper = parse(text.substr(colon + 1));
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+// "Na-Cl:2.4" -> pair_distance[{Cl, Na}] = 2.4
+bool parsePairDistance(const std::string& text, RandomStructureOptions& options) {
+    size_t dash = text.find('-');
+    size_t colon = text.find(':');
+    if (dash == std::string::npos || colon == std::string::npos || dash == 0 || colon < dash + 2)
+        return false;
+    try {
+        std::string first = text.substr(0, dash);
+        std::string second = text.substr(dash + 1, colon - dash - 1);
+        if (second < first)
+            std::swap(first, second);
+        options.pair_distance[{first, second}] = std::stod(text.substr(colon + 1));
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+std::string formatPOSCAR(const POSCAR& poscar) {
+    std::ostringstream text;
+    TextWriter writer(text);
+    poscar.writePOSCAR(writer);
+    writer.flush();
+    return text.str();
+}
+
+}  // namespace
+
+bool readInput(int argc, char* argv[], RandomStructureOptions& options, int& minGroup, int& maxGroup,
+               int& n_structures, std::uint64_t& seed, bool& seedSet, int& threads, std::string& archiveFile) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--composition") {
+            if (i + 1 >= argc)
+                return false;
+            if (!parseFormula(argv[++i], options.composition)) {
+                std::cerr << "Error: cannot parse composition " << argv[i] << "\n";
+                return false;
+            }
+        } else if (arg == "--volume") {
+            if (i + 1 >= argc)
+                return false;
+            if (!parseRange(argv[++i], options.min_volume, options.max_volume,
+                            [](const std::string& s) { return std::stod(s); }))
+                return false;
+        } else if (arg == "--min-distance") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                options.min_distance = std::stod(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--pair-distance") {
+            if (i + 1 >= argc)
+                return false;
+            if (!parsePairDistance(argv[++i], options)) {
+                std::cerr << "Error: expected --pair-distance A-B:distance, got " << argv[i] << "\n";
+                return false;
+            }
+        } else if (arg == "--spacegroup") {
+            if (i + 1 >= argc)
+                return false;
+            minGroup = 1;
+            maxGroup = 230;
+            if (!parseRange(argv[++i], minGroup, maxGroup, [](const std::string& s) { return std::stoi(s); }))
+                return false;
+        } else if (arg == "--nstructures") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                n_structures = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--seed") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                seed = std::stoull(argv[++i]);
+                seedSet = true;
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--threads") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                threads = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--archive") {
+            if (i + 1 >= argc)
+                return false;
+            archiveFile = argv[++i];
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+bool validateInput(const RandomStructureOptions& options, int minGroup, int maxGroup, int n_structures,
+                   bool archive) {
+    if (options.composition.empty()) {
+        std::cerr << "Error: composition is missing (--composition)!\n";
+        return false;
+    }
+    for (const auto& [element, count] : options.composition) {
+        if (count <= 0) {
+            std::cerr << "Error: number of " << element << " atoms must be positive!\n";
+            return false;
+        }
+    }
+
+    if (options.min_volume <= 0 || options.max_volume < options.min_volume) {
+        std::cerr << "Error: volume range must be positive with min <= max (--volume)!\n";
+        return false;
+    }
+
+    if (options.min_distance <= 0) {
+        std::cerr << "Error: minimum distance must be positive!\n";
+        return false;
+    }
+    for (const auto& [key, distance] : options.pair_distance) {
+        if (distance <= 0) {
+            std::cerr << "Error: minimum distance of " << key.first << "-" << key.second << " must be positive!\n";
+            return false;
+        }
+        auto present = [&](const std::string& element) {
+            return std::any_of(options.composition.begin(), options.composition.end(),
+                               [&](const auto& entry) { return entry.first == element; });
+        };
+        if (!present(key.first) || !present(key.second))
+            std::cerr << "Warning: " << key.first << "-" << key.second << " is not a pair of the composition\n";
+    }
+
+    if (minGroup != 0 && (minGroup < 1 || maxGroup > 230 || minGroup > maxGroup)) {
+        std::cerr << "Error: space groups must lie between 1 and 230!\n";
+        return false;
+    }
+
+    if (n_structures <= 0) {
+        std::cerr << "Error: number of structures must be positive!\n";
+        return false;
+    }
+    // One archive does not load the file system with metadata, so only separate files are limited
+    if (n_structures > 1000 && !archive) {
+        std::cerr << "Error: number of structure files is too high! Use --archive for more.\n";
+        return false;
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  poscar_random [options]\n\n"
+                 "Options:\n"
+                 "  --composition atoms per cell, e.g. Na4Cl4\n"
+                 "  --volume     cell volume range min:max in Angstrom^3\n"
+                 "  --min-distance minimum distance between atoms in Angstroms (default: 1.5)\n"
+                 "  --pair-distance minimum distance of one species pair, e.g. Na-Cl:2.4 (repeatable)\n"
+                 "  --spacegroup impose a random space group from the range min:max, or one number\n"
+                 "               (default: none, P1)\n"
+                 "  --nstructures number of structures to generate (default: 1)\n"
+                 "  --seed       seed of the run; structure i depends only on seed and i (default: random)\n"
+                 "  --threads    number of worker threads (default: all cores)\n"
+                 "  --archive    write all structures into this tar archive instead of separate files\n"
+                 "  --timings    Print phase timing breakdown to stderr\n"
+                 "  --timings-json Print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   Print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json Print memory report to stderr as JSON\n"
+                 "  --help       Show this help message\n\n"
+                 "Structures are written as POSCAR_random1, POSCAR_random2, ...\n\n"
+                 "Example:\n"
+                 "  poscar_random --composition Na4Cl4 --volume 150:220 --nstructures 100\n"
+                 "  poscar_random --composition Si8 --volume 140:180 --min-distance 2.0 --spacegroup 2:230 \\\n"
+                 "                --nstructures 50000 --seed 7 --archive si8.tar.zst\n";
+}
+
+int main(int argc, char* argv[]) {
+    RandomStructureOptions options;
+    int minGroup{0};
+    int maxGroup{0};
+    int n_structures{1};
+    std::uint64_t seed{0};
+    bool seedSet{false};
+    int threads{0};
+    std::string archiveFile;
+
+    if (!readInput(argc, argv, options, minGroup, maxGroup, n_structures, seed, seedSet, threads, archiveFile))
+        return 1;
+
+    if (!validateInput(options, minGroup, maxGroup, n_structures, !archiveFile.empty()))
+        return 1;
+
+    for (int number = minGroup; minGroup > 0 && number <= maxGroup; ++number) {
+        SpaceGroupChoice group;
+        group.number = number;
+        if (!spacegroupOperations(number, group.operations)) {
+            std::cerr << "Error: no operations for space group " << number << "\n";
+            return 1;
+        }
+        options.spacegroups.push_back(std::move(group));
+    }
+
+    if (!seedSet) {
+        std::random_device device;
+        seed = (static_cast<std::uint64_t>(device()) << 32) ^ device();
+        std::cerr << "Seed: " << seed << "\n";
+    }
+
+    std::unique_ptr<ArchiveWriter> archive;
+    if (!archiveFile.empty()) {
+        archive = std::make_unique<ArchiveWriter>(archiveFile);
+        if (!*archive)
+            return 1;
+    }
+
+    int atomsPerCell = 0;
+    for (const auto& entry : options.composition)
+        atomsPerCell += entry.second;
+
+    // Candidates are generated in parallel batches and written in order, so the output does not depend on
+    // the thread count
+    const int batch = 1024;
+    std::vector<std::string> texts(batch);
+    std::vector<char> generated(batch);
+    int failed = 0;
+    for (int start = 0; start < n_structures; start += batch) {
+        const int count = std::min(batch, n_structures - start);
+        {
+            ScopedTimer phase("generate_structures", static_cast<std::size_t>(count) * atomsPerCell);
+            parallelFor(count, threads, [&](std::size_t i) {
+                POSCAR structure;
+                generated[i] = generateRandomStructure(options, candidateSeed(seed, start + i), structure);
+                if (generated[i])
+                    texts[i] = formatPOSCAR(structure);
+            });
+        }
+
+        for (int i = 0; i < count; ++i) {
+            if (!generated[i]) {
+                ++failed;
+                continue;
+            }
+            const std::string name = "POSCAR_random" + std::to_string(start + i + 1);
+            if (archive) {
+                if (!archive->add(name, std::move(texts[i])))
+                    return 1;
+                continue;
+            }
+            std::ofstream file(name);
+            if (!(file << texts[i])) {
+                std::cerr << "Error: cannot write " << name << "\n";
+                return 1;
+            }
+        }
+    }
+    if (archive && !archive->close())
+        return 1;
+
+    if (failed > 0) {
+        std::cerr << "Warning: " << failed << " of " << n_structures
+                  << " structures could not be placed; widen the volume range or lower the distances\n";
+    }
+    return failed == n_structures ? 1 : 0;
+}
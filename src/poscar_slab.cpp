@@ -0,0 +1,324 @@
+#include "poscar_slab.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "instrumentation.h"
+#include "parallel_utility.h"
+#include "poscar_file.h"
+#include "slab.h"
+#include "structure_matcher.h"
+#include "symmetry.h"
+
+namespace {
+
+// Divides by the gcd and makes the first non-zero index positive; (hkl) and (-h-k-l) give the same slab
+std::array<int, 3> normalizeMiller(const std::array<int, 3>& hkl) {
+    int g = std::gcd(std::gcd(std::abs(hkl[0]), std::abs(hkl[1])), std::abs(hkl[2]));
+    std::array<int, 3> out = hkl;
+    if (g == 0)
+        return out;
+    int sign = 0;
+    for (int k = 0; k < 3 && sign == 0; ++k)
+        sign = out[k] > 0 ? 1 : (out[k] < 0 ? -1 : 0);
+    for (int& x : out)
+        x = sign * x / g;
+    return out;
+}
+
+std::string millerLabel(const std::array<int, 3>& hkl) {
+    return std::to_string(hkl[0]) + "_" + std::to_string(hkl[1]) + "_" + std::to_string(hkl[2]);
+}
+
+struct SlabCandidate {
+    size_t surface;  // index into the Miller list
+    int termination;
+    POSCAR slab;
+    POSCAR standardized;
+    int spacegroup{0};
+    int equivalent_to{-1};  // candidate index of the first equivalent termination, -1 if unique
+};
+
+}  // namespace
+
+bool readInput(int argc, char* argv[], std::string& inputFile, std::vector<std::array<int, 3>>& millers,
+               int& maxIndex, double& thickness, double& vacuum, double& layerTolerance, double& symprec,
+               std::string& outputPrefix, int& threads) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--input") {
+            if (i + 1 >= argc)
+                return false;
+            inputFile = argv[++i];
+        } else if (arg == "--miller") {
+            if (i + 3 >= argc)
+                return false;
+            std::array<int, 3> hkl;
+            try {
+                for (int k = 0; k < 3; ++k)
+                    hkl[k] = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+            millers.push_back(hkl);
+        } else if (arg == "--max-index" || arg == "--threads") {
+            if (i + 1 >= argc)
+                return false;
+            int value;
+            try {
+                value = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+            if (arg == "--max-index")
+                maxIndex = value;
+            else
+                threads = value;
+        } else if (arg == "--thickness" || arg == "--vacuum" || arg == "--layer-tol" || arg == "--symprec") {
+            if (i + 1 >= argc)
+                return false;
+            double value;
+            try {
+                value = std::stod(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+            if (arg == "--thickness")
+                thickness = value;
+            else if (arg == "--vacuum")
+                vacuum = value;
+            else if (arg == "--layer-tol")
+                layerTolerance = value;
+            else
+                symprec = value;
+        } else if (arg == "--output-prefix") {
+            if (i + 1 >= argc)
+                return false;
+            outputPrefix = argv[++i];
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+bool validateInput(const std::string& inputFile, const std::vector<std::array<int, 3>>& millers, int maxIndex,
+                   double thickness, double vacuum, double layerTolerance, double symprec) {
+    std::ifstream file(inputFile);
+    if (!file) {
+        std::cerr << "Error: cannot open file " << inputFile << "\n";
+        return false;
+    }
+    if (millers.empty() && maxIndex <= 0) {
+        std::cerr << "Error: give --miller h k l or --max-index n!\n";
+        return false;
+    }
+    for (const auto& hkl : millers) {
+        if (hkl[0] == 0 && hkl[1] == 0 && hkl[2] == 0) {
+            std::cerr << "Error: Miller indices 0 0 0 do not define a plane!\n";
+            return false;
+        }
+    }
+    if (thickness <= 0 || vacuum < 0 || layerTolerance <= 0) {
+        std::cerr << "Error: thickness and layer tolerance must be positive, vacuum non-negative!\n";
+        return false;
+    }
+    if (symprec <= 0) {
+        std::cerr << "Error: symprec must be positive!!!\n";
+        return false;
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  poscar_slab [options]\n\n"
+                 "Options:\n"
+                 "  --input      bulk POSCAR file name (default: POSCAR)\n"
+                 "  --miller     Miller indices h k l of the surface, may be repeated\n"
+                 "  --max-index  also build every surface with |h|, |k|, |l| <= n\n"
+                 "  --thickness  minimal slab thickness in Angstrom (default: 10)\n"
+                 "  --vacuum     vacuum thickness in Angstrom (default: 15)\n"
+                 "  --layer-tol  atoms closer than this along the normal form one layer, Angstrom (default: 0.05)\n"
+                 "  --symprec    tolerance for comparing terminations (default: 1e-3)\n"
+                 "  --output-prefix prefix of written slabs (default: POSCAR_slab)\n"
+                 "  --threads    number of worker threads (default: all cores)\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
+                 "  --help       show this help message\n\n"
+                 "Example:\n"
+                 "  poscar_slab --input POSCAR --miller 1 1 1 --miller 1 0 0 --thickness 12 --vacuum 20\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputFile{"POSCAR"};
+    std::vector<std::array<int, 3>> millers;
+    int maxIndex{0};
+    double thickness{10.0};
+    double vacuum{15.0};
+    double layerTolerance{0.05};
+    double symprec{1e-3};
+    std::string outputPrefix{"POSCAR_slab"};
+    int threads{0};
+
+    if (!readInput(argc, argv, inputFile, millers, maxIndex, thickness, vacuum, layerTolerance, symprec,
+                   outputPrefix, threads))
+        return 1;
+
+    if (!validateInput(inputFile, millers, maxIndex, thickness, vacuum, layerTolerance, symprec))
+        return 1;
+
+    POSCAR bulk;
+    if (!bulk.readPOSCAR(inputFile)) {
+        std::cerr << "Error: reading POSCAR file " << inputFile << "\n";
+        return 1;
+    }
+
+    for (int h = -maxIndex; h <= maxIndex; ++h)
+        for (int k = -maxIndex; k <= maxIndex; ++k)
+            for (int l = -maxIndex; l <= maxIndex; ++l)
+                if (h != 0 || k != 0 || l != 0)
+                    millers.push_back({h, k, l});
+
+    std::vector<std::array<int, 3>> surfaces;
+    for (const auto& hkl : millers) {
+        std::array<int, 3> n = normalizeMiller(hkl);
+        if (std::find(surfaces.begin(), surfaces.end(), n) == surfaces.end())
+            surfaces.push_back(n);
+    }
+
+    // Oriented cells and their layers, one surface per task
+    std::vector<POSCAR> oriented(surfaces.size());
+    std::vector<SlabLayers> layers(surfaces.size());
+    std::vector<char> valid(surfaces.size(), 0);
+    {
+        ScopedTimer phase("slab_orient", surfaces.size());
+        parallelFor(surfaces.size(), threads, [&](size_t s) {
+            if (!orientedCell(bulk, surfaces[s].data(), oriented[s]))
+                return;
+            layers[s] = findLayers(oriented[s], layerTolerance);
+            valid[s] = !layers[s].height.empty();
+        });
+    }
+
+    std::vector<SlabCandidate> candidates;
+    for (size_t s = 0; s < surfaces.size(); ++s) {
+        if (!valid[s]) {
+            std::cerr << "Warning: failed to orient the cell for (" << millerLabel(surfaces[s]) << ")\n";
+            continue;
+        }
+        for (int t = 0; t < static_cast<int>(layers[s].height.size()); ++t) {
+            SlabCandidate c;
+            c.surface = s;
+            c.termination = t;
+            candidates.push_back(std::move(c));
+        }
+    }
+
+    // Build every termination and prepare it for comparison
+    {
+        ScopedTimer phase("slab_build", candidates.size());
+        parallelFor(candidates.size(), threads, [&](size_t c) {
+            SlabCandidate& cand = candidates[c];
+            const size_t s = cand.surface;
+            const int n_cells = std::max(1, static_cast<int>(std::ceil(thickness / layers[s].repeat - 1e-8)));
+            cand.slab = buildSlab(oriented[s], layers[s], cand.termination, n_cells, vacuum);
+            cand.slab.comment = bulk.comment + " (" + millerLabel(surfaces[s]) + ") termination " +
+                                std::to_string(cand.termination + 1);
+
+            auto dataset = analyzeSymmetry(cand.slab, symprec);
+            cand.spacegroup = dataset ? dataset->spacegroup_number : 0;
+            cand.standardized = standardizeForMatching(cand.slab, symprec);
+        });
+    }
+
+    // Symmetry-equivalent terminations of the same surface, surfaces compared in parallel
+    MatchOptions match;
+    match.symprec = symprec;
+    {
+        ScopedTimer phase("slab_match", candidates.size());
+        parallelFor(surfaces.size(), threads, [&](size_t s) {
+            std::vector<size_t> reps;
+            for (size_t c = 0; c < candidates.size(); ++c) {
+                if (candidates[c].surface != s)
+                    continue;
+                for (size_t r : reps) {
+                    if (candidates[r].spacegroup != candidates[c].spacegroup)
+                        continue;
+                    if (standardizedStructuresMatch(candidates[c].standardized, candidates[r].standardized, match)) {
+                        candidates[c].equivalent_to = static_cast<int>(r);
+                        break;
+                    }
+                }
+                if (candidates[c].equivalent_to < 0)
+                    reps.push_back(c);
+            }
+        });
+    }
+
+    std::vector<std::string> names(candidates.size());
+    std::vector<char> written(candidates.size(), 0);
+    {
+        ScopedTimer phase("slab_write", candidates.size());
+        parallelFor(candidates.size(), threads, [&](size_t c) {
+            if (candidates[c].equivalent_to >= 0)
+                return;
+            names[c] = outputPrefix + "_" + millerLabel(surfaces[candidates[c].surface]) + "_t" +
+                       std::to_string(candidates[c].termination + 1);
+            written[c] = candidates[c].slab.writePOSCAR(names[c]);
+        });
+    }
+
+    std::ofstream summary(outputPrefix + "_summary.txt");
+    summary << "# h k l  termination  n_atoms  space_group  file_or_equivalent\n";
+    size_t unique = 0, failed = 0;
+    for (size_t c = 0; c < candidates.size(); ++c) {
+        const auto& hkl = surfaces[candidates[c].surface];
+        summary << hkl[0] << " " << hkl[1] << " " << hkl[2] << " " << candidates[c].termination + 1 << " "
+                << candidates[c].slab.total_atoms << " " << candidates[c].spacegroup << " ";
+        if (candidates[c].equivalent_to < 0) {
+            summary << (written[c] ? names[c] : std::string("-")) << "\n";
+            unique++;
+            failed += !written[c];
+        } else {
+            summary << "= t" << candidates[candidates[c].equivalent_to].termination + 1 << "\n";
+        }
+    }
+
+    std::cout << "Surfaces: " << surfaces.size() << ", terminations: " << candidates.size()
+              << ", symmetry-distinct: " << unique << "\n";
+    summary.close();
+    if (!summary) {
+        std::cerr << "Error: failed to write " << outputPrefix << "_summary.txt\n";
+        return 1;
+    }
+    std::cout << "Summary written to: " << outputPrefix << "_summary.txt\n";
+
+    if (failed > 0) {
+        std::cerr << "Error: " << failed << " of " << unique << " slabs could not be written\n";
+        return 1;
+    }
+    return 0;
+}
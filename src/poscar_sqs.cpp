@@ -0,0 +1,274 @@
+#include "poscar_sqs.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "instrumentation.h"
+#include "poscar_file.h"
+#include "sqs.h"
+#include "structure_utility.h"
+
+bool readInput(int argc, char* argv[], std::string& inputFile, int supercell[3], std::string& site,
+               std::string& substitute, int& count, SqsOptions& options, std::string& outputFile) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--input") {
+            if (i + 1 >= argc)
+                return false;
+            inputFile = argv[++i];
+        } else if (arg == "--supercell") {
+            if (i + 3 >= argc)
+                return false;
+            try {
+                for (int k = 0; k < 3; ++k)
+                    supercell[k] = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--site") {
+            if (i + 1 >= argc)
+                return false;
+            site = argv[++i];
+        } else if (arg == "--substitute") {
+            if (i + 1 >= argc)
+                return false;
+            substitute = argv[++i];
+        } else if (arg == "--count") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                count = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--pair-shells") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                options.pair_shells = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--triplet-shells") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                options.triplet_shells = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--steps") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                options.steps = std::stoll(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--chains") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                options.chains = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--threads") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                options.threads = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--seed") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                options.seed = std::stoull(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--temperature") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                options.temperature = std::stod(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--output") {
+            if (i + 1 >= argc)
+                return false;
+            outputFile = argv[++i];
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+bool validateInput(const std::string& inputFile, const int supercell[3], const std::string& site,
+                   const std::string& substitute, int count, const SqsOptions& options) {
+    std::ifstream file(inputFile);
+    if (!file) {
+        std::cerr << "Error: cannot open file " << inputFile << "\n";
+        return false;
+    }
+    for (int k = 0; k < 3; ++k) {
+        if (supercell[k] <= 0) {
+            std::cerr << "Error: supercell multiples must be positive!\n";
+            return false;
+        }
+    }
+    if (site.empty() || substitute.empty()) {
+        std::cerr << "Error: --site and --substitute are required!\n";
+        return false;
+    }
+    if (count < 0) {
+        std::cerr << "Error: --count must not be negative!\n";
+        return false;
+    }
+    if (options.pair_shells < 1 || options.triplet_shells < 0) {
+        std::cerr << "Error: at least one pair shell is required and triplet shells must not be negative!\n";
+        return false;
+    }
+    if (options.steps < 0 || options.temperature <= 0) {
+        std::cerr << "Error: steps must not be negative and temperature must be positive!\n";
+        return false;
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  poscar_sqs [options]\n\n"
+                 "Options:\n"
+                 "  --input      parent POSCAR file name (default: POSCAR)\n"
+                 "  --supercell  supercell multiples along a, b, c (default: 1 1 1)\n"
+                 "  --site       element whose sites are decorated (required)\n"
+                 "  --substitute substituting element (required)\n"
+                 "  --count      number of substituted sites (default: half of the sites)\n"
+                 "  --pair-shells number of pair correlation shells fitted (default: 3)\n"
+                 "  --triplet-shells number of triplet correlation shells fitted (default: 1)\n"
+                 "  --steps      Monte Carlo swap attempts per chain (default: 100000)\n"
+                 "  --chains     number of independent chains (default: one per thread)\n"
+                 "  --threads    number of worker threads (default: all cores)\n"
+                 "  --seed       random seed, chain c uses seed + c (default: 12345)\n"
+                 "  --temperature initial annealing temperature (default: 0.05)\n"
+                 "  --output     output POSCAR file name (default: POSCAR_sqs)\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
+                 "  --help       show this help message\n\n"
+                 "Example:\n"
+                 "  poscar_sqs --input POSCAR --supercell 3 3 3 --site Au --substitute Cu --count 54\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputFile{"POSCAR"};
+    int supercell[3] = {1, 1, 1};
+    std::string site;
+    std::string substitute;
+    int count{-1};
+    SqsOptions options;
+    std::string outputFile{"POSCAR_sqs"};
+
+    if (!readInput(argc, argv, inputFile, supercell, site, substitute, count, options, outputFile))
+        return 1;
+
+    // -1 stands for "not given", the default is an equimolar split
+    int countCheck = count < 0 ? 0 : count;
+    if (!validateInput(inputFile, supercell, site, substitute, countCheck, options))
+        return 1;
+
+    POSCAR parent;
+    if (!parent.readPOSCAR(inputFile)) {
+        std::cerr << "Error: reading POSCAR file " << inputFile << "\n";
+        return 1;
+    }
+
+    POSCAR super = makeSupercell(parent, supercell[0], supercell[1], supercell[2]);
+    std::vector<std::string> species = atomSpecies(super);
+
+    std::vector<int> active;
+    for (int i = 0; i < super.total_atoms; ++i)
+        if (species[i] == site)
+            active.push_back(i);
+
+    if (active.empty()) {
+        std::cerr << "Error: element " << site << " not found in " << inputFile << "\n";
+        return 1;
+    }
+    const int n_sites = static_cast<int>(active.size());
+    if (count < 0)
+        count = n_sites / 2;
+    if (count > n_sites) {
+        std::cerr << "Error: --count " << count << " exceeds the " << n_sites << " active sites.\n";
+        return 1;
+    }
+
+    std::unique_ptr<SqsModel> model;
+    {
+        ScopedTimer phase("sqs_shells", n_sites);
+        model = std::make_unique<SqsModel>(super, active, options.pair_shells, options.triplet_shells);
+    }
+
+    SqsResult result;
+    {
+        ScopedTimer phase("sqs_monte_carlo", n_sites);
+        result = runSqs(*model, count, options);
+    }
+
+    std::vector<std::string> decorated = species;
+    for (int b = 0; b < n_sites; ++b)
+        if (result.spins[b] < 0)
+            decorated[active[b]] = substitute;
+
+    std::vector<std::string> elementOrder = super.elements;
+    elementOrder.push_back(substitute);
+
+    POSCAR direct = super;
+    direct.toDirect();
+    std::string comment = super.comment + " SQS " + std::to_string(count) + "/" + std::to_string(n_sites) + " " +
+                          substitute;
+    POSCAR out = buildPOSCAR(comment, direct.lattice, decorated, direct.coordinates, elementOrder,
+                             direct.selective_dynamics ? direct.selective_flags : std::vector<std::uint8_t>{});
+    if (!out.writePOSCAR(outputFile)) {
+        std::cerr << "Error writing output POSCAR file: " << outputFile << "\n";
+        return 1;
+    }
+
+    const double m = static_cast<double>(n_sites - 2 * count) / n_sites;
+    std::cout << "Active sites: " << n_sites << ", substituted: " << count << ", best chain: " << result.chain
+              << "\n";
+    std::cout << std::fixed << std::setprecision(5);
+    for (size_t s = 0; s < result.pair_correlations.size(); ++s)
+        std::cout << "pair shell " << s + 1 << " (" << model->shellDistances()[s]
+                  << " A): " << result.pair_correlations[s] << "  target " << m * m << "\n";
+    for (size_t t = 0; t < result.triplet_correlations.size(); ++t)
+        std::cout << "triplet shell " << t + 1 << ": " << result.triplet_correlations[t] << "  target " << m * m * m
+                  << "\n";
+    std::cout << "Objective: " << result.objective << "\n";
+    std::cout << "SQS written to: " << outputFile << "\n";
+
+    return 0;
+}
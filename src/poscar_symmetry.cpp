@@ -7,6 +7,7 @@
 #include <optional>
 #include <string>
 
+#include "instrumentation.h"
 #include "poscar_file.h"
 #include "symmetry.h"
 
@@ -33,6 +34,14 @@ bool readInput(int argc, char* argv[], std::string& inputFile, double& symprec,
             } catch (...) {
                 return false;
             }
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
         } else {
             std::cerr << "Warning: unknown argument! Ignoring it!\n";
             printHelp();
@@ -70,6 +79,10 @@ void printHelp() {
                  "  --symprec    symmetry tolerance (spglib symprec) (default: 1e-5)\n"
                  "  --wyckoff    print the Wyckoff positions\n"
                  "  --symoper    print the symmetry operations\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
                  "  --help       show this help message\n\n"
                  "Example:\n"
                  "  poscar_symmetry --input POSCARin --symprec 1e-5 \n";
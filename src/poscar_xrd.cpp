@@ -0,0 +1,254 @@
+#include "poscar_xrd.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "instrumentation.h"
+#include "parallel_utility.h"
+#include "poscar_file.h"
+#include "xrd.h"
+
+namespace fs = std::filesystem;
+
+bool readInput(int argc, char* argv[], std::string& inputFile, std::string& inputDir, std::string& prefix,
+               std::string& outputDir, XrdOptions& options, double& step, double& fwhm) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--input") {
+            if (i + 1 >= argc)
+                return false;
+            inputFile = argv[++i];
+        } else if (arg == "--input-dir") {
+            if (i + 1 >= argc)
+                return false;
+            inputDir = argv[++i];
+        } else if (arg == "--prefix") {
+            if (i + 1 >= argc)
+                return false;
+            prefix = argv[++i];
+        } else if (arg == "--output-dir") {
+            if (i + 1 >= argc)
+                return false;
+            outputDir = argv[++i];
+        } else if (arg == "--wavelength" || arg == "--two-theta-min" || arg == "--two-theta-max" ||
+                   arg == "--step" || arg == "--fwhm" || arg == "--merge-tol" || arg == "--min-intensity") {
+            if (i + 1 >= argc)
+                return false;
+            double value;
+            try {
+                value = std::stod(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+            if (arg == "--wavelength")
+                options.wavelength = value;
+            else if (arg == "--two-theta-min")
+                options.two_theta_min = value;
+            else if (arg == "--two-theta-max")
+                options.two_theta_max = value;
+            else if (arg == "--step")
+                step = value;
+            else if (arg == "--fwhm")
+                fwhm = value;
+            else if (arg == "--merge-tol")
+                options.merge_tolerance = value;
+            else
+                options.min_intensity = value;
+        } else if (arg == "--threads") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                options.threads = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+bool validateInput(const std::string& inputFile, const std::string& inputDir, const XrdOptions& options, double step,
+                   double fwhm) {
+    if (!inputDir.empty()) {
+        if (!fs::is_directory(inputDir)) {
+            std::cerr << "Error: " << inputDir << " is not a directory\n";
+            return false;
+        }
+    } else {
+        std::ifstream file(inputFile);
+        if (!file) {
+            std::cerr << "Error: cannot open file " << inputFile << "\n";
+            return false;
+        }
+    }
+    if (options.wavelength <= 0) {
+        std::cerr << "Error: wavelength must be positive!\n";
+        return false;
+    }
+    if (options.two_theta_min < 0 || options.two_theta_max > 180 || options.two_theta_min >= options.two_theta_max) {
+        std::cerr << "Error: 2theta range must satisfy 0 <= min < max <= 180!\n";
+        return false;
+    }
+    if (step <= 0 || fwhm <= 0 || options.merge_tolerance < 0) {
+        std::cerr << "Error: step and FWHM must be positive, merge tolerance non-negative!\n";
+        return false;
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  poscar_xrd [options]\n\n"
+                 "Options:\n"
+                 "  --input      POSCAR file name (default: POSCAR)\n"
+                 "  --input-dir  batch mode: every file of this directory starting with --prefix\n"
+                 "  --prefix     file name prefix in batch mode (default: POSCAR)\n"
+                 "  --output-dir directory for <name>_xrd_peaks.txt and <name>_xrd_pattern.txt (default: .)\n"
+                 "  --wavelength X-ray wavelength in Angstrom (default: 1.54184, Cu K-alpha)\n"
+                 "  --two-theta-min lower 2theta limit in degrees (default: 5)\n"
+                 "  --two-theta-max upper 2theta limit in degrees (default: 90)\n"
+                 "  --step       2theta step of the broadened pattern (default: 0.02)\n"
+                 "  --fwhm       Gaussian peak width of the broadened pattern, degrees (default: 0.1)\n"
+                 "  --merge-tol  reflections closer than this in 2theta form one peak (default: 1e-3)\n"
+                 "  --min-intensity drop peaks weaker than this percentage of the strongest (default: 1e-3)\n"
+                 "  --threads    number of worker threads (default: all cores)\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
+                 "  --help       show this help message\n\n"
+                 "Example:\n"
+                 "  poscar_xrd --input-dir candidates --prefix POSCAR_enum --two-theta-max 70\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputFile{"POSCAR"};
+    std::string inputDir;
+    std::string prefix{"POSCAR"};
+    std::string outputDir{"."};
+    XrdOptions options;
+    double step{0.02};
+    double fwhm{0.1};
+
+    if (!readInput(argc, argv, inputFile, inputDir, prefix, outputDir, options, step, fwhm))
+        return 1;
+
+    if (!validateInput(inputFile, inputDir, options, step, fwhm))
+        return 1;
+
+    std::vector<std::string> files;
+    if (inputDir.empty()) {
+        files.push_back(inputFile);
+    } else {
+        for (const auto& entry : fs::directory_iterator(inputDir)) {
+            if (entry.is_regular_file() && entry.path().filename().string().rfind(prefix, 0) == 0)
+                files.push_back(entry.path().string());
+        }
+        std::sort(files.begin(), files.end());
+        if (files.empty()) {
+            std::cerr << "Error: no files starting with \"" << prefix << "\" in " << inputDir << "\n";
+            return 1;
+        }
+    }
+    std::error_code ec;
+    fs::create_directories(outputDir, ec);
+    if (ec) {
+        std::cerr << "Error: cannot create directory " << outputDir << ": " << ec.message() << "\n";
+        return 1;
+    }
+
+    // A single structure uses all threads over reflections, a batch runs one structure per thread
+    const int threads = options.threads;
+    if (files.size() > 1)
+        options.threads = 1;
+
+    std::mutex warning_mutex;
+    std::set<std::string> warned;
+    std::vector<char> valid(files.size(), 0);
+    {
+        ScopedTimer phase("xrd", 0);
+        parallelFor(files.size(), files.size() > 1 ? threads : 1, [&](size_t f) {
+            POSCAR poscar;
+            if (!poscar.readPOSCAR(files[f]))
+                return;
+
+            std::vector<FormFactor> factors(poscar.elements.size());
+            for (size_t e = 0; e < poscar.elements.size(); ++e) {
+                std::string substitute;
+                if (!formFactor(poscar.elements[e], factors[e], substitute)) {
+                    std::lock_guard<std::mutex> lock(warning_mutex);
+                    std::cerr << "Error: unknown element " << poscar.elements[e] << " in " << files[f] << "\n";
+                    return;
+                }
+                if (!substitute.empty()) {
+                    std::lock_guard<std::mutex> lock(warning_mutex);
+                    if (warned.insert(poscar.elements[e]).second)
+                        std::cerr << "Warning: no form factor for " << poscar.elements[e] << ", using " << substitute
+                                  << " scaled by atomic number.\n";
+                }
+            }
+
+            std::vector<XrdPeak> peaks = simulateXrd(poscar, factors, options);
+            std::vector<double> pattern =
+                broadenPattern(peaks, options.two_theta_min, options.two_theta_max, step, fwhm);
+
+            const std::string stem = (fs::path(outputDir) / fs::path(files[f]).filename()).string();
+            std::ofstream out(stem + "_xrd_peaks.txt");
+            out << "# 2theta  d_A  intensity  h k l  multiplicity\n";
+            out << std::fixed;
+            for (const auto& p : peaks)
+                out << std::setprecision(4) << p.two_theta << " " << std::setprecision(5) << p.d_spacing << " "
+                    << std::setprecision(3) << p.intensity << " " << p.hkl[0] << " " << p.hkl[1] << " " << p.hkl[2]
+                    << " " << p.multiplicity << "\n";
+
+            std::ofstream xy(stem + "_xrd_pattern.txt");
+            xy << "# 2theta  intensity\n";
+            xy << std::fixed;
+            for (size_t i = 0; i < pattern.size(); ++i)
+                xy << std::setprecision(3) << options.two_theta_min + i * step << " " << std::setprecision(4)
+                   << pattern[i] << "\n";
+
+            out.close();
+            xy.close();
+            if (!out || !xy) {
+                std::lock_guard<std::mutex> lock(warning_mutex);
+                std::cerr << "Error: failed to write " << stem << (out ? "_xrd_pattern.txt" : "_xrd_peaks.txt") << "\n";
+                return;
+            }
+            valid[f] = 1;
+        });
+    }
+
+    size_t written = 0;
+    for (size_t f = 0; f < files.size(); ++f) {
+        if (valid[f])
+            written++;
+        else
+            std::cerr << "Warning: skipping file " << files[f] << "\n";
+    }
+    std::cout << "Patterns written: " << written << " to " << outputDir << "\n";
+
+    return written == files.size() ? 0 : 1;
+}
@@ -0,0 +1,321 @@
+#include "random_structure.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+
+#include "lattice_utility.h"
+#include "poscar_file.h"
+
+namespace {
+
+using Point = std::array<double, 3>;
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kSameSite = 1e-3;  // Angstrom; orbit images closer than this are one site
+
+enum class LatticeFamily { Triclinic, Monoclinic, Orthorhombic, Tetragonal, Hexagonal, Cubic };
+
+LatticeFamily latticeFamily(int spacegroup) {
+    if (spacegroup <= 2)
+        return LatticeFamily::Triclinic;
+    if (spacegroup <= 15)
+        return LatticeFamily::Monoclinic;
+    if (spacegroup <= 74)
+        return LatticeFamily::Orthorhombic;
+    if (spacegroup <= 142)
+        return LatticeFamily::Tetragonal;
+    if (spacegroup <= 194)
+        return LatticeFamily::Hexagonal;  // trigonal groups in hexagonal axes
+    return LatticeFamily::Cubic;
+}
+
+// Random cell of the family (standard orientation, monoclinic unique axis b) scaled to volume; false for a
+// nearly flat shape
+bool randomLattice(LatticeFamily family, double volume, std::mt19937_64& rng, double lattice[3][3]) {
+    std::uniform_real_distribution<double> length(1.0, 2.0);
+    std::uniform_real_distribution<double> angle(60.0, 120.0);
+    double a = length(rng), b = length(rng), c = length(rng);
+    double alpha = 90.0, beta = 90.0, gamma = 90.0;
+    switch (family) {
+        case LatticeFamily::Triclinic:
+            alpha = angle(rng);
+            beta = angle(rng);
+            gamma = angle(rng);
+            break;
+        case LatticeFamily::Monoclinic:
+            beta = angle(rng);
+            break;
+        case LatticeFamily::Orthorhombic:
+            break;
+        case LatticeFamily::Tetragonal:
+            b = a;
+            break;
+        case LatticeFamily::Hexagonal:
+            b = a;
+            gamma = 120.0;
+            break;
+        case LatticeFamily::Cubic:
+            b = c = a;
+            break;
+    }
+
+    const double ca = std::cos(alpha * kPi / 180.0), cb = std::cos(beta * kPi / 180.0);
+    const double cg = std::cos(gamma * kPi / 180.0), sg = std::sin(gamma * kPi / 180.0);
+    const double shape = 1.0 - ca * ca - cb * cb - cg * cg + 2.0 * ca * cb * cg;
+    if (shape < 0.1)
+        return false;
+
+    const double cell[3][3] = {{a, 0.0, 0.0},
+                               {b * cg, b * sg, 0.0},
+                               {c * cb, c * (ca - cb * cg) / sg, c * std::sqrt(shape) / sg}};
+    const double scale = std::cbrt(volume / cellVolume(cell));
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            lattice[i][j] = cell[i][j] * scale;
+    return true;
+}
+
+Point applyOperation(const SymmetryOperation& op, const Point& x) {
+    Point y;
+    for (int i = 0; i < 3; ++i)
+        y[i] = op.rotation[i][0] * x[0] + op.rotation[i][1] * x[1] + op.rotation[i][2] * x[2] + op.translation[i];
+    return y;
+}
+
+double distance(const double lattice[3][3], const Point& a, const Point& b) {
+    const double delta[3] = {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+    return minimumImageDistance(lattice, delta);
+}
+
+// Length of the fractional difference reduced to [-0.5, 0.5), which is the minimum image for the short
+// separations compared here
+double shortLength(const double lattice[3][3], const double frac_delta[3]) {
+    double d[3], cart[3];
+    for (int i = 0; i < 3; ++i)
+        d[i] = frac_delta[i] - std::round(frac_delta[i]);
+    fractionalToCartesian(lattice, d, cart);
+    return std::sqrt(cart[0] * cart[0] + cart[1] * cart[1] + cart[2] * cart[2]);
+}
+
+// Orbit of x under the operations. Images closer to x than merge are first averaged into x, repeatedly,
+// which moves x onto the special position they surround. False if the orbit has more than max_sites sites
+// or the images do not form a proper orbit (every site reached equally often), e.g. when merging did not
+// settle.
+bool symmetrizedOrbit(Point x, const std::vector<SymmetryOperation>& operations, const double lattice[3][3],
+                      double merge, size_t max_sites, std::vector<Point>& orbit) {
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        double shift[3] = {0.0, 0.0, 0.0};
+        int cluster = 0;
+        for (const auto& op : operations) {
+            const Point y = applyOperation(op, x);
+            double delta[3];
+            for (int i = 0; i < 3; ++i)
+                delta[i] = y[i] - x[i] - std::round(y[i] - x[i]);
+            if (shortLength(lattice, delta) < merge) {
+                for (int i = 0; i < 3; ++i)
+                    shift[i] += delta[i];
+                ++cluster;
+            }
+        }
+        if (cluster <= 1)
+            break;
+        for (int i = 0; i < 3; ++i) {
+            shift[i] /= cluster;
+            x[i] += shift[i];
+        }
+        if (shortLength(lattice, shift) < kSameSite * 1e-3)
+            break;
+    }
+
+    orbit.clear();
+    std::vector<int> hits;
+    for (const auto& op : operations) {
+        Point y = applyOperation(op, x);
+        for (double& v : y)
+            v = wrapFractional(v);
+        size_t site = 0;
+        for (; site < orbit.size(); ++site) {
+            const double delta[3] = {y[0] - orbit[site][0], y[1] - orbit[site][1], y[2] - orbit[site][2]};
+            if (shortLength(lattice, delta) < kSameSite)
+                break;
+        }
+        if (site == orbit.size()) {
+            if (orbit.size() == max_sites)
+                return false;
+            orbit.push_back(y);
+            hits.push_back(0);
+        }
+        ++hits[site];
+    }
+    return std::all_of(hits.begin(), hits.end(), [&](int h) { return h == hits[0]; }) &&
+           static_cast<size_t>(hits[0]) * orbit.size() == operations.size();
+}
+
+// Incremental cell list over the fractional cube. Bins are at least cutoff thick in every direction, so two
+// atoms closer than cutoff always sit in the same or neighbouring bins (periodically).
+class SpatialHash {
+public:
+    SpatialHash(const double lattice[3][3], double cutoff) {
+        double heights[3];
+        perpendicularHeights(lattice, heights);
+        for (int k = 0; k < 3; ++k)
+            n_[k] = std::clamp(static_cast<int>(heights[k] / cutoff), 1, 32);
+        bins_.assign(static_cast<size_t>(n_[0]) * n_[1] * n_[2], {});
+    }
+
+    void insert(int atom, const Point& frac) {
+        int b[3];
+        binOf(frac, b);
+        bins_[index(b[0], b[1], b[2])].push_back(atom);
+    }
+
+    // Calls visit(atom) for every atom in the bins around frac until visit returns false
+    template <typename Visit>
+    bool forEachNear(const Point& frac, Visit&& visit) const {
+        int b[3];
+        binOf(frac, b);
+        int around[3][3];
+        int count[3];
+        for (int k = 0; k < 3; ++k) {
+            count[k] = std::min(n_[k], 3);
+            for (int d = 0; d < count[k]; ++d)
+                around[k][d] = (b[k] + d - 1 + n_[k]) % n_[k];
+        }
+        for (int i = 0; i < count[0]; ++i)
+            for (int j = 0; j < count[1]; ++j)
+                for (int k = 0; k < count[2]; ++k)
+                    for (int atom : bins_[index(around[0][i], around[1][j], around[2][k])])
+                        if (!visit(atom))
+                            return false;
+        return true;
+    }
+
+private:
+    void binOf(const Point& frac, int b[3]) const {
+        for (int k = 0; k < 3; ++k)
+            b[k] = std::min(static_cast<int>(frac[k] * n_[k]), n_[k] - 1);
+    }
+    size_t index(int i, int j, int k) const {
+        return (static_cast<size_t>(i) * n_[1] + j) * n_[2] + k;
+    }
+
+    int n_[3];
+    std::vector<std::vector<int>> bins_;
+};
+
+}  // namespace
+
+std::uint64_t candidateSeed(std::uint64_t seed, std::uint64_t index) {
+    std::uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+bool generateRandomStructure(const RandomStructureOptions& options, std::uint64_t seed, POSCAR& out,
+                             int* spacegroup) {
+    const size_t n_species = options.composition.size();
+    if (n_species == 0 || options.min_volume <= 0.0 || options.max_volume < options.min_volume)
+        return false;
+
+    // Minimum distance of every species pair; the largest one sizes the hash bins
+    std::vector<double> pair(n_species * n_species, options.min_distance);
+    double cutoff = options.min_distance;
+    for (size_t s = 0; s < n_species; ++s)
+        for (size_t t = 0; t < n_species; ++t) {
+            auto key = std::minmax(options.composition[s].first, options.composition[t].first);
+            auto it = options.pair_distance.find({key.first, key.second});
+            if (it != options.pair_distance.end())
+                pair[s * n_species + t] = it->second;
+            cutoff = std::max(cutoff, pair[s * n_species + t]);
+        }
+    if (cutoff <= 0.0)
+        return false;
+
+    static const std::vector<SymmetryOperation> identity = {{{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}, {0.0, 0.0, 0.0}}};
+
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<Point> positions;
+    std::vector<int> types;
+    std::vector<Point> orbit;
+
+    for (int cell_attempt = 0; cell_attempt < options.cell_attempts; ++cell_attempt) {
+        const SpaceGroupChoice* group = nullptr;
+        if (!options.spacegroups.empty()) {
+            std::uniform_int_distribution<size_t> pick(0, options.spacegroups.size() - 1);
+            group = &options.spacegroups[pick(rng)];
+        }
+        const std::vector<SymmetryOperation>& operations = group ? group->operations : identity;
+        const int number = group ? group->number : 1;
+
+        double lattice[3][3];
+        const double volume = options.min_volume + (options.max_volume - options.min_volume) * unit(rng);
+        if (!randomLattice(latticeFamily(number), volume, rng, lattice))
+            continue;
+        // An atom must also keep its distance from its own periodic images
+        double heights[3];
+        perpendicularHeights(lattice, heights);
+        if (*std::min_element(heights, heights + 3) < cutoff)
+            continue;
+
+        SpatialHash hash(lattice, cutoff);
+        positions.clear();
+        types.clear();
+        bool complete = true;
+        for (size_t s = 0; s < n_species && complete; ++s) {
+            int remaining = options.composition[s].second;
+            for (int attempt = 0; remaining > 0 && attempt < options.placement_attempts; ++attempt) {
+                const Point x = {unit(rng), unit(rng), unit(rng)};
+                if (!symmetrizedOrbit(x, operations, lattice, pair[s * n_species + s], remaining, orbit))
+                    continue;
+
+                bool fits = true;
+                for (size_t i = 1; i < orbit.size() && fits; ++i)
+                    fits = distance(lattice, orbit[0], orbit[i]) >= pair[s * n_species + s];
+                for (size_t i = 0; i < orbit.size() && fits; ++i) {
+                    fits = hash.forEachNear(orbit[i], [&](int atom) {
+                        return distance(lattice, orbit[i], positions[atom]) >= pair[s * n_species + types[atom]];
+                    });
+                }
+                if (!fits)
+                    continue;
+
+                for (const Point& p : orbit) {
+                    hash.insert(static_cast<int>(positions.size()), p);
+                    positions.push_back(p);
+                    types.push_back(static_cast<int>(s));
+                }
+                remaining -= static_cast<int>(orbit.size());
+                attempt = -1;  // the attempt budget is per orbit
+            }
+            complete = remaining == 0;
+        }
+        if (!complete)
+            continue;
+
+        out = POSCAR();
+        out.comment.clear();
+        for (const auto& [element, count] : options.composition) {
+            out.comment += element + std::to_string(count);
+            out.elements.push_back(element);
+            out.num_atoms.push_back(count);
+        }
+        out.comment += " random structure, space group " + std::to_string(number);
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                out.lattice[i][j] = lattice[i][j];
+        out.is_direct = true;
+        out.total_atoms = static_cast<int>(positions.size());
+        out.coordinates.reserve(positions.size());
+        for (const Point& p : positions)
+            out.coordinates.push_back({p[0], p[1], p[2]});
+        out.updateSpecies();
+        if (spacegroup)
+            *spacegroup = number;
+        return true;
+    }
+    return false;
+}
@@ -1,8 +1,8 @@
 #include "random_utility.h"
 
-// Single RNG engine for the whole program
-static std::random_device rd;
-static std::mt19937 gen(rd());
+// One RNG engine per thread, so concurrent requests in vasp_utilsd do not share state;
+// seedRandom reseeds the engine of the calling thread
+static thread_local std::mt19937 gen(std::random_device{}());
 
 double randomDouble(double min, double max) {
     std::uniform_real_distribution<double> dist(min, max);
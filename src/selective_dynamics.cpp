@@ -0,0 +1,72 @@
+#include "selective_dynamics.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "lattice_utility.h"
+#include "neighbor_list.h"
+
+std::vector<int> atomsInSurfaceRegion(const POSCAR& poscar, int axis, double thickness, bool top) {
+    POSCAR direct = poscar;
+    direct.toDirect();
+
+    std::vector<int> atoms;
+    const int n = static_cast<int>(direct.coordinates.size());
+    if (n == 0)
+        return atoms;
+
+    double heights[3];
+    perpendicularHeights(direct.lattice, heights);
+    const double h = heights[axis];
+
+    std::vector<double> f(n);
+    for (int i = 0; i < n; ++i) {
+        const Atom& a = direct.coordinates[i];
+        f[i] = wrapFractional(axis == 0 ? a.x : axis == 1 ? a.y : a.z);
+    }
+
+    // The vacuum is the largest gap between consecutive atoms (cyclically); the slab starts above it
+    std::vector<double> sorted = f;
+    std::sort(sorted.begin(), sorted.end());
+    double bottom = sorted.front(), gap = sorted.front() + 1.0 - sorted.back();
+    for (int i = 1; i < n; ++i)
+        if (sorted[i] - sorted[i - 1] > gap) {
+            gap = sorted[i] - sorted[i - 1];
+            bottom = sorted[i];
+        }
+    const double extent = 1.0 - gap;  // fractional slab thickness
+
+    for (int i = 0; i < n; ++i) {
+        const double above = wrapFractional(f[i] - bottom) * h;  // Angstrom above the bottom surface
+        const double depth = top ? extent * h - above : above;
+        if (depth <= thickness + 1e-8)
+            atoms.push_back(i);
+    }
+    return atoms;
+}
+
+std::vector<int> atomsOutsideSphere(const POSCAR& poscar, const double center[3], double radius) {
+    POSCAR direct = poscar;
+    direct.toDirect();
+
+    const int n = static_cast<int>(direct.coordinates.size());
+    std::vector<char> inside(n, 0);
+    PeriodicCellIndex index(direct.lattice, direct.coordinates, std::max(radius, 1.0));
+    double point[3];
+    fractionalToCartesian(direct.lattice, center, point);
+    index.forEachWithin(point, radius, [&](int atom, double) { inside[atom] = 1; });
+
+    std::vector<int> atoms;
+    for (int i = 0; i < n; ++i)
+        if (!inside[i])
+            atoms.push_back(i);
+    return atoms;
+}
+
+void freezeAtoms(POSCAR& poscar, const std::vector<int>& atoms, std::uint8_t fixed) {
+    if (!poscar.selective_dynamics || poscar.selective_flags.size() != poscar.coordinates.size())
+        poscar.selective_flags.assign(poscar.coordinates.size(), kMoveAll);
+    poscar.selective_dynamics = true;
+    for (int atom : atoms)
+        poscar.selective_flags[atom] &= static_cast<std::uint8_t>(~fixed);
+}
@@ -0,0 +1,241 @@
+#include "slab.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+
+#include "lattice_utility.h"
+#include "structure_utility.h"
+
+namespace {
+
+// g = gcd(a, b) = x a + y b
+int extendedGcd(int a, int b, int& x, int& y) {
+    if (b == 0) {
+        x = a >= 0 ? 1 : -1;
+        y = 0;
+        return std::abs(a);
+    }
+    int x1, y1;
+    int g = extendedGcd(b, a % b, x1, y1);
+    x = y1;
+    y = x1 - (a / b) * y1;
+    return g;
+}
+
+double dot3(const double a[3], const double b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+void rowToCartesian(const int row[3], const double lattice[3][3], double out[3]) {
+    for (int j = 0; j < 3; ++j)
+        out[j] = row[0] * lattice[0][j] + row[1] * lattice[1][j] + row[2] * lattice[2][j];
+}
+
+int determinant(const int m[3][3]) {
+    return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+           m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+}
+
+void surfaceNormal(const double lattice[3][3], double normal[3]) {
+    normal[0] = lattice[0][1] * lattice[1][2] - lattice[0][2] * lattice[1][1];
+    normal[1] = lattice[0][2] * lattice[1][0] - lattice[0][0] * lattice[1][2];
+    normal[2] = lattice[0][0] * lattice[1][1] - lattice[0][1] * lattice[1][0];
+    const double norm = std::sqrt(dot3(normal, normal));
+    for (int j = 0; j < 3; ++j)
+        normal[j] /= norm;
+}
+
+}  // namespace
+
+bool millerTransform(const int hkl_in[3], int transform[3][3]) {
+    int common = std::gcd(std::gcd(std::abs(hkl_in[0]), std::abs(hkl_in[1])), std::abs(hkl_in[2]));
+    if (common == 0)
+        return false;
+    const int h = hkl_in[0] / common, k = hkl_in[1] / common, l = hkl_in[2] / common;
+
+    int v[3][3];
+    if (h == 0 && k == 0) {
+        const int rows[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, l}};
+        std::copy(&rows[0][0], &rows[0][0] + 9, &v[0][0]);
+    } else {
+        // p h + q k = g, then r g + s l = 1 (gcd(g, l) = 1 after the reduction above)
+        int p, q, r, s;
+        const int g = extendedGcd(h, k, p, q);
+        extendedGcd(g, l, r, s);
+        const int rows[3][3] = {{k / g, -h / g, 0}, {p * l, q * l, -g}, {r * p, r * q, s}};
+        std::copy(&rows[0][0], &rows[0][0] + 9, &v[0][0]);
+    }
+
+    if (determinant(v) < 0)
+        for (int j = 0; j < 3; ++j)
+            std::swap(v[0][j], v[1][j]);
+
+    std::copy(&v[0][0], &v[0][0] + 9, &transform[0][0]);
+    return true;
+}
+
+bool orientedCell(const POSCAR& bulk, const int hkl[3], POSCAR& oriented) {
+    int t[3][3];
+    if (!millerTransform(hkl, t))
+        return false;
+
+    POSCAR direct = bulk;
+    direct.toDirect();
+
+    // Gauss reduction of the in-plane vectors
+    double a[3], b[3];
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        rowToCartesian(t[0], direct.lattice, a);
+        rowToCartesian(t[1], direct.lattice, b);
+        if (dot3(b, b) < dot3(a, a) - 1e-10) {
+            std::swap(t[0], t[1]);
+            continue;
+        }
+        const int mu = static_cast<int>(std::lround(dot3(a, b) / dot3(a, a)));
+        if (mu == 0)
+            break;
+        for (int j = 0; j < 3; ++j)
+            t[1][j] -= mu * t[0][j];
+    }
+
+    // Remove the in-plane part of c as far as lattice vectors allow
+    rowToCartesian(t[0], direct.lattice, a);
+    rowToCartesian(t[1], direct.lattice, b);
+    double c[3];
+    rowToCartesian(t[2], direct.lattice, c);
+    const double aa = dot3(a, a), bb = dot3(b, b), ab = dot3(a, b);
+    const double ca = dot3(c, a), cb = dot3(c, b);
+    const double det = aa * bb - ab * ab;
+    const int alpha = static_cast<int>(std::lround((ca * bb - cb * ab) / det));
+    const int beta = static_cast<int>(std::lround((cb * aa - ca * ab) / det));
+    for (int j = 0; j < 3; ++j)
+        t[2][j] -= alpha * t[0][j] + beta * t[1][j];
+
+    if (determinant(t) < 0)
+        for (int j = 0; j < 3; ++j)
+            std::swap(t[0][j], t[1][j]);
+
+    oriented = makeSupercell(direct, t);
+    return oriented.total_atoms == direct.total_atoms;
+}
+
+SlabLayers findLayers(const POSCAR& oriented, double tolerance) {
+    POSCAR direct = oriented;
+    direct.toDirect();
+
+    double normal[3];
+    surfaceNormal(direct.lattice, normal);
+
+    SlabLayers layers;
+    layers.repeat = dot3(direct.lattice[2], normal);
+
+    // a and b lie in the plane, so the height is the c fraction times the repeat
+    const int n = direct.total_atoms;
+    std::vector<double> z(n);
+    std::vector<int> order(n);
+    for (int i = 0; i < n; ++i) {
+        z[i] = wrapFractional(direct.coordinates[i].z) * layers.repeat;
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](int x, int y) { return z[x] < z[y]; });
+
+    layers.atom_layer.assign(n, 0);
+    std::vector<double> sum;
+    std::vector<int> count;
+    double previous = -1e30;
+    for (int i : order) {
+        if (z[i] - previous > tolerance) {
+            sum.push_back(0.0);
+            count.push_back(0);
+        }
+        previous = z[i];
+        layers.atom_layer[i] = static_cast<int>(sum.size()) - 1;
+        sum.back() += z[i];
+        count.back()++;
+    }
+
+    // A layer split by the periodic boundary: fold the top group into the bottom one
+    if (sum.size() > 1 && z[order.front()] + layers.repeat - z[order.back()] <= tolerance) {
+        const int top = static_cast<int>(sum.size()) - 1;
+        for (int i = 0; i < n; ++i)
+            if (layers.atom_layer[i] == top) {
+                layers.atom_layer[i] = 0;
+                sum[0] += z[i] - layers.repeat;
+                count[0]++;
+            }
+        sum.pop_back();
+        count.pop_back();
+    }
+
+    for (size_t l = 0; l < sum.size(); ++l)
+        layers.height.push_back(sum[l] / count[l]);
+    return layers;
+}
+
+POSCAR buildSlab(const POSCAR& oriented, const SlabLayers& layers, int termination, int n_cells, double vacuum) {
+    POSCAR direct = oriented;
+    direct.toDirect();
+
+    double normal[3];
+    surfaceNormal(direct.lattice, normal);
+    const double d = layers.repeat;
+    const double thickness = n_cells * d;
+
+    double slab_lattice[3][3];
+    for (int j = 0; j < 3; ++j) {
+        slab_lattice[0][j] = direct.lattice[0][j];
+        slab_lattice[1][j] = direct.lattice[1][j];
+        slab_lattice[2][j] = normal[j] * (thickness + vacuum);
+    }
+    double slab_inverse[3][3];
+    invert3(slab_lattice, slab_inverse);
+
+    // Heights are measured from just below the termination layer; atoms of lower layers move one repeat up
+    const double base = layers.height[termination] - 1e-6;
+    std::vector<std::string> species = atomSpecies(direct);
+    std::vector<std::string> slab_species;
+    std::vector<Atom> slab_coordinates;
+    double lowest = 1e30, highest = -1e30;
+
+    struct Placed {
+        double r[3];
+        double height;
+        int atom;
+    };
+    std::vector<Placed> placed;
+    for (int i = 0; i < direct.total_atoms; ++i) {
+        const double f[3] = {direct.coordinates[i].x, direct.coordinates[i].y, wrapFractional(direct.coordinates[i].z)};
+        double r[3];
+        fractionalToCartesian(direct.lattice, f, r);
+
+        // Layer height decides the image, so atoms of one layer stay together even when it straddles c = 0
+        double layer_height = layers.height[layers.atom_layer[i]];
+        double atom_height = dot3(r, normal);
+        int shift = static_cast<int>(std::floor((layer_height - base) / d));
+        for (int m = 0; m < n_cells; ++m) {
+            Placed p;
+            for (int j = 0; j < 3; ++j)
+                p.r[j] = r[j] + (m - shift) * direct.lattice[2][j];
+            p.height = atom_height + (m - shift) * d - base;
+            p.atom = i;
+            lowest = std::min(lowest, p.height);
+            highest = std::max(highest, p.height);
+            placed.push_back(p);
+        }
+    }
+
+    // Centre the slab along c
+    const double offset = 0.5 * (thickness + vacuum) - 0.5 * (lowest + highest);
+    for (const Placed& p : placed) {
+        double s[3];
+        cartesianToFractional(slab_inverse, p.r, s);
+        slab_coordinates.push_back(
+            {wrapFractional(s[0]), wrapFractional(s[1]), (p.height + offset) / (thickness + vacuum)});
+        slab_species.push_back(species[p.atom]);
+    }
+
+    return buildPOSCAR(direct.comment, slab_lattice, slab_species, slab_coordinates, direct.elements);
+}
@@ -0,0 +1,288 @@
+#include "sqs.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "lattice_utility.h"
+#include "neighbor_list.h"
+#include "parallel_utility.h"
+
+namespace {
+
+constexpr double kShellTolerance = 1e-3;  // Angstrom
+
+int shellOf(const std::vector<double>& shells, double d) {
+    for (size_t s = 0; s < shells.size(); ++s)
+        if (std::abs(d - shells[s]) <= kShellTolerance)
+            return static_cast<int>(s);
+    return -1;
+}
+
+double objective(const std::vector<double>& pair, const std::vector<double>& triplet, double m) {
+    double value = 0.0;
+    for (double p : pair)
+        value += std::abs(p - m * m);
+    for (double t : triplet)
+        value += std::abs(t - m * m * m);
+    return value;
+}
+
+}  // namespace
+
+SqsModel::SqsModel(const POSCAR& supercell, const std::vector<int>& active_sites, int pair_shells,
+                   int triplet_shells)
+    : n_sites_(static_cast<int>(active_sites.size())) {
+    POSCAR direct = supercell;
+    direct.toDirect();
+
+    std::vector<Atom> sites;
+    sites.reserve(active_sites.size());
+    for (int i : active_sites)
+        sites.push_back(direct.coordinates[i]);
+
+    if (n_sites_ < 2 || pair_shells <= 0)
+        return;
+    triplet_shells = std::min(triplet_shells, pair_shells);
+
+    // Grow the cutoff until enough distinct site-site distances are seen
+    double heights[3];
+    perpendicularHeights(direct.lattice, heights);
+    double cutoff = 1.2 * std::cbrt(cellVolume(direct.lattice) / n_sites_);
+    const double max_cutoff = 4.0 * std::max({heights[0], heights[1], heights[2]});
+
+    std::vector<std::vector<Neighbor>> neighbors(n_sites_);
+    while (true) {
+        PeriodicCellIndex index(direct.lattice, sites, cutoff);
+        shell_distances_.clear();
+        for (int i = 0; i < n_sites_; ++i) {
+            neighbors[i].clear();
+            const double f[3] = {sites[i].x, sites[i].y, sites[i].z};
+            double r[3];
+            fractionalToCartesian(direct.lattice, f, r);
+            index.forEachWithin(r, cutoff, [&](int j, double d) {
+                if (j != i)
+                    neighbors[i].push_back({j, d});
+            });
+            for (const auto& nb : neighbors[i])
+                if (shellOf(shell_distances_, nb.distance) < 0)
+                    shell_distances_.push_back(nb.distance);
+        }
+        std::sort(shell_distances_.begin(), shell_distances_.end());
+        if (static_cast<int>(shell_distances_.size()) > pair_shells || cutoff > max_cutoff)
+            break;
+        cutoff *= 1.3;
+    }
+    if (static_cast<int>(shell_distances_.size()) > pair_shells)
+        shell_distances_.resize(pair_shells);
+
+    double min_height = std::min({heights[0], heights[1], heights[2]});
+    if (!shell_distances_.empty() && shell_distances_.back() > 0.5 * min_height)
+        std::cerr << "Warning: outermost pair shell exceeds half of the supercell height, correlations include "
+                     "periodic images of the same pair.\n";
+
+    const int n_pair = static_cast<int>(shell_distances_.size());
+    pair_offsets_.assign(n_pair, std::vector<int>(n_sites_ + 1, 0));
+    pair_indices_.assign(n_pair, {});
+    pair_terms_.assign(n_pair, 0.0);
+
+    for (int s = 0; s < n_pair; ++s) {
+        for (int i = 0; i < n_sites_; ++i) {
+            for (const auto& nb : neighbors[i])
+                if (shellOf(shell_distances_, nb.distance) == s)
+                    pair_indices_[s].push_back(nb.index);
+            pair_offsets_[s][i + 1] = static_cast<int>(pair_indices_[s].size());
+        }
+        pair_terms_[s] = static_cast<double>(pair_indices_[s].size());
+    }
+
+    // Minimum-image shell of every pair of sites, for the triangle edges
+    const int n_trip = std::min(triplet_shells, n_pair);
+    std::map<std::pair<int, int>, int> pair_shell;
+    for (int i = 0; i < n_sites_; ++i)
+        for (const auto& nb : neighbors[i]) {
+            int s = shellOf(shell_distances_, nb.distance);
+            if (s < 0 || s >= n_trip)
+                continue;
+            auto key = std::make_pair(std::min(i, nb.index), std::max(i, nb.index));
+            auto it = pair_shell.find(key);
+            if (it == pair_shell.end() || s < it->second)
+                pair_shell[key] = s;
+        }
+
+    std::vector<std::vector<std::vector<int>>> incident(n_trip, std::vector<std::vector<int>>(n_sites_));
+    triplet_terms_.assign(n_trip, 0.0);
+
+    std::vector<std::vector<int>> close(n_sites_);
+    for (const auto& [key, s] : pair_shell) {
+        close[key.first].push_back(key.second);
+        close[key.second].push_back(key.first);
+    }
+
+    for (int a = 0; a < n_sites_; ++a) {
+        for (int b : close[a]) {
+            if (b <= a)
+                continue;
+            for (int c : close[a]) {
+                if (c <= b)
+                    continue;
+                auto bc = pair_shell.find(std::make_pair(b, c));
+                if (bc == pair_shell.end())
+                    continue;
+                int t = std::max({pair_shell[{a, b}], pair_shell[{a, c}], bc->second});
+                triplet_terms_[t] += 1.0;
+                incident[t][a].insert(incident[t][a].end(), {b, c});
+                incident[t][b].insert(incident[t][b].end(), {a, c});
+                incident[t][c].insert(incident[t][c].end(), {a, b});
+            }
+        }
+    }
+
+    triplet_offsets_.assign(n_trip, std::vector<int>(n_sites_ + 1, 0));
+    triplet_partners_.assign(n_trip, {});
+    for (int t = 0; t < n_trip; ++t) {
+        for (int i = 0; i < n_sites_; ++i) {
+            triplet_partners_[t].insert(triplet_partners_[t].end(), incident[t][i].begin(), incident[t][i].end());
+            triplet_offsets_[t][i + 1] = static_cast<int>(triplet_partners_[t].size());
+        }
+    }
+}
+
+void SqsModel::clusterSums(const std::vector<signed char>& spins, std::vector<double>& pair_sums,
+                           std::vector<double>& triplet_sums) const {
+    pair_sums.assign(pair_offsets_.size(), 0.0);
+    triplet_sums.assign(triplet_offsets_.size(), 0.0);
+
+    for (size_t s = 0; s < pair_offsets_.size(); ++s)
+        for (int i = 0; i < n_sites_; ++i)
+            for (int k = pair_offsets_[s][i]; k < pair_offsets_[s][i + 1]; ++k)
+                pair_sums[s] += spins[i] * spins[pair_indices_[s][k]];
+
+    // Every triplet is listed once per member site
+    for (size_t t = 0; t < triplet_offsets_.size(); ++t) {
+        for (int i = 0; i < n_sites_; ++i)
+            for (int k = triplet_offsets_[t][i]; k < triplet_offsets_[t][i + 1]; k += 2)
+                triplet_sums[t] += spins[i] * spins[triplet_partners_[t][k]] * spins[triplet_partners_[t][k + 1]];
+        triplet_sums[t] /= 3.0;
+    }
+}
+
+void SqsModel::applyFlip(const std::vector<signed char>& spins, int site, std::vector<double>& pair_sums,
+                         std::vector<double>& triplet_sums) const {
+    const int si = spins[site];
+
+    for (size_t s = 0; s < pair_offsets_.size(); ++s) {
+        int field = 0;
+        const int* idx = pair_indices_[s].data();
+        for (int k = pair_offsets_[s][site]; k < pair_offsets_[s][site + 1]; ++k)
+            field += spins[idx[k]];
+        // The pair (i, j) appears in the lists of both i and j
+        pair_sums[s] -= 4.0 * si * field;
+    }
+
+    for (size_t t = 0; t < triplet_offsets_.size(); ++t) {
+        int field = 0;
+        const int* partners = triplet_partners_[t].data();
+        for (int k = triplet_offsets_[t][site]; k < triplet_offsets_[t][site + 1]; k += 2)
+            field += spins[partners[k]] * spins[partners[k + 1]];
+        triplet_sums[t] -= 2.0 * si * field;
+    }
+}
+
+void SqsModel::correlations(const std::vector<double>& pair_sums, const std::vector<double>& triplet_sums,
+                            std::vector<double>& pair, std::vector<double>& triplet) const {
+    pair.resize(pair_sums.size());
+    triplet.resize(triplet_sums.size());
+    for (size_t s = 0; s < pair_sums.size(); ++s)
+        pair[s] = pair_terms_[s] > 0 ? pair_sums[s] / pair_terms_[s] : 0.0;
+    for (size_t t = 0; t < triplet_sums.size(); ++t)
+        triplet[t] = triplet_terms_[t] > 0 ? triplet_sums[t] / triplet_terms_[t] : 0.0;
+}
+
+SqsResult runSqs(const SqsModel& model, int n_substituted, const SqsOptions& options) {
+    const int n = model.siteCount();
+    const int chains = options.chains > 0 ? options.chains : resolveThreadCount(options.threads);
+    const double m = n > 0 ? static_cast<double>(n - 2 * n_substituted) / n : 0.0;
+
+    std::vector<SqsResult> results(chains);
+
+    parallelFor(static_cast<size_t>(chains), options.threads, [&](size_t c) {
+        std::mt19937_64 rng(options.seed + c);
+
+        // Random start with the exact composition; up/down hold the sites of each spin for O(1) picks
+        std::vector<int> order(n);
+        for (int i = 0; i < n; ++i)
+            order[i] = i;
+        std::shuffle(order.begin(), order.end(), rng);
+
+        std::vector<signed char> spins(n, 1);
+        for (int i = 0; i < n_substituted; ++i)
+            spins[order[i]] = -1;
+        std::vector<int> down(order.begin(), order.begin() + n_substituted);
+        std::vector<int> up(order.begin() + n_substituted, order.end());
+
+        std::vector<double> pair_sums, triplet_sums, pair, triplet;
+        model.clusterSums(spins, pair_sums, triplet_sums);
+        model.correlations(pair_sums, triplet_sums, pair, triplet);
+        double current = objective(pair, triplet, m);
+
+        SqsResult& best = results[c];
+        best.spins = spins;
+        best.objective = current;
+        best.chain = static_cast<int>(c);
+
+        if (up.empty() || down.empty())
+            return;
+
+        std::uniform_int_distribution<size_t> pick_up(0, up.size() - 1);
+        std::uniform_int_distribution<size_t> pick_down(0, down.size() - 1);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+        std::vector<double> trial_pair, trial_triplet;
+        for (long long step = 0; step < options.steps; ++step) {
+            const double temperature =
+                options.temperature * std::pow(1e-3, static_cast<double>(step) / std::max(1LL, options.steps));
+
+            size_t ui = pick_up(rng), di = pick_down(rng);
+            int a = up[ui], b = down[di];
+
+            trial_pair = pair_sums;
+            trial_triplet = triplet_sums;
+            model.applyFlip(spins, a, trial_pair, trial_triplet);
+            spins[a] = -spins[a];
+            model.applyFlip(spins, b, trial_pair, trial_triplet);
+            spins[b] = -spins[b];
+
+            model.correlations(trial_pair, trial_triplet, pair, triplet);
+            double trial = objective(pair, triplet, m);
+
+            if (trial <= current || uniform(rng) < std::exp((current - trial) / temperature)) {
+                pair_sums.swap(trial_pair);
+                triplet_sums.swap(trial_triplet);
+                current = trial;
+                up[ui] = b;
+                down[di] = a;
+                if (current < best.objective) {
+                    best.objective = current;
+                    best.spins = spins;
+                }
+            } else {
+                spins[a] = -spins[a];
+                spins[b] = -spins[b];
+            }
+        }
+    });
+
+    SqsResult best = results[0];
+    for (const auto& r : results)
+        if (r.objective < best.objective)
+            best = r;
+
+    std::vector<double> pair_sums, triplet_sums;
+    model.clusterSums(best.spins, pair_sums, triplet_sums);
+    model.correlations(pair_sums, triplet_sums, best.pair_correlations, best.triplet_correlations);
+    return best;
+}
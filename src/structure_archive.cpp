@@ -0,0 +1,236 @@
+#include "structure_archive.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "instrumentation.h"
+
+namespace {
+
+constexpr std::size_t kBlock = 512;
+
+// ustar header field offsets and widths
+constexpr std::size_t kNameOffset = 0, kNameSize = 100;
+constexpr std::size_t kModeOffset = 100, kSizeOffset = 124, kMtimeOffset = 136, kChecksumOffset = 148;
+constexpr std::size_t kTypeOffset = 156, kMagicOffset = 257, kPrefixOffset = 345, kPrefixSize = 155;
+
+// Octal number, zero padded, terminated by NUL
+void putOctal(char* field, std::size_t width, unsigned long long value) {
+    field[width - 1] = '\0';
+    for (std::size_t i = width - 1; i-- > 0; value >>= 3)
+        field[i] = static_cast<char>('0' + (value & 7));
+}
+
+bool parseOctal(const char* field, std::size_t width, unsigned long long& value) {
+    value = 0;
+    std::size_t i = 0;
+    while (i < width && field[i] == ' ')
+        ++i;
+    bool digits = false;
+    for (; i < width && field[i] >= '0' && field[i] <= '7'; ++i, digits = true)
+        value = (value << 3) | static_cast<unsigned long long>(field[i] - '0');
+    return digits && (i == width || field[i] == '\0' || field[i] == ' ');
+}
+
+unsigned long long headerChecksum(const char* header) {
+    unsigned long long sum = 0;
+    for (std::size_t i = 0; i < kBlock; ++i) {
+        bool inChecksum = i >= kChecksumOffset && i < kChecksumOffset + 8;
+        sum += inChecksum ? static_cast<unsigned char>(' ') : static_cast<unsigned char>(header[i]);
+    }
+    return sum;
+}
+
+// Splits a long name at a '/' into the ustar prefix and name fields; false if it cannot be stored
+bool splitName(const std::string& path, std::string& prefix, std::string& name) {
+    if (path.empty())
+        return false;
+    if (path.size() <= kNameSize) {
+        prefix.clear();
+        name = path;
+        return true;
+    }
+    for (std::size_t slash = path.find('/'); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+        if (slash <= kPrefixSize && path.size() - slash - 1 <= kNameSize && slash + 1 < path.size()) {
+            prefix = path.substr(0, slash);
+            name = path.substr(slash + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void fillHeader(char* header, const std::string& prefix, const std::string& name, std::size_t size,
+                std::time_t mtime) {
+    std::memset(header, 0, kBlock);
+    std::memcpy(header + kNameOffset, name.data(), name.size());
+    putOctal(header + kModeOffset, 8, 0644);
+    putOctal(header + kModeOffset + 8, 8, 0);   // uid
+    putOctal(header + kModeOffset + 16, 8, 0);  // gid
+    putOctal(header + kSizeOffset, 12, size);
+    putOctal(header + kMtimeOffset, 12, static_cast<unsigned long long>(mtime));
+    header[kTypeOffset] = '0';
+    std::memcpy(header + kMagicOffset, "ustar\0" "00", 8);
+    std::memcpy(header + kPrefixOffset, prefix.data(), prefix.size());
+    // Six octal digits, NUL, space
+    putOctal(header + kChecksumOffset, 7, headerChecksum(header));
+    header[kChecksumOffset + 7] = ' ';
+}
+
+}  // namespace
+
+struct ArchiveWriter::State {
+    OutputFileStream out;
+    std::size_t depth;
+    std::time_t mtime{std::time(nullptr)};
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<ArchiveEntry> queue;
+    bool closing{false};
+    bool closed{false};
+    std::atomic<bool> failed{false};
+    std::thread writer;
+
+    State(const std::string& filename, std::size_t queue_depth) : out(filename), depth(queue_depth) {}
+
+    // Writer thread: drains the queue until close() and the queue is empty
+    void run() {
+        ScopedTimer timer("archive_write");
+        std::size_t bytes = 0;
+        char header[kBlock];
+        const char padding[kBlock] = {};
+        for (;;) {
+            ArchiveEntry entry;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return !queue.empty() || closing; });
+                if (queue.empty())
+                    break;
+                entry = std::move(queue.front());
+                queue.pop_front();
+                changed.notify_all();
+            }
+
+            std::string prefix, name;
+            splitName(entry.name, prefix, name);  // checked in add()
+            fillHeader(header, prefix, name, entry.contents.size(), mtime);
+            out.write(header, kBlock);
+            out.write(entry.contents.data(), static_cast<std::streamsize>(entry.contents.size()));
+            out.write(padding, static_cast<std::streamsize>((kBlock - entry.contents.size() % kBlock) % kBlock));
+            bytes += kBlock + (entry.contents.size() + kBlock - 1) / kBlock * kBlock;
+
+            if (!out) {
+                std::lock_guard<std::mutex> lock(mutex);
+                failed = true;
+                queue.clear();
+                changed.notify_all();
+                break;
+            }
+        }
+        if (timer.active())
+            timer.setBytes(bytes);
+    }
+};
+
+ArchiveWriter::ArchiveWriter(const std::string& filename, std::size_t queue_depth)
+    : state_(std::make_unique<State>(filename, queue_depth > 0 ? queue_depth : 1)) {
+    if (!state_->out) {
+        std::cerr << "Error: cannot create file " << filename << "\n";
+        return;
+    }
+    state_->writer = std::thread([this] { state_->run(); });
+}
+
+ArchiveWriter::~ArchiveWriter() {
+    close();
+}
+
+ArchiveWriter::operator bool() const {
+    return (state_->writer.joinable() || state_->closed) && !state_->failed;
+}
+
+bool ArchiveWriter::add(std::string name, std::string contents) {
+    std::string prefix, shortName;
+    if (!splitName(name, prefix, shortName)) {
+        std::cerr << "Error: name too long for a tar archive: " << name << "\n";
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    state_->changed.wait(lock, [&] { return state_->queue.size() < state_->depth || state_->failed; });
+    if (state_->failed || state_->closing || !state_->writer.joinable())
+        return false;
+    state_->queue.push_back({std::move(name), std::move(contents)});
+    state_->changed.notify_all();
+    return true;
+}
+
+bool ArchiveWriter::close() {
+    if (!state_->writer.joinable())
+        return state_->closed && !state_->failed;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->closing = true;
+        state_->changed.notify_all();
+    }
+    state_->writer.join();
+
+    // End of archive: two zero blocks
+    const char zeros[2 * kBlock] = {};
+    if (!state_->failed)
+        state_->out.write(zeros, sizeof(zeros));
+    bool ok = !state_->failed && state_->out.close();
+    if (!ok)
+        std::cerr << "Error: failed writing the archive\n";
+    state_->failed = !ok;
+    state_->closed = true;
+    return ok;
+}
+
+ArchiveReader::ArchiveReader(const std::string& filename) : in_(filename), filename_(filename) {}
+
+bool ArchiveReader::next(ArchiveEntry& entry) {
+    char header[kBlock];
+    for (;;) {
+        if (!in_.read(header, kBlock)) {
+            if (in_.gcount() != 0)
+                error_ = "truncated header in " + filename_;
+            return false;
+        }
+        if (std::all_of(header, header + kBlock, [](char c) { return c == '\0'; }))
+            return false;  // end-of-archive marker
+
+        unsigned long long checksum = 0, size = 0;
+        if (!parseOctal(header + kChecksumOffset, 8, checksum) || checksum != headerChecksum(header) ||
+            !parseOctal(header + kSizeOffset, 12, size)) {
+            error_ = "damaged header in " + filename_;
+            return false;
+        }
+
+        const char type = header[kTypeOffset];
+        if (type != '0' && type != '\0') {
+            // Not a regular file: skip its data blocks
+            in_.ignore(static_cast<std::streamsize>((size + kBlock - 1) / kBlock * kBlock));
+            continue;
+        }
+
+        entry.name.assign(header + kNameOffset, strnlen(header + kNameOffset, kNameSize));
+        if (std::memcmp(header + kMagicOffset, "ustar", 5) == 0 && header[kPrefixOffset] != '\0')
+            entry.name = std::string(header + kPrefixOffset, strnlen(header + kPrefixOffset, kPrefixSize)) + "/" +
+                         entry.name;
+        entry.contents.resize(size);
+        if (!in_.read(&entry.contents[0], static_cast<std::streamsize>(size))) {
+            error_ = "truncated data of " + entry.name + " in " + filename_;
+            return false;
+        }
+        in_.ignore(static_cast<std::streamsize>((kBlock - size % kBlock) % kBlock));
+        return true;
+    }
+}
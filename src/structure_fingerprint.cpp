@@ -0,0 +1,120 @@
+#include "structure_fingerprint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "lattice_utility.h"
+#include "poscar_file.h"
+
+namespace {
+
+std::size_t hashCombine(std::size_t seed, std::size_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+}  // namespace
+
+StructureFingerprint computeFingerprint(const POSCAR& poscar, const FingerprintOptions& options) {
+    StructureFingerprint fp;
+
+    // Composition, merging repeated element blocks
+    std::map<std::string, int> counts;
+    for (size_t i = 0; i < poscar.elements.size() && i < poscar.num_atoms.size(); ++i)
+        counts[poscar.elements[i]] += poscar.num_atoms[i];
+    fp.composition.assign(counts.begin(), counts.end());
+    fp.total_atoms = poscar.total_atoms;
+
+    fp.composition_hash = std::hash<int>{}(fp.total_atoms);
+    for (const auto& [el, n] : fp.composition) {
+        fp.composition_hash = hashCombine(fp.composition_hash, std::hash<std::string>{}(el));
+        fp.composition_hash = hashCombine(fp.composition_hash, std::hash<int>{}(n));
+    }
+
+    if (fp.total_atoms <= 0)
+        return fp;
+
+    fp.volume_per_atom = cellVolume(poscar.lattice) / fp.total_atoms;
+
+    // Cartesian positions without modifying the input
+    std::vector<double> cart(3 * static_cast<size_t>(fp.total_atoms));
+    for (int i = 0; i < fp.total_atoms; ++i) {
+        const Atom& a = poscar.coordinates[i];
+        double f[3] = {a.x, a.y, a.z};
+        if (poscar.is_direct)
+            fractionalToCartesian(poscar.lattice, f, &cart[3 * i]);
+        else
+            std::copy(f, f + 3, &cart[3 * i]);
+    }
+
+    const int n_bins = static_cast<int>(std::ceil(options.cutoff / options.bin_width));
+    fp.distance_histogram.assign(n_bins, 0.0);
+
+    // Lattice translations needed to see every neighbour within the cutoff
+    double heights[3];
+    perpendicularHeights(poscar.lattice, heights);
+    int range[3];
+    for (int k = 0; k < 3; ++k)
+        range[k] = heights[k] > 0.0 ? static_cast<int>(std::ceil(options.cutoff / heights[k])) : 0;
+
+    const double cutoff2 = options.cutoff * options.cutoff;
+    for (int t0 = -range[0]; t0 <= range[0]; ++t0)
+        for (int t1 = -range[1]; t1 <= range[1]; ++t1)
+            for (int t2 = -range[2]; t2 <= range[2]; ++t2) {
+                double shift[3];
+                for (int j = 0; j < 3; ++j)
+                    shift[j] = t0 * poscar.lattice[0][j] + t1 * poscar.lattice[1][j] + t2 * poscar.lattice[2][j];
+                const bool home = (t0 == 0 && t1 == 0 && t2 == 0);
+
+                for (int i = 0; i < fp.total_atoms; ++i) {
+                    const double* ri = &cart[3 * i];
+                    for (int j = 0; j < fp.total_atoms; ++j) {
+                        if (home && i == j)
+                            continue;
+                        const double* rj = &cart[3 * j];
+                        double dx = rj[0] + shift[0] - ri[0];
+                        double dy = rj[1] + shift[1] - ri[1];
+                        double dz = rj[2] + shift[2] - ri[2];
+                        double r2 = dx * dx + dy * dy + dz * dz;
+                        if (r2 >= cutoff2)
+                            continue;
+                        int bin = static_cast<int>(std::sqrt(r2) / options.bin_width);
+                        if (bin < n_bins)
+                            fp.distance_histogram[bin] += 1.0;
+                    }
+                }
+            }
+
+    for (double& h : fp.distance_histogram)
+        h /= fp.total_atoms;
+
+    return fp;
+}
+
+double histogramDifference(const std::vector<double>& a, const std::vector<double>& b) {
+    size_t n = std::max(a.size(), b.size());
+    double ca = 0.0, cb = 0.0;
+    double diff = 0.0, norm = 0.0;
+    for (size_t k = 0; k < n; ++k) {
+        ca += k < a.size() ? a[k] : 0.0;
+        cb += k < b.size() ? b[k] : 0.0;
+        diff += std::abs(ca - cb);
+        norm += std::max(ca, cb);
+    }
+    return norm > 0.0 ? diff / norm : 0.0;
+}
+
+bool fingerprintsCompatible(const StructureFingerprint& a, const StructureFingerprint& b, double volume_tolerance,
+                            double histogram_tolerance) {
+    if (a.composition_hash != b.composition_hash || a.composition != b.composition)
+        return false;
+
+    double vmax = std::max(a.volume_per_atom, b.volume_per_atom);
+    if (vmax > 0.0 && std::abs(a.volume_per_atom - b.volume_per_atom) / vmax > volume_tolerance)
+        return false;
+
+    return histogramDifference(a.distance_histogram, b.distance_histogram) <= histogram_tolerance;
+}
@@ -0,0 +1,563 @@
+#include "structure_formats.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "compressed_stream.h"
+#include "instrumentation.h"
+#include "lattice_utility.h"
+#include "structure_utility.h"
+
+namespace {
+
+std::deque<StructureFormat> builtinFormats() {
+    std::deque<StructureFormat> formats;
+    formats.push_back({"poscar",
+                       {".vasp", ".poscar"},
+                       {"POSCAR", "CONTCAR"},
+                       false,
+                       [](std::istream& in, const std::string& source, POSCAR& poscar) {
+                           return poscar.readPOSCAR(in, source);
+                       },
+                       [](TextWriter& out, const POSCAR& poscar) { poscar.writePOSCAR(out); }});
+    formats.push_back({"ctrls",
+                       {},
+                       {"ctrls."},
+                       false,
+                       [](std::istream& in, const std::string& source, POSCAR& poscar) {
+                           return poscar.readCtrls(in, source);
+                       },
+                       [](TextWriter& out, const POSCAR& poscar) { poscar.writeCtrls(out); }});
+    formats.push_back({"extxyz", {".xyz", ".extxyz"}, {}, true, readExtxyz, writeExtxyz});
+    formats.push_back({"lammps", {".lmp", ".data"}, {}, false, nullptr, writeLammpsData});
+    formats.push_back({"cif", {".cif"}, {}, false, nullptr, writeCif});
+    return formats;
+}
+
+struct Registry {
+    std::mutex mutex;
+    std::deque<StructureFormat> formats{builtinFormats()};  // deque keeps the returned pointers valid
+};
+
+// Built-ins are installed here rather than by static registration objects, which the linker drops from a
+// static library when nothing refers to their translation unit
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+std::string lowerCase(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+}
+
+const StructureFormat* resolveFormat(const std::string& filename, const std::string& format) {
+    const StructureFormat* found = format.empty() ? findStructureFormat(filename) : structureFormatByName(format);
+    if (!found) {
+        if (format.empty())
+            std::cerr << "Error: cannot tell the structure format of " << filename << " from its name\n";
+        else
+            std::cerr << "Error: unknown structure format " << format << "\n";
+    }
+    return found;
+}
+
+// Lattice with the scale factor applied and its inverse
+void scaledLattice(const POSCAR& poscar, double lattice[3][3], double inverse[3][3]) {
+    for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 3; ++c)
+            lattice[r][c] = poscar.lattice[r][c] * poscar.scale;
+    invert3(lattice, inverse);
+}
+
+// Cartesian position (Angstrom) and fractional coordinates of an atom regardless of the POSCAR mode
+void atomPosition(const POSCAR& poscar, const double lattice[3][3], const double inverse[3][3], std::size_t i,
+                  double cart[3], double frac[3]) {
+    const Atom& a = poscar.coordinates[i];
+    const double p[3] = {a.x, a.y, a.z};
+    if (poscar.is_direct) {
+        for (int k = 0; k < 3; ++k)
+            frac[k] = p[k];
+        fractionalToCartesian(lattice, frac, cart);
+    } else {
+        for (int k = 0; k < 3; ++k)
+            cart[k] = p[k] * poscar.scale;
+        cartesianToFractional(inverse, cart, frac);
+    }
+}
+
+std::vector<std::string_view> splitWhitespace(std::string_view line) {
+    std::vector<std::string_view> tokens;
+    std::size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && std::isspace(static_cast<unsigned char>(line[i])))
+            ++i;
+        std::size_t start = i;
+        while (i < line.size() && !std::isspace(static_cast<unsigned char>(line[i])))
+            ++i;
+        if (i > start)
+            tokens.push_back(line.substr(start, i - start));
+    }
+    return tokens;
+}
+
+bool parseDouble(std::string_view token, double& value) {
+    if (!token.empty() && token.front() == '+')
+        token.remove_prefix(1);
+    auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+    return result.ec == std::errc() && result.ptr == token.data() + token.size();
+}
+
+// key=value pairs of an extxyz comment line; values may be double quoted. Keys are lower cased.
+std::vector<std::pair<std::string, std::string>> parseKeyValues(std::string_view line) {
+    std::vector<std::pair<std::string, std::string>> pairs;
+    std::size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && std::isspace(static_cast<unsigned char>(line[i])))
+            ++i;
+        std::size_t start = i;
+        while (i < line.size() && line[i] != '=' && !std::isspace(static_cast<unsigned char>(line[i])))
+            ++i;
+        if (i == start)
+            break;
+        std::string key = lowerCase(std::string(line.substr(start, i - start)));
+        std::string value;
+        if (i < line.size() && line[i] == '=') {
+            ++i;
+            if (i < line.size() && line[i] == '"') {
+                std::size_t close = line.find('"', i + 1);
+                if (close == std::string_view::npos)
+                    close = line.size();
+                value = std::string(line.substr(i + 1, close - i - 1));
+                i = std::min(close + 1, line.size());
+            } else {
+                start = i;
+                while (i < line.size() && !std::isspace(static_cast<unsigned char>(line[i])))
+                    ++i;
+                value = std::string(line.substr(start, i - start));
+            }
+        } else {
+            value = "T";  // bare key is a true flag
+        }
+        pairs.emplace_back(std::move(key), std::move(value));
+    }
+    return pairs;
+}
+
+bool logicalValue(std::string_view token) {
+    return !token.empty() && (token[0] == 'T' || token[0] == 't' || token == "1");
+}
+
+}  // namespace
+
+void registerStructureFormat(StructureFormat format) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (StructureFormat& existing : r.formats)
+        if (existing.name == format.name) {
+            existing = std::move(format);
+            return;
+        }
+    r.formats.push_back(std::move(format));
+}
+
+const StructureFormat* structureFormatByName(const std::string& name) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    const std::string wanted = lowerCase(name);
+    for (const StructureFormat& format : r.formats)
+        if (format.name == wanted)
+            return &format;
+    return nullptr;
+}
+
+const StructureFormat* findStructureFormat(const std::string& filename) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    const std::filesystem::path path(stripCompressionSuffix(filename));
+    const std::string extension = lowerCase(path.extension().string());
+    const std::string name = path.filename().string();
+
+    // The extension wins over the prefix, so POSCAR_Si.xyz is extxyz; NaCl.cif.gz is cif
+    if (!extension.empty())
+        for (const StructureFormat& format : r.formats)
+            for (const std::string& e : format.extensions)
+                if (e == extension)
+                    return &format;
+    for (const StructureFormat& format : r.formats)
+        for (const std::string& p : format.prefixes)
+            if (name.compare(0, p.size(), p) == 0)
+                return &format;
+    return nullptr;
+}
+
+std::vector<const StructureFormat*> structureFormats() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<const StructureFormat*> formats;
+    for (const StructureFormat& format : r.formats)
+        formats.push_back(&format);
+    return formats;
+}
+
+bool readStructures(const std::string& filename, std::vector<POSCAR>& frames, const std::string& format) {
+    const StructureFormat* f = resolveFormat(filename, format);
+    if (!f)
+        return false;
+    if (!f->read) {
+        std::cerr << "Error: reading " << f->name << " files is not supported\n";
+        return false;
+    }
+
+    ScopedTimer timer("read_structure");
+
+    InputFileStream file(filename);
+    if (!file) {
+        std::cerr << "Error: cannot open file " << filename << "\n";
+        return false;
+    }
+
+    frames.clear();
+    std::size_t atoms = 0;
+    do {
+        POSCAR poscar;
+        if (!f->read(file, filename, poscar))
+            return false;
+        atoms += poscar.coordinates.size();
+        frames.push_back(std::move(poscar));
+        file >> std::ws;
+    } while (f->multi_frame && file.peek() != std::char_traits<char>::eof());
+
+    if (timer.active()) {
+        std::error_code ec;
+        auto bytes = std::filesystem::file_size(filename, ec);
+        timer.setAtoms(atoms);
+        timer.setBytes(ec ? 0 : static_cast<std::size_t>(bytes));
+    }
+
+    return true;
+}
+
+bool readStructure(const std::string& filename, POSCAR& poscar, const std::string& format) {
+    const StructureFormat* f = resolveFormat(filename, format);
+    if (!f)
+        return false;
+    if (!f->read) {
+        std::cerr << "Error: reading " << f->name << " files is not supported\n";
+        return false;
+    }
+
+    ScopedTimer timer("read_structure");
+
+    InputFileStream file(filename);
+    if (!file) {
+        std::cerr << "Error: cannot open file " << filename << "\n";
+        return false;
+    }
+    if (!f->read(file, filename, poscar))
+        return false;
+
+    if (timer.active()) {
+        std::error_code ec;
+        auto bytes = std::filesystem::file_size(filename, ec);
+        timer.setAtoms(poscar.coordinates.size());
+        timer.setBytes(ec ? 0 : static_cast<std::size_t>(bytes));
+    }
+
+    return true;
+}
+
+bool writeStructures(const std::string& filename, const std::vector<POSCAR>& frames, const std::string& format) {
+    const StructureFormat* f = resolveFormat(filename, format);
+    if (!f)
+        return false;
+    if (!f->write) {
+        std::cerr << "Error: writing " << f->name << " files is not supported\n";
+        return false;
+    }
+    if (frames.size() > 1 && !f->multi_frame) {
+        std::cerr << "Error: " << f->name << " files hold a single structure\n";
+        return false;
+    }
+
+    std::ifstream fileTest(filename);
+    if (fileTest.good()) {
+        std::cerr << "Warning: file \"" << filename << "\" already exists and will be overwritten.\n";
+    }
+    fileTest.close();
+
+    std::size_t atoms = 0;
+    for (const POSCAR& poscar : frames)
+        atoms += poscar.coordinates.size();
+    ScopedTimer timer("write_structure", atoms);
+
+    OutputFileStream file(filename);
+    if (!file) {
+        std::cerr << "Error: cannot create file " << filename << "\n";
+        return false;
+    }
+
+    TextWriter out(file);
+    for (const POSCAR& poscar : frames)
+        f->write(out, poscar);
+    if (!out.flush() || !file.close()) {
+        std::cerr << "Error: failed writing to " << filename << "\n";
+        return false;
+    }
+
+    if (timer.active())
+        timer.setBytes(out.bytesWritten());
+
+    return true;
+}
+
+bool writeStructure(const std::string& filename, const POSCAR& poscar, const std::string& format) {
+    return writeStructures(filename, std::vector<POSCAR>{poscar}, format);
+}
+
+bool readExtxyz(std::istream& in, const std::string& source, POSCAR& poscar) {
+    std::string line;
+    if (!std::getline(in, line)) {
+        std::cerr << "Error: missing atom count in " << source << "\n";
+        return false;
+    }
+    std::vector<std::string_view> count_tokens = splitWhitespace(line);
+    long long n_atoms = -1;
+    if (count_tokens.size() != 1 ||
+        std::from_chars(count_tokens[0].data(), count_tokens[0].data() + count_tokens[0].size(), n_atoms).ec !=
+            std::errc() ||
+        n_atoms < 0) {
+        std::cerr << "Error: invalid atom count \"" << line << "\" in " << source << "\n";
+        return false;
+    }
+
+    if (!std::getline(in, line)) {
+        std::cerr << "Error: missing extxyz comment line in " << source << "\n";
+        return false;
+    }
+
+    double lattice[3][3];
+    bool have_lattice = false;
+    std::string comment = std::filesystem::path(source).filename().string();
+    std::string properties = "species:S:1:pos:R:3";
+    for (const auto& [key, value] : parseKeyValues(line)) {
+        if (key == "lattice") {
+            std::vector<std::string_view> tokens = splitWhitespace(value);
+            have_lattice = tokens.size() == 9;
+            for (std::size_t k = 0; have_lattice && k < 9; ++k)
+                have_lattice = parseDouble(tokens[k], lattice[k / 3][k % 3]);
+        } else if (key == "properties") {
+            properties = value;
+        } else if (key == "comment") {
+            comment = value;
+        }
+    }
+    if (!have_lattice) {
+        std::cerr << "Error: extxyz frame without a valid Lattice in " << source << "\n";
+        return false;
+    }
+
+    // Properties is a list of name:type:columns triples; find the columns we use
+    int species_column = -1, pos_column = -1, mask_column = -1, n_columns = 0;
+    {
+        std::vector<std::string> fields;
+        std::size_t start = 0;
+        while (start <= properties.size()) {
+            std::size_t colon = properties.find(':', start);
+            if (colon == std::string::npos)
+                colon = properties.size();
+            fields.push_back(properties.substr(start, colon - start));
+            start = colon + 1;
+        }
+        if (fields.size() % 3 != 0) {
+            std::cerr << "Error: malformed Properties \"" << properties << "\" in " << source << "\n";
+            return false;
+        }
+        for (std::size_t k = 0; k < fields.size(); k += 3) {
+            const std::string name = lowerCase(fields[k]);
+            int width = 0;
+            if (std::from_chars(fields[k + 2].data(), fields[k + 2].data() + fields[k + 2].size(), width).ec !=
+                    std::errc() ||
+                width < 1) {
+                std::cerr << "Error: malformed Properties \"" << properties << "\" in " << source << "\n";
+                return false;
+            }
+            if (name == "species" && width == 1)
+                species_column = n_columns;
+            else if (name == "pos" && width == 3)
+                pos_column = n_columns;
+            else if (name == "move_mask" && width == 3)
+                mask_column = n_columns;
+            n_columns += width;
+        }
+    }
+    if (species_column < 0 || pos_column < 0) {
+        std::cerr << "Error: Properties lacks species:S:1 or pos:R:3 in " << source << "\n";
+        return false;
+    }
+
+    double inverse[3][3];
+    if (!invert3(lattice, inverse)) {
+        std::cerr << "Error: singular Lattice in " << source << "\n";
+        return false;
+    }
+
+    // Grown line by line: the header count is untrusted, so a bogus value fails at end of input instead of
+    // reserving memory up front
+    std::vector<std::string> species;
+    std::vector<Atom> fractional;
+    std::vector<std::uint8_t> flags;
+    for (long long i = 0; i < n_atoms; ++i) {
+        if (!std::getline(in, line)) {
+            std::cerr << "Error: not enough atom lines in " << source << "\n";
+            return false;
+        }
+        std::vector<std::string_view> tokens = splitWhitespace(line);
+        double cart[3], frac[3];
+        if (static_cast<int>(tokens.size()) < n_columns || !parseDouble(tokens[pos_column], cart[0]) ||
+            !parseDouble(tokens[pos_column + 1], cart[1]) || !parseDouble(tokens[pos_column + 2], cart[2])) {
+            std::cerr << "Error: failed to parse atom " << i << " in " << source << "\n";
+            return false;
+        }
+        species.emplace_back(tokens[species_column]);
+        cartesianToFractional(inverse, cart, frac);
+        fractional.push_back(Atom{frac[0], frac[1], frac[2]});
+        if (mask_column >= 0)
+            flags.push_back((logicalValue(tokens[mask_column]) ? kMoveX : 0) |
+                            (logicalValue(tokens[mask_column + 1]) ? kMoveY : 0) |
+                            (logicalValue(tokens[mask_column + 2]) ? kMoveZ : 0));
+    }
+
+    poscar = buildPOSCAR(comment, lattice, species, fractional, {}, flags);
+    return true;
+}
+
+void writeExtxyz(TextWriter& out, const POSCAR& poscar) {
+    double lattice[3][3], inverse[3][3];
+    scaledLattice(poscar, lattice, inverse);
+
+    out.integer(static_cast<long long>(poscar.coordinates.size())).character('\n');
+    out.text("Lattice=\"");
+    for (int k = 0; k < 9; ++k) {
+        if (k > 0)
+            out.character(' ');
+        out.fixed(lattice[k / 3][k % 3], 10);
+    }
+    out.text(poscar.selective_dynamics ? "\" Properties=species:S:1:pos:R:3:move_mask:L:3"
+                                       : "\" Properties=species:S:1:pos:R:3");
+    out.text(" pbc=\"T T T\" comment=\"");
+    for (char c : poscar.comment)
+        out.character(c == '"' ? '\'' : c);
+    out.text("\"\n");
+
+    std::size_t i = 0;
+    for (std::size_t e = 0; e < poscar.elements.size() && e < poscar.num_atoms.size(); ++e) {
+        for (int k = 0; k < poscar.num_atoms[e] && i < poscar.coordinates.size(); ++k, ++i) {
+            double cart[3], frac[3];
+            atomPosition(poscar, lattice, inverse, i, cart, frac);
+            out.text(poscar.elements[e]);
+            for (int d = 0; d < 3; ++d)
+                out.character(' ').fixed(cart[d], 10);
+            if (poscar.selective_dynamics) {
+                const std::uint8_t flags = i < poscar.selective_flags.size() ? poscar.selective_flags[i] : kMoveAll;
+                out.text(flags & kMoveX ? " T" : " F").text(flags & kMoveY ? " T" : " F");
+                out.text(flags & kMoveZ ? " T" : " F");
+            }
+            out.character('\n');
+        }
+    }
+}
+
+void writeLammpsData(TextWriter& out, const POSCAR& poscar) {
+    double lattice[3][3], inverse[3][3];
+    scaledLattice(poscar, lattice, inverse);
+
+    // Lower triangular cell A = (lx, 0, 0), B = (xy, ly, 0), C = (xz, yz, lz) with the same metric
+    auto dot = [](const double* u, const double* v) { return u[0] * v[0] + u[1] * v[1] + u[2] * v[2]; };
+    const double lx = std::sqrt(dot(lattice[0], lattice[0]));
+    const double xy = dot(lattice[1], lattice[0]) / lx;
+    const double ly = std::sqrt(std::max(0.0, dot(lattice[1], lattice[1]) - xy * xy));
+    const double xz = dot(lattice[2], lattice[0]) / lx;
+    const double yz = (dot(lattice[1], lattice[2]) - xy * xz) / ly;
+    const double lz = std::sqrt(std::max(0.0, dot(lattice[2], lattice[2]) - xz * xz - yz * yz));
+
+    out.text("# ").text(poscar.comment).text("\n\n");
+    out.integer(static_cast<long long>(poscar.coordinates.size())).text(" atoms\n");
+    out.integer(static_cast<long long>(poscar.elements.size())).text(" atom types  #");
+    for (const std::string& element : poscar.elements)
+        out.character(' ').text(element);
+    out.text("\n\n");
+    out.text("0.0 ").fixed(lx, 10).text(" xlo xhi\n");
+    out.text("0.0 ").fixed(ly, 10).text(" ylo yhi\n");
+    out.text("0.0 ").fixed(lz, 10).text(" zlo zhi\n");
+    if (std::abs(xy) > 1e-10 || std::abs(xz) > 1e-10 || std::abs(yz) > 1e-10)
+        out.fixed(xy, 10).character(' ').fixed(xz, 10).character(' ').fixed(yz, 10).text(" xy xz yz\n");
+    out.text("\nAtoms  # atomic\n\n");
+
+    std::size_t i = 0;
+    for (std::size_t e = 0; e < poscar.num_atoms.size(); ++e) {
+        for (int k = 0; k < poscar.num_atoms[e] && i < poscar.coordinates.size(); ++k, ++i) {
+            double cart[3], f[3];
+            atomPosition(poscar, lattice, inverse, i, cart, f);
+            out.integer(static_cast<long long>(i + 1)).character(' ').integer(static_cast<long long>(e + 1));
+            out.character(' ').fixed(f[0] * lx + f[1] * xy + f[2] * xz, 10);
+            out.character(' ').fixed(f[1] * ly + f[2] * yz, 10);
+            out.character(' ').fixed(f[2] * lz, 10).character('\n');
+        }
+    }
+}
+
+void writeCif(TextWriter& out, const POSCAR& poscar) {
+    double lattice[3][3], inverse[3][3];
+    scaledLattice(poscar, lattice, inverse);
+    double lengths[3], angles[3];
+    latticeParameters(lattice, lengths, angles);
+
+    // Data block names cannot contain whitespace
+    out.text("data_");
+    bool named = false;
+    for (char c : poscar.comment)
+        if (!std::isspace(static_cast<unsigned char>(c))) {
+            out.character(c);
+            named = true;
+        }
+    if (!named)
+        out.text("structure");
+    out.character('\n');
+
+    out.text("_symmetry_space_group_name_H-M   'P 1'\n");
+    out.text("_symmetry_Int_Tables_number      1\n");
+    const char* length_tags[3] = {"_cell_length_a    ", "_cell_length_b    ", "_cell_length_c    "};
+    const char* angle_tags[3] = {"_cell_angle_alpha ", "_cell_angle_beta  ", "_cell_angle_gamma "};
+    for (int k = 0; k < 3; ++k)
+        out.text(length_tags[k]).fixed(lengths[k], 10).character('\n');
+    for (int k = 0; k < 3; ++k)
+        out.text(angle_tags[k]).fixed(angles[k], 10).character('\n');
+    out.text("_cell_volume      ").fixed(std::abs(cellVolume(lattice)), 10).character('\n');
+    out.text("loop_\n_symmetry_equiv_pos_as_xyz\n  'x, y, z'\n");
+    out.text("loop_\n_atom_site_label\n_atom_site_type_symbol\n_atom_site_fract_x\n_atom_site_fract_y\n");
+    out.text("_atom_site_fract_z\n_atom_site_occupancy\n");
+
+    std::size_t i = 0;
+    for (std::size_t e = 0; e < poscar.elements.size() && e < poscar.num_atoms.size(); ++e) {
+        for (int k = 0; k < poscar.num_atoms[e] && i < poscar.coordinates.size(); ++k, ++i) {
+            double cart[3], f[3];
+            atomPosition(poscar, lattice, inverse, i, cart, f);
+            out.text(poscar.elements[e]).integer(k + 1).character(' ').text(poscar.elements[e]);
+            for (int d = 0; d < 3; ++d)
+                out.character(' ').fixed(f[d], 10);
+            out.text(" 1\n");
+        }
+    }
+}
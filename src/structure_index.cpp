@@ -0,0 +1,411 @@
+#include "structure_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <unordered_map>
+
+#include "instrumentation.h"
+#include "lattice_utility.h"
+#include "parallel_utility.h"
+#include "poscar_file.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char kMagic[8] = {'V', 'U', 'I', 'N', 'D', 'E', 'X', '\0'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kByteOrder = 0x01020304;
+
+template <typename T>
+void writeArray(std::ostream& out, const std::vector<T>& values) {
+    out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+template <typename T>
+void writeValue(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void writeStrings(std::ostream& out, const std::vector<std::string>& strings) {
+    std::vector<std::uint64_t> offsets(strings.size() + 1, 0);
+    for (size_t i = 0; i < strings.size(); ++i)
+        offsets[i + 1] = offsets[i] + strings[i].size();
+    writeArray(out, offsets);
+    for (const std::string& s : strings)
+        out.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+// Bounds-checked cursor over the loaded file
+class Reader {
+public:
+    explicit Reader(const std::vector<char>& data) : data_(data) {}
+
+    template <typename T>
+    bool value(T& v) {
+        if (pos_ + sizeof(T) > data_.size())
+            return false;
+        std::memcpy(&v, data_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    bool array(std::vector<T>& values, std::uint64_t n) {
+        if (n > (data_.size() - pos_) / sizeof(T))
+            return false;
+        values.resize(n);
+        std::memcpy(values.data(), data_.data() + pos_, n * sizeof(T));
+        pos_ += n * sizeof(T);
+        return true;
+    }
+
+    bool strings(std::vector<std::string>& strings, std::uint64_t n) {
+        std::vector<std::uint64_t> offsets;
+        if (!array(offsets, n + 1) || offsets[0] != 0 || offsets[n] > data_.size() - pos_)
+            return false;
+        strings.resize(n);
+        for (std::uint64_t i = 0; i < n; ++i) {
+            if (offsets[i + 1] < offsets[i])
+                return false;
+            strings[i].assign(data_.data() + pos_ + offsets[i], offsets[i + 1] - offsets[i]);
+        }
+        pos_ += offsets[n];
+        return true;
+    }
+
+    bool atEnd() const {
+        return pos_ == data_.size();
+    }
+
+private:
+    const std::vector<char>& data_;
+    std::size_t pos_{0};
+};
+
+struct FileInfo {
+    std::string path;
+    std::int64_t mtime;
+    std::uint64_t size;
+};
+
+// Header of one file, with repeated element blocks merged in order of first appearance
+struct ParsedHeader {
+    bool ok{false};
+    std::int32_t natoms{0};
+    double volume{0.0};
+    std::vector<std::pair<std::string, int>> composition;
+};
+
+ParsedHeader parseHeader(const std::string& path) {
+    ParsedHeader parsed;
+    POSCAR header;
+    if (!header.readHeader(path)) {
+        std::cerr << "Error: reading POSCAR header from " << path << "\n";
+        return parsed;
+    }
+    if (header.elements.size() != header.num_atoms.size() || header.elements.empty()) {
+        std::cerr << "Error: element and count lines of " << path << " do not match\n";
+        return parsed;
+    }
+    for (size_t i = 0; i < header.elements.size(); ++i) {
+        auto it = std::find_if(parsed.composition.begin(), parsed.composition.end(),
+                               [&](const auto& entry) { return entry.first == header.elements[i]; });
+        if (it == parsed.composition.end())
+            parsed.composition.emplace_back(header.elements[i], header.num_atoms[i]);
+        else
+            it->second += header.num_atoms[i];
+    }
+    parsed.natoms = header.total_atoms;
+    parsed.volume = std::abs(cellVolume(header.lattice));
+    parsed.ok = true;
+    return parsed;
+}
+
+int gcdOf(const std::int32_t* counts, size_t n) {
+    int g = 0;
+    for (size_t i = 0; i < n; ++i)
+        g = std::gcd(g, static_cast<int>(counts[i]));
+    return g;
+}
+
+}  // namespace
+
+bool saveStructureIndex(const std::string& filename, const StructureIndex& index) {
+    ScopedTimer timer("save_index", index.size());
+
+    // Written next to the target and renamed, so readers never see a half-written index
+    const std::string tmp = filename + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Error: cannot create file " << tmp << "\n";
+            return false;
+        }
+        out.write(kMagic, sizeof(kMagic));
+        writeValue(out, kVersion);
+        writeValue(out, kByteOrder);
+        writeValue<std::uint64_t>(out, index.size());
+        writeValue<std::uint64_t>(out, index.species.size());
+        writeValue<std::uint64_t>(out, index.composition_species.size());
+        writeStrings(out, index.species);
+        writeStrings(out, index.paths);
+        writeArray(out, index.mtimes);
+        writeArray(out, index.file_sizes);
+        writeArray(out, index.natoms);
+        writeArray(out, index.volumes);
+        writeArray(out, index.composition_offsets);
+        writeArray(out, index.composition_species);
+        writeArray(out, index.composition_counts);
+        out.flush();
+        if (!out) {
+            std::cerr << "Error: failed writing to " << tmp << "\n";
+            return false;
+        }
+        if (timer.active())
+            timer.setBytes(static_cast<std::size_t>(out.tellp()));
+    }
+
+    std::error_code ec;
+    fs::rename(tmp, filename, ec);
+    if (ec) {
+        std::cerr << "Error: cannot replace " << filename << ": " << ec.message() << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool loadStructureIndex(const std::string& filename, StructureIndex& index) {
+    ScopedTimer timer("load_index");
+
+    std::ifstream in(filename, std::ios::binary);
+    if (!in)
+        return false;
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    Reader reader(data);
+    char magic[8];
+    std::uint32_t version = 0, byte_order = 0;
+    std::uint64_t n = 0, n_species = 0, n_composition = 0;
+    for (char& c : magic)
+        if (!reader.value(c))
+            return false;
+    if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || !reader.value(version) || !reader.value(byte_order) ||
+        version != kVersion || byte_order != kByteOrder) {
+        std::cerr << "Error: " << filename << " is not a structure index of this version and byte order\n";
+        return false;
+    }
+
+    StructureIndex loaded;
+    bool ok = reader.value(n) && reader.value(n_species) && reader.value(n_composition) &&
+              reader.strings(loaded.species, n_species) && reader.strings(loaded.paths, n) &&
+              reader.array(loaded.mtimes, n) && reader.array(loaded.file_sizes, n) && reader.array(loaded.natoms, n) &&
+              reader.array(loaded.volumes, n) && reader.array(loaded.composition_offsets, n + 1) &&
+              reader.array(loaded.composition_species, n_composition) &&
+              reader.array(loaded.composition_counts, n_composition) && reader.atEnd();
+    ok = ok && loaded.composition_offsets.front() == 0 && loaded.composition_offsets.back() == n_composition;
+    for (size_t i = 0; ok && i < n; ++i)
+        ok = loaded.composition_offsets[i] <= loaded.composition_offsets[i + 1];
+    for (size_t k = 0; ok && k < n_composition; ++k)
+        ok = loaded.composition_species[k] < n_species;
+    if (!ok) {
+        std::cerr << "Error: structure index " << filename << " is corrupt\n";
+        return false;
+    }
+
+    if (timer.active()) {
+        timer.setAtoms(n);
+        timer.setBytes(data.size());
+    }
+    index = std::move(loaded);
+    return true;
+}
+
+IndexUpdateStats updateStructureIndex(StructureIndex& index, const std::string& directory, const std::string& prefix,
+                                      int threads) {
+    IndexUpdateStats stats;
+
+    std::vector<FileInfo> files;
+    {
+        ScopedTimer phase("scan_directory");
+        std::error_code ec;
+        for (fs::recursive_directory_iterator it(directory, fs::directory_options::skip_permission_denied, ec), end;
+             !ec && it != end; it.increment(ec)) {
+            if (!it->is_regular_file() || it->path().filename().string().rfind(prefix, 0) != 0)
+                continue;
+            std::error_code stat_ec;
+            auto mtime = it->last_write_time(stat_ec);
+            auto size = it->file_size(stat_ec);
+            if (stat_ec)
+                continue;
+            files.push_back({it->path().string(), static_cast<std::int64_t>(mtime.time_since_epoch().count()),
+                             static_cast<std::uint64_t>(size)});
+        }
+        if (ec)
+            std::cerr << "Warning: scanning " << directory << " stopped early: " << ec.message() << "\n";
+        std::sort(files.begin(), files.end(), [](const FileInfo& a, const FileInfo& b) { return a.path < b.path; });
+    }
+
+    std::unordered_map<std::string, size_t> previous;
+    previous.reserve(index.size());
+    for (size_t i = 0; i < index.size(); ++i)
+        previous.emplace(index.paths[i], i);
+
+    // Unchanged files keep their entry, the rest are read
+    std::vector<long long> old_entry(files.size(), -1);
+    std::vector<size_t> to_parse;
+    size_t still_present = 0;
+    for (size_t f = 0; f < files.size(); ++f) {
+        auto it = previous.find(files[f].path);
+        if (it != previous.end()) {
+            still_present++;
+            if (index.mtimes[it->second] == files[f].mtime && index.file_sizes[it->second] == files[f].size) {
+                old_entry[f] = static_cast<long long>(it->second);
+                continue;
+            }
+        }
+        to_parse.push_back(f);
+    }
+    stats.removed = index.size() - still_present;
+
+    std::vector<ParsedHeader> parsed(files.size());
+    {
+        ScopedTimer phase("read_headers", to_parse.size());
+        parallelFor(to_parse.size(), threads, [&](size_t k) { parsed[to_parse[k]] = parseHeader(files[to_parse[k]].path); });
+    }
+
+    ScopedTimer phase("build_index", files.size());
+    StructureIndex updated;
+    std::unordered_map<std::string, std::uint16_t> species_id;
+    auto intern = [&](const std::string& name) {
+        auto [it, inserted] = species_id.emplace(name, static_cast<std::uint16_t>(updated.species.size()));
+        if (inserted)
+            updated.species.push_back(name);
+        return it->second;
+    };
+
+    for (size_t f = 0; f < files.size(); ++f) {
+        if (old_entry[f] >= 0) {
+            const size_t e = static_cast<size_t>(old_entry[f]);
+            for (std::uint32_t k = index.composition_offsets[e]; k < index.composition_offsets[e + 1]; ++k) {
+                updated.composition_species.push_back(intern(index.species[index.composition_species[k]]));
+                updated.composition_counts.push_back(index.composition_counts[k]);
+            }
+            updated.natoms.push_back(index.natoms[e]);
+            updated.volumes.push_back(index.volumes[e]);
+            stats.reused++;
+        } else if (parsed[f].ok) {
+            for (const auto& [element, count] : parsed[f].composition) {
+                updated.composition_species.push_back(intern(element));
+                updated.composition_counts.push_back(count);
+            }
+            updated.natoms.push_back(parsed[f].natoms);
+            updated.volumes.push_back(parsed[f].volume);
+            stats.parsed++;
+        } else {
+            stats.failed++;
+            continue;
+        }
+        updated.paths.push_back(std::move(files[f].path));
+        updated.mtimes.push_back(files[f].mtime);
+        updated.file_sizes.push_back(files[f].size);
+        updated.composition_offsets.push_back(static_cast<std::uint32_t>(updated.composition_species.size()));
+    }
+
+    index = std::move(updated);
+    return stats;
+}
+
+std::vector<std::size_t> queryStructureIndex(const StructureIndex& index, const IndexQuery& query) {
+    ScopedTimer timer("query_index", index.size());
+    std::vector<std::size_t> matches;
+
+    // Resolve element names to species ids once; a required element missing from the table matches nothing
+    auto lookup = [&](const std::string& name) -> int {
+        auto it = std::find(index.species.begin(), index.species.end(), name);
+        return it == index.species.end() ? -1 : static_cast<int>(it - index.species.begin());
+    };
+    std::vector<int> required, excluded;
+    for (const std::string& name : query.contains) {
+        required.push_back(lookup(name));
+        if (required.back() < 0)
+            return matches;
+    }
+    for (const std::string& name : query.exclude)
+        if (int id = lookup(name); id >= 0)
+            excluded.push_back(id);
+
+    std::vector<std::pair<int, int>> formula;  // species id, reduced count
+    int formula_gcd = 0;
+    for (const auto& [name, count] : query.formula)
+        formula_gcd = std::gcd(formula_gcd, count);
+    for (const auto& [name, count] : query.formula) {
+        formula.emplace_back(lookup(name), count / formula_gcd);
+        if (formula.back().first < 0)
+            return matches;
+    }
+
+    std::vector<char> present(index.species.size(), 0);
+    for (size_t i = 0; i < index.size(); ++i) {
+        // Numeric columns first, they reject most entries without touching the composition
+        if (index.natoms[i] < query.min_atoms || index.natoms[i] > query.max_atoms ||
+            index.volumes[i] < query.min_volume || index.volumes[i] > query.max_volume)
+            continue;
+
+        const std::uint32_t begin = index.composition_offsets[i], end = index.composition_offsets[i + 1];
+        for (std::uint32_t k = begin; k < end; ++k)
+            present[index.composition_species[k]] = 1;
+
+        bool match = std::all_of(required.begin(), required.end(), [&](int id) { return present[id]; }) &&
+                     std::none_of(excluded.begin(), excluded.end(), [&](int id) { return present[id]; });
+        if (match && !formula.empty()) {
+            match = end - begin == formula.size();
+            const int g = gcdOf(index.composition_counts.data() + begin, end - begin);
+            for (std::uint32_t k = begin; match && k < end; ++k) {
+                auto it = std::find_if(formula.begin(), formula.end(),
+                                       [&](const auto& f) { return f.first == index.composition_species[k]; });
+                match = it != formula.end() && g > 0 && index.composition_counts[k] / g == it->second;
+            }
+        }
+
+        for (std::uint32_t k = begin; k < end; ++k)
+            present[index.composition_species[k]] = 0;
+        if (match)
+            matches.push_back(i);
+    }
+    return matches;
+}
+
+bool parseFormula(const std::string& text, std::vector<std::pair<std::string, int>>& composition) {
+    composition.clear();
+    size_t i = 0;
+    while (i < text.size()) {
+        if (!std::isupper(static_cast<unsigned char>(text[i])))
+            return false;
+        size_t start = i++;
+        while (i < text.size() && std::islower(static_cast<unsigned char>(text[i])))
+            ++i;
+        std::string element = text.substr(start, i - start);
+        int count = 0;
+        while (i < text.size() && std::isdigit(static_cast<unsigned char>(text[i])))
+            count = 10 * count + (text[i++] - '0');
+        if (start + element.size() == i)
+            count = 1;  // no digits
+        if (count <= 0)
+            return false;
+
+        auto it = std::find_if(composition.begin(), composition.end(),
+                               [&](const auto& entry) { return entry.first == element; });
+        if (it == composition.end())
+            composition.emplace_back(element, count);
+        else
+            it->second += count;
+    }
+    return !composition.empty();
+}
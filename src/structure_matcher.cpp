@@ -0,0 +1,206 @@
+#include "structure_matcher.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "lattice_utility.h"
+#include "poscar_file.h"
+#include "symmetry.h"
+
+namespace {
+
+using IntMatrix = std::array<std::array<int, 3>, 3>;
+
+// Per-atom species index, shared between both structures through the name table
+std::vector<int> speciesOf(const POSCAR& poscar, std::map<std::string, int>& names) {
+    std::vector<int> species;
+    species.reserve(poscar.total_atoms);
+    if (poscar.speciesConsistent()) {
+        std::vector<int> shared;
+        for (const std::string& name : poscar.species)
+            shared.push_back(names.emplace(name, static_cast<int>(names.size())).first->second);
+        for (std::uint16_t type : poscar.atom_types)
+            species.push_back(shared[type]);
+        return species;
+    }
+    for (size_t i = 0; i < poscar.elements.size() && i < poscar.num_atoms.size(); ++i) {
+        auto it = names.emplace(poscar.elements[i], static_cast<int>(names.size())).first;
+        species.insert(species.end(), poscar.num_atoms[i], it->second);
+    }
+    return species;
+}
+
+void metricTensor(const double lattice[3][3], double g[3][3]) {
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            g[i][j] = lattice[i][0] * lattice[j][0] + lattice[i][1] * lattice[j][1] + lattice[i][2] * lattice[j][2];
+}
+
+// Unimodular matrices R with entries in {-1, 0, 1} and R Ga R^T ~ Gb
+std::vector<IntMatrix> metricMaps(const double lattice_a[3][3], const double lattice_b[3][3], double tolerance) {
+    double ga[3][3], gb[3][3];
+    metricTensor(lattice_a, ga);
+    metricTensor(lattice_b, gb);
+
+    double scale = std::max({gb[0][0], gb[1][1], gb[2][2]});
+    std::vector<IntMatrix> maps;
+
+    // Rows of R are lattice vectors of A expressed in A's basis; each must match the length of b_i
+    std::vector<std::array<int, 3>> rows;
+    for (int x = -1; x <= 1; ++x)
+        for (int y = -1; y <= 1; ++y)
+            for (int z = -1; z <= 1; ++z)
+                if (x != 0 || y != 0 || z != 0)
+                    rows.push_back({x, y, z});
+
+    auto dot = [&](const std::array<int, 3>& u, const std::array<int, 3>& v) {
+        double s = 0.0;
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                s += u[i] * ga[i][j] * v[j];
+        return s;
+    };
+
+    std::vector<std::array<int, 3>> candidates[3];
+    for (int k = 0; k < 3; ++k)
+        for (const auto& r : rows)
+            if (std::abs(dot(r, r) - gb[k][k]) <= tolerance * scale)
+                candidates[k].push_back(r);
+
+    for (const auto& r0 : candidates[0])
+        for (const auto& r1 : candidates[1]) {
+            if (std::abs(dot(r0, r1) - gb[0][1]) > tolerance * scale)
+                continue;
+            for (const auto& r2 : candidates[2]) {
+                if (std::abs(dot(r0, r2) - gb[0][2]) > tolerance * scale ||
+                    std::abs(dot(r1, r2) - gb[1][2]) > tolerance * scale)
+                    continue;
+                int det = r0[0] * (r1[1] * r2[2] - r1[2] * r2[1]) - r0[1] * (r1[0] * r2[2] - r1[2] * r2[0]) +
+                          r0[2] * (r1[0] * r2[1] - r1[1] * r2[0]);
+                if (det == 1 || det == -1)
+                    maps.push_back({r0, r1, r2});
+            }
+        }
+    return maps;
+}
+
+void integerInverse(const IntMatrix& m, double inv[3][3]) {
+    double md[3][3];
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            md[i][j] = m[i][j];
+    invert3(md, inv);
+}
+
+bool sitesMatch(const std::vector<std::array<double, 3>>& frac_a, const std::vector<int>& species_a,
+                const std::vector<std::array<double, 3>>& frac_b, const std::vector<int>& species_b,
+                const double shift[3], const double lattice[3][3], double tolerance) {
+    std::vector<char> used(frac_b.size(), 0);
+
+    for (size_t i = 0; i < frac_a.size(); ++i) {
+        bool found = false;
+        for (size_t j = 0; j < frac_b.size() && !found; ++j) {
+            if (used[j] || species_b[j] != species_a[i])
+                continue;
+            double d[3];
+            for (int k = 0; k < 3; ++k)
+                d[k] = frac_a[i][k] + shift[k] - frac_b[j][k];
+            if (minimumImageDistance(lattice, d) <= tolerance) {
+                used[j] = 1;
+                found = true;
+            }
+        }
+        if (!found)
+            return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+POSCAR standardizeForMatching(const POSCAR& poscar, double symprec) {
+    auto standardized = makeConventionalCell(poscar, symprec);
+    if (standardized)
+        return *standardized;
+
+    POSCAR copy = poscar;
+    copy.toDirect();
+    return copy;
+}
+
+bool standardizedStructuresMatch(const POSCAR& a, const POSCAR& b, const MatchOptions& options) {
+    if (a.total_atoms != b.total_atoms || a.total_atoms == 0)
+        return false;
+
+    std::map<std::string, int> names;
+    std::vector<int> species_a = speciesOf(a, names);
+    std::vector<int> species_b = speciesOf(b, names);
+    if (species_a.size() != static_cast<size_t>(a.total_atoms) || species_b.size() != species_a.size())
+        return false;
+
+    {
+        std::vector<int> sa = species_a, sb = species_b;
+        std::sort(sa.begin(), sa.end());
+        std::sort(sb.begin(), sb.end());
+        if (sa != sb)
+            return false;
+    }
+
+    double vol_a = cellVolume(a.lattice), vol_b = cellVolume(b.lattice);
+    if (std::abs(vol_a - vol_b) > 3.0 * options.length_tolerance * std::max(vol_a, vol_b))
+        return false;
+
+    // Rarest species gives the fewest anchor translations to try
+    std::map<int, int> population;
+    for (int s : species_a)
+        population[s]++;
+    int anchor_species = population.begin()->first;
+    for (const auto& [s, n] : population)
+        if (n < population[anchor_species])
+            anchor_species = s;
+    size_t anchor = std::find(species_a.begin(), species_a.end(), anchor_species) - species_a.begin();
+
+    auto fractional = [](const POSCAR& p) {
+        POSCAR direct = p;
+        direct.toDirect();
+        std::vector<std::array<double, 3>> f(direct.coordinates.size());
+        for (size_t i = 0; i < f.size(); ++i)
+            f[i] = {direct.coordinates[i].x, direct.coordinates[i].y, direct.coordinates[i].z};
+        return f;
+    };
+    std::vector<std::array<double, 3>> frac_a = fractional(a);
+    std::vector<std::array<double, 3>> frac_b = fractional(b);
+
+    for (const IntMatrix& r : metricMaps(a.lattice, b.lattice, 2.0 * options.length_tolerance)) {
+        // Express A in the basis R * L_a, which has the metric of B: f' = f * R^-1
+        double r_inv[3][3];
+        integerInverse(r, r_inv);
+
+        std::vector<std::array<double, 3>> mapped(frac_a.size());
+        for (size_t i = 0; i < frac_a.size(); ++i)
+            for (int k = 0; k < 3; ++k)
+                mapped[i][k] = frac_a[i][0] * r_inv[0][k] + frac_a[i][1] * r_inv[1][k] + frac_a[i][2] * r_inv[2][k];
+
+        for (size_t j = 0; j < frac_b.size(); ++j) {
+            if (species_b[j] != anchor_species)
+                continue;
+            double shift[3];
+            for (int k = 0; k < 3; ++k)
+                shift[k] = frac_b[j][k] - mapped[anchor][k];
+            if (sitesMatch(mapped, species_a, frac_b, species_b, shift, b.lattice, options.site_tolerance))
+                return true;
+        }
+    }
+    return false;
+}
+
+bool structuresEquivalent(const POSCAR& a, const POSCAR& b, const MatchOptions& options) {
+    POSCAR std_a = standardizeForMatching(a, options.symprec);
+    POSCAR std_b = standardizeForMatching(b, options.symprec);
+    return standardizedStructuresMatch(std_a, std_b, options);
+}
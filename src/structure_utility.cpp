@@ -0,0 +1,168 @@
+#include "structure_utility.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lattice_utility.h"
+
+POSCAR makeSupercell(const POSCAR& poscar, const int transform[3][3]) {
+    POSCAR input = poscar;
+    input.toDirect();
+
+    double t[3][3];
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            t[i][j] = transform[i][j];
+
+    double t_inv[3][3];
+    if (!invert3(t, t_inv)) {
+        std::cerr << "Error: supercell transformation matrix is singular.\n";
+        return input;
+    }
+    const int multiplicity = static_cast<int>(std::lround(std::abs(determinant3(t))));
+
+    POSCAR super;
+    super.comment = poscar.comment;
+    super.scale = 1.0;
+    super.is_direct = true;
+    super.selective_dynamics = input.selective_dynamics;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            super.lattice[i][j] = t[i][0] * input.lattice[0][j] + t[i][1] * input.lattice[1][j] +
+                                  t[i][2] * input.lattice[2][j];
+
+    super.elements = input.elements;
+    super.num_atoms = input.num_atoms;
+    for (int& n : super.num_atoms)
+        n *= multiplicity;
+    super.total_atoms = input.total_atoms * multiplicity;
+
+    // Parent lattice translations n = f' * T for f' in the unit cube: bound them by the cube corners
+    int lo[3], hi[3];
+    for (int k = 0; k < 3; ++k) {
+        double mn = 0.0, mx = 0.0;
+        for (int c = 1; c < 8; ++c) {
+            double v = 0.0;
+            for (int i = 0; i < 3; ++i)
+                if (c & (1 << i))
+                    v += t[i][k];
+            mn = std::min(mn, v);
+            mx = std::max(mx, v);
+        }
+        lo[k] = static_cast<int>(std::floor(mn)) - 1;
+        hi[k] = static_cast<int>(std::ceil(mx)) + 1;
+    }
+
+    const double eps = 1e-8;
+    super.coordinates.reserve(super.total_atoms);
+    for (size_t a = 0; a < input.coordinates.size(); ++a) {
+        const Atom& atom = input.coordinates[a];
+        const std::uint8_t flags = a < input.selective_flags.size() ? input.selective_flags[a] : kMoveAll;
+        const double f[3] = {wrapFractional(atom.x), wrapFractional(atom.y), wrapFractional(atom.z)};
+        for (int n0 = lo[0]; n0 <= hi[0]; ++n0)
+            for (int n1 = lo[1]; n1 <= hi[1]; ++n1)
+                for (int n2 = lo[2]; n2 <= hi[2]; ++n2) {
+                    const double p[3] = {f[0] + n0, f[1] + n1, f[2] + n2};
+                    double s[3];
+                    bool inside = true;
+                    for (int k = 0; k < 3 && inside; ++k) {
+                        s[k] = p[0] * t_inv[0][k] + p[1] * t_inv[1][k] + p[2] * t_inv[2][k];
+                        inside = s[k] >= -eps && s[k] < 1.0 - eps;
+                    }
+                    if (inside) {
+                        super.coordinates.push_back({wrapFractional(s[0]), wrapFractional(s[1]), wrapFractional(s[2])});
+                        if (super.selective_dynamics)
+                            super.selective_flags.push_back(flags);
+                    }
+                }
+    }
+
+    if (static_cast<int>(super.coordinates.size()) != super.total_atoms) {
+        std::cerr << "Error: supercell construction produced " << super.coordinates.size() << " atoms, expected "
+                  << super.total_atoms << ".\n";
+    }
+    super.updateSpecies();
+
+    return super;
+}
+
+POSCAR makeSupercell(const POSCAR& poscar, int na, int nb, int nc) {
+    const int transform[3][3] = {{na, 0, 0}, {0, nb, 0}, {0, 0, nc}};
+    return makeSupercell(poscar, transform);
+}
+
+std::vector<std::string> atomSpecies(const POSCAR& poscar) {
+    std::vector<std::string> species;
+    species.reserve(poscar.total_atoms);
+    for (size_t i = 0; i < poscar.elements.size() && i < poscar.num_atoms.size(); ++i)
+        species.insert(species.end(), poscar.num_atoms[i], poscar.elements[i]);
+    return species;
+}
+
+POSCAR buildPOSCAR(const std::string& comment, const double lattice[3][3], const std::vector<std::string>& species,
+                   const std::vector<Atom>& fractional, const std::vector<std::string>& element_order,
+                   const std::vector<std::uint8_t>& flags) {
+    POSCAR out;
+    out.comment = comment;
+    out.scale = 1.0;
+    out.is_direct = true;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            out.lattice[i][j] = lattice[i][j];
+
+    // Intern the species once; atoms are then placed by type index instead of comparing strings per atom
+    std::unordered_map<std::string, std::uint16_t> seen;
+    std::vector<std::string> first;  // in order of first appearance
+    std::vector<std::uint16_t> type(species.size());
+    for (size_t i = 0; i < species.size(); ++i) {
+        auto [it, inserted] = seen.emplace(species[i], static_cast<std::uint16_t>(first.size()));
+        if (inserted)
+            first.push_back(species[i]);
+        type[i] = it->second;
+    }
+
+    // Output rank of every type: element_order first, the rest in order of appearance
+    std::vector<int> rank(first.size(), -1);
+    int n_ranked = 0;
+    for (const auto& el : element_order) {
+        auto it = seen.find(el);
+        if (it != seen.end() && rank[it->second] < 0)
+            rank[it->second] = n_ranked++;
+    }
+    for (size_t t = 0; t < first.size(); ++t)
+        if (rank[t] < 0)
+            rank[t] = n_ranked++;
+
+    out.species.resize(first.size());
+    out.num_atoms.assign(first.size(), 0);
+    for (size_t t = 0; t < first.size(); ++t)
+        out.species[rank[t]] = first[t];
+    for (size_t i = 0; i < species.size(); ++i)
+        out.num_atoms[rank[type[i]]]++;
+    out.elements = out.species;
+
+    // Stable counting sort of the atoms by output rank
+    std::vector<size_t> offset(first.size() + 1, 0);
+    for (size_t r = 0; r < first.size(); ++r)
+        offset[r + 1] = offset[r] + out.num_atoms[r];
+    out.selective_dynamics = !flags.empty();
+    out.coordinates.resize(species.size());
+    out.atom_types.resize(species.size());
+    if (out.selective_dynamics)
+        out.selective_flags.resize(species.size());
+    for (size_t i = 0; i < species.size(); ++i) {
+        const int r = rank[type[i]];
+        const size_t slot = offset[r]++;
+        out.coordinates[slot] = fractional[i];
+        out.atom_types[slot] = static_cast<std::uint16_t>(r);
+        if (out.selective_dynamics)
+            out.selective_flags[slot] = i < flags.size() ? flags[i] : kMoveAll;
+    }
+    out.total_atoms = static_cast<int>(out.coordinates.size());
+
+    return out;
+}
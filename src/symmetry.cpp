@@ -2,298 +2,378 @@
 
 #include <spglib.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <iomanip>
 #include <iostream>
-#include <map>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <set>
+#include <string>
+#include <string_view>
 #include <vector>
 
+#include "instrumentation.h"
+#include "lattice_utility.h"
 #include "poscar_file.h"
+#include "random_structure.h"
+#include "workspace.h"
 
-SpglibDatasetPtr analyzeSymmetry(const POSCAR& poscar, const double& symprec) {
-    // Make a copy in fractional coordinates
-    POSCAR poscarDirect = poscar;
-    if (!poscarDirect.is_direct) {
-        poscarDirect.toDirect();
-    }
+namespace {
 
-    int num_atoms = static_cast<int>(poscarDirect.total_atoms);
+// spglib input: fractional positions and 1-based types. A type is a species, or with selective dynamics a
+// species together with one combination of flags. The arrays have room for capacity atoms, since spglib
+// writes the primitive or standardized cell back into them. All arrays come from one memory resource, so
+// with a Workspace arena building a cell does not touch the heap.
+struct SpglibCell {
+    explicit SpglibCell(std::pmr::memory_resource* memory)
+        : positions(memory), types(memory), species(memory), type_species(memory), type_flags(memory) {}
 
-    // Prepare lattice as flat 3x3 vector
     double lattice[3][3];
-    for (int i = 0; i < 3; ++i)
-        for (int j = 0; j < 3; ++j)
-            lattice[i][j] = poscarDirect.lattice[i][j];
-
-    // Prepare atomic positions as flat vector (num_atoms*3)
-    double positions[num_atoms][3];
-    for (int i = 0; i < num_atoms; ++i) {
-        positions[i][0] = poscarDirect.coordinates[i].x;
-        positions[i][1] = poscarDirect.coordinates[i].y;
-        positions[i][2] = poscarDirect.coordinates[i].z;
-    }
-
-    // Prepare atomic types
-    int types[num_atoms];
-    int type_counter = 1;
-    std::map<std::string, int> element_map;
-
-    for (size_t i = 0, idx = 0; i < poscarDirect.elements.size(); ++i) {
-        const std::string& el = poscarDirect.elements[i];
-        int n = poscarDirect.num_atoms[i];
-        if (element_map.find(el) == element_map.end())
-            element_map[el] = type_counter++;
-        for (int j = 0; j < n; ++j)
-            types[idx++] = element_map[el];
+    std::pmr::vector<double> positions;
+    std::pmr::vector<int> types;
+    std::pmr::vector<std::string_view> species;  // views into the source POSCAR
+    std::pmr::vector<int> type_species;          // species index of every type
+    std::pmr::vector<std::uint8_t> type_flags;   // selective dynamics flags of every type
+    int num_atoms{0};
+    bool selective_dynamics{false};
+
+    double (*positionData())[3] {
+        return reinterpret_cast<double(*)[3]>(positions.data());
     }
+    std::pmr::memory_resource* memory() const { return positions.get_allocator().resource(); }
+};
 
-    SpglibDataset* dataset = spg_get_dataset(lattice, positions, types, num_atoms, symprec);
-
-    return SpglibDatasetPtr(dataset, &spg_free_dataset);
-}
-
-std::optional<POSCAR> makePrimitiveCell(const POSCAR& poscar, const double& symprec) {
-    // 1) Copy and ensure fractional coordinates
-    POSCAR poscarDirect = poscar;
-    if (!poscarDirect.is_direct) {
-        poscarDirect.toDirect();
-    }
-
-    int num_atoms = static_cast<int>(poscarDirect.total_atoms);
-
-    // 2) Prepare C‑arrays for spg_find_primitive
-    double lattice[3][3];
+// Fills cell straight from poscar instead of a fractional copy of it: Cartesian coordinates are converted
+// on the fly, and a stale species table is rebuilt from the elements line. With keep_flags, atoms whose
+// selective dynamics flags differ get different types, so the cell spglib returns still carries them.
+bool fillSpglibCell(const POSCAR& poscar, int capacity, bool keep_flags, SpglibCell& cell) {
     for (int i = 0; i < 3; ++i)
         for (int j = 0; j < 3; ++j)
-            lattice[i][j] = poscarDirect.lattice[i][j];
+            cell.lattice[i][j] = poscar.lattice[i][j];
+
+    cell.num_atoms = static_cast<int>(poscar.coordinates.size());
+    cell.positions.resize(3 * static_cast<size_t>(std::max(capacity, cell.num_atoms)));
+    cell.types.resize(std::max(capacity, cell.num_atoms));
+
+    cell.species.clear();
+    if (poscar.speciesConsistent()) {
+        cell.species.assign(poscar.species.begin(), poscar.species.end());
+        for (int i = 0; i < cell.num_atoms; ++i)
+            cell.types[i] = poscar.atom_types[i] + 1;
+    } else {
+        size_t total = 0;
+        for (size_t e = 0; e < poscar.elements.size() && e < poscar.num_atoms.size(); ++e) {
+            auto it = std::find(cell.species.begin(), cell.species.end(), poscar.elements[e]);
+            if (it == cell.species.end())
+                it = cell.species.insert(cell.species.end(), poscar.elements[e]);
+            const int type = static_cast<int>(it - cell.species.begin()) + 1;
+            for (int k = 0; k < poscar.num_atoms[e]; ++k, ++total)
+                if (total < poscar.coordinates.size())
+                    cell.types[total] = type;
+        }
+        if (total != poscar.coordinates.size()) {
+            std::cerr << "Error: atom counts do not match the number of coordinates.\n";
+            return false;
+        }
+    }
 
-    double positions[num_atoms][3];
-    for (int i = 0; i < num_atoms; ++i) {
-        positions[i][0] = poscarDirect.coordinates[i].x;
-        positions[i][1] = poscarDirect.coordinates[i].y;
-        positions[i][2] = poscarDirect.coordinates[i].z;
+    cell.type_species.resize(cell.species.size());
+    for (size_t t = 0; t < cell.species.size(); ++t)
+        cell.type_species[t] = static_cast<int>(t);
+    cell.type_flags.assign(cell.species.size(), kMoveAll);
+    cell.selective_dynamics = keep_flags && poscar.selective_dynamics;
+    if (cell.selective_dynamics && poscar.selective_flags.size() == poscar.coordinates.size()) {
+        cell.type_species.clear();
+        cell.type_flags.clear();
+        for (int i = 0; i < cell.num_atoms; ++i) {
+            const int species = cell.types[i] - 1;
+            const std::uint8_t flags = poscar.selective_flags[i];
+            size_t t = 0;
+            while (t < cell.type_species.size() && (cell.type_species[t] != species || cell.type_flags[t] != flags))
+                ++t;
+            if (t == cell.type_species.size()) {
+                cell.type_species.push_back(species);
+                cell.type_flags.push_back(flags);
+            }
+            cell.types[i] = static_cast<int>(t) + 1;
+        }
     }
 
-    int types[num_atoms];
-    int type_counter = 1;
-    std::map<std::string, int> element_map;
-    for (size_t i = 0, idx = 0; i < poscarDirect.elements.size(); ++i) {
-        const std::string& el = poscarDirect.elements[i];
-        int count = poscarDirect.num_atoms[i];
-        if (element_map.find(el) == element_map.end())
-            element_map[el] = type_counter++;
-        for (int j = 0; j < count; ++j)
-            types[idx++] = element_map[el];
+    double inverse[3][3];
+    if (!poscar.is_direct && !invert3(poscar.lattice, inverse)) {
+        std::cerr << "Error: Matrix inversion failed.\n";
+        return false;
+    }
+    for (int i = 0; i < cell.num_atoms; ++i) {
+        const Atom& atom = poscar.coordinates[i];
+        double* frac = &cell.positions[3 * i];
+        if (poscar.is_direct) {
+            frac[0] = atom.x;
+            frac[1] = atom.y;
+            frac[2] = atom.z;
+        } else {
+            const double cart[3] = {atom.x, atom.y, atom.z};
+            cartesianToFractional(inverse, cart, frac);
+        }
     }
+    return true;
+}
 
-    // Checking if empty spheres are present in input
-    for (const auto& el : poscar.elements) {
+void warnEmptySpheres(const SpglibCell& cell) {
+    for (std::string_view el : cell.species) {
         if (el == "X" || el == "E" || el == "V" || el == "Vac") {
             std::cerr << "Warning: Empty sphere detected.\n"
                       << "SPGLIB will treat them as real atoms and symmetry may change.\n";
         }
     }
-    // 3) Call spglib primitive finder
-    int num_prim = spg_find_primitive(lattice, positions, types, num_atoms, symprec);
-
-    if (num_prim <= 0) {
-        return std::nullopt;  // failed
-    }
-
-    // Determine maximum type index
-    int max_type = 0;
-    for (int i = 0; i < num_prim; ++i)
-        if (types[i] > max_type)
-            max_type = types[i];
-
-    // Create lookup vector (type -> element)
-    std::vector<std::string> type_to_element(max_type + 1);
-
-    // Fill from original element_map
-    for (const auto& [el, t] : element_map)
-        type_to_element[t] = el;
-
-    // 4) Build POSCAR from arrays now holding primitive cell
-    POSCAR prim;
-    prim.comment = poscar.comment + " primitive cell";
-    prim.is_direct = true;
-    prim.total_atoms = num_prim;
+}
 
-    // Copy new lattice
+// Overwrites out with the first n atoms spglib returned, reusing its storage. spglib does not keep atoms of
+// one species together, so they are sorted by species (stably) to group them under the elements line.
+void poscarFromCell(const SpglibCell& cell, int n, const std::string& comment, const char* suffix, POSCAR& out) {
+    const size_t n_species = cell.species.size();
+
+    out.comment.assign(comment).append(suffix);
+    out.scale = 1.0;
+    out.is_direct = true;
+    out.selective_dynamics = cell.selective_dynamics;
+    if (cell.selective_dynamics)
+        out.selective_flags.resize(n);
+    else
+        out.selective_flags.clear();
+    out.total_atoms = n;
     for (int i = 0; i < 3; ++i)
         for (int j = 0; j < 3; ++j)
-            prim.lattice[i][j] = lattice[i][j];
-
-    // Copy positions
-    prim.coordinates.resize(num_prim);
-    for (int i = 0; i < num_prim; ++i) {
-        prim.coordinates[i].x = positions[i][0];
-        prim.coordinates[i].y = positions[i][1];
-        prim.coordinates[i].z = positions[i][2];
+            out.lattice[i][j] = cell.lattice[i][j];
+
+    std::pmr::vector<int> count(n_species, 0, cell.memory());
+    for (int i = 0; i < n; ++i)
+        count[cell.type_species[cell.types[i] - 1]]++;
+
+    // Species that survived, in the order of the input table. The names are copied before out's tables are
+    // touched: cell.species views the input, which may be out itself (in-place conversion).
+    std::pmr::vector<int> new_type(n_species, -1, cell.memory());
+    std::pmr::vector<size_t> offset(cell.memory());
+    std::pmr::vector<std::pmr::string> names(cell.memory());
+    out.num_atoms.clear();
+    size_t next = 0;
+    for (size_t t = 0; t < n_species; ++t) {
+        if (count[t] == 0)
+            continue;
+        new_type[t] = static_cast<int>(names.size());
+        names.emplace_back(cell.species[t]);
+        out.num_atoms.push_back(count[t]);
+        offset.push_back(next);
+        next += count[t];
+    }
+    out.species.resize(names.size());
+    out.elements.resize(names.size());
+    for (size_t k = 0; k < names.size(); ++k) {
+        out.species[k].assign(names[k]);
+        out.elements[k].assign(names[k]);
     }
 
-    prim.elements = poscar.elements;
-    prim.num_atoms.assign(prim.elements.size(), 0);
+    out.coordinates.resize(n);
+    out.atom_types.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const int t = new_type[cell.type_species[cell.types[i] - 1]];
+        const size_t slot = offset[t]++;
+        out.coordinates[slot] = {cell.positions[3 * i], cell.positions[3 * i + 1], cell.positions[3 * i + 2]};
+        out.atom_types[slot] = static_cast<std::uint16_t>(t);
+        if (cell.selective_dynamics)
+            out.selective_flags[slot] = cell.type_flags[cell.types[i] - 1];
+    }
+}
 
-    for (int i = 0; i < num_prim; ++i) {
-        std::string el = type_to_element[types[i]];
+SpglibDatasetPtr datasetOf(const POSCAR& poscar, double symprec, std::pmr::memory_resource* memory) {
+    ScopedTimer phase("analyze_symmetry", poscar.total_atoms);
 
-        // Find element index in original ordering
-        for (size_t j = 0; j < prim.elements.size(); ++j) {
-            if (prim.elements[j] == el) {
-                prim.num_atoms[j]++;
-                break;
-            }
-        }
+    SpglibCell cell(memory);
+    if (!fillSpglibCell(poscar, 0, false, cell))
+        return SpglibDatasetPtr(nullptr, &spg_free_dataset);
+
+    SpglibDataset* dataset = nullptr;
+    {
+        ScopedTimer timer("spglib_dataset", cell.num_atoms);
+        dataset = spg_get_dataset(cell.lattice, cell.positionData(), cell.types.data(), cell.num_atoms, symprec);
     }
-    return prim;
+
+    return SpglibDatasetPtr(dataset, &spg_free_dataset);
 }
 
-std::optional<POSCAR> makeConventionalCell(const POSCAR& poscar, const double& symprec) {
-    // 1) Copy and ensure fractional coordinates
-    POSCAR poscarDirect = poscar;
-    if (!poscarDirect.is_direct) {
-        poscarDirect.toDirect();
-    }
+bool primitiveCell(const POSCAR& poscar, double symprec, std::pmr::memory_resource* memory, POSCAR& out) {
+    ScopedTimer phase("make_primitive", poscar.total_atoms);
 
-    int num_atoms = static_cast<int>(poscarDirect.total_atoms);
+    SpglibCell cell(memory);
+    if (!fillSpglibCell(poscar, 0, true, cell))
+        return false;
 
-    // 2) Prepare C‑arrays for spg_find_primitive
-    double lattice[3][3];
-    for (int i = 0; i < 3; ++i)
-        for (int j = 0; j < 3; ++j)
-            lattice[i][j] = poscarDirect.lattice[i][j];
+    // Checking if empty spheres are present in input
+    warnEmptySpheres(cell);
 
-    double positions[num_atoms][3];
-    for (int i = 0; i < num_atoms; ++i) {
-        positions[i][0] = poscarDirect.coordinates[i].x;
-        positions[i][1] = poscarDirect.coordinates[i].y;
-        positions[i][2] = poscarDirect.coordinates[i].z;
+    int num_prim = 0;
+    {
+        ScopedTimer timer("spglib_primitive", cell.num_atoms);
+        num_prim = spg_find_primitive(cell.lattice, cell.positionData(), cell.types.data(), cell.num_atoms, symprec);
     }
 
-    int types[num_atoms];
-    int type_counter = 1;
-    std::map<std::string, int> element_map;
-    for (size_t i = 0, idx = 0; i < poscarDirect.elements.size(); ++i) {
-        const std::string& el = poscarDirect.elements[i];
-        int count = poscarDirect.num_atoms[i];
-        if (element_map.find(el) == element_map.end())
-            element_map[el] = type_counter++;
-        for (int j = 0; j < count; ++j)
-            types[idx++] = element_map[el];
+    if (num_prim <= 0) {
+        return false;  // failed
     }
 
+    poscarFromCell(cell, num_prim, poscar.comment, " primitive cell", out);
+    return true;
+}
+
+bool conventionalCell(const POSCAR& poscar, double symprec, std::pmr::memory_resource* memory, POSCAR& out) {
+    ScopedTimer phase("make_conventional", poscar.total_atoms);
+
+    SpglibCell cell(memory);
+    // The conventional cell of a primitive input has up to four times as many atoms (face centring)
+    if (!fillSpglibCell(poscar, 4 * static_cast<int>(poscar.coordinates.size()), true, cell))
+        return false;
+
     // Checking if empty spheres are present in input
-    for (const auto& el : poscar.elements) {
-        if (el == "X" || el == "E" || el == "V" || el == "Vac") {
-            std::cerr << "Warning: Empty sphere detected.\n"
-                      << "SPGLIB will treat them as real atoms and symmetry may change.\n";
-        }
-    }
+    warnEmptySpheres(cell);
 
-    // 3) Call spglib standardization
-    int num_std = spg_standardize_cell(lattice, positions, types, num_atoms, 0, 1, symprec);
+    int num_std = 0;
+    {
+        ScopedTimer timer("spglib_standardize", cell.num_atoms);
+        num_std =
+            spg_standardize_cell(cell.lattice, cell.positionData(), cell.types.data(), cell.num_atoms, 0, 1, symprec);
+    }
 
     if (num_std <= 0) {
-        return std::nullopt;
+        return false;
     }
 
-    // Determine maximum type index
-    int max_type = 0;
-    for (int i = 0; i < num_std; ++i)
-        if (types[i] > max_type)
-            max_type = types[i];
+    poscarFromCell(cell, num_std, poscar.comment, " conventional cell", out);
+    return true;
+}
 
-    // Create lookup vector (type -> element)
-    std::vector<std::string> type_to_element(max_type + 1);
+}  // namespace
 
-    // Fill from original element_map
-    for (const auto& [el, t] : element_map)
-        type_to_element[t] = el;
+SpglibDatasetPtr analyzeSymmetry(const POSCAR& poscar, const double& symprec) {
+    return datasetOf(poscar, symprec, std::pmr::get_default_resource());
+}
 
-    // 4) Build POSCAR from arrays now holding primitive cell
-    POSCAR std_poscar;
-    std_poscar.comment = poscar.comment + " conventional cell";
-    std_poscar.is_direct = true;
-    std_poscar.total_atoms = num_std;
+SpglibDatasetPtr analyzeSymmetry(const POSCAR& poscar, const double& symprec, Workspace& workspace) {
+    return datasetOf(poscar, symprec, workspace.resource());
+}
 
-    // Copy new lattice
-    for (int i = 0; i < 3; ++i)
-        for (int j = 0; j < 3; ++j)
-            std_poscar.lattice[i][j] = lattice[i][j];
-
-    // Copy positions
-    std_poscar.coordinates.resize(num_std);
-    for (int i = 0; i < num_std; ++i) {
-        std_poscar.coordinates[i].x = positions[i][0];
-        std_poscar.coordinates[i].y = positions[i][1];
-        std_poscar.coordinates[i].z = positions[i][2];
-    }
+std::optional<POSCAR> makePrimitiveCell(const POSCAR& poscar, const double& symprec) {
+    POSCAR primitive;
+    if (!primitiveCell(poscar, symprec, std::pmr::get_default_resource(), primitive))
+        return std::nullopt;
+    return primitive;
+}
 
-    std_poscar.elements = poscar.elements;
-    std_poscar.num_atoms.assign(std_poscar.elements.size(), 0);
+bool makePrimitiveCell(const POSCAR& poscar, const double& symprec, Workspace& workspace, POSCAR& primitive) {
+    return primitiveCell(poscar, symprec, workspace.resource(), primitive);
+}
 
-    for (int i = 0; i < num_std; ++i) {
-        std::string el = type_to_element[types[i]];
+std::optional<POSCAR> makeConventionalCell(const POSCAR& poscar, const double& symprec) {
+    POSCAR conventional;
+    if (!conventionalCell(poscar, symprec, std::pmr::get_default_resource(), conventional))
+        return std::nullopt;
+    return conventional;
+}
 
-        // Find element index in original ordering
-        for (size_t j = 0; j < std_poscar.elements.size(); ++j) {
-            if (std_poscar.elements[j] == el) {
-                std_poscar.num_atoms[j]++;
-                break;
-            }
-        }
-    }
-    return std_poscar;
+bool makeConventionalCell(const POSCAR& poscar, const double& symprec, Workspace& workspace,
+                          POSCAR& conventional) {
+    return conventionalCell(poscar, symprec, workspace.resource(), conventional);
 }
 
-void printSymmetryInfo(const SpglibDataset& dataset, const bool& wyckoff, const bool& symoperation) {
-    std::cout << "=== Symmetry Information ===\n";
+void printSymmetryInfo(const SpglibDataset& dataset, const bool& wyckoff, const bool& symoperation, std::ostream& out) {
+    out << "=== Symmetry Information ===\n";
 
     // Space group
-    std::cout << "Space group number: " << dataset.spacegroup_number << "\n";
-    std::cout << "International symbol: " << dataset.international_symbol << "\n";
+    out << "Space group number: " << dataset.spacegroup_number << "\n";
+    out << "International symbol: " << dataset.international_symbol << "\n";
 
     // Hall symbol
-    std::cout << "Hall symbol: " << dataset.hall_symbol << "\n";
+    out << "Hall symbol: " << dataset.hall_symbol << "\n";
 
     // Point group
-    std::cout << "Point group: " << dataset.pointgroup_symbol << "\n";
+    out << "Point group: " << dataset.pointgroup_symbol << "\n";
 
     // Symmetry operations
-    std::cout << "\nNumber of symmetry operations: " << dataset.n_operations << "\n";
+    out << "\nNumber of symmetry operations: " << dataset.n_operations << "\n";
 
     if (symoperation)
-        printSymmetryOperations(dataset);
+        printSymmetryOperations(dataset, out);
 
     // Compute number of irreducible atoms
     std::set<int> irreducible_atoms;
     for (int i = 0; i < dataset.n_atoms; ++i)
         irreducible_atoms.insert(dataset.equivalent_atoms[i]);
 
-    std::cout << "\nNumber of Wyckoff positions (irreducible atoms): " << irreducible_atoms.size() << "\n";
+    out << "\nNumber of Wyckoff positions (irreducible atoms): " << irreducible_atoms.size() << "\n";
 
     // Print Wyckoff letters for each atom
     if (wyckoff) {
-        std::cout << "Wyckoff letters: ";
+        out << "Wyckoff letters: ";
         for (int i = 0; i < dataset.n_atoms; ++i) {
             char wyckoff_letter = 'a' + dataset.wyckoffs[i];  // convert 0->'a', 1->'b', ...
-            std::cout << wyckoff_letter << " ";
+            out << wyckoff_letter << " ";
         }
     }
-    std::cout << "\n";
+    out << "\n";
 }
 
-void printSymmetryOperations(const SpglibDataset& dataset) {
+void printSymmetryOperations(const SpglibDataset& dataset, std::ostream& out) {
     for (int i = 0; i < dataset.n_operations; ++i) {
-        std::cout << "Operation " << i + 1 << ":\n";
-        std::cout << "  Rotation matrix:\n";
+        out << "Operation " << i + 1 << ":\n";
+        out << "  Rotation matrix:\n";
         for (int j = 0; j < 3; ++j)
-            std::cout << "   " << std::setw(2) << dataset.rotations[i][j][0] << " " << std::setw(2)
-                      << dataset.rotations[i][j][1] << " " << std::setw(2) << dataset.rotations[i][j][2] << "\n";
-        std::cout << "  Translation vector: " << dataset.translations[i][0] << " " << dataset.translations[i][1] << " "
-                  << dataset.translations[i][2] << "\n";
+            out << "   " << std::setw(2) << dataset.rotations[i][j][0] << " " << std::setw(2)
+                << dataset.rotations[i][j][1] << " " << std::setw(2) << dataset.rotations[i][j][2] << "\n";
+        out << "  Translation vector: " << dataset.translations[i][0] << " " << dataset.translations[i][1] << " "
+            << dataset.translations[i][2] << "\n";
+    }
+}
+
+int countIrreducibleKpoints(const int mesh[3], const int is_shift[3], const int (*rotations)[3][3], int n_rot) {
+    const int n_points = mesh[0] * mesh[1] * mesh[2];
+    ScopedTimer timer("spglib_kmesh", n_points);
+
+    std::vector<int> grid_address(3 * static_cast<size_t>(n_points));
+    std::vector<int> ir_mapping(n_points);
+    const double gamma[1][3] = {{0.0, 0.0, 0.0}};
+
+    return spg_get_stabilized_reciprocal_mesh(reinterpret_cast<int(*)[3]>(grid_address.data()), ir_mapping.data(),
+                                              mesh, is_shift, 1, n_rot, rotations, 1, gamma);
+}
+
+bool spacegroupOperations(int number, std::vector<SymmetryOperation>& operations) {
+    // First (standard) Hall setting of every space group, looked up once
+    static const std::vector<int> hall = [] {
+        std::vector<int> first(231, 0);
+        for (int h = 1; h <= 530; ++h) {
+            const int n = spg_get_spacegroup_type(h).number;
+            if (n >= 1 && n <= 230 && first[n] == 0)
+                first[n] = h;
+        }
+        return first;
+    }();
+
+    operations.clear();
+    if (number < 1 || number > 230 || hall[number] == 0)
+        return false;
+
+    int rotations[192][3][3];
+    double translations[192][3];
+    const int n = spg_get_symmetry_from_database(rotations, translations, hall[number]);
+    for (int k = 0; k < n; ++k) {
+        SymmetryOperation op;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j)
+                op.rotation[i][j] = rotations[k][i][j];
+            op.translation[i] = translations[k][i];
+        }
+        operations.push_back(op);
     }
+    return n > 0;
 }
@@ -0,0 +1,66 @@
+#include "text_writer.h"
+
+#include <charconv>
+#include <cstring>
+
+TextWriter::TextWriter(std::ostream& out, std::size_t capacity) : out_(out), buffer_(capacity, '\0') {}
+
+TextWriter::~TextWriter() {
+    flush();
+}
+
+char* TextWriter::reserve(std::size_t n) {
+    if (used_ + n > buffer_.size()) {
+        flush();
+        if (n > buffer_.size())
+            buffer_.resize(n);
+    }
+    return buffer_.data() + used_;
+}
+
+TextWriter& TextWriter::text(std::string_view s) {
+    if (s.size() > buffer_.size()) {
+        flush();
+        out_.write(s.data(), static_cast<std::streamsize>(s.size()));
+        written_ += s.size();
+        return *this;
+    }
+    std::memcpy(reserve(s.size()), s.data(), s.size());
+    used_ += s.size();
+    return *this;
+}
+
+TextWriter& TextWriter::character(char c) {
+    *reserve(1) = c;
+    used_ += 1;
+    return *this;
+}
+
+TextWriter& TextWriter::integer(long long value) {
+    char* p = reserve(24);
+    used_ = std::to_chars(p, p + 24, value).ptr - buffer_.data();
+    return *this;
+}
+
+TextWriter& TextWriter::fixed(double value, int precision) {
+    // 308 integer digits at most, plus sign, point and the fraction
+    const std::size_t room = 320 + static_cast<std::size_t>(precision);
+    char* p = reserve(room);
+    used_ = std::to_chars(p, p + room, value, std::chars_format::fixed, precision).ptr - buffer_.data();
+    return *this;
+}
+
+TextWriter& TextWriter::general(double value) {
+    char* p = reserve(32);
+    used_ = std::to_chars(p, p + 32, value).ptr - buffer_.data();
+    return *this;
+}
+
+bool TextWriter::flush() {
+    if (used_ > 0) {
+        out_.write(buffer_.data(), static_cast<std::streamsize>(used_));
+        written_ += used_;
+        used_ = 0;
+    }
+    return static_cast<bool>(out_);
+}
@@ -0,0 +1,260 @@
+#include "vasp_utils_c.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "lattice_utility.h"
+#include "memory_stream.h"
+#include "random_utility.h"
+#include "structure_formats.h"
+#include "structure_utility.h"
+#include "text_writer.h"
+#include "vasp_utils_c_internal.h"
+
+// vu_structure_positions and vu_structure_types hand out the POSCAR arrays directly
+static_assert(sizeof(Atom) == 3 * sizeof(double) && std::is_standard_layout<Atom>::value,
+              "Atom must be three packed doubles");
+static_assert(std::is_same<std::uint16_t, unsigned short>::value, "atom types must be unsigned short");
+
+namespace {
+
+thread_local std::string lastError;
+
+const StructureFormat* formatFor(const char* format, const char* fallback, bool writing) {
+    const StructureFormat* found = structureFormatByName(format ? format : fallback);
+    if (found && (writing ? static_cast<bool>(found->write) : static_cast<bool>(found->read)))
+        return found;
+    return nullptr;
+}
+
+}  // namespace
+
+vu_status vuFail(vu_status status, const std::string& message) {
+    lastError = message;
+    return status;
+}
+
+void vuClearError() {
+    lastError.clear();
+}
+
+int vu_api_version(void) {
+    return VU_API_VERSION;
+}
+
+const char* vu_status_string(vu_status status) {
+    switch (status) {
+    case VU_OK:
+        return "success";
+    case VU_ERROR_ARGUMENT:
+        return "invalid argument";
+    case VU_ERROR_PARSE:
+        return "invalid structure text";
+    case VU_ERROR_FORMAT:
+        return "unsupported format";
+    case VU_ERROR_SYMMETRY:
+        return "symmetry search failed";
+    case VU_ERROR_IO:
+        return "file error";
+    case VU_ERROR_BUFFER_TOO_SMALL:
+        return "buffer too small";
+    case VU_ERROR_INTERNAL:
+        return "internal error";
+    }
+    return "unknown status";
+}
+
+const char* vu_last_error(void) {
+    return lastError.c_str();
+}
+
+vu_status vu_structure_create(const double lattice[3][3], size_t n_atoms, const double* positions, int fractional,
+                              const int* types, const char* const* species, size_t n_species, vu_structure** out) {
+    return vuGuard([&] {
+        if (!lattice || !out || (n_atoms > 0 && (!positions || !types)) || (n_species > 0 && !species))
+            return vuFail(VU_ERROR_ARGUMENT, "null pointer");
+        double inverse[3][3];
+        if (!invert3(lattice, inverse))
+            return vuFail(VU_ERROR_ARGUMENT, "singular lattice");
+
+        std::vector<std::string> order(species, species + n_species);
+        std::vector<std::string> atomSpecies(n_atoms);
+        std::vector<Atom> frac(n_atoms);
+        for (size_t i = 0; i < n_atoms; ++i) {
+            if (types[i] < 0 || static_cast<size_t>(types[i]) >= n_species || !species[types[i]])
+                return vuFail(VU_ERROR_ARGUMENT, "species index of atom " + std::to_string(i) + " out of range");
+            atomSpecies[i] = order[types[i]];
+            double f[3] = {positions[3 * i], positions[3 * i + 1], positions[3 * i + 2]};
+            if (!fractional)
+                cartesianToFractional(inverse, &positions[3 * i], f);
+            frac[i] = {f[0], f[1], f[2]};
+        }
+
+        auto structure = std::make_unique<vu_structure>();
+        structure->poscar = buildPOSCAR("System", lattice, atomSpecies, frac, order);
+        if (!fractional)
+            structure->poscar.toCartesian();
+        *out = structure.release();
+        return VU_OK;
+    });
+}
+
+vu_status vu_structure_parse(const char* data, size_t size, const char* format, vu_structure** out) {
+    return vuGuard([&] {
+        if ((!data && size > 0) || !out)
+            return vuFail(VU_ERROR_ARGUMENT, "null pointer");
+        const StructureFormat* reader = formatFor(format, "poscar", false);
+        if (!reader)
+            return vuFail(VU_ERROR_FORMAT, std::string("cannot read format ") + (format ? format : "poscar"));
+
+        MemoryInputBuffer buffer;
+        buffer.reset(data, size);
+        std::istream in(&buffer);
+        auto structure = std::make_unique<vu_structure>();
+        if (!reader->read(in, "buffer", structure->poscar))
+            return vuFail(VU_ERROR_PARSE, "cannot parse the " + reader->name + " text");
+        *out = structure.release();
+        return VU_OK;
+    });
+}
+
+vu_status vu_structure_serialize(const vu_structure* structure, const char* format, char* buffer, size_t capacity,
+                                 size_t* size) {
+    return vuGuard([&] {
+        if (!structure || !size || (!buffer && capacity > 0))
+            return vuFail(VU_ERROR_ARGUMENT, "null pointer");
+        const StructureFormat* writer = formatFor(format, "poscar", true);
+        if (!writer)
+            return vuFail(VU_ERROR_FORMAT, std::string("cannot write format ") + (format ? format : "poscar"));
+
+        std::string text;
+        StringOutputBuffer sink;
+        sink.reset(text);
+        std::ostream stream(&sink);
+        {
+            TextWriter out(stream);
+            writer->write(out, structure->poscar);
+            out.flush();
+        }
+        *size = text.size();
+        if (text.size() > capacity)
+            return vuFail(VU_ERROR_BUFFER_TOO_SMALL, "need " + std::to_string(text.size()) + " bytes");
+        std::memcpy(buffer, text.data(), text.size());
+        return VU_OK;
+    });
+}
+
+vu_status vu_structure_read_file(const char* path, const char* format, vu_structure** out) {
+    return vuGuard([&] {
+        if (!path || !out)
+            return vuFail(VU_ERROR_ARGUMENT, "null pointer");
+        if (format && !formatFor(format, "", false))
+            return vuFail(VU_ERROR_FORMAT, std::string("cannot read format ") + format);
+        auto structure = std::make_unique<vu_structure>();
+        if (!readStructure(path, structure->poscar, format ? format : ""))
+            return vuFail(VU_ERROR_IO, std::string("cannot read structure file ") + path);
+        *out = structure.release();
+        return VU_OK;
+    });
+}
+
+vu_status vu_structure_write_file(const vu_structure* structure, const char* path, const char* format) {
+    return vuGuard([&] {
+        if (!structure || !path)
+            return vuFail(VU_ERROR_ARGUMENT, "null pointer");
+        if (format && !formatFor(format, "", true))
+            return vuFail(VU_ERROR_FORMAT, std::string("cannot write format ") + format);
+        if (!writeStructure(path, structure->poscar, format ? format : ""))
+            return vuFail(VU_ERROR_IO, std::string("cannot write structure file ") + path);
+        return VU_OK;
+    });
+}
+
+vu_status vu_structure_clone(const vu_structure* structure, vu_structure** out) {
+    return vuGuard([&] {
+        if (!structure || !out)
+            return vuFail(VU_ERROR_ARGUMENT, "null pointer");
+        *out = std::make_unique<vu_structure>(*structure).release();
+        return VU_OK;
+    });
+}
+
+void vu_structure_free(vu_structure* structure) {
+    delete structure;
+}
+
+size_t vu_structure_atom_count(const vu_structure* structure) {
+    return structure ? structure->poscar.coordinates.size() : 0;
+}
+
+void vu_structure_lattice(const vu_structure* structure, double lattice[3][3]) {
+    if (!structure || !lattice)
+        return;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            lattice[i][j] = structure->poscar.lattice[i][j] * structure->poscar.scale;
+}
+
+int vu_structure_is_fractional(const vu_structure* structure) {
+    return structure && structure->poscar.is_direct ? 1 : 0;
+}
+
+const double* vu_structure_positions(const vu_structure* structure) {
+    if (!structure || structure->poscar.coordinates.empty())
+        return nullptr;
+    return &structure->poscar.coordinates.front().x;
+}
+
+size_t vu_structure_species_count(const vu_structure* structure) {
+    return structure ? structure->poscar.species.size() : 0;
+}
+
+const char* vu_structure_species_name(const vu_structure* structure, size_t index) {
+    if (!structure || index >= structure->poscar.species.size())
+        return nullptr;
+    return structure->poscar.species[index].c_str();
+}
+
+const unsigned short* vu_structure_types(const vu_structure* structure) {
+    if (!structure || structure->poscar.atom_types.empty())
+        return nullptr;
+    return structure->poscar.atom_types.data();
+}
+
+vu_status vu_structure_to_fractional(vu_structure* structure) {
+    return vuGuard([&] {
+        if (!structure)
+            return vuFail(VU_ERROR_ARGUMENT, "null pointer");
+        structure->poscar.toDirect();
+        return VU_OK;
+    });
+}
+
+vu_status vu_structure_to_cartesian(vu_structure* structure) {
+    return vuGuard([&] {
+        if (!structure)
+            return vuFail(VU_ERROR_ARGUMENT, "null pointer");
+        structure->poscar.toCartesian();
+        return VU_OK;
+    });
+}
+
+vu_status vu_structure_displace(vu_structure* structure, int n_atoms, double amplitude, unsigned long seed) {
+    return vuGuard([&] {
+        if (!structure)
+            return vuFail(VU_ERROR_ARGUMENT, "null pointer");
+        if (n_atoms < 0 || amplitude < 0)
+            return vuFail(VU_ERROR_ARGUMENT, "n_atoms and amplitude must not be negative");
+        POSCAR& poscar = structure->poscar;
+        seedRandom(static_cast<unsigned int>(seed));
+        poscar.displaceAtoms(std::min(n_atoms, poscar.total_atoms), amplitude);
+        return VU_OK;
+    });
+}
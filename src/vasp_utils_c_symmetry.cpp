@@ -0,0 +1,64 @@
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <set>
+
+#include "symmetry.h"
+#include "vasp_utils_c.h"
+#include "vasp_utils_c_internal.h"
+
+namespace {
+
+template <std::size_t N>
+void copySymbol(char (&target)[N], const char* source) {
+    std::strncpy(target, source, N - 1);
+    target[N - 1] = '\0';
+}
+
+vu_status standardCell(const vu_structure* structure, double symprec, bool primitive, vu_structure** out) {
+    return vuGuard([&] {
+        if (!structure || !out)
+            return vuFail(VU_ERROR_ARGUMENT, "null pointer");
+        if (symprec <= 0)
+            return vuFail(VU_ERROR_ARGUMENT, "symprec must be positive");
+        std::optional<POSCAR> cell = primitive ? makePrimitiveCell(structure->poscar, symprec)
+                                               : makeConventionalCell(structure->poscar, symprec);
+        if (!cell)
+            return vuFail(VU_ERROR_SYMMETRY, primitive ? "no primitive cell found" : "no conventional cell found");
+        auto result = std::make_unique<vu_structure>();
+        result->poscar = std::move(*cell);
+        *out = result.release();
+        return VU_OK;
+    });
+}
+
+}  // namespace
+
+vu_status vu_symmetry(const vu_structure* structure, double symprec, vu_symmetry_info* info) {
+    return vuGuard([&] {
+        if (!structure || !info)
+            return vuFail(VU_ERROR_ARGUMENT, "null pointer");
+        if (symprec <= 0)
+            return vuFail(VU_ERROR_ARGUMENT, "symprec must be positive");
+        SpglibDatasetPtr dataset = analyzeSymmetry(structure->poscar, symprec);
+        if (!dataset)
+            return vuFail(VU_ERROR_SYMMETRY, "spglib found no symmetry dataset");
+
+        std::set<int> independent(dataset->equivalent_atoms, dataset->equivalent_atoms + dataset->n_atoms);
+        info->spacegroup_number = dataset->spacegroup_number;
+        info->n_operations = dataset->n_operations;
+        info->n_independent_atoms = static_cast<int>(independent.size());
+        copySymbol(info->international_symbol, dataset->international_symbol);
+        copySymbol(info->hall_symbol, dataset->hall_symbol);
+        copySymbol(info->pointgroup_symbol, dataset->pointgroup_symbol);
+        return VU_OK;
+    });
+}
+
+vu_status vu_primitive(const vu_structure* structure, double symprec, vu_structure** out) {
+    return standardCell(structure, symprec, true, out);
+}
+
+vu_status vu_conventional(const vu_structure* structure, double symprec, vu_structure** out) {
+    return standardCell(structure, symprec, false, out);
+}
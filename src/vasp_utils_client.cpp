@@ -0,0 +1,185 @@
+#include "vasp_utils_client.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "compressed_stream.h"
+#include "daemon_protocol.h"
+#include "instrumentation.h"
+
+bool readInput(int argc, char* argv[], std::string& socketPath, std::string& inputFile, std::string& outputFile,
+               DaemonRequest& request, int& repeat) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--socket") {
+            if (i + 1 >= argc)
+                return false;
+            socketPath = argv[++i];
+        } else if (arg == "--command") {
+            if (i + 1 >= argc)
+                return false;
+            request.command = argv[++i];
+        } else if (arg == "--input") {
+            if (i + 1 >= argc)
+                return false;
+            inputFile = argv[++i];
+        } else if (arg == "--output") {
+            if (i + 1 >= argc)
+                return false;
+            outputFile = argv[++i];
+        } else if (arg == "--symprec" || arg == "--natoms" || arg == "--amp" || arg == "--seed" ||
+                   arg == "--input-format" || arg == "--output-format") {
+            // Passed through to the server, which checks the values
+            if (i + 1 >= argc)
+                return false;
+            request.options[arg.substr(2)] = argv[++i];
+        } else if (arg == "--wyckoff" || arg == "--operations" || arg == "--allatoms") {
+            request.options[arg.substr(2)] = "1";
+        } else if (arg == "--repeat") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                repeat = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+bool validateInput(const DaemonRequest& request, int repeat) {
+    if (request.command.empty()) {
+        std::cerr << "Error: --command is required!\n";
+        return false;
+    }
+    for (const auto& [key, value] : request.options) {
+        if (value.empty() || value.find_first_of(" \n") != std::string::npos) {
+            std::cerr << "Error: invalid value for --" << key << "\n";
+            return false;
+        }
+    }
+    if (repeat <= 0) {
+        std::cerr << "Error: repeat count must be positive!\n";
+        return false;
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  vasp_utils_client [options]\n\n"
+                 "Sends one structure to a running vasp_utilsd and prints the result.\n\n"
+                 "Options:\n"
+                 "  --socket     server socket (default: $VASP_UTILSD_SOCKET or /tmp/vasp_utilsd.<uid>.sock)\n"
+                 "  --command    symmetry, primitive, conventional, convert, displace or ping (required)\n"
+                 "  --input      structure file, may be compressed; - reads stdin (default: POSCAR)\n"
+                 "  --output     result file (default: stdout)\n"
+                 "  --symprec    symmetry tolerance (default: 1e-5)\n"
+                 "  --wyckoff    symmetry: print Wyckoff letters\n"
+                 "  --operations symmetry: print the symmetry operations\n"
+                 "  --natoms     displace: number of atoms to displace (default: 1)\n"
+                 "  --allatoms   displace: displace all atoms\n"
+                 "  --amp        displace: maximal displacement in Angstroms (default: 0.01)\n"
+                 "  --seed       displace: random seed for a reproducible result\n"
+                 "  --input-format format of the input (default: poscar)\n"
+                 "  --output-format format of structure results (default: poscar)\n"
+                 "  --repeat     send the request this many times and report the mean latency\n"
+                 "  --timings    print phase timing breakdown to stderr\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr\n"
+                 "  --memstats-json print memory report to stderr as JSON\n"
+                 "  --help       show this help message\n\n"
+                 "Example:\n"
+                 "  vasp_utils_client --command symmetry --input POSCAR --symprec 1e-3 --wyckoff\n"
+                 "  vasp_utils_client --command displace --input POSCAR --allatoms --amp 0.05 --output POSCAR_d\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string socketPath = defaultSocketPath();
+    std::string inputFile{"POSCAR"};
+    std::string outputFile;
+    DaemonRequest request;
+    int repeat{1};
+
+    if (!readInput(argc, argv, socketPath, inputFile, outputFile, request, repeat))
+        return 1;
+
+    if (!validateInput(request, repeat))
+        return 1;
+
+    if (request.command != "ping") {
+        std::ostringstream text;
+        if (inputFile == "-") {
+            text << std::cin.rdbuf();
+        } else {
+            InputFileStream in(inputFile);
+            if (!in) {
+                std::cerr << "Error: cannot open file " << inputFile << "\n";
+                return 1;
+            }
+            text << in.rdbuf();
+        }
+        request.structure = text.str();
+    }
+
+    int fd = connectUnixSocket(socketPath);
+    if (fd < 0) {
+        std::cerr << "Error: no vasp_utilsd listening on " << socketPath << "\n";
+        return 1;
+    }
+
+    std::string frame;
+    DaemonResponse response;
+    const auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; ++r) {
+        formatRequest(request, frame);
+        if (!writeFrame(fd, frame) || !readFrame(fd, frame) || !parseResponse(frame, response)) {
+            std::cerr << "Error: lost connection to the server\n";
+            ::close(fd);
+            return 1;
+        }
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    ::close(fd);
+
+    if (repeat > 1)
+        std::cerr << repeat << " requests, mean round trip " << elapsed.count() / repeat << " us\n";
+
+    if (!response.ok) {
+        std::cerr << "Error: " << response.body << "\n";
+        return 1;
+    }
+    if (outputFile.empty()) {
+        std::cout << response.body;
+    } else {
+        std::ofstream out(outputFile);
+        out << response.body;
+        if (!out) {
+            std::cerr << "Error: failed writing to " << outputFile << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
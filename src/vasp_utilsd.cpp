@@ -0,0 +1,323 @@
+#include "vasp_utilsd.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "daemon_protocol.h"
+#include "instrumentation.h"
+#include "memory_stream.h"
+#include "parallel_utility.h"
+#include "poscar_file.h"
+#include "random_utility.h"
+#include "structure_formats.h"
+#include "symmetry.h"
+#include "text_writer.h"
+#include "workspace.h"
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void onSignal(int) {
+    stopRequested = 1;
+}
+
+// Everything a worker needs per request, allocated once per worker and reused
+struct Worker {
+    std::string frame;
+    DaemonRequest request;
+    DaemonResponse response;
+    MemoryInputBuffer input_buffer;
+    StringOutputBuffer output_buffer;
+    std::istream input{&input_buffer};
+    std::ostream output{&output_buffer};
+    POSCAR poscar;
+    POSCAR cell;  // primitive or conventional result
+    Workspace workspace;
+};
+
+double doubleOption(const DaemonRequest& request, const std::string& key, double fallback) {
+    auto it = request.options.find(key);
+    return it == request.options.end() ? fallback : std::stod(it->second);
+}
+
+int intOption(const DaemonRequest& request, const std::string& key, int fallback) {
+    auto it = request.options.find(key);
+    return it == request.options.end() ? fallback : std::stoi(it->second);
+}
+
+std::string stringOption(const DaemonRequest& request, const std::string& key, const std::string& fallback) {
+    auto it = request.options.find(key);
+    return it == request.options.end() ? fallback : it->second;
+}
+
+bool fail(Worker& worker, const std::string& message) {
+    worker.response.ok = false;
+    worker.response.body = message;
+    return false;
+}
+
+bool writeStructure(Worker& worker, const POSCAR& poscar) {
+    const std::string name = stringOption(worker.request, "output-format", "poscar");
+    const StructureFormat* format = structureFormatByName(name);
+    if (!format || !format->write)
+        return fail(worker, "cannot write format " + name);
+    TextWriter out(worker.output);
+    format->write(out, poscar);
+    out.flush();
+    return true;
+}
+
+// Runs one request; the result or error message ends up in worker.response
+bool handleRequest(Worker& worker) {
+    const DaemonRequest& request = worker.request;
+    worker.response.ok = true;
+    worker.response.body.clear();
+    worker.output.clear();
+    worker.output_buffer.reset(worker.response.body);
+    worker.workspace.reset();
+
+    if (request.command == "ping") {
+        worker.response.body = "pong\n";
+        return true;
+    }
+
+    const std::string inputName = stringOption(request, "input-format", "poscar");
+    const StructureFormat* inputFormat = structureFormatByName(inputName);
+    if (!inputFormat || !inputFormat->read)
+        return fail(worker, "cannot read format " + inputName);
+    worker.input.clear();
+    worker.input_buffer.reset(request.structure.data(), request.structure.size());
+
+    try {
+        if (!inputFormat->read(worker.input, "request", worker.poscar))
+            return fail(worker, "cannot parse the structure");
+
+        const double symprec = doubleOption(request, "symprec", 1e-5);
+        if (request.command == "symmetry") {
+            auto dataset = analyzeSymmetry(worker.poscar, symprec, worker.workspace);
+            if (!dataset)
+                return fail(worker, "failed to analyze symmetry");
+            printSymmetryInfo(*dataset, intOption(request, "wyckoff", 0) != 0,
+                              intOption(request, "operations", 0) != 0, worker.output);
+            return true;
+        }
+        if (request.command == "primitive" || request.command == "conventional") {
+            const bool made = request.command == "primitive"
+                                  ? makePrimitiveCell(worker.poscar, symprec, worker.workspace, worker.cell)
+                                  : makeConventionalCell(worker.poscar, symprec, worker.workspace, worker.cell);
+            if (!made)
+                return fail(worker, "failed to create the " + request.command + " cell");
+            return writeStructure(worker, worker.cell);
+        }
+        if (request.command == "convert")
+            return writeStructure(worker, worker.poscar);
+        if (request.command == "displace") {
+            int natoms = intOption(request, "allatoms", 0) != 0 ? worker.poscar.total_atoms
+                                                                : intOption(request, "natoms", 1);
+            const double amplitude = doubleOption(request, "amp", 0.01);
+            if (natoms <= 0 || amplitude < 0)
+                return fail(worker, "natoms must be positive and amp not negative");
+            if (request.options.count("seed"))
+                seedRandom(static_cast<unsigned int>(std::stoul(request.options.at("seed"))));
+            worker.poscar.displaceAtoms(std::min(natoms, worker.poscar.total_atoms), amplitude);
+            return writeStructure(worker, worker.poscar);
+        }
+    } catch (const std::invalid_argument&) {
+        return fail(worker, "invalid option value");
+    } catch (const std::out_of_range&) {
+        return fail(worker, "invalid option value");
+    } catch (const std::exception& e) {
+        return fail(worker, std::string("request failed: ") + e.what());
+    }
+    return fail(worker, "unknown command " + request.command);
+}
+
+// Connections waiting for a worker, and the ones being served (shut down on exit so idle clients let go)
+class ConnectionQueue {
+public:
+    void push(int fd) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        waiting_.push_back(fd);
+        changed_.notify_one();
+    }
+
+    // Next connection for a worker; -1 once the server stops
+    int pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [&] { return !waiting_.empty() || stopped_; });
+        if (stopped_)
+            return -1;
+        int fd = waiting_.front();
+        waiting_.pop_front();
+        active_.insert(fd);
+        return fd;
+    }
+
+    void done(int fd) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_.erase(fd);
+        ::close(fd);
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+        for (int fd : waiting_)
+            ::close(fd);
+        waiting_.clear();
+        for (int fd : active_)
+            ::shutdown(fd, SHUT_RDWR);
+        changed_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::deque<int> waiting_;
+    std::set<int> active_;
+    bool stopped_{false};
+};
+
+void serve(ConnectionQueue& connections, std::atomic<std::size_t>& served) {
+    Worker worker;
+    for (int fd; (fd = connections.pop()) >= 0;) {
+        // A connection may carry any number of requests; it is served until the client closes it
+        while (readFrame(fd, worker.frame)) {
+            if (!parseRequest(worker.frame, worker.request)) {
+                fail(worker, "malformed request");
+            } else {
+                ScopedTimer timer("daemon_request", worker.request.structure.size());
+                // Nothing a client sends may take the server down
+                try {
+                    handleRequest(worker);
+                } catch (...) {
+                    fail(worker, "internal error");
+                }
+            }
+            formatResponse(worker.response, worker.frame);
+            if (!writeFrame(fd, worker.frame))
+                break;
+            served++;
+        }
+        connections.done(fd);
+    }
+}
+
+}  // namespace
+
+bool readInput(int argc, char* argv[], std::string& socketPath, int& threads) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--help") {
+            printHelp();
+            return false;
+        } else if (arg == "--socket") {
+            if (i + 1 >= argc)
+                return false;
+            socketPath = argv[++i];
+        } else if (arg == "--threads") {
+            if (i + 1 >= argc)
+                return false;
+            try {
+                threads = std::stoi(argv[++i]);
+            } catch (...) {
+                return false;
+            }
+        } else if (arg == "--timings") {
+            enableTimings(TimingFormat::Text);
+        } else if (arg == "--timings-json") {
+            enableTimings(TimingFormat::Json);
+        } else if (arg == "--memstats") {
+            enableMemoryStats(TimingFormat::Text);
+        } else if (arg == "--memstats-json") {
+            enableMemoryStats(TimingFormat::Json);
+        } else {
+            std::cerr << "Warning: unknown argument! Ignoring it!\n";
+            printHelp();
+        }
+    }
+    return true;
+}
+
+void printHelp() {
+    std::cerr << "Usage:\n"
+                 "  vasp_utilsd [options]\n\n"
+                 "Serves symmetry, primitive, conventional, convert and displace requests from vasp_utils_client\n"
+                 "on a Unix domain socket until interrupted (SIGINT or SIGTERM).\n\n"
+                 "Options:\n"
+                 "  --socket     socket path (default: $VASP_UTILSD_SOCKET or /tmp/vasp_utilsd.<uid>.sock)\n"
+                 "  --threads    worker threads, each serving one connection at a time (default: all cores)\n"
+                 "  --timings    print phase timing breakdown to stderr on exit\n"
+                 "  --timings-json print phase timing breakdown to stderr as JSON on exit\n"
+                 "  --memstats   print per-phase allocations and peak memory to stderr on exit\n"
+                 "  --memstats-json print memory report to stderr as JSON on exit\n"
+                 "  --help       show this help message\n\n"
+                 "Example:\n"
+                 "  vasp_utilsd --socket /tmp/vasp.sock --threads 8 &\n"
+                 "  vasp_utils_client --socket /tmp/vasp.sock --command primitive --input POSCAR\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string socketPath = defaultSocketPath();
+    int threads{0};
+
+    if (!readInput(argc, argv, socketPath, threads))
+        return 1;
+
+    int listenFd = listenUnixSocket(socketPath);
+    if (listenFd < 0)
+        return 1;
+
+    struct sigaction action {};
+    action.sa_handler = onSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    ConnectionQueue connections;
+    std::atomic<std::size_t> served{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < resolveThreadCount(threads); ++t)
+        workers.emplace_back(serve, std::ref(connections), std::ref(served));
+    std::cerr << "Listening on " << socketPath << " with " << workers.size() << " workers\n";
+
+    // Poll with a timeout, so a signal arriving between checks still ends the loop promptly
+    while (!stopRequested) {
+        pollfd pfd{listenFd, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, 200);
+        if (ready < 0 && errno != EINTR) {
+            std::cerr << "Error: waiting for connections failed\n";
+            break;
+        }
+        if (ready <= 0)
+            continue;
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd >= 0)
+            connections.push(fd);
+    }
+
+    ::close(listenFd);
+    ::unlink(socketPath.c_str());
+    connections.stop();
+    for (std::thread& worker : workers)
+        worker.join();
+    std::cerr << "Served " << served.load() << " requests\n";
+
+    return 0;
+}
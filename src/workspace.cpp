@@ -0,0 +1,31 @@
+#include "workspace.h"
+
+Workspace::Workspace(std::size_t initial_bytes)
+    : capacity_(initial_bytes > 0 ? initial_bytes : 1), buffer_(new std::byte[capacity_]) {
+    arena_.emplace(buffer_.get(), capacity_, &overflow_);
+}
+
+void Workspace::reset() {
+    const std::size_t overflow = overflow_.bytes();
+    arena_.reset();  // returns the overflow chunks to the heap
+    if (overflow > 0) {
+        capacity_ += overflow;
+        buffer_.reset(new std::byte[capacity_]);
+    }
+    overflow_.clear();
+    arena_.emplace(buffer_.get(), capacity_, &overflow_);
+}
+
+void* Workspace::OverflowResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+    void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    bytes_ += bytes;
+    return p;
+}
+
+void Workspace::OverflowResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool Workspace::OverflowResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
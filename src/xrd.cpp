@@ -0,0 +1,295 @@
+#include "xrd.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "instrumentation.h"
+#include "lattice_utility.h"
+#include "parallel_utility.h"
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+const char* const kSymbols[] = {
+    "H",  "He", "Li", "Be", "B",  "C",  "N",  "O",  "F",  "Ne", "Na", "Mg", "Al", "Si", "P",  "S",  "Cl", "Ar", "K",
+    "Ca", "Sc", "Ti", "V",  "Cr", "Mn", "Fe", "Co", "Ni", "Cu", "Zn", "Ga", "Ge", "As", "Se", "Br", "Kr", "Rb", "Sr",
+    "Y",  "Zr", "Nb", "Mo", "Tc", "Ru", "Rh", "Pd", "Ag", "Cd", "In", "Sn", "Sb", "Te", "I",  "Xe", "Cs", "Ba", "La",
+    "Ce", "Pr", "Nd", "Pm", "Sm", "Eu", "Gd", "Tb", "Dy", "Ho", "Er", "Tm", "Yb", "Lu", "Hf", "Ta", "W",  "Re", "Os",
+    "Ir", "Pt", "Au", "Hg", "Tl", "Pb", "Bi", "Po", "At", "Rn", "Fr", "Ra", "Ac", "Th", "Pa", "U",  "Np", "Pu"};
+constexpr int kElementCount = sizeof(kSymbols) / sizeof(kSymbols[0]);
+
+struct TabulatedFactor {
+    int z;
+    FormFactor factor;
+};
+
+// Neutral-atom coefficients from International Tables for Crystallography Vol. C, Table 6.1.1.4
+const TabulatedFactor kFormFactors[] = {
+    {1, {{0.489918, 0.262003, 0.196767, 0.049879}, {20.6593, 7.74039, 49.5519, 2.20159}, 0.001305}},
+    {3, {{1.12820, 0.750800, 0.617500, 0.465300}, {3.95460, 1.05240, 85.3905, 168.261}, 0.037700}},
+    {4, {{1.59190, 1.12780, 0.539100, 0.702900}, {43.6427, 1.86230, 103.483, 0.542000}, 0.038500}},
+    {5, {{2.05450, 1.33260, 1.09790, 0.706800}, {23.2185, 1.02100, 60.3498, 0.140300}, -0.19320}},
+    {6, {{2.31000, 1.02000, 1.58860, 0.865000}, {20.8439, 10.2075, 0.568700, 51.6512}, 0.215600}},
+    {7, {{12.2126, 3.13220, 2.01250, 1.16630}, {0.005700, 9.89330, 28.9975, 0.582600}, -11.529}},
+    {8, {{3.04850, 2.28680, 1.54630, 0.867000}, {13.2771, 5.70110, 0.323900, 32.9089}, 0.250800}},
+    {9, {{3.53920, 2.64120, 1.51700, 1.02430}, {10.2825, 4.29440, 0.261500, 26.1476}, 0.277600}},
+    {11, {{4.76260, 3.17360, 1.26740, 1.11280}, {3.28500, 8.84220, 0.313600, 129.424}, 0.676000}},
+    {12, {{5.42040, 2.17350, 1.22690, 2.30730}, {2.82750, 79.2611, 0.380800, 7.19370}, 0.858400}},
+    {13, {{6.42020, 1.90020, 1.59360, 1.96460}, {3.03870, 0.742600, 31.5472, 85.0886}, 1.11510}},
+    {14, {{6.29150, 3.03530, 1.98910, 1.54100}, {2.43860, 32.3337, 0.678500, 81.6937}, 1.14070}},
+    {15, {{6.43450, 4.17910, 1.78000, 1.49080}, {1.90670, 27.1570, 0.526000, 68.1645}, 1.11490}},
+    {16, {{6.90530, 5.20340, 1.43790, 1.58630}, {1.46790, 22.2151, 0.253600, 56.1720}, 0.866900}},
+    {17, {{11.4604, 7.19640, 6.25560, 1.64550}, {0.010400, 1.16620, 18.5194, 47.7784}, -9.5574}},
+    {19, {{8.21860, 7.43980, 1.05190, 0.865900}, {12.7949, 0.774800, 213.187, 41.6841}, 1.42280}},
+    {20, {{8.62660, 7.38730, 1.58990, 1.02110}, {10.4421, 0.659900, 85.7484, 178.437}, 1.37510}},
+    {22, {{9.75950, 7.35580, 1.69910, 1.90210}, {7.85080, 0.500000, 35.6338, 116.105}, 1.28070}},
+    {23, {{10.2971, 7.35110, 2.07030, 2.05710}, {6.86570, 0.438500, 26.8938, 102.478}, 1.21990}},
+    {24, {{10.6406, 7.35370, 3.32400, 1.49220}, {6.10380, 0.392000, 20.2626, 98.7399}, 1.18320}},
+    {25, {{11.2819, 7.35730, 3.01930, 2.24410}, {5.34090, 0.343200, 17.8674, 83.7543}, 1.08960}},
+    {26, {{11.7695, 7.35730, 3.52220, 2.30450}, {4.76110, 0.307200, 15.3535, 76.8805}, 1.03690}},
+    {27, {{12.2841, 7.34090, 4.00340, 2.34880}, {4.27910, 0.278400, 13.5359, 71.1692}, 1.01180}},
+    {28, {{12.8376, 7.29200, 4.44380, 2.38000}, {3.87850, 0.256500, 12.1763, 66.3421}, 1.03410}},
+    {29, {{13.3380, 7.16760, 5.61580, 1.67350}, {3.58280, 0.247000, 11.3966, 64.8126}, 1.19100}},
+    {30, {{14.0743, 7.03180, 5.16520, 2.41000}, {3.26550, 0.233300, 10.3163, 58.7097}, 1.30410}},
+    {31, {{15.2354, 6.70060, 4.35910, 2.96230}, {3.06690, 0.241200, 10.7805, 61.4135}, 1.71890}},
+    {32, {{16.0816, 6.37470, 3.70680, 3.68300}, {2.85090, 0.251600, 11.4468, 54.7625}, 2.13130}},
+    {33, {{16.6723, 6.07010, 3.43130, 4.27790}, {2.63450, 0.264700, 12.9479, 47.7972}, 2.53100}},
+    {34, {{17.0006, 5.81960, 3.97310, 4.35430}, {2.40980, 0.272600, 15.2372, 43.8163}, 2.84090}},
+    {35, {{17.1789, 5.23580, 5.63770, 3.98510}, {2.17230, 16.5796, 0.260900, 41.4328}, 2.95570}},
+};
+
+int atomicNumber(const std::string& element) {
+    // Leading symbol only: "Na_pv" and "Fe1" map to Na and Fe
+    std::string symbol;
+    if (!element.empty() && std::isupper(static_cast<unsigned char>(element[0]))) {
+        symbol += element[0];
+        if (element.size() > 1 && std::islower(static_cast<unsigned char>(element[1])))
+            symbol += element[1];
+    }
+    for (int z = 0; z < kElementCount; ++z)
+        if (symbol == kSymbols[z])
+            return z + 1;
+    return 0;
+}
+
+// Powers exp(2 pi i h x) for h in [-range, range] of every atom, stored [h][atom] for contiguous atom loops
+void phaseTable(const std::vector<double>& x, int range, std::vector<double>& re, std::vector<double>& im) {
+    const size_t n = x.size();
+    re.resize((2 * range + 1) * n);
+    im.resize((2 * range + 1) * n);
+    for (int h = -range; h <= range; ++h) {
+        double* r = re.data() + (h + range) * n;
+        double* m = im.data() + (h + range) * n;
+        for (size_t i = 0; i < n; ++i) {
+            r[i] = std::cos(2.0 * kPi * h * x[i]);
+            m[i] = std::sin(2.0 * kPi * h * x[i]);
+        }
+    }
+}
+
+struct Reflection {
+    double two_theta;
+    double d_spacing;
+    double intensity;
+    std::array<int, 3> hkl;
+};
+
+}  // namespace
+
+bool formFactor(const std::string& element, FormFactor& factor, std::string& substitute) {
+    substitute.clear();
+    const int z = atomicNumber(element);
+    if (z == 0)
+        return false;
+
+    const TabulatedFactor* nearest = &kFormFactors[0];
+    for (const auto& entry : kFormFactors)
+        if (std::abs(entry.z - z) < std::abs(nearest->z - z))
+            nearest = &entry;
+
+    factor = nearest->factor;
+    if (nearest->z != z) {
+        // Keep the shape of the nearest tabulated atom and scale f(0) to the right electron count
+        const double scale = static_cast<double>(z) / nearest->z;
+        for (double& a : factor.a)
+            a *= scale;
+        factor.c *= scale;
+        substitute = kSymbols[nearest->z - 1];
+    }
+    return true;
+}
+
+double scatteringFactor(const FormFactor& factor, double s) {
+    const double s2 = s * s;
+    double f = factor.c;
+    for (int i = 0; i < 4; ++i)
+        f += factor.a[i] * std::exp(-factor.b[i] * s2);
+    return f;
+}
+
+std::vector<XrdPeak> simulateXrd(const POSCAR& poscar, const std::vector<FormFactor>& species_factors,
+                                 const XrdOptions& options) {
+    POSCAR direct = poscar;
+    direct.toDirect();
+
+    std::vector<XrdPeak> peaks;
+    const size_t n = direct.coordinates.size();
+    if (n == 0 || species_factors.size() != direct.num_atoms.size())
+        return peaks;
+
+    double reciprocal[3][3];
+    reciprocalLattice(direct.lattice, reciprocal);
+
+    const double sin_max = std::sin(0.5 * options.two_theta_max * kPi / 180.0);
+    const double sin_min = std::sin(0.5 * options.two_theta_min * kPi / 180.0);
+    const double g_max = 2.0 * sin_max / options.wavelength;
+
+    // |h| <= g_max |a_1| because h = G . a_1
+    int range[3];
+    for (int k = 0; k < 3; ++k) {
+        const double length = std::sqrt(direct.lattice[k][0] * direct.lattice[k][0] +
+                                        direct.lattice[k][1] * direct.lattice[k][1] +
+                                        direct.lattice[k][2] * direct.lattice[k][2]);
+        range[k] = static_cast<int>(std::floor(g_max * length + 1e-9));
+    }
+
+    std::vector<double> x(n), y(n), z(n);
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = direct.coordinates[i].x;
+        y[i] = direct.coordinates[i].y;
+        z[i] = direct.coordinates[i].z;
+    }
+    std::vector<double> xr, xi, yr, yi, zr, zi;
+    {
+        ScopedTimer phase("xrd_phase_tables", n);
+        phaseTable(x, range[0], xr, xi);
+        phaseTable(y, range[1], yr, yi);
+        phaseTable(z, range[2], zr, zi);
+    }
+
+    std::vector<size_t> block_begin{0};
+    for (int count : direct.num_atoms)
+        block_begin.push_back(block_begin.back() + count);
+    const size_t n_species = species_factors.size();
+
+    // One task per (h, k) column; Friedel mates are skipped, so only half of reciprocal space is visited
+    std::vector<std::array<int, 2>> columns;
+    for (int h = 0; h <= range[0]; ++h)
+        for (int k = (h == 0 ? 0 : -range[1]); k <= range[1]; ++k)
+            columns.push_back({h, k});
+
+    std::vector<std::vector<Reflection>> found(columns.size());
+    {
+        ScopedTimer phase("xrd_structure_factors", n * columns.size());
+        parallelFor(columns.size(), options.threads, [&](size_t c) {
+            const int h = columns[c][0], k = columns[c][1];
+            const double* hr = xr.data() + (h + range[0]) * n;
+            const double* hi = xi.data() + (h + range[0]) * n;
+            const double* kr = yr.data() + (k + range[1]) * n;
+            const double* ki = yi.data() + (k + range[1]) * n;
+            std::vector<double> pr(n), pi(n);
+            for (size_t i = 0; i < n; ++i) {
+                pr[i] = hr[i] * kr[i] - hi[i] * ki[i];
+                pi[i] = hr[i] * ki[i] + hi[i] * kr[i];
+            }
+
+            std::vector<Reflection>& out = found[c];
+            for (int l = (h == 0 && k == 0 ? 1 : -range[2]); l <= range[2]; ++l) {
+                double g[3];
+                for (int m = 0; m < 3; ++m)
+                    g[m] = h * reciprocal[0][m] + k * reciprocal[1][m] + l * reciprocal[2][m];
+                const double g_len = std::sqrt(g[0] * g[0] + g[1] * g[1] + g[2] * g[2]);
+                const double sin_theta = 0.5 * options.wavelength * g_len;
+                if (sin_theta > sin_max || sin_theta < sin_min)
+                    continue;
+
+                const double* lr = zr.data() + (l + range[2]) * n;
+                const double* li = zi.data() + (l + range[2]) * n;
+                const double s = 0.5 * g_len;
+                double f_re = 0.0, f_im = 0.0;
+                for (size_t sp = 0; sp < n_species; ++sp) {
+                    // Four partial sums so the reduction vectorizes without reassociation flags
+                    double acc_re[4] = {0, 0, 0, 0}, acc_im[4] = {0, 0, 0, 0};
+                    size_t i = block_begin[sp];
+                    const size_t end = block_begin[sp + 1];
+                    for (; i + 4 <= end; i += 4)
+                        for (int u = 0; u < 4; ++u) {
+                            acc_re[u] += pr[i + u] * lr[i + u] - pi[i + u] * li[i + u];
+                            acc_im[u] += pr[i + u] * li[i + u] + pi[i + u] * lr[i + u];
+                        }
+                    for (; i < end; ++i) {
+                        acc_re[0] += pr[i] * lr[i] - pi[i] * li[i];
+                        acc_im[0] += pr[i] * li[i] + pi[i] * lr[i];
+                    }
+                    const double f = scatteringFactor(species_factors[sp], s);
+                    f_re += f * (acc_re[0] + acc_re[1] + acc_re[2] + acc_re[3]);
+                    f_im += f * (acc_im[0] + acc_im[1] + acc_im[2] + acc_im[3]);
+                }
+
+                const double theta = std::asin(sin_theta);
+                const double cos2 = std::cos(2.0 * theta);
+                const double lp = (1.0 + cos2 * cos2) / (sin_theta * sin_theta * std::cos(theta));
+                // Factor 2 for the skipped Friedel mate
+                out.push_back({2.0 * theta * 180.0 / kPi, 1.0 / g_len, 2.0 * lp * (f_re * f_re + f_im * f_im),
+                               {h, k, l}});
+            }
+        });
+    }
+
+    // Extinct reflections are numerically zero; dropping them keeps them out of accidental 2 theta overlaps
+    double strongest_reflection = 0.0;
+    for (const auto& column : found)
+        for (const auto& r : column)
+            strongest_reflection = std::max(strongest_reflection, r.intensity);
+    std::vector<Reflection> reflections;
+    for (const auto& column : found)
+        for (const auto& r : column)
+            if (r.intensity > 1e-10 * strongest_reflection)
+                reflections.push_back(r);
+    std::sort(reflections.begin(), reflections.end(),
+              [](const Reflection& a, const Reflection& b) { return a.two_theta < b.two_theta; });
+
+    for (const auto& r : reflections) {
+        if (peaks.empty() || r.two_theta - peaks.back().two_theta > options.merge_tolerance) {
+            peaks.push_back({r.two_theta, r.d_spacing, 0.0, r.hkl, 0});
+        } else if (r.hkl > peaks.back().hkl) {
+            peaks.back().hkl = r.hkl;
+        }
+        peaks.back().intensity += r.intensity;
+        peaks.back().multiplicity += 2;
+    }
+
+    double strongest = 0.0;
+    for (const auto& p : peaks)
+        strongest = std::max(strongest, p.intensity);
+    if (strongest <= 0.0)
+        return {};
+    for (auto& p : peaks)
+        p.intensity *= 100.0 / strongest;
+    peaks.erase(std::remove_if(peaks.begin(), peaks.end(),
+                               [&](const XrdPeak& p) { return p.intensity < options.min_intensity; }),
+                peaks.end());
+    return peaks;
+}
+
+std::vector<double> broadenPattern(const std::vector<XrdPeak>& peaks, double two_theta_min, double two_theta_max,
+                                   double step, double fwhm) {
+    const size_t n_points = static_cast<size_t>(std::floor((two_theta_max - two_theta_min) / step + 1e-9)) + 1;
+    std::vector<double> pattern(n_points, 0.0);
+    const double sigma = fwhm / (2.0 * std::sqrt(2.0 * std::log(2.0)));
+    const double window = 5.0 * sigma;
+    for (const auto& p : peaks) {
+        const long first = std::max(0L, static_cast<long>(std::ceil((p.two_theta - window - two_theta_min) / step)));
+        const long last = std::min(static_cast<long>(n_points) - 1,
+                                   static_cast<long>(std::floor((p.two_theta + window - two_theta_min) / step)));
+        for (long i = first; i <= last; ++i) {
+            const double t = (two_theta_min + i * step - p.two_theta) / sigma;
+            pattern[i] += p.intensity * std::exp(-0.5 * t * t);
+        }
+    }
+    return pattern;
+}
@@ -0,0 +1,35 @@
+# Lists the dynamic symbols defined by the vasp_utils shared library and fails if any of them is not part
+# of the C API (vu_*). Run by CTest as: cmake -DNM=<nm> -DLIBRARY=<path> -P check_exports.cmake
+
+execute_process(COMMAND ${NM} -D --defined-only ${LIBRARY}
+    OUTPUT_VARIABLE symbols
+    RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${NM} failed on ${LIBRARY}")
+endif()
+
+string(REPLACE "\n" ";" lines "${symbols}")
+set(exported 0)
+set(unexpected "")
+foreach(line IN LISTS lines)
+    # "<address> <type> <name>"; type A marks version nodes, which are not symbols
+    if(NOT line MATCHES "^[0-9a-fA-F]* +([A-Za-z]) +([^ ]+)$" OR CMAKE_MATCH_1 STREQUAL "A")
+        continue()
+    endif()
+    set(name "${CMAKE_MATCH_2}")
+    message(STATUS "exported: ${name}")
+    if(name MATCHES "^vu_")
+        math(EXPR exported "${exported} + 1")
+    else()
+        list(APPEND unexpected ${name})
+    endif()
+endforeach()
+
+if(unexpected)
+    list(LENGTH unexpected n)
+    message(FATAL_ERROR "${LIBRARY} exports ${n} symbols outside the C API: ${unexpected}")
+endif()
+if(exported EQUAL 0)
+    message(FATAL_ERROR "${LIBRARY} exports no vu_* symbols")
+endif()
+message(STATUS "${exported} vu_* symbols exported")
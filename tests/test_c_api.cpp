@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "vasp_utils_c.h"
+
+static std::string naclText() {
+    std::ifstream in(std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar");
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+TEST(CApi, ParsesAndSerializesBuffers) {
+    const std::string text = naclText();
+    vu_structure* nacl = nullptr;
+    ASSERT_EQ(vu_structure_parse(text.data(), text.size(), nullptr, &nacl), VU_OK);
+    EXPECT_EQ(vu_structure_atom_count(nacl), 8u);
+    ASSERT_EQ(vu_structure_species_count(nacl), 2u);
+    EXPECT_STREQ(vu_structure_species_name(nacl, 1), "Cl");
+    EXPECT_EQ(vu_structure_types(nacl)[7], 1);
+    EXPECT_TRUE(vu_structure_is_fractional(nacl));
+    EXPECT_DOUBLE_EQ(vu_structure_positions(nacl)[3 * 1 + 1], 0.5);
+
+    size_t size = 0;
+    EXPECT_EQ(vu_structure_serialize(nacl, "extxyz", nullptr, 0, &size), VU_ERROR_BUFFER_TOO_SMALL);
+    std::vector<char> buffer(size);
+    ASSERT_EQ(vu_structure_serialize(nacl, "extxyz", buffer.data(), buffer.size(), &size), VU_OK);
+    EXPECT_EQ(std::string(buffer.data(), 2), "8\n");
+
+    vu_structure* copy = nullptr;
+    ASSERT_EQ(vu_structure_parse(buffer.data(), size, "extxyz", &copy), VU_OK);
+    EXPECT_EQ(vu_structure_atom_count(copy), 8u);
+    vu_structure_free(copy);
+    vu_structure_free(nacl);
+}
+
+TEST(CApi, ReportsErrors) {
+    vu_structure* structure = nullptr;
+    EXPECT_EQ(vu_structure_parse("garbage", 7, "poscar", &structure), VU_ERROR_PARSE);
+    EXPECT_EQ(structure, nullptr);
+    EXPECT_NE(std::string(vu_last_error()), "");
+    EXPECT_EQ(vu_structure_parse("x", 1, "no_such_format", &structure), VU_ERROR_FORMAT);
+    EXPECT_EQ(vu_structure_parse(nullptr, 1, nullptr, &structure), VU_ERROR_ARGUMENT);
+    EXPECT_STREQ(vu_status_string(VU_ERROR_BUFFER_TOO_SMALL), "buffer too small");
+    EXPECT_EQ(vu_api_version(), VU_API_VERSION);
+}
+
+TEST(CApi, CreatesFromArraysAndDisplaces) {
+    const double lattice[3][3] = {{4.0, 0, 0}, {0, 4.0, 0}, {0, 0, 4.0}};
+    const double positions[] = {2.0, 2.0, 2.0, 0.0, 0.0, 0.0};  // Cartesian, Cl listed first
+    const int types[] = {1, 0};
+    const char* species[] = {"Cs", "Cl"};
+    vu_structure* cscl = nullptr;
+    ASSERT_EQ(vu_structure_create(lattice, 2, positions, 0, types, species, 2, &cscl), VU_OK);
+    EXPECT_FALSE(vu_structure_is_fractional(cscl));
+    EXPECT_STREQ(vu_structure_species_name(cscl, vu_structure_types(cscl)[0]), "Cs");
+    EXPECT_DOUBLE_EQ(vu_structure_positions(cscl)[0], 0.0);
+
+    ASSERT_EQ(vu_structure_to_fractional(cscl), VU_OK);
+    EXPECT_DOUBLE_EQ(vu_structure_positions(cscl)[3], 0.5);
+
+    vu_structure* a = nullptr;
+    vu_structure* b = nullptr;
+    ASSERT_EQ(vu_structure_clone(cscl, &a), VU_OK);
+    ASSERT_EQ(vu_structure_clone(cscl, &b), VU_OK);
+    ASSERT_EQ(vu_structure_displace(a, 2, 0.1, 42), VU_OK);
+    ASSERT_EQ(vu_structure_displace(b, 2, 0.1, 42), VU_OK);
+    for (int k = 0; k < 6; ++k)
+        EXPECT_DOUBLE_EQ(vu_structure_positions(a)[k], vu_structure_positions(b)[k]);
+    EXPECT_NE(vu_structure_positions(a)[3], 0.5);
+
+    const int badTypes[] = {0, 2};
+    vu_structure* bad = nullptr;
+    EXPECT_EQ(vu_structure_create(lattice, 2, positions, 0, badTypes, species, 2, &bad), VU_ERROR_ARGUMENT);
+    vu_structure_free(a);
+    vu_structure_free(b);
+    vu_structure_free(cscl);
+}
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "compressed_stream.h"
+#include "poscar_file.h"
+
+static const std::string kNaClPath = std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar";
+
+static std::string rawBytes(const std::string& path, std::size_t n) {
+    std::ifstream in(path, std::ios::binary);
+    std::string bytes(n, '\0');
+    in.read(&bytes[0], static_cast<std::streamsize>(n));
+    bytes.resize(static_cast<std::size_t>(in.gcount()));
+    return bytes;
+}
+
+// Many lines, several decode blocks long
+static std::string largeText() {
+    std::ostringstream text;
+    for (int i = 0; i < 20000; ++i)
+        text << i << " 0.1234567890 0.2345678901 0.3456789012\n";
+    return text.str();
+}
+
+static void expectRoundTrip(const std::string& path, Compression compression) {
+    const std::string text = largeText();
+    {
+        OutputFileStream out(path);
+        ASSERT_TRUE(out);
+        EXPECT_EQ(out.compression(), compression);
+        out << text;
+        ASSERT_TRUE(out.close());
+    }
+    EXPECT_LT(rawBytes(path, 1 << 24).size(), text.size() / 2);
+
+    InputFileStream in(path);
+    ASSERT_TRUE(in);
+    EXPECT_EQ(in.compression(), compression);
+    std::stringstream read;
+    read << in.rdbuf();
+    std::remove(path.c_str());
+    EXPECT_EQ(read.str(), text);
+}
+
+TEST(CompressedStream, SuffixSelectsCompression) {
+    EXPECT_EQ(compressionFromName("POSCAR.gz"), Compression::Gzip);
+    EXPECT_EQ(compressionFromName("XDATCAR.xz"), Compression::Xz);
+    EXPECT_EQ(compressionFromName("CHGCAR.zst"), Compression::Zstd);
+    EXPECT_EQ(compressionFromName("POSCAR"), Compression::None);
+    EXPECT_EQ(stripCompressionSuffix("dir/NaCl.cif.zst"), "dir/NaCl.cif");
+    EXPECT_EQ(stripCompressionSuffix(".gz"), ".gz");
+}
+
+TEST(CompressedStream, PlainFilesPassThrough) {
+    InputFileStream in(kNaClPath);
+    ASSERT_TRUE(in);
+    EXPECT_EQ(in.compression(), Compression::None);
+    std::string comment;
+    std::getline(in, comment);
+    EXPECT_FALSE(comment.empty());
+
+    InputFileStream missing(std::string(TEST_DATA_DIR) + "/no_such_file.gz");
+    EXPECT_FALSE(missing);
+}
+
+#ifdef VASP_UTILS_HAVE_ZLIB
+TEST(CompressedStream, GzipRoundTrip) {
+    expectRoundTrip(std::string(TEST_DATA_DIR) + "/test_compressed_tmp.gz", Compression::Gzip);
+}
+
+TEST(CompressedStream, PoscarReadsAndWritesGzip) {
+    POSCAR original;
+    ASSERT_TRUE(original.readPOSCAR(kNaClPath));
+
+    const std::string tmpFile = std::string(TEST_DATA_DIR) + "/POSCAR_compressed_tmp.gz";
+    ASSERT_TRUE(original.writePOSCAR(tmpFile));
+    EXPECT_EQ(rawBytes(tmpFile, 2), "\x1f\x8b");
+
+    POSCAR reloaded;
+    ASSERT_TRUE(reloaded.readPOSCAR(tmpFile));
+    std::remove(tmpFile.c_str());
+    EXPECT_EQ(reloaded.elements, original.elements);
+    EXPECT_EQ(reloaded.total_atoms, original.total_atoms);
+    for (size_t i = 0; i < original.coordinates.size(); ++i)
+        EXPECT_NEAR(reloaded.coordinates[i].z, original.coordinates[i].z, 1e-10);
+}
+
+TEST(CompressedStream, TruncatedGzipEndsEarly) {
+    const std::string tmpFile = std::string(TEST_DATA_DIR) + "/test_truncated_tmp.gz";
+    const std::string text = largeText();
+    {
+        OutputFileStream out(tmpFile);
+        out << text;
+        ASSERT_TRUE(out.close());
+    }
+    std::string bytes = rawBytes(tmpFile, 1 << 24);
+    {
+        std::ofstream cut(tmpFile, std::ios::binary | std::ios::trunc);
+        cut.write(bytes.data(), static_cast<std::streamsize>(bytes.size() / 2));
+    }
+
+    InputFileStream in(tmpFile);
+    std::stringstream read;
+    read << in.rdbuf();
+    std::remove(tmpFile.c_str());
+    EXPECT_LT(read.str().size(), text.size());
+    EXPECT_EQ(read.str(), text.substr(0, read.str().size()));
+}
+
+TEST(CompressedStream, ReaderMayStopEarly) {
+    const std::string tmpFile = std::string(TEST_DATA_DIR) + "/test_early_tmp.gz";
+    {
+        OutputFileStream out(tmpFile);
+        out << largeText();
+        ASSERT_TRUE(out.close());
+    }
+    {
+        InputFileStream in(tmpFile);
+        std::string line;
+        std::getline(in, line);
+        EXPECT_EQ(line, "0 0.1234567890 0.2345678901 0.3456789012");
+    }  // the decoding thread must wind down while blocked on a full queue
+    std::remove(tmpFile.c_str());
+}
+#endif
+
+#ifdef VASP_UTILS_HAVE_LZMA
+TEST(CompressedStream, XzRoundTrip) {
+    expectRoundTrip(std::string(TEST_DATA_DIR) + "/test_compressed_tmp.xz", Compression::Xz);
+}
+#endif
+
+#ifdef VASP_UTILS_HAVE_ZSTD
+TEST(CompressedStream, ZstdRoundTrip) {
+    expectRoundTrip(std::string(TEST_DATA_DIR) + "/test_compressed_tmp.zst", Compression::Zstd);
+}
+
+TEST(CompressedStream, ZstdMultiFrame) {
+    // Two frames back to back, as from concatenated .zst files. The short first frame puts the blocks of the
+    // second one across the boundaries of the 256 KiB decode buffers.
+    const std::string text = largeText();
+    const std::string frames[2] = {text.substr(0, 100000), text.substr(100000)};
+    const std::string tmpFile = std::string(TEST_DATA_DIR) + "/test_multiframe_tmp.zst";
+    std::string bytes;
+    for (const std::string& frame : frames) {
+        {
+            OutputFileStream out(tmpFile);
+            out << frame;
+            ASSERT_TRUE(out.close());
+        }
+        bytes += rawBytes(tmpFile, 1 << 24);
+    }
+    {
+        std::ofstream joined(tmpFile, std::ios::binary | std::ios::trunc);
+        joined.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    InputFileStream in(tmpFile);
+    std::stringstream read;
+    read << in.rdbuf();
+    std::remove(tmpFile.c_str());
+    EXPECT_EQ(read.str(), text);
+}
+#endif
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "compressed_stream.h"
+#include "coordinate_parser.h"
+#include "poscar_file.h"
+
+namespace {
+
+std::string coordinateLines(std::size_t n, bool selective) {
+    std::string text;
+    char line[128];
+    for (std::size_t i = 0; i < n; ++i) {
+        std::snprintf(line, sizeof(line), "  %.6f %+.6f\t%.6e%s%s", i * 0.001, -0.5 + i * 1e-4, i * 1.0,
+                      selective ? (i % 2 ? " T F T" : " F F T") : "", i % 3 == 0 ? "  Na\r\n" : "\n");
+        text += line;
+    }
+    return text;
+}
+
+}  // namespace
+
+TEST(CoordinateParser, ParsesChunksInParallel) {
+    const std::size_t n = 2000;
+    const std::string text = coordinateLines(n, false) + "0.0 0.0 0.0\n";  // extra line is ignored
+    std::vector<Atom> atoms(n);
+    ASSERT_TRUE(parseCoordinateBlock(text.data(), text.data() + text.size(), n, atoms.data(), nullptr, 4, 256));
+    for (std::size_t i = 0; i < n; i += 97) {
+        EXPECT_DOUBLE_EQ(atoms[i].x, std::stod(std::to_string(i * 0.001)));
+        EXPECT_NEAR(atoms[i].y, -0.5 + i * 1e-4, 1e-6);
+        EXPECT_DOUBLE_EQ(atoms[i].z, static_cast<double>(i));
+    }
+}
+
+TEST(CoordinateParser, ReadsSelectiveFlagsAndReportsErrors) {
+    const std::size_t n = 300;
+    std::string text = coordinateLines(n, true);
+    std::vector<Atom> atoms(n);
+    std::vector<std::uint8_t> flags(n);
+    ASSERT_TRUE(parseCoordinateBlock(text.data(), text.data() + text.size(), n, atoms.data(), flags.data(), 3, 64));
+    EXPECT_EQ(flags[0], kMoveZ);
+    EXPECT_EQ(flags[1], kMoveX | kMoveZ);
+
+    EXPECT_FALSE(parseCoordinateBlock(text.data(), text.data() + text.size(), n + 1, atoms.data(), nullptr, 3, 64));
+    text.replace(text.find('\n', text.size() / 2) + 3, 1, "x");
+    EXPECT_FALSE(parseCoordinateBlock(text.data(), text.data() + text.size(), n, atoms.data(), flags.data(), 3, 64));
+}
+
+TEST(CoordinateParser, LargeFileReadMatchesStreamRead) {
+    const std::size_t n = 240000;  // above the size from which readPOSCAR maps the file
+    const std::string path = std::string(TEST_DATA_DIR) + "/test_large_tmp.vasp";
+    {
+        std::ofstream out(path);
+        out << "large\n1.0\n10 0 0\n0 10 0\n0 0 10\nSi O\n80000 160000\nSelective dynamics\nDirect\n";
+        out << coordinateLines(n, true);
+    }
+
+    POSCAR mapped;
+    ASSERT_TRUE(mapped.readPOSCAR(path));
+    InputFileStream in(path);
+    POSCAR streamed;
+    ASSERT_TRUE(streamed.readPOSCAR(in, path));
+    std::filesystem::remove(path);
+
+    ASSERT_EQ(mapped.coordinates.size(), n);
+    EXPECT_EQ(mapped.num_atoms, streamed.num_atoms);
+    EXPECT_TRUE(mapped.selective_dynamics);
+    EXPECT_EQ(mapped.selective_flags, streamed.selective_flags);
+    for (std::size_t i = 0; i < n; ++i) {
+        ASSERT_EQ(mapped.coordinates[i].x, streamed.coordinates[i].x);
+        ASSERT_EQ(mapped.coordinates[i].z, streamed.coordinates[i].z);
+    }
+    EXPECT_EQ(mapped.atom_types[n - 1], 1);
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "poscar_file.h"
+
+static const std::string kNaClPath = std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar";
+
+TEST(Ctrls, RoundTripFromFractional) {
+    POSCAR original;
+    ASSERT_TRUE(original.readPOSCAR(kNaClPath));
+    ASSERT_TRUE(original.is_direct);
+
+    const std::string tmpFile = std::string(TEST_DATA_DIR) + "/ctrls.test_roundtrip_tmp";
+    ASSERT_TRUE(original.writeCtrlsFile(tmpFile));
+
+    POSCAR reloaded;
+    ASSERT_TRUE(reloaded.readCtrlsFile(tmpFile));
+    std::remove(tmpFile.c_str());
+
+    EXPECT_EQ(reloaded.elements, original.elements);
+    EXPECT_EQ(reloaded.num_atoms, original.num_atoms);
+    EXPECT_EQ(reloaded.total_atoms, 8);
+    EXPECT_FALSE(reloaded.is_direct);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            EXPECT_NEAR(reloaded.lattice[i][j], original.lattice[i][j], 1e-8);
+
+    reloaded.toDirect();
+    for (size_t i = 0; i < original.coordinates.size(); ++i) {
+        EXPECT_NEAR(reloaded.coordinates[i].x, original.coordinates[i].x, 1e-9);
+        EXPECT_NEAR(reloaded.coordinates[i].y, original.coordinates[i].y, 1e-9);
+        EXPECT_NEAR(reloaded.coordinates[i].z, original.coordinates[i].z, 1e-9);
+    }
+}
+
+TEST(Ctrls, ReadsFractionalSitesInAnyOrder) {
+    const std::string tmpFile = std::string(TEST_DATA_DIR) + "/ctrls.test_xpos_tmp";
+    {
+        std::ofstream out(tmpFile);
+        out << "% const a=7.6\n"
+               "# rock salt, ALAT in Bohr\n"
+               "STRUC   ALAT=7.6 NSPEC=2\n"
+               "        PLAT= 0 0.5 0.5\n"
+               "              0.5 0 0.5\n"
+               "              0.5 0.5 0\n"
+               "SPEC    ATOM=Cl Z=17\n"
+               "        ATOM=Na Z=11\n"
+               "SITE    ATOM=Cl XPOS=0.5 0.5 0.5\n"
+               "        ATOM=Na XPOS=0 0 0\n";
+    }
+
+    POSCAR poscar;
+    ASSERT_TRUE(poscar.readCtrlsFile(tmpFile));
+    std::remove(tmpFile.c_str());
+
+    ASSERT_EQ(poscar.elements.size(), 2u);
+    EXPECT_EQ(poscar.elements[0], "Cl");
+    EXPECT_EQ(poscar.elements[1], "Na");
+    EXPECT_EQ(poscar.total_atoms, 2);
+    EXPECT_TRUE(poscar.is_direct);
+    EXPECT_DOUBLE_EQ(poscar.coordinates[0].x, 0.5);
+    EXPECT_NEAR(poscar.lattice[0][1], 0.5 * 7.6 / 1.889726125, 1e-12);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+
+#include "daemon_protocol.h"
+
+TEST(DaemonProtocol, RequestRoundTrip) {
+    DaemonRequest request;
+    request.command = "displace";
+    request.options = {{"amp", "0.05"}, {"seed", "7"}};
+    request.structure = "Na4 Cl4\n1.0\n";
+
+    std::string payload;
+    formatRequest(request, payload);
+    EXPECT_EQ(payload, "displace amp=0.05 seed=7\nNa4 Cl4\n1.0\n");
+
+    DaemonRequest parsed;
+    ASSERT_TRUE(parseRequest(payload, parsed));
+    EXPECT_EQ(parsed.command, "displace");
+    EXPECT_EQ(parsed.options, request.options);
+    EXPECT_EQ(parsed.structure, request.structure);
+
+    EXPECT_FALSE(parseRequest("no newline", parsed));
+    EXPECT_FALSE(parseRequest("symmetry =1e-3\n", parsed));
+    EXPECT_FALSE(parseRequest("\n", parsed));
+}
+
+TEST(DaemonProtocol, ResponseRoundTrip) {
+    std::string payload;
+    formatResponse({false, "cannot parse the structure"}, payload);
+    DaemonResponse response;
+    ASSERT_TRUE(parseResponse(payload, response));
+    EXPECT_FALSE(response.ok);
+    EXPECT_EQ(response.body, "cannot parse the structure");
+    EXPECT_FALSE(parseResponse("maybe\n", response));
+}
+
+TEST(DaemonProtocol, FramesSurviveLargePayloads) {
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    // Larger than the socket buffer, so the writer blocks until the reader drains it
+    const std::string large(1 << 20, 'x');
+    std::thread writer([&] {
+        EXPECT_TRUE(writeFrame(fds[0], large));
+        EXPECT_TRUE(writeFrame(fds[0], ""));
+        close(fds[0]);
+    });
+
+    std::string payload;
+    ASSERT_TRUE(readFrame(fds[1], payload));
+    EXPECT_EQ(payload, large);
+    ASSERT_TRUE(readFrame(fds[1], payload));
+    EXPECT_TRUE(payload.empty());
+    EXPECT_FALSE(readFrame(fds[1], payload));  // closed
+    writer.join();
+    close(fds[1]);
+}
+
+TEST(DaemonProtocol, ListensAndConnects) {
+    const std::string path = "/tmp/vasp_utils_test_" + std::to_string(getpid()) + ".sock";
+    int server = listenUnixSocket(path);
+    ASSERT_GE(server, 0);
+
+    int client = connectUnixSocket(path);
+    ASSERT_GE(client, 0);
+    int accepted = accept(server, nullptr, nullptr);
+    ASSERT_GE(accepted, 0);
+
+    std::string payload;
+    ASSERT_TRUE(writeFrame(client, "ping\n"));
+    ASSERT_TRUE(readFrame(accepted, payload));
+    EXPECT_EQ(payload, "ping\n");
+    EXPECT_LT(listenUnixSocket(path), 0);  // already served
+
+    close(accepted);
+    close(client);
+    close(server);
+    unlink(path.c_str());
+    EXPECT_LT(connectUnixSocket(path), 0);
+}
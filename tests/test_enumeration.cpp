@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "derivative_enumeration.h"
+#include "poscar_file.h"
+#include "structure_utility.h"
+
+static const std::string kNaClPath = std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar";
+
+// Dihedral group of a ring of n sites (rotations and reflections)
+static std::vector<std::vector<int>> ringPermutations(int n) {
+    std::vector<std::vector<int>> perms;
+    for (int r = 0; r < n; ++r) {
+        std::vector<int> rot(n), refl(n);
+        for (int i = 0; i < n; ++i) {
+            rot[i] = (i + r) % n;
+            refl[i] = (r - i + n) % n;
+        }
+        perms.push_back(rot);
+        perms.push_back(refl);
+    }
+    return perms;
+}
+
+TEST(Enumeration, Binomial) {
+    EXPECT_EQ(binomial(6, 2), 15u);
+    EXPECT_EQ(binomial(10, 0), 1u);
+    EXPECT_EQ(binomial(5, 6), 0u);
+    EXPECT_EQ(binomial(64, 32), 1832624140942590534ULL);
+}
+
+TEST(Enumeration, RingClassesAndDegeneracies) {
+    OccupationCanonicalizer canonicalizer(ringPermutations(6), 6);
+    ASSERT_EQ(canonicalizer.groupOrder(), 12u);
+
+    for (int k = 0; k <= 6; ++k) {
+        auto configs = enumerateInequivalent(6, k, canonicalizer, 1);
+        std::uint64_t total = 0;
+        for (const auto& c : configs)
+            total += c.degeneracy;
+        EXPECT_EQ(total, binomial(6, k)) << "k = " << k;
+    }
+
+    EXPECT_EQ(enumerateInequivalent(6, 2, canonicalizer, 1).size(), 3u);
+    EXPECT_EQ(enumerateInequivalent(6, 3, canonicalizer, 1).size(), 3u);
+}
+
+TEST(Enumeration, ThreadCountDoesNotChangeResult) {
+    OccupationCanonicalizer canonicalizer(ringPermutations(20), 20);
+
+    auto serial = enumerateInequivalent(20, 6, canonicalizer, 1);
+    auto parallel = enumerateInequivalent(20, 6, canonicalizer, 4);
+
+    ASSERT_EQ(serial.size(), parallel.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(serial[i].occupation, parallel[i].occupation);
+        EXPECT_EQ(serial[i].degeneracy, parallel[i].degeneracy);
+    }
+}
+
+TEST(Enumeration, TranslationPermutations) {
+    POSCAR poscar;
+    ASSERT_TRUE(poscar.readPOSCAR(kNaClPath));
+    POSCAR super = makeSupercell(poscar, 2, 1, 1);
+
+    std::vector<int> active;
+    auto species = atomSpecies(super);
+    for (int i = 0; i < super.total_atoms; ++i)
+        if (species[i] == "Na")
+            active.push_back(i);
+    ASSERT_EQ(active.size(), 8u);
+
+    // Identity and the parent lattice translation along a
+    const int rotations[2][3][3] = {{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}, {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}};
+    const double translations[2][3] = {{0.0, 0.0, 0.0}, {0.5, 0.0, 0.0}};
+
+    auto perms = activeSitePermutations(super, rotations, translations, 2, active, 1e-3);
+    ASSERT_EQ(perms.size(), 2u);
+
+    OccupationCanonicalizer canonicalizer(perms, 8);
+    auto configs = enumerateInequivalent(8, 1, canonicalizer, 1);
+    EXPECT_EQ(configs.size(), 4u);
+}
+
+TEST(Supercell, DiagonalAndGeneralTransforms) {
+    POSCAR poscar;
+    ASSERT_TRUE(poscar.readPOSCAR(kNaClPath));
+
+    POSCAR diag = makeSupercell(poscar, 2, 1, 3);
+    EXPECT_EQ(diag.total_atoms, 48);
+    EXPECT_EQ(static_cast<int>(diag.coordinates.size()), 48);
+    EXPECT_EQ(diag.num_atoms[0], 24);
+
+    const int transform[3][3] = {{1, 1, 0}, {-1, 1, 0}, {0, 0, 1}};
+    POSCAR rotated = makeSupercell(poscar, transform);
+    EXPECT_EQ(static_cast<int>(rotated.coordinates.size()), 16);
+    for (const auto& atom : rotated.coordinates) {
+        EXPECT_GE(atom.x, 0.0);
+        EXPECT_LT(atom.x, 1.0);
+    }
+}
+
+TEST(Supercell, BuildPOSCARGroupsSpecies) {
+    const double lattice[3][3] = {{3.0, 0.0, 0.0}, {0.0, 3.0, 0.0}, {0.0, 0.0, 3.0}};
+    std::vector<std::string> species = {"Cu", "Au", "Cu", "Au"};
+    std::vector<Atom> coords = {{0.0, 0.0, 0.0}, {0.5, 0.0, 0.0}, {0.0, 0.5, 0.0}, {0.0, 0.0, 0.5}};
+
+    POSCAR out = buildPOSCAR("test", lattice, species, coords, {"Au"});
+    ASSERT_EQ(out.elements.size(), 2u);
+    EXPECT_EQ(out.elements[0], "Au");
+    EXPECT_EQ(out.num_atoms[0], 2);
+    EXPECT_DOUBLE_EQ(out.coordinates[0].x, 0.5);
+    EXPECT_DOUBLE_EQ(out.coordinates[2].x, 0.0);
+    EXPECT_EQ(out.total_atoms, 4);
+    EXPECT_EQ(out.species, (std::vector<std::string>{"Au", "Cu"}));
+    EXPECT_EQ(out.atom_types, (std::vector<std::uint16_t>{0, 0, 1, 1}));
+    EXPECT_TRUE(out.speciesConsistent());
+}
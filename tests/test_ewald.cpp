@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ewald.h"
+#include "poscar_file.h"
+#include "structure_utility.h"
+
+static const std::string kNaClPath = std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar";
+
+static std::vector<double> naclCharges(const POSCAR& poscar) {
+    std::map<std::string, double> oxidation;
+    EXPECT_TRUE(parseOxidationStates("Na:1,Cl:-1", oxidation));
+    std::vector<double> charges;
+    EXPECT_TRUE(atomCharges(poscar, oxidation, charges));
+    return charges;
+}
+
+TEST(Ewald, RockSaltMadelungConstant) {
+    POSCAR nacl;
+    ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+    const double a = 5.5881264354399347;
+    const double madelung = 1.747564594633;
+
+    EwaldEnergy energy = ewaldEnergy(nacl, naclCharges(nacl));
+    const double expected = -4.0 * madelung * kCoulombEVAngstrom / (a / 2.0);
+    EXPECT_NEAR(energy.total, expected, 1e-5);
+    EXPECT_NEAR(energy.background, 0.0, 1e-12);
+
+    // The split between real and reciprocal space must not change the total
+    EwaldOptions options;
+    options.alpha = 0.8;
+    options.threads = 2;
+    EXPECT_NEAR(ewaldEnergy(nacl, naclCharges(nacl), options).total, expected, 1e-5);
+}
+
+TEST(Ewald, ModelMatchesDirectSum) {
+    POSCAR nacl;
+    ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+    POSCAR super = makeSupercell(nacl, 2, 1, 1);
+    std::vector<double> charges = naclCharges(super);
+
+    EwaldModel model(super, charges);
+    EXPECT_NEAR(model.energy(), ewaldEnergy(super, charges).total, 1e-6);
+}
+
+TEST(Ewald, IncrementalSwapAndRemoval) {
+    POSCAR nacl;
+    ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+    POSCAR super = makeSupercell(nacl, 2, 1, 1);
+    std::vector<double> charges = naclCharges(super);
+
+    EwaldOptions options;
+    options.threads = 2;
+    EwaldModel model(super, charges, options);
+
+    // Exchange a cation and an anion
+    const int cation = 0;
+    const int anion = super.total_atoms - 1;
+    const double before = model.energy();
+    const double delta = model.swapDelta(cation, anion);
+    model.applySwap(cation, anion);
+    std::swap(charges[cation], charges[anion]);
+    EXPECT_NEAR(model.energy(), before + delta, 1e-9);
+    EXPECT_NEAR(model.energy(), ewaldEnergy(super, charges, options).total, 1e-6);
+
+    // Removing a charge leaves a charged cell, handled through the neutralizing background
+    const double removal = model.removalDelta(3);
+    model.applyRemoval(3);
+    charges[3] = 0.0;
+    EwaldEnergy direct = ewaldEnergy(super, charges, options);
+    EXPECT_LT(direct.background, 0.0);
+    EXPECT_NEAR(model.energy(), direct.total, 1e-6);
+    EXPECT_NEAR(removal, direct.total - (before + delta), 1e-6);
+
+    // Potentials stay consistent with the charges after the updates
+    double energy = 0.0;
+    for (int i = 0; i < model.size(); ++i)
+        energy += 0.5 * model.charge(i) * model.sitePotential(i);
+    EXPECT_NEAR(energy, model.energy(), 1e-9);
+}
+
+TEST(Ewald, MissingOxidationState) {
+    POSCAR nacl;
+    ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+    std::map<std::string, double> oxidation{{"Na", 1.0}};
+    std::vector<double> charges;
+    EXPECT_FALSE(atomCharges(nacl, oxidation, charges));
+    EXPECT_FALSE(parseOxidationStates("Na=1", oxidation));
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "instrumentation.h"
+#include "poscar_file.h"
+
+static const std::string kNaClPath = std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar";
+
+class InstrumentationTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        resetTimings();
+    }
+    void TearDown() override {
+        setTimingsEnabled(false);
+        setMemoryStatsEnabled(false);
+        resetTimings();
+    }
+
+    static const PhaseStats* findPhase(const std::vector<PhaseStats>& phases, const std::string& name) {
+        for (const auto& p : phases)
+            if (p.name == name)
+                return &p;
+        return nullptr;
+    }
+};
+
+TEST_F(InstrumentationTest, DisabledRecordsNothing) {
+    setTimingsEnabled(false);
+
+    POSCAR poscar;
+    ASSERT_TRUE(poscar.readPOSCAR(kNaClPath));
+    poscar.toCartesian();
+
+    EXPECT_TRUE(timingSnapshot().empty());
+}
+
+TEST_F(InstrumentationTest, RecordsReadAndConversionPhases) {
+    setTimingsEnabled(true);
+
+    POSCAR poscar;
+    ASSERT_TRUE(poscar.readPOSCAR(kNaClPath));
+    poscar.toCartesian();
+    poscar.toDirect();
+    poscar.toCartesian();
+
+    auto phases = timingSnapshot();
+
+    const PhaseStats* read = findPhase(phases, "read_poscar");
+    ASSERT_NE(read, nullptr);
+    EXPECT_EQ(read->calls, 1);
+    EXPECT_EQ(read->atoms, 8u);
+    EXPECT_GT(read->bytes, 0u);
+
+    const PhaseStats* cart = findPhase(phases, "to_cartesian");
+    ASSERT_NE(cart, nullptr);
+    EXPECT_EQ(cart->calls, 2);
+    EXPECT_EQ(cart->atoms, 16u);
+
+    const PhaseStats* direct = findPhase(phases, "to_direct");
+    ASSERT_NE(direct, nullptr);
+    EXPECT_EQ(direct->calls, 1);
+}
+
+TEST_F(InstrumentationTest, JsonReportListsPhases) {
+    setTimingsEnabled(true);
+    { ScopedTimer timer("unit_phase", 10, 100); }
+
+    std::ostringstream out;
+    printTimings(out, TimingFormat::Json);
+
+    const std::string json = out.str();
+    EXPECT_NE(json.find("\"name\": \"unit_phase\""), std::string::npos);
+    EXPECT_NE(json.find("\"calls\": 1"), std::string::npos);
+    EXPECT_NE(json.find("\"atoms\": 10"), std::string::npos);
+}
+
+TEST_F(InstrumentationTest, MemoryStatsCountPhaseAllocations) {
+    setMemoryStatsEnabled(true);
+    {
+        ScopedTimer timer("alloc_phase");
+        std::vector<double> data(1000, 1.0);
+        EXPECT_DOUBLE_EQ(data[999], 1.0);
+    }
+
+    auto phases = timingSnapshot();
+    const PhaseStats* phase = findPhase(phases, "alloc_phase");
+    ASSERT_NE(phase, nullptr);
+    EXPECT_GE(phase->allocations, 1u);
+    EXPECT_GE(phase->allocated_bytes, 1000u * sizeof(double));
+    EXPECT_GT(peakRSSBytes(), 0);
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "interstitial.h"
+#include "neighbor_list.h"
+#include "poscar_file.h"
+
+static const std::string kNaClPath = std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar";
+static const double kNaClA = 5.5881264354399347;
+
+// Fm-3m in the conventional cell: 48 signed permutations times the four fcc centring translations
+static void rockSaltOperations(std::vector<int>& rotations, std::vector<double>& translations) {
+    const double centring[4][3] = {{0, 0, 0}, {0, 0.5, 0.5}, {0.5, 0, 0.5}, {0.5, 0.5, 0}};
+    int perm[3] = {0, 1, 2};
+    do {
+        for (int signs = 0; signs < 8; ++signs)
+            for (const auto& t : centring) {
+                for (int i = 0; i < 3; ++i)
+                    for (int j = 0; j < 3; ++j)
+                        rotations.push_back(j == perm[i] ? ((signs >> i) & 1 ? -1 : 1) : 0);
+                translations.insert(translations.end(), t, t + 3);
+            }
+    } while (std::next_permutation(perm, perm + 3));
+}
+
+TEST(NeighborList, NearestDistance) {
+    POSCAR nacl;
+    ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+    nacl.toDirect();
+    PeriodicCellIndex index(nacl.lattice, nacl.coordinates, 2.0);
+
+    const double tetrahedral[3] = {0.25 * kNaClA, 0.25 * kNaClA, 0.25 * kNaClA};
+    EXPECT_NEAR(index.nearestDistance(tetrahedral, 10.0), kNaClA * std::sqrt(3.0) / 4.0, 1e-9);
+    EXPECT_DOUBLE_EQ(index.nearestDistance(tetrahedral, 1.0), 1.0);
+}
+
+TEST(Interstitial, RockSaltTetrahedralSites) {
+    POSCAR nacl;
+    ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+
+    InterstitialOptions options;
+    options.grid_spacing = kNaClA / 28.0;  // puts (1/4, 1/4, 1/4) on the grid
+    options.threads = 2;
+    std::vector<InterstitialSite> sites = findInterstitials(nacl, options);
+
+    ASSERT_EQ(sites.size(), 8u);
+    for (const auto& site : sites) {
+        EXPECT_NEAR(site.distance, kNaClA * std::sqrt(3.0) / 4.0, 1e-5);
+        for (double f : {site.position.x, site.position.y, site.position.z})
+            EXPECT_TRUE(std::abs(f - 0.25) < 1e-9 || std::abs(f - 0.75) < 1e-9);
+    }
+
+    std::vector<int> rotations;
+    std::vector<double> translations;
+    rockSaltOperations(rotations, translations);
+    const int n_ops = static_cast<int>(translations.size() / 3);
+    ASSERT_EQ(n_ops, 192);
+
+    nacl.toDirect();
+    std::vector<InterstitialSite> unique =
+        symmetryReduceSites(sites, nacl.lattice, reinterpret_cast<const int(*)[3][3]>(rotations.data()),
+                            reinterpret_cast<const double(*)[3]>(translations.data()), n_ops, 0.1);
+    ASSERT_EQ(unique.size(), 1u);
+    EXPECT_EQ(unique[0].multiplicity, 8);
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "kpoint_mesh.h"
+
+// All 48 signed permutation matrices: the point group m-3m in a cubic basis
+static std::vector<int> cubicRotations() {
+    std::vector<int> packed;
+    int perm[3] = {0, 1, 2};
+    do {
+        for (int signs = 0; signs < 8; ++signs)
+            for (int i = 0; i < 3; ++i)
+                for (int j = 0; j < 3; ++j)
+                    packed.push_back(j == perm[i] ? ((signs >> i) & 1 ? -1 : 1) : 0);
+    } while (std::next_permutation(perm, perm + 3));
+    return packed;
+}
+
+static const int (*asRotations(const std::vector<int>& packed))[3][3] {
+    return reinterpret_cast<const int(*)[3][3]>(packed.data());
+}
+
+TEST(KpointMesh, MeshForSpacing) {
+    const double a = 5.5881264354399347;
+    const double lattice[3][3] = {{a, 0, 0}, {0, a, 0}, {0, 0, 2 * a}};
+    int mesh[3];
+    meshForSpacing(lattice, 0.25, mesh);  // 2 pi / a = 1.124 1/A
+    EXPECT_EQ(mesh[0], 5);
+    EXPECT_EQ(mesh[1], 5);
+    EXPECT_EQ(mesh[2], 3);
+}
+
+TEST(KpointMesh, UniqueRotations) {
+    std::vector<int> packed = cubicRotations();
+    std::vector<int> doubled = packed;
+    doubled.insert(doubled.end(), packed.begin(), packed.end());
+    EXPECT_EQ(uniqueRotations(asRotations(doubled), 96).size(), 48u);
+}
+
+TEST(KpointMesh, CompatibilityWithCubicAndHexagonalGroups) {
+    std::vector<int> cubic = cubicRotations();
+    KMesh mesh;
+    mesh.mesh[0] = mesh.mesh[1] = mesh.mesh[2] = 4;
+    EXPECT_TRUE(meshCompatible(mesh, asRotations(cubic), 48));
+    mesh.gamma_centered = false;
+    EXPECT_TRUE(meshCompatible(mesh, asRotations(cubic), 48));
+    mesh.mesh[2] = 5;
+    EXPECT_FALSE(meshCompatible(mesh, asRotations(cubic), 48));
+
+    // Six-fold axis along c: shifted meshes break it, Gamma-centred ones need equal a and b subdivisions
+    const std::vector<int> sixfold = {1, -1, 0, 1, 0, 0, 0, 0, 1};
+    KMesh hex;
+    hex.mesh[0] = hex.mesh[1] = 6;
+    hex.mesh[2] = 4;
+    EXPECT_TRUE(meshCompatible(hex, asRotations(sixfold), 1));
+    hex.gamma_centered = false;
+    EXPECT_FALSE(meshCompatible(hex, asRotations(sixfold), 1));
+    hex.gamma_centered = true;
+    hex.mesh[1] = 7;
+    EXPECT_FALSE(meshCompatible(hex, asRotations(sixfold), 1));
+}
+
+TEST(KpointMesh, CandidatesAndRanking) {
+    const double a = 5.5881264354399347;
+    const double lattice[3][3] = {{a, 0, 0}, {0, a, 0}, {0, 0, a}};
+    std::vector<int> cubic = cubicRotations();
+
+    std::vector<KMesh> meshes = candidateMeshes(lattice, 0.25, 2, asRotations(cubic), 48, false);
+    // 5, 6, 7 along the diagonal as Gamma meshes, plus the shifted 6x6x6
+    ASSERT_EQ(meshes.size(), 4u);
+    for (const KMesh& m : meshes) {
+        EXPECT_EQ(m.mesh[0], m.mesh[1]);
+        EXPECT_EQ(m.mesh[1], m.mesh[2]);
+    }
+
+    meshes[0].irreducible = 10;
+    meshes[1].irreducible = 8;
+    meshes[2].irreducible = 8;
+    meshes[3].irreducible = 20;
+    rankMeshes(meshes);
+    EXPECT_EQ(meshes[0].irreducible, 8);
+    EXPECT_GE(meshes[0].total(), meshes[1].total());
+    EXPECT_EQ(meshes.back().irreducible, 20);
+}
+
+TEST(KpointMesh, WriteKPOINTS) {
+    KMesh mesh;
+    mesh.mesh[0] = 6;
+    mesh.mesh[1] = 6;
+    mesh.mesh[2] = 4;
+    mesh.gamma_centered = false;
+    const std::string path = "test_KPOINTS";
+    ASSERT_TRUE(writeKPOINTS(path, mesh, "comment"));
+
+    std::ifstream file(path);
+    std::string line;
+    std::vector<std::string> lines;
+    while (std::getline(file, line))
+        lines.push_back(line);
+    std::remove(path.c_str());
+
+    ASSERT_EQ(lines.size(), 5u);
+    EXPECT_EQ(lines[1], "0");
+    EXPECT_EQ(lines[2], "Monkhorst-Pack");
+    EXPECT_EQ(lines[3], "  6 6 4");
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+
+#include "lattice_reduction.h"
+#include "lattice_utility.h"
+#include "neighbor_list.h"
+#include "poscar_file.h"
+#include "structure_utility.h"
+
+static const std::string kNaClPath = std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar";
+
+// fcc primitive cell sheared by a unimodular matrix
+static void skewedFcc(double a, double lattice[3][3]) {
+    const double primitive[3][3] = {{0.0, 0.5 * a, 0.5 * a}, {0.5 * a, 0.0, 0.5 * a}, {0.5 * a, 0.5 * a, 0.0}};
+    const int shear[3][3] = {{1, 0, 0}, {3, 1, 0}, {-2, 5, 1}};
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            lattice[i][j] = shear[i][0] * primitive[0][j] + shear[i][1] * primitive[1][j] +
+                            shear[i][2] * primitive[2][j];
+}
+
+static void expectTransform(const double lattice[3][3], const double reduced[3][3], const int transform[3][3]) {
+    double m[3][3];
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            m[i][j] = transform[i][j];
+    EXPECT_NEAR(determinant3(m), 1.0, 1e-12);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            EXPECT_NEAR(reduced[i][j],
+                        m[i][0] * lattice[0][j] + m[i][1] * lattice[1][j] + m[i][2] * lattice[2][j], 1e-9);
+}
+
+TEST(LatticeReduction, NiggliFcc) {
+    const double a = 4.0;
+    double lattice[3][3], reduced[3][3];
+    int transform[3][3];
+    skewedFcc(a, lattice);
+
+    ASSERT_TRUE(niggliReduce(lattice, reduced, transform));
+    expectTransform(lattice, reduced, transform);
+
+    // Niggli cell of fcc: three vectors of length a / sqrt(2) at 60 degrees
+    double lengths[3], angles[3];
+    latticeParameters(reduced, lengths, angles);
+    for (int k = 0; k < 3; ++k) {
+        EXPECT_NEAR(lengths[k], a / std::sqrt(2.0), 1e-9);
+        EXPECT_NEAR(angles[k], 60.0, 1e-6);
+    }
+}
+
+TEST(LatticeReduction, DelaunayFcc) {
+    const double a = 4.0;
+    double lattice[3][3], reduced[3][3];
+    int transform[3][3];
+    skewedFcc(a, lattice);
+
+    ASSERT_TRUE(delaunayReduce(lattice, reduced, transform));
+    expectTransform(lattice, reduced, transform);
+
+    double lengths[3], angles[3];
+    latticeParameters(reduced, lengths, angles);
+    for (int k = 0; k < 3; ++k) {
+        EXPECT_NEAR(lengths[k], a / std::sqrt(2.0), 1e-9);
+        EXPECT_GE(angles[k], 90.0 - 1e-6);  // obtuse superbase
+    }
+}
+
+TEST(LatticeReduction, ReduceCellKeepsStructure) {
+    POSCAR nacl;
+    ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+    const int shear[3][3] = {{1, 2, 0}, {0, 1, 0}, {1, -3, 1}};
+    POSCAR skewed = makeSupercell(nacl, shear);
+    ASSERT_EQ(skewed.total_atoms, nacl.total_atoms);
+
+    POSCAR reduced = skewed;
+    ASSERT_TRUE(reduceCell(reduced, CellReduction::Niggli));
+    EXPECT_NEAR(cellVolume(reduced.lattice), cellVolume(nacl.lattice), 1e-8);
+
+    double lengths[3], angles[3];
+    latticeParameters(reduced.lattice, lengths, angles);
+    for (int k = 0; k < 3; ++k) {
+        EXPECT_NEAR(lengths[k], 5.5881264354399347, 1e-8);
+        EXPECT_NEAR(angles[k], 90.0, 1e-6);
+    }
+
+    // Same environments before and after: 6 + 12 neighbours within 4 Angstrom of every atom
+    for (const POSCAR* p : {&skewed, &reduced}) {
+        auto neighbors = buildNeighborList(*p, 4.0);
+        for (const auto& list : neighbors)
+            EXPECT_EQ(list.size(), 18u);
+    }
+}
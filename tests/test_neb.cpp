@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "lattice_utility.h"
+#include "neb.h"
+#include "poscar_file.h"
+#include "structure_utility.h"
+
+static POSCAR cubicBox(double a, const std::vector<std::string>& species, const std::vector<Atom>& fractional) {
+    const double lattice[3][3] = {{a, 0, 0}, {0, a, 0}, {0, 0, a}};
+    return buildPOSCAR("box", lattice, species, fractional);
+}
+
+TEST(Neb, MatchAtomsUndoesPermutationAcrossBoundary) {
+    POSCAR initial = cubicBox(10.0, {"Na", "Na", "Cl"}, {{0.02, 0.5, 0.5}, {0.5, 0.5, 0.5}, {0.3, 0.3, 0.3}});
+    // Same atoms, listed in the other order, the first one moved across the cell boundary
+    POSCAR final = cubicBox(10.0, {"Na", "Na", "Cl"}, {{0.52, 0.5, 0.5}, {0.97, 0.5, 0.5}, {0.3, 0.3, 0.35}});
+
+    std::vector<int> order = matchAtoms(initial, final);
+    ASSERT_EQ(order.size(), 3u);
+    EXPECT_EQ(order[0], 1);
+    EXPECT_EQ(order[1], 0);
+    EXPECT_EQ(order[2], 2);
+
+    std::vector<Atom> aligned = alignEndpoint(initial.coordinates, final.coordinates, order);
+    EXPECT_NEAR(aligned[0].x, -0.03, 1e-12);
+
+    // The midpoint of the wrapped atom stays next to the boundary instead of crossing the cell
+    std::vector<std::vector<Atom>> path = linearPath(initial.coordinates, aligned, 1);
+    ASSERT_EQ(path.size(), 3u);
+    EXPECT_NEAR(path[1][0].x, -0.005, 1e-12);
+    EXPECT_NEAR(path[1][2].z, 0.325, 1e-12);
+}
+
+TEST(Neb, IdppKeepsRotatingBondLength) {
+    // A 1.5 Angstrom dimer turning by 90 degrees: the linear midpoint shortens the bond to 1.06 Angstrom
+    const double a = 10.0, bond = 1.5;
+    POSCAR initial = cubicBox(a, {"H", "H"}, {{0.5, 0.5, 0.5}, {0.5 + bond / a, 0.5, 0.5}});
+    POSCAR final = cubicBox(a, {"H", "H"}, {{0.5, 0.5, 0.5}, {0.5, 0.5 + bond / a, 0.5}});
+
+    std::vector<int> order = matchAtoms(initial, final);
+    std::vector<Atom> aligned = alignEndpoint(initial.coordinates, final.coordinates, order);
+    std::vector<std::vector<Atom>> path = linearPath(initial.coordinates, aligned, 3);
+
+    auto bondLength = [&](const std::vector<Atom>& image) {
+        const double delta[3] = {image[1].x - image[0].x, image[1].y - image[0].y, image[1].z - image[0].z};
+        return minimumImageDistance(initial.lattice, delta);
+    };
+    EXPECT_NEAR(bondLength(path[2]), bond / std::sqrt(2.0), 1e-9);
+    const double linear_objective = idppObjective(initial.lattice, path, 2);
+
+    IdppOptions options;
+    options.threads = 2;
+    options.max_iterations = 5000;
+    options.force_tolerance = 1e-3;
+    IdppResult result = idppOptimize(initial.lattice, path, options);
+
+    EXPECT_TRUE(result.converged);
+    EXPECT_LT(idppObjective(initial.lattice, path, 2), linear_objective);
+    for (size_t k = 1; k + 1 < path.size(); ++k)
+        EXPECT_NEAR(bondLength(path[k]), bond, 0.02);
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "neighbor_list.h"
+#include "poscar_file.h"
+#include "sqs.h"
+#include "structure_utility.h"
+
+static const std::string kNaClPath = std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar";
+
+static std::vector<int> sitesOf(const POSCAR& poscar, const std::string& element) {
+    std::vector<std::string> species = atomSpecies(poscar);
+    std::vector<int> sites;
+    for (int i = 0; i < poscar.total_atoms; ++i)
+        if (species[i] == element)
+            sites.push_back(i);
+    return sites;
+}
+
+TEST(NeighborList, RockSaltShells) {
+    POSCAR nacl;
+    ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+    const double a = 5.5881264354399347;
+
+    // 6 unlike neighbours at a/2 and 12 like neighbours at a/sqrt(2)
+    auto neighbors = buildNeighborList(nacl, 0.5 * (a / std::sqrt(2.0) + a / 2.0));
+    for (const auto& list : neighbors) {
+        ASSERT_EQ(list.size(), 6u);
+        EXPECT_NEAR(list.front().distance, a / 2.0, 1e-6);
+    }
+
+    neighbors = buildNeighborList(nacl, 4.0);
+    for (const auto& list : neighbors) {
+        ASSERT_EQ(list.size(), 18u);
+        EXPECT_NEAR(list.back().distance, a / std::sqrt(2.0), 1e-6);
+    }
+}
+
+TEST(NeighborList, SmallCellCountsImages) {
+    POSCAR nacl;
+    ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+    const double a = 5.5881264354399347;
+
+    // Cutoff larger than the cell: every atom sees its own images at distance a
+    auto neighbors = buildNeighborList(nacl, a + 1e-3);
+    int self_images = 0;
+    for (const auto& nb : neighbors[0])
+        if (nb.index == 0)
+            ++self_images;
+    EXPECT_EQ(self_images, 6);
+}
+
+TEST(Sqs, IncrementalSumsMatchRecompute) {
+    POSCAR nacl;
+    ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+    POSCAR super = makeSupercell(nacl, 2, 2, 2);
+    std::vector<int> active = sitesOf(super, nacl.elements[0]);
+    ASSERT_EQ(active.size(), 32u);
+
+    SqsModel model(super, active, 3, 2);
+    ASSERT_EQ(model.pairShellCount(), 3);
+    ASSERT_EQ(model.tripletShellCount(), 2);
+
+    std::mt19937_64 rng(7);
+    std::vector<signed char> spins(active.size());
+    for (auto& s : spins)
+        s = (rng() & 1) ? 1 : -1;
+
+    std::vector<double> pair, triplet;
+    model.clusterSums(spins, pair, triplet);
+
+    for (int step = 0; step < 200; ++step) {
+        int site = static_cast<int>(rng() % spins.size());
+        model.applyFlip(spins, site, pair, triplet);
+        spins[site] = -spins[site];
+    }
+
+    std::vector<double> pair_ref, triplet_ref;
+    model.clusterSums(spins, pair_ref, triplet_ref);
+    for (size_t s = 0; s < pair.size(); ++s)
+        EXPECT_NEAR(pair[s], pair_ref[s], 1e-9);
+    for (size_t t = 0; t < triplet.size(); ++t)
+        EXPECT_NEAR(triplet[t], triplet_ref[t], 1e-9);
+}
+
+TEST(Sqs, UniformSpinsGiveUnitCorrelations) {
+    POSCAR nacl;
+    ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+    POSCAR super = makeSupercell(nacl, 2, 2, 2);
+    SqsModel model(super, sitesOf(super, nacl.elements[0]), 2, 1);
+
+    std::vector<signed char> spins(model.siteCount(), 1);
+    std::vector<double> sums_pair, sums_triplet, pair, triplet;
+    model.clusterSums(spins, sums_pair, sums_triplet);
+    model.correlations(sums_pair, sums_triplet, pair, triplet);
+    for (double p : pair)
+        EXPECT_DOUBLE_EQ(p, 1.0);
+    for (double t : triplet)
+        EXPECT_DOUBLE_EQ(t, 1.0);
+}
+
+TEST(Sqs, KeepsCompositionAndIsReproducible) {
+    POSCAR nacl;
+    ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+    POSCAR super = makeSupercell(nacl, 2, 2, 2);
+    SqsModel model(super, sitesOf(super, nacl.elements[0]), 2, 1);
+
+    SqsOptions options;
+    options.steps = 2000;
+    options.chains = 4;
+    options.threads = 2;
+
+    SqsResult first = runSqs(model, 16, options);
+    SqsResult second = runSqs(model, 16, options);
+
+    int down = 0;
+    for (signed char s : first.spins)
+        down += s < 0;
+    EXPECT_EQ(down, 16);
+    EXPECT_EQ(first.spins, second.spins);
+    EXPECT_DOUBLE_EQ(first.objective, second.objective);
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "point_defects.h"
+#include "poscar_file.h"
+#include "structure_utility.h"
+
+static const std::string kNaClPath = std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar";
+
+TEST(PointDefects, InequivalentSitesCountMultiplicity) {
+    // NaCl conventional cell: all Na equivalent to atom 0, all Cl to atom 4
+    std::vector<std::string> species = {"Na", "Na", "Na", "Na", "Cl", "Cl", "Cl", "Cl"};
+    std::vector<int> equivalent = {0, 0, 0, 0, 4, 4, 4, 4};
+    std::vector<DefectSite> sites = inequivalentSites(species, equivalent);
+
+    ASSERT_EQ(sites.size(), 2u);
+    EXPECT_EQ(sites[0].atom, 0);
+    EXPECT_EQ(sites[0].element, "Na");
+    EXPECT_EQ(sites[0].multiplicity, 4);
+    EXPECT_EQ(sites[1].atom, 4);
+    EXPECT_EQ(sites[1].element, "Cl");
+    EXPECT_EQ(sites[1].multiplicity, 4);
+}
+
+TEST(PointDefects, VacancyAndSubstitution) {
+    POSCAR nacl;
+    ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+
+    POSCAR vacancy = makeVacancy(nacl, 5, "V_Cl");
+    EXPECT_EQ(vacancy.total_atoms, 7);
+    ASSERT_EQ(vacancy.num_atoms.size(), 2u);
+    EXPECT_EQ(vacancy.num_atoms[0], 4);
+    EXPECT_EQ(vacancy.num_atoms[1], 3);
+
+    POSCAR doped = makeSubstitution(nacl, 0, "K", "K_Na");
+    EXPECT_EQ(doped.total_atoms, 8);
+    ASSERT_EQ(doped.elements.size(), 3u);
+    EXPECT_EQ(doped.elements[0], "Na");
+    EXPECT_EQ(doped.elements[1], "Cl");
+    EXPECT_EQ(doped.elements[2], "K");
+    EXPECT_EQ(doped.num_atoms[0], 3);
+    EXPECT_EQ(doped.num_atoms[2], 1);
+
+    nacl.toDirect();
+    EXPECT_NEAR(doped.coordinates[7].x, nacl.coordinates[0].x, 1e-12);
+    EXPECT_NEAR(doped.coordinates[7].y, nacl.coordinates[0].y, 1e-12);
+    EXPECT_NEAR(doped.coordinates[7].z, nacl.coordinates[0].z, 1e-12);
+}
+
+TEST(PointDefects, ParseSubstitutions) {
+    std::vector<std::pair<std::string, std::string>> subs;
+    ASSERT_TRUE(parseSubstitutions("Na:K,Na:Li,Cl:Br", subs));
+    ASSERT_EQ(subs.size(), 3u);
+    EXPECT_EQ(subs[1].first, "Na");
+    EXPECT_EQ(subs[1].second, "Li");
+
+    std::vector<std::pair<std::string, std::string>> bad;
+    EXPECT_FALSE(parseSubstitutions("Na", bad));
+    bad.clear();
+    EXPECT_FALSE(parseSubstitutions("Na:", bad));
+}
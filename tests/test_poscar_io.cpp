@@ -1,8 +1,12 @@
 #include <gtest/gtest.h>
 
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
+#include <fstream>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "poscar_file.h"
 
@@ -70,6 +74,38 @@ TEST(PoscarIO, CoordinateValues) {
     EXPECT_NEAR(poscar.coordinates[7].z, 0.5, tol);
 }
 
+TEST(PoscarIO, SpeciesTableMergesRepeatedBlocks) {
+    const std::string tmpFile = std::string(TEST_DATA_DIR) + "/test_species_tmp.poscar";
+    {
+        std::ofstream out(tmpFile);
+        out << "FeO with split oxygen\n1.0\n4 0 0\n0 4 0\n0 0 4\nO Fe O\n1 2 1\nDirect\n"
+               "0 0 0\n0.5 0 0\n0 0.5 0\n0 0 0.5\n";
+    }
+    POSCAR poscar;
+    ASSERT_TRUE(poscar.readPOSCAR(tmpFile));
+    std::remove(tmpFile.c_str());
+
+    EXPECT_EQ(poscar.species, (std::vector<std::string>{"O", "Fe"}));
+    EXPECT_EQ(poscar.atom_types, (std::vector<std::uint16_t>{0, 1, 1, 0}));
+    EXPECT_TRUE(poscar.speciesConsistent());
+
+    poscar.num_atoms = {1, 1, 1};
+    EXPECT_FALSE(poscar.speciesConsistent());
+    poscar.coordinates.pop_back();
+    poscar.updateSpecies();
+    EXPECT_EQ(poscar.atom_types, (std::vector<std::uint16_t>{0, 1, 0}));
+    EXPECT_TRUE(poscar.speciesConsistent());
+}
+
+TEST(PoscarIO, RejectsInvalidAtomCounts) {
+    for (const char* counts : {"2 -1", "2000000000 2000000000"}) {
+        std::istringstream in(std::string("bad counts\n1.0\n4 0 0\n0 4 0\n0 0 4\nNa Cl\n") + counts +
+                              "\nDirect\n0 0 0\n");
+        POSCAR poscar;
+        EXPECT_FALSE(poscar.readPOSCAR(in, "stream")) << counts;
+    }
+}
+
 TEST(PoscarIO, ReadNonExistentFile) {
     POSCAR poscar;
     EXPECT_FALSE(poscar.readPOSCAR("nonexistent_file.poscar"));
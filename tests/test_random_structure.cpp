@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "lattice_utility.h"
+#include "poscar_file.h"
+#include "random_structure.h"
+
+namespace {
+
+// Fm-3m in its conventional setting: the 48 signed permutation matrices times the four face centrings
+SpaceGroupChoice fm3m() {
+    SpaceGroupChoice group;
+    group.number = 225;
+    const int permutations[6][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+    const double centrings[4][3] = {{0, 0, 0}, {0, 0.5, 0.5}, {0.5, 0, 0.5}, {0.5, 0.5, 0}};
+    for (const auto& perm : permutations)
+        for (int signs = 0; signs < 8; ++signs)
+            for (const auto& centring : centrings) {
+                SymmetryOperation op{};
+                for (int i = 0; i < 3; ++i) {
+                    op.rotation[i][perm[i]] = (signs >> i) & 1 ? -1 : 1;
+                    op.translation[i] = centring[i];
+                }
+                group.operations.push_back(op);
+            }
+    return group;
+}
+
+double closestPair(const POSCAR& poscar, int species_a, int species_b) {
+    double closest = 1e9;
+    for (size_t i = 0; i < poscar.coordinates.size(); ++i)
+        for (size_t j = i + 1; j < poscar.coordinates.size(); ++j) {
+            const int a = poscar.atom_types[i], b = poscar.atom_types[j];
+            if (!((a == species_a && b == species_b) || (a == species_b && b == species_a)))
+                continue;
+            const double delta[3] = {poscar.coordinates[i].x - poscar.coordinates[j].x,
+                                     poscar.coordinates[i].y - poscar.coordinates[j].y,
+                                     poscar.coordinates[i].z - poscar.coordinates[j].z};
+            closest = std::min(closest, minimumImageDistance(poscar.lattice, delta));
+        }
+    return closest;
+}
+
+}  // namespace
+
+TEST(RandomStructure, RespectsCompositionVolumeAndDistances) {
+    RandomStructureOptions options;
+    options.composition = {{"Na", 4}, {"Cl", 4}};
+    options.min_volume = 150.0;
+    options.max_volume = 200.0;
+    options.min_distance = 2.0;
+    options.pair_distance[{"Cl", "Na"}] = 2.5;
+
+    POSCAR poscar;
+    int spacegroup = 0;
+    ASSERT_TRUE(generateRandomStructure(options, 11, poscar, &spacegroup));
+    EXPECT_EQ(spacegroup, 1);
+    EXPECT_EQ(poscar.total_atoms, 8);
+    EXPECT_EQ(poscar.num_atoms, (std::vector<int>{4, 4}));
+    const double volume = cellVolume(poscar.lattice);
+    EXPECT_GE(volume, 150.0 - 1e-9);
+    EXPECT_LE(volume, 200.0 + 1e-9);
+    EXPECT_GE(closestPair(poscar, 0, 0), 2.0);
+    EXPECT_GE(closestPair(poscar, 1, 1), 2.0);
+    EXPECT_GE(closestPair(poscar, 0, 1), 2.5);
+}
+
+TEST(RandomStructure, SameSeedGivesSameStructure) {
+    RandomStructureOptions options;
+    options.composition = {{"Si", 6}};
+    options.min_volume = 100.0;
+    options.max_volume = 140.0;
+
+    POSCAR a, b, c;
+    ASSERT_TRUE(generateRandomStructure(options, candidateSeed(5, 3), a));
+    ASSERT_TRUE(generateRandomStructure(options, candidateSeed(5, 3), b));
+    ASSERT_TRUE(generateRandomStructure(options, candidateSeed(5, 4), c));
+    for (int i = 0; i < 6; ++i) {
+        EXPECT_EQ(a.coordinates[i].x, b.coordinates[i].x);
+        EXPECT_EQ(a.coordinates[i].z, b.coordinates[i].z);
+    }
+    EXPECT_NE(a.coordinates[0].x, c.coordinates[0].x);
+}
+
+TEST(RandomStructure, ImposedSpaceGroupMapsStructureOntoItself) {
+    RandomStructureOptions options;
+    options.composition = {{"Na", 4}, {"Cl", 4}};
+    options.min_volume = 150.0;
+    options.max_volume = 200.0;
+    options.min_distance = 2.2;
+    options.spacegroups.push_back(fm3m());
+
+    POSCAR poscar;
+    int spacegroup = 0;
+    ASSERT_TRUE(generateRandomStructure(options, 3, poscar, &spacegroup));
+    EXPECT_EQ(spacegroup, 225);
+    EXPECT_NEAR(poscar.lattice[0][0], poscar.lattice[2][2], 1e-9);  // cubic cell
+    EXPECT_NEAR(poscar.lattice[1][0], 0.0, 1e-9);
+
+    for (const SymmetryOperation& op : options.spacegroups[0].operations) {
+        for (size_t i = 0; i < poscar.coordinates.size(); ++i) {
+            const double x[3] = {poscar.coordinates[i].x, poscar.coordinates[i].y, poscar.coordinates[i].z};
+            double y[3];
+            for (int k = 0; k < 3; ++k)
+                y[k] = op.rotation[k][0] * x[0] + op.rotation[k][1] * x[1] + op.rotation[k][2] * x[2] +
+                       op.translation[k];
+            double closest = 1e9;
+            for (size_t j = 0; j < poscar.coordinates.size(); ++j) {
+                if (poscar.atom_types[j] != poscar.atom_types[i])
+                    continue;
+                const double delta[3] = {y[0] - poscar.coordinates[j].x, y[1] - poscar.coordinates[j].y,
+                                         y[2] - poscar.coordinates[j].z};
+                closest = std::min(closest, minimumImageDistance(poscar.lattice, delta));
+            }
+            ASSERT_LT(closest, 1e-3);
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "poscar_file.h"
+#include "selective_dynamics.h"
+#include "structure_utility.h"
+
+// Four atomic planes 2 Angstrom apart, crossing the periodic boundary along c, with 12 Angstrom of vacuum
+static POSCAR layeredSlab() {
+    const double lattice[3][3] = {{3, 0, 0}, {0, 3, 0}, {0, 0, 18}};
+    std::vector<std::string> species(4, "Cu");
+    std::vector<Atom> coords = {{0, 0, 15.0 / 18}, {0.5, 0.5, 17.0 / 18}, {0, 0, 1.0 / 18}, {0.5, 0.5, 3.0 / 18}};
+    return buildPOSCAR("slab", lattice, species, coords);
+}
+
+TEST(SelectiveDynamics, SurfaceRegionsAcrossBoundary) {
+    POSCAR slab = layeredSlab();
+
+    std::vector<int> bottom = atomsInSurfaceRegion(slab, 2, 2.5, false);
+    EXPECT_EQ(bottom, (std::vector<int>{0, 1}));
+    std::vector<int> top = atomsInSurfaceRegion(slab, 2, 0.5, true);
+    EXPECT_EQ(top, (std::vector<int>{3}));
+}
+
+TEST(SelectiveDynamics, SphereAroundPoint) {
+    POSCAR slab = layeredSlab();
+    const double center[3] = {0.0, 0.0, 1.0 / 18};
+
+    // Atom 2 is the centre, atoms 1 and 3 are sqrt(4.5 + 4) = 2.92 Angstrom away, atom 0 is 4 Angstrom away
+    std::vector<int> outside = atomsOutsideSphere(slab, center, 3.0);
+    EXPECT_EQ(outside, (std::vector<int>{0}));
+}
+
+TEST(SelectiveDynamics, FreezeAndPropagate) {
+    POSCAR slab = layeredSlab();
+    freezeAtoms(slab, {0, 1}, kMoveAll);
+    freezeAtoms(slab, {3}, kMoveZ);
+    ASSERT_TRUE(slab.selective_dynamics);
+    EXPECT_EQ(slab.selective_flags, (std::vector<std::uint8_t>{0, 0, kMoveAll, kMoveX | kMoveY}));
+
+    const std::string tmpFile = std::string(TEST_DATA_DIR) + "/test_selective_tmp.poscar";
+    ASSERT_TRUE(slab.writePOSCAR(tmpFile));
+    POSCAR reloaded;
+    ASSERT_TRUE(reloaded.readPOSCAR(tmpFile));
+    std::remove(tmpFile.c_str());
+    EXPECT_TRUE(reloaded.selective_dynamics);
+    EXPECT_EQ(reloaded.selective_flags, slab.selective_flags);
+
+    // Every periodic copy keeps the flags of its parent atom
+    POSCAR super = makeSupercell(reloaded, 1, 1, 2);
+    ASSERT_TRUE(super.selective_dynamics);
+    ASSERT_EQ(super.selective_flags.size(), 8u);
+    EXPECT_EQ(super.selective_flags[0], 0);
+    EXPECT_EQ(super.selective_flags[1], 0);
+    EXPECT_EQ(super.selective_flags[7], kMoveX | kMoveY);
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "lattice_utility.h"
+#include "poscar_file.h"
+#include "slab.h"
+#include "structure_utility.h"
+
+static const std::string kNaClPath = std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar";
+static const double kNaClA = 5.5881264354399347;
+
+TEST(Slab, MillerTransformIsUnimodular) {
+    const int cases[][3] = {{1, 0, 0}, {0, 0, 1}, {1, 1, 0}, {1, 1, 1}, {2, 1, 0}, {3, -2, 5}, {0, 2, 4}, {-1, 1, 2}};
+    for (const auto& hkl : cases) {
+        int t[3][3];
+        ASSERT_TRUE(millerTransform(hkl, t));
+
+        double m[3][3];
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                m[i][j] = t[i][j];
+        EXPECT_NEAR(determinant3(m), 1.0, 1e-12);
+
+        const int g = std::gcd(std::gcd(std::abs(hkl[0]), std::abs(hkl[1])), std::abs(hkl[2]));
+        for (int i = 0; i < 3; ++i) {
+            int dot = (hkl[0] * t[i][0] + hkl[1] * t[i][1] + hkl[2] * t[i][2]) / g;
+            EXPECT_EQ(dot, i == 2 ? 1 : 0);
+        }
+    }
+    const int zero[3] = {0, 0, 0};
+    int t[3][3];
+    EXPECT_FALSE(millerTransform(zero, t));
+}
+
+TEST(Slab, RockSaltLayers) {
+    POSCAR nacl;
+    ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+
+    // (100): mixed Na/Cl planes every a/2
+    const int h100[3] = {1, 0, 0};
+    POSCAR oriented;
+    ASSERT_TRUE(orientedCell(nacl, h100, oriented));
+    SlabLayers layers = findLayers(oriented, 0.05);
+    EXPECT_NEAR(layers.repeat, kNaClA, 1e-8);
+    ASSERT_EQ(layers.height.size(), 2u);
+    EXPECT_NEAR(layers.height[1] - layers.height[0], kNaClA / 2.0, 1e-6);
+
+    // (111): alternating pure Na and pure Cl planes
+    const int h111[3] = {1, 1, 1};
+    ASSERT_TRUE(orientedCell(nacl, h111, oriented));
+    EXPECT_NEAR(cellVolume(oriented.lattice), cellVolume(nacl.lattice), 1e-8);
+    layers = findLayers(oriented, 0.05);
+    EXPECT_NEAR(layers.repeat, kNaClA / std::sqrt(3.0), 1e-8);
+    ASSERT_EQ(layers.height.size(), 2u);
+
+    std::vector<std::string> species = atomSpecies(oriented);
+    for (int l = 0; l < 2; ++l) {
+        std::set<std::string> in_layer;
+        for (int i = 0; i < oriented.total_atoms; ++i)
+            if (layers.atom_layer[i] == l)
+                in_layer.insert(species[i]);
+        EXPECT_EQ(in_layer.size(), 1u);
+    }
+}
+
+TEST(Slab, BuildSlabTerminations) {
+    POSCAR nacl;
+    ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+    const int h111[3] = {1, 1, 1};
+    POSCAR oriented;
+    ASSERT_TRUE(orientedCell(nacl, h111, oriented));
+    SlabLayers layers = findLayers(oriented, 0.05);
+
+    const int n_cells = 4;
+    const double vacuum = 15.0;
+    std::string bottom_species[2];
+    for (int t = 0; t < 2; ++t) {
+        POSCAR slab = buildSlab(oriented, layers, t, n_cells, vacuum);
+        ASSERT_EQ(slab.total_atoms, n_cells * oriented.total_atoms);
+
+        // c along the surface normal
+        for (int i = 0; i < 2; ++i) {
+            double dot = 0.0;
+            for (int j = 0; j < 3; ++j)
+                dot += slab.lattice[i][j] * slab.lattice[2][j];
+            EXPECT_NEAR(dot, 0.0, 1e-8);
+        }
+        const double c = std::sqrt(slab.lattice[2][0] * slab.lattice[2][0] + slab.lattice[2][1] * slab.lattice[2][1] +
+                                   slab.lattice[2][2] * slab.lattice[2][2]);
+        EXPECT_NEAR(c, n_cells * layers.repeat + vacuum, 1e-8);
+
+        // n_cells * 2 planes, a half repeat apart
+        std::vector<std::string> species = atomSpecies(slab);
+        double lowest = 1.0, highest = 0.0;
+        int lowest_atom = 0;
+        for (int i = 0; i < slab.total_atoms; ++i) {
+            EXPECT_GT(slab.coordinates[i].z, 0.0);
+            EXPECT_LT(slab.coordinates[i].z, 1.0);
+            if (slab.coordinates[i].z < lowest) {
+                lowest = slab.coordinates[i].z;
+                lowest_atom = i;
+            }
+            highest = std::max(highest, slab.coordinates[i].z);
+        }
+        EXPECT_NEAR((highest - lowest) * c, (2 * n_cells - 1) * 0.5 * layers.repeat, 1e-6);
+        bottom_species[t] = species[lowest_atom];
+    }
+    EXPECT_NE(bottom_species[0], bottom_species[1]);
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "structure_archive.h"
+
+static std::string archivePath(const char* name) {
+    return std::string(TEST_DATA_DIR) + "/" + name;
+}
+
+TEST(StructureArchive, RoundTripsManyEntries) {
+    const std::string path = archivePath("test_archive_tmp.tar");
+    {
+        ArchiveWriter writer(path, 4);  // small queue, so add() has to wait for the writer thread
+        ASSERT_TRUE(writer);
+        for (int i = 0; i < 200; ++i)
+            ASSERT_TRUE(writer.add("POSCAR_modified" + std::to_string(i + 1), std::string(i * 7, 'a' + i % 26)));
+        ASSERT_TRUE(writer.close());
+    }
+
+    ArchiveReader reader(path);
+    ASSERT_TRUE(reader);
+    ArchiveEntry entry;
+    int count = 0;
+    while (reader.next(entry)) {
+        EXPECT_EQ(entry.name, "POSCAR_modified" + std::to_string(count + 1));
+        EXPECT_EQ(entry.contents, std::string(count * 7, 'a' + count % 26));
+        count++;
+    }
+    std::remove(path.c_str());
+    EXPECT_TRUE(reader.error().empty());
+    EXPECT_EQ(count, 200);
+}
+
+TEST(StructureArchive, SplitsLongNames) {
+    const std::string path = archivePath("test_archive_long_tmp.tar");
+    const std::string longName = std::string(120, 'd') + "/POSCAR_1";
+    {
+        ArchiveWriter writer(path);
+        EXPECT_TRUE(writer.add(longName, "Si\n"));
+        EXPECT_FALSE(writer.add(std::string(300, 'x'), "too long\n"));
+        ASSERT_TRUE(writer.close());
+    }
+
+    ArchiveReader reader(path);
+    ArchiveEntry entry;
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(entry.name, longName);
+    EXPECT_EQ(entry.contents, "Si\n");
+    EXPECT_FALSE(reader.next(entry));
+    std::remove(path.c_str());
+}
+
+TEST(StructureArchive, DetectsTruncation) {
+    const std::string path = archivePath("test_archive_cut_tmp.tar");
+    {
+        ArchiveWriter writer(path);
+        writer.add("POSCAR_1", std::string(2000, 'x'));
+        ASSERT_TRUE(writer.close());
+    }
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), 1024);
+    }
+
+    ArchiveReader reader(path);
+    ArchiveEntry entry;
+    EXPECT_FALSE(reader.next(entry));
+    EXPECT_FALSE(reader.error().empty());
+    std::remove(path.c_str());
+}
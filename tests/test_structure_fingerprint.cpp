@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <utility>
+
+#include "lattice_utility.h"
+#include "poscar_file.h"
+#include "structure_fingerprint.h"
+
+static const std::string kNaClPath = std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar";
+
+class FingerprintTest : public ::testing::Test {
+protected:
+    POSCAR poscar;
+    void SetUp() override {
+        ASSERT_TRUE(poscar.readPOSCAR(kNaClPath));
+    }
+};
+
+TEST_F(FingerprintTest, CompositionAndVolume) {
+    StructureFingerprint fp = computeFingerprint(poscar);
+
+    ASSERT_EQ(fp.composition.size(), 2u);
+    EXPECT_EQ(fp.composition[0], std::make_pair(std::string("Cl"), 4));
+    EXPECT_EQ(fp.composition[1], std::make_pair(std::string("Na"), 4));
+
+    const double a = 5.5881264354399347;
+    EXPECT_NEAR(fp.volume_per_atom, a * a * a / 8.0, 1e-9);
+}
+
+TEST_F(FingerprintTest, NearestNeighbourShell) {
+    FingerprintOptions options;
+    options.cutoff = 3.0;
+    StructureFingerprint fp = computeFingerprint(poscar, options);
+
+    // Rock salt: 6 neighbours at a/2 = 2.794 Angstrom, nothing closer
+    double total = 0.0;
+    for (double h : fp.distance_histogram)
+        total += h;
+    EXPECT_NEAR(total, 6.0, 1e-12);
+    EXPECT_NEAR(fp.distance_histogram[27], 6.0, 1e-12);
+}
+
+TEST_F(FingerprintTest, InvariantUnderTranslationAndCoordinateSystem) {
+    StructureFingerprint reference = computeFingerprint(poscar);
+
+    POSCAR shifted = poscar;
+    for (auto& atom : shifted.coordinates) {
+        atom.x = wrapFractional(atom.x + 0.123);
+        atom.y = wrapFractional(atom.y - 0.321);
+    }
+    shifted.toCartesian();
+
+    StructureFingerprint fp = computeFingerprint(shifted);
+    EXPECT_EQ(fp.composition_hash, reference.composition_hash);
+    EXPECT_TRUE(fingerprintsCompatible(fp, reference, 1e-6, 1e-9));
+}
+
+TEST_F(FingerprintTest, DetectsStrainedCell) {
+    StructureFingerprint reference = computeFingerprint(poscar);
+
+    POSCAR strained = poscar;
+    for (int j = 0; j < 3; ++j)
+        strained.lattice[0][j] *= 1.1;
+
+    EXPECT_FALSE(fingerprintsCompatible(computeFingerprint(strained), reference, 0.02, 0.05));
+}
+
+TEST(LatticeUtility, MinimumImageDistanceSkewedCell) {
+    // Hexagonal cell with 120 degree gamma: (0.9, 0.9, 0) is close to the origin through the (1,1,0) image
+    const double lattice[3][3] = {{1.0, 0.0, 0.0}, {-0.5, std::sqrt(3.0) / 2.0, 0.0}, {0.0, 0.0, 5.0}};
+    const double delta[3] = {0.9, 0.9, 0.0};
+    EXPECT_NEAR(minimumImageDistance(lattice, delta), 0.1, 1e-12);
+}
+
+TEST(LatticeUtility, InverseAndVolume) {
+    const double lattice[3][3] = {{2.0, 0.0, 0.0}, {1.0, 3.0, 0.0}, {0.5, 0.5, 4.0}};
+    double inv[3][3];
+    ASSERT_TRUE(invert3(lattice, inv));
+    EXPECT_NEAR(cellVolume(lattice), 24.0, 1e-12);
+
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j) {
+            double s = 0.0;
+            for (int k = 0; k < 3; ++k)
+                s += lattice[i][k] * inv[k][j];
+            EXPECT_NEAR(s, i == j ? 1.0 : 0.0, 1e-12);
+        }
+}
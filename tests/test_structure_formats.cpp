@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "poscar_file.h"
+#include "selective_dynamics.h"
+#include "structure_formats.h"
+#include "text_writer.h"
+
+static const std::string kNaClPath = std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar";
+
+TEST(StructureFormats, DispatchesByExtensionAndPrefix) {
+    ASSERT_NE(findStructureFormat("POSCAR"), nullptr);
+    EXPECT_EQ(findStructureFormat("POSCAR")->name, "poscar");
+    EXPECT_EQ(findStructureFormat("dir/CONTCAR_relaxed")->name, "poscar");
+    EXPECT_EQ(findStructureFormat("NaCl.vasp")->name, "poscar");
+    EXPECT_EQ(findStructureFormat("ctrls.nacl")->name, "ctrls");
+    EXPECT_EQ(findStructureFormat("POSCAR_Si.XYZ")->name, "extxyz");
+    EXPECT_EQ(findStructureFormat("data.lmp")->name, "lammps");
+    EXPECT_EQ(findStructureFormat("NaCl.cif")->name, "cif");
+    EXPECT_EQ(findStructureFormat("notes.txt"), nullptr);
+    EXPECT_EQ(structureFormatByName("LAMMPS"), findStructureFormat("x.data"));
+}
+
+TEST(StructureFormats, RegisteredFormatIsUsed) {
+    StructureFormat format;
+    format.name = "count";
+    format.extensions = {".count"};
+    format.write = [](TextWriter& out, const POSCAR& poscar) {
+        out.integer(static_cast<long long>(poscar.coordinates.size())).character('\n');
+    };
+    registerStructureFormat(format);
+
+    POSCAR poscar;
+    ASSERT_TRUE(poscar.readPOSCAR(kNaClPath));
+    const std::string tmpFile = std::string(TEST_DATA_DIR) + "/test_formats_tmp.count";
+    ASSERT_TRUE(writeStructure(tmpFile, poscar));
+    std::ifstream in(tmpFile);
+    int count = 0;
+    in >> count;
+    std::remove(tmpFile.c_str());
+    EXPECT_EQ(count, 8);
+
+    POSCAR unused;
+    EXPECT_FALSE(readStructure(tmpFile, unused));  // no reader
+}
+
+TEST(StructureFormats, PoscarStreamMatchesFileWriter) {
+    POSCAR poscar;
+    ASSERT_TRUE(poscar.readPOSCAR(kNaClPath));
+    freezeAtoms(poscar, {0, 5}, kMoveZ);
+
+    const std::string tmpFile = std::string(TEST_DATA_DIR) + "/POSCAR_formats_tmp";
+    ASSERT_TRUE(poscar.writePOSCAR(tmpFile));
+    std::ifstream in(tmpFile);
+    std::stringstream fromFile;
+    fromFile << in.rdbuf();
+    std::remove(tmpFile.c_str());
+
+    std::ostringstream fromStream;
+    {
+        TextWriter out(fromStream);
+        poscar.writePOSCAR(out);
+    }
+    EXPECT_EQ(fromStream.str(), fromFile.str());
+
+    // The stream reader resets the atom count instead of adding to it
+    std::istringstream again(fromStream.str());
+    ASSERT_TRUE(poscar.readPOSCAR(again, "stream"));
+    EXPECT_EQ(poscar.total_atoms, 8);
+    ASSERT_EQ(poscar.selective_flags.size(), 8u);
+    EXPECT_EQ(poscar.selective_flags[5], kMoveX | kMoveY);
+}
+
+TEST(StructureFormats, ExtxyzRoundTripKeepsFramesAndFlags) {
+    POSCAR first;
+    ASSERT_TRUE(first.readPOSCAR(kNaClPath));
+    POSCAR second = first;
+    second.coordinates[0].x += 0.01;
+    freezeAtoms(second, {7}, kMoveAll);
+
+    const std::string tmpFile = std::string(TEST_DATA_DIR) + "/test_formats_tmp.xyz";
+    ASSERT_TRUE(writeStructures(tmpFile, {first, second}));
+
+    std::vector<POSCAR> frames;
+    ASSERT_TRUE(readStructures(tmpFile, frames));
+    POSCAR single;
+    ASSERT_TRUE(readStructure(tmpFile, single));
+    std::remove(tmpFile.c_str());
+
+    ASSERT_EQ(frames.size(), 2u);
+    EXPECT_EQ(single.total_atoms, 8);
+    for (size_t f = 0; f < frames.size(); ++f) {
+        const POSCAR& expected = f == 0 ? first : second;
+        EXPECT_EQ(frames[f].elements, expected.elements);
+        EXPECT_EQ(frames[f].num_atoms, expected.num_atoms);
+        EXPECT_TRUE(frames[f].is_direct);
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                EXPECT_NEAR(frames[f].lattice[i][j], expected.lattice[i][j], 1e-9);
+        for (size_t i = 0; i < expected.coordinates.size(); ++i) {
+            EXPECT_NEAR(frames[f].coordinates[i].x, expected.coordinates[i].x, 1e-9);
+            EXPECT_NEAR(frames[f].coordinates[i].y, expected.coordinates[i].y, 1e-9);
+            EXPECT_NEAR(frames[f].coordinates[i].z, expected.coordinates[i].z, 1e-9);
+        }
+    }
+    EXPECT_FALSE(frames[0].selective_dynamics);
+    ASSERT_TRUE(frames[1].selective_dynamics);
+    EXPECT_EQ(frames[1].selective_flags[7], 0);
+    EXPECT_EQ(frames[1].selective_flags[0], kMoveAll);
+}
+
+TEST(StructureFormats, ExtxyzReaderFindsColumnsAndGroupsSpecies) {
+    std::istringstream in(
+        "3\n"
+        "energy=-1.5 Properties=id:I:1:species:S:1:pos:R:3 Lattice=\"4 0 0 0 4 0 0 0 4\" pbc=\"T T T\"\n"
+        "1 O 0 0 0\n"
+        "2 H +1.0 0 0\n"
+        "3 O 2 2 2\n");
+    POSCAR poscar;
+    ASSERT_TRUE(readExtxyz(in, "water.xyz", poscar));
+    EXPECT_EQ(poscar.elements, (std::vector<std::string>{"O", "H"}));
+    EXPECT_EQ(poscar.num_atoms, (std::vector<int>{2, 1}));
+    EXPECT_NEAR(poscar.coordinates[1].x, 0.5, 1e-12);
+    EXPECT_NEAR(poscar.coordinates[2].x, 0.25, 1e-12);
+
+    std::istringstream noLattice("1\nProperties=species:S:1:pos:R:3\nH 0 0 0\n");
+    EXPECT_FALSE(readExtxyz(noLattice, "molecule.xyz", poscar));
+}
+
+TEST(StructureFormats, ExtxyzReaderRejectsOversizedAtomCount) {
+    std::istringstream in("999999999999\nLattice=\"4 0 0 0 4 0 0 0 4\" Properties=species:S:1:pos:R:3\nH 0 0 0\n");
+    POSCAR poscar;
+    EXPECT_FALSE(readExtxyz(in, "truncated.xyz", poscar));
+}
+
+TEST(StructureFormats, LammpsCellIsLowerTriangularWithSameMetric) {
+    POSCAR poscar;
+    poscar.comment = "tilted";
+    const double lattice[3][3] = {{0, 2.5, 2.5}, {2.5, 0, 2.5}, {2.5, 2.5, 0}};
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            poscar.lattice[i][j] = lattice[i][j];
+    poscar.elements = {"Cu"};
+    poscar.num_atoms = {1};
+    poscar.total_atoms = 1;
+    poscar.coordinates = {{0.5, 0.5, 0.5}};
+
+    std::ostringstream text;
+    {
+        TextWriter out(text);
+        writeLammpsData(out, poscar);
+    }
+    std::istringstream in(text.str());
+    std::string line;
+    double lx = 0, ly = 0, lz = 0, xy = 0, xz = 0, yz = 0, lo = 0;
+    std::vector<double> atom;
+    bool inAtoms = false;
+    while (std::getline(in, line)) {
+        std::istringstream iss(line);
+        if (line.find("xlo xhi") != std::string::npos)
+            iss >> lo >> lx;
+        else if (line.find("ylo yhi") != std::string::npos)
+            iss >> lo >> ly;
+        else if (line.find("zlo zhi") != std::string::npos)
+            iss >> lo >> lz;
+        else if (line.find("xy xz yz") != std::string::npos)
+            iss >> xy >> xz >> yz;
+        else if (line.rfind("Atoms", 0) == 0)
+            inAtoms = true;
+        else if (inAtoms && !line.empty())
+            for (double v; iss >> v;)
+                atom.push_back(v);
+    }
+
+    const double edge = std::sqrt(12.5);
+    EXPECT_NEAR(lx, edge, 1e-9);
+    EXPECT_NEAR(std::sqrt(xy * xy + ly * ly), edge, 1e-9);
+    EXPECT_NEAR(std::sqrt(xz * xz + yz * yz + lz * lz), edge, 1e-9);
+    EXPECT_NEAR(xy * xz + ly * yz, 6.25, 1e-9);  // b . c
+    ASSERT_EQ(atom.size(), 5u);
+    EXPECT_EQ(atom[0], 1);
+    EXPECT_EQ(atom[1], 1);
+    EXPECT_NEAR(atom[2], 0.5 * (lx + xy + xz), 1e-9);
+    EXPECT_NEAR(atom[4], 0.5 * lz, 1e-9);
+}
+
+TEST(StructureFormats, CifListsCellAndFractionalSites) {
+    POSCAR poscar;
+    ASSERT_TRUE(poscar.readPOSCAR(kNaClPath));
+    poscar.toCartesian();
+
+    std::ostringstream text;
+    {
+        TextWriter out(text);
+        writeCif(out, poscar);
+    }
+    const std::string cif = text.str();
+    EXPECT_EQ(cif.rfind("data_", 0), 0u);
+    EXPECT_NE(cif.find("_cell_length_a    5.5881264354"), std::string::npos);
+    EXPECT_NE(cif.find("_cell_angle_gamma 90.0000000000"), std::string::npos);
+    EXPECT_NE(cif.find("\nNa1 Na "), std::string::npos);
+    EXPECT_NE(cif.find("\nCl4 Cl "), std::string::npos);
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "poscar_file.h"
+#include "structure_index.h"
+#include "structure_utility.h"
+
+namespace fs = std::filesystem;
+
+static const std::string kNaClPath = std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar";
+
+// Directory with NaCl, a doubled NaCl cell and a Na-only cell
+class StructureIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = std::string(TEST_DATA_DIR) + "/structure_index_tmp";
+        fs::remove_all(dir);
+        fs::create_directories(dir + "/sub");
+
+        POSCAR nacl;
+        ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+        ASSERT_TRUE(nacl.writePOSCAR(dir + "/POSCAR_NaCl"));
+        ASSERT_TRUE(makeSupercell(nacl, 2, 1, 1).writePOSCAR(dir + "/sub/POSCAR_NaCl_211"));
+
+        std::ofstream na(dir + "/POSCAR_Na");
+        na << "Na bcc\n1.0\n4.2 0 0\n0 4.2 0\n0 0 4.2\nNa\n2\nDirect\n0 0 0\n0.5 0.5 0.5\n";
+        std::ofstream other(dir + "/notes.txt");
+        other << "not a structure\n";
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+
+    std::string dir;
+};
+
+TEST(StructureIndex, ReadsHeadersOnly) {
+    POSCAR header;
+    ASSERT_TRUE(header.readHeader(kNaClPath));
+    EXPECT_EQ(header.total_atoms, 8);
+    EXPECT_TRUE(header.coordinates.empty());
+    EXPECT_EQ(header.elements, (std::vector<std::string>{"Na", "Cl"}));
+}
+
+TEST_F(StructureIndexTest, IndexesAndQueries) {
+    StructureIndex index;
+    IndexUpdateStats stats = updateStructureIndex(index, dir, "POSCAR", 2);
+    EXPECT_EQ(stats.parsed, 3u);
+    ASSERT_EQ(index.size(), 3u);
+    EXPECT_EQ(fs::path(index.paths[0]).filename(), "POSCAR_Na");
+
+    IndexQuery byFormula;
+    ASSERT_TRUE(parseFormula("Na2Cl2", byFormula.formula));
+    EXPECT_EQ(queryStructureIndex(index, byFormula).size(), 2u);
+
+    IndexQuery small;
+    small.contains = {"Na"};
+    small.max_atoms = 8;
+    EXPECT_EQ(queryStructureIndex(index, small).size(), 2u);
+    small.exclude = {"Cl"};
+    ASSERT_EQ(queryStructureIndex(index, small).size(), 1u);
+    EXPECT_EQ(index.natoms[queryStructureIndex(index, small)[0]], 2);
+
+    IndexQuery byVolume;
+    byVolume.min_volume = 300.0;
+    std::vector<std::size_t> large = queryStructureIndex(index, byVolume);
+    ASSERT_EQ(large.size(), 1u);
+    EXPECT_EQ(index.natoms[large[0]], 16);
+
+    IndexQuery unknown;
+    unknown.contains = {"Xe"};
+    EXPECT_TRUE(queryStructureIndex(index, unknown).empty());
+}
+
+TEST_F(StructureIndexTest, SavesLoadsAndUpdatesIncrementally) {
+    StructureIndex index;
+    updateStructureIndex(index, dir, "POSCAR", 0);
+    const std::string indexFile = dir + "/structures.idx";
+    ASSERT_TRUE(saveStructureIndex(indexFile, index));
+
+    StructureIndex loaded;
+    ASSERT_TRUE(loadStructureIndex(indexFile, loaded));
+    EXPECT_EQ(loaded.paths, index.paths);
+    EXPECT_EQ(loaded.volumes, index.volumes);
+    EXPECT_EQ(loaded.composition_offsets, index.composition_offsets);
+
+    fs::remove(dir + "/sub/POSCAR_NaCl_211");
+    std::ofstream(dir + "/POSCAR_Na", std::ios::app) << "\n";  // modified: size changes
+    IndexUpdateStats stats = updateStructureIndex(loaded, dir, "POSCAR", 0);
+    EXPECT_EQ(stats.reused, 1u);
+    EXPECT_EQ(stats.parsed, 1u);
+    EXPECT_EQ(stats.removed, 1u);
+    EXPECT_EQ(loaded.size(), 2u);
+
+    // Truncated file is rejected
+    fs::resize_file(indexFile, fs::file_size(indexFile) - 3);
+    StructureIndex broken;
+    EXPECT_FALSE(loadStructureIndex(indexFile, broken));
+}
+
+TEST(StructureIndex, ParsesFormulas) {
+    std::vector<std::pair<std::string, int>> composition;
+    ASSERT_TRUE(parseFormula("Fe2O3", composition));
+    EXPECT_EQ(composition, (std::vector<std::pair<std::string, int>>{{"Fe", 2}, {"O", 3}}));
+    ASSERT_TRUE(parseFormula("OHO", composition));
+    EXPECT_EQ(composition, (std::vector<std::pair<std::string, int>>{{"O", 2}, {"H", 1}}));
+    EXPECT_FALSE(parseFormula("fe2", composition));
+    EXPECT_FALSE(parseFormula("Fe0", composition));
+    EXPECT_FALSE(parseFormula("", composition));
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "lattice_utility.h"
+#include "poscar_file.h"
+#include "structure_utility.h"
+#include "symmetry.h"
+#include "workspace.h"
+
+static const double kSymprec = 1e-5;
+static const double kNaClLattice = 5.5881264354399347;
+
+// Rock salt in its face-centred primitive setting: one Na and one Cl
+static POSCAR primitiveNaCl() {
+    const double h = 0.5 * kNaClLattice;
+    const double lattice[3][3] = {{0, h, h}, {h, 0, h}, {h, h, 0}};
+    return buildPOSCAR("NaCl", lattice, {"Na", "Cl"}, {{0, 0, 0}, {0.5, 0.5, 0.5}});
+}
+
+// Atoms must sit under the elements line they belong to, with atom_types and num_atoms agreeing
+static void expectGroupedBySpecies(const POSCAR& poscar) {
+    ASSERT_TRUE(poscar.speciesConsistent());
+    ASSERT_EQ(poscar.num_atoms.size(), poscar.elements.size());
+    EXPECT_TRUE(std::is_sorted(poscar.atom_types.begin(), poscar.atom_types.end()));
+    size_t i = 0;
+    for (size_t e = 0; e < poscar.num_atoms.size(); ++e)
+        for (int k = 0; k < poscar.num_atoms[e]; ++k, ++i)
+            EXPECT_EQ(poscar.atom_types[i], e);
+    EXPECT_EQ(i, poscar.coordinates.size());
+}
+
+TEST(Symmetry, CentredPrimitiveCellStandardizesToConventional) {
+    // The conventional cell has four times the atoms of the input; spglib writes them all back
+    POSCAR primitive = primitiveNaCl();
+    std::optional<POSCAR> conventional = makeConventionalCell(primitive, kSymprec);
+    ASSERT_TRUE(conventional);
+
+    EXPECT_EQ(conventional->total_atoms, 8);
+    ASSERT_EQ(conventional->coordinates.size(), 8u);
+    EXPECT_EQ(conventional->elements, (std::vector<std::string>{"Na", "Cl"}));
+    EXPECT_EQ(conventional->num_atoms, (std::vector<int>{4, 4}));
+    EXPECT_NEAR(cellVolume(conventional->lattice), 4.0 * cellVolume(primitive.lattice), 1e-8);
+    for (int i = 0; i < 3; ++i)
+        EXPECT_NEAR(conventional->lattice[i][i], kNaClLattice, 1e-8);
+    expectGroupedBySpecies(*conventional);
+}
+
+TEST(Symmetry, PrimitiveCellGroupsAtomsBySpecies) {
+    // Cubic perovskite doubled along a: the primitive cell is back to Sr Ti O3
+    const double a = 3.905;
+    const double lattice[3][3] = {{2 * a, 0, 0}, {0, a, 0}, {0, 0, a}};
+    std::vector<std::string> species;
+    std::vector<Atom> coords;
+    for (int k = 0; k < 2; ++k) {
+        const double x = 0.5 * k;
+        species.insert(species.end(), {"Sr", "Ti", "O", "O", "O"});
+        coords.insert(coords.end(), {{x, 0, 0}, {x + 0.25, 0.5, 0.5}, {x, 0.5, 0.5}, {x + 0.25, 0, 0.5},
+                                     {x + 0.25, 0.5, 0}});
+    }
+    POSCAR supercell = buildPOSCAR("SrTiO3", lattice, species, coords);
+
+    std::optional<POSCAR> primitive = makePrimitiveCell(supercell, kSymprec);
+    ASSERT_TRUE(primitive);
+    EXPECT_EQ(primitive->total_atoms, 5);
+    EXPECT_EQ(primitive->elements, (std::vector<std::string>{"Sr", "Ti", "O"}));
+    EXPECT_EQ(primitive->num_atoms, (std::vector<int>{1, 1, 3}));
+    EXPECT_NEAR(cellVolume(primitive->lattice), a * a * a, 1e-8);
+    expectGroupedBySpecies(*primitive);
+}
+
+TEST(Symmetry, PrimitiveCellKeepsSelectiveFlags) {
+    POSCAR conventional;
+    ASSERT_TRUE(conventional.readPOSCAR(std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar"));
+    conventional.selective_dynamics = true;
+    conventional.selective_flags.assign(8, kMoveAll);
+    for (int i = 4; i < 8; ++i)
+        conventional.selective_flags[i] = kMoveZ;
+
+    // Flags that respect the translations survive the reduction, one per species here
+    std::optional<POSCAR> primitive = makePrimitiveCell(conventional, kSymprec);
+    ASSERT_TRUE(primitive);
+    EXPECT_EQ(primitive->num_atoms, (std::vector<int>{1, 1}));
+    EXPECT_TRUE(primitive->selective_dynamics);
+    EXPECT_EQ(primitive->selective_flags, (std::vector<std::uint8_t>{kMoveAll, kMoveZ}));
+
+    // Fixing a single Na breaks the centring, so the cell keeps all eight atoms and the one fixed atom
+    conventional.selective_flags[2] = 0;
+    primitive = makePrimitiveCell(conventional, kSymprec);
+    ASSERT_TRUE(primitive);
+    EXPECT_EQ(primitive->num_atoms, (std::vector<int>{4, 4}));
+    ASSERT_EQ(primitive->selective_flags.size(), 8u);
+    EXPECT_EQ(std::count(primitive->selective_flags.begin(), primitive->selective_flags.begin() + 4, 0), 1);
+    EXPECT_EQ(std::count(primitive->selective_flags.begin() + 4, primitive->selective_flags.end(), kMoveZ), 4);
+}
+
+TEST(Symmetry, PrimitiveCellInPlace) {
+    POSCAR p;
+    ASSERT_TRUE(p.readPOSCAR(std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar"));
+    std::optional<POSCAR> expected = makePrimitiveCell(p, kSymprec);
+    ASSERT_TRUE(expected);
+
+    // The species names are views into p while p is being overwritten
+    Workspace workspace;
+    ASSERT_TRUE(makePrimitiveCell(p, kSymprec, workspace, p));
+    EXPECT_EQ(p.comment, expected->comment);
+    EXPECT_EQ(p.elements, (std::vector<std::string>{"Na", "Cl"}));
+    EXPECT_EQ(p.species, p.elements);
+    EXPECT_EQ(p.num_atoms, (std::vector<int>{1, 1}));
+    EXPECT_EQ(p.total_atoms, 2);
+    EXPECT_NEAR(cellVolume(p.lattice), cellVolume(expected->lattice), 1e-8);
+    ASSERT_EQ(p.coordinates.size(), 2u);
+    for (size_t i = 0; i < 2; ++i) {
+        EXPECT_DOUBLE_EQ(p.coordinates[i].x, expected->coordinates[i].x);
+        EXPECT_DOUBLE_EQ(p.coordinates[i].y, expected->coordinates[i].y);
+        EXPECT_DOUBLE_EQ(p.coordinates[i].z, expected->coordinates[i].z);
+    }
+    expectGroupedBySpecies(p);
+}
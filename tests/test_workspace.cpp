@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+
+#include <memory_resource>
+#include <vector>
+
+#include "workspace.h"
+
+TEST(Workspace, SmallRequestsStayInTheArena) {
+    Workspace workspace(4096);
+    std::pmr::vector<double> positions(300, 0.0, workspace.resource());
+    std::pmr::vector<int> types(100, 1, workspace.resource());
+    EXPECT_EQ(workspace.overflowBytes(), 0u);
+    EXPECT_EQ(types.get_allocator().resource(), workspace.resource());
+}
+
+TEST(Workspace, GrowsToTheHighWaterMarkOnReset) {
+    Workspace workspace(256);
+    for (int pass = 0; pass < 3; ++pass) {
+        workspace.reset();
+        std::pmr::vector<double> positions(3 * 1000, 0.5, workspace.resource());
+        positions[2999] = 1.0;
+        if (pass == 0)
+            EXPECT_GT(workspace.overflowBytes(), 0u);
+        else
+            EXPECT_EQ(workspace.overflowBytes(), 0u);
+    }
+    EXPECT_GE(workspace.capacity(), 3 * 1000 * sizeof(double));
+}
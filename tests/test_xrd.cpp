@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "poscar_file.h"
+#include "xrd.h"
+
+static const std::string kNaClPath = std::string(TEST_DATA_DIR) + "/NaCl_conv_fcc.poscar";
+static const double kNaClA = 5.5881264354399347;
+
+static double twoTheta(double d) {
+    return 2.0 * std::asin(kCuKalpha / (2.0 * d)) * 180.0 / 3.14159265358979323846;
+}
+
+TEST(Xrd, FormFactorsAtZeroAngle) {
+    FormFactor factor;
+    std::string substitute;
+    for (const auto& [element, z] : std::vector<std::pair<std::string, double>>{{"H", 1}, {"O", 8}, {"Na", 11},
+                                                                                 {"Cl", 17}, {"Fe", 26}}) {
+        ASSERT_TRUE(formFactor(element, factor, substitute));
+        EXPECT_TRUE(substitute.empty());
+        EXPECT_NEAR(scatteringFactor(factor, 0.0), z, 0.02) << element;
+    }
+
+    // Untabulated elements borrow the nearest tabulated shape, scaled to their electron count
+    ASSERT_TRUE(formFactor("Ne_s", factor, substitute));
+    EXPECT_FALSE(substitute.empty());
+    EXPECT_NEAR(scatteringFactor(factor, 0.0), 10.0, 0.02);
+    EXPECT_FALSE(formFactor("Xx", factor, substitute));
+}
+
+TEST(Xrd, RockSaltPattern) {
+    POSCAR nacl;
+    ASSERT_TRUE(nacl.readPOSCAR(kNaClPath));
+
+    std::vector<FormFactor> factors(2);
+    std::string substitute;
+    ASSERT_TRUE(formFactor("Na", factors[0], substitute));
+    ASSERT_TRUE(formFactor("Cl", factors[1], substitute));
+
+    XrdOptions options;
+    options.threads = 2;
+    std::vector<XrdPeak> peaks = simulateXrd(nacl, factors, options);
+    ASSERT_FALSE(peaks.empty());
+
+    // Face-centring removes mixed-parity reflections: the first peaks are 111, 200 and 220
+    ASSERT_GE(peaks.size(), 3u);
+    EXPECT_NEAR(peaks[0].two_theta, twoTheta(kNaClA / std::sqrt(3.0)), 1e-6);
+    EXPECT_EQ(peaks[0].multiplicity, 8);
+    EXPECT_NEAR(peaks[1].two_theta, twoTheta(kNaClA / 2.0), 1e-6);
+    EXPECT_EQ(peaks[1].multiplicity, 6);
+    EXPECT_EQ(peaks[1].hkl, (std::array<int, 3>{2, 0, 0}));
+    EXPECT_NEAR(peaks[2].two_theta, twoTheta(kNaClA / std::sqrt(8.0)), 1e-6);
+    EXPECT_EQ(peaks[2].multiplicity, 12);
+
+    // 200 (f_Na + f_Cl) is the strongest, 111 (f_Cl - f_Na) is weak
+    EXPECT_DOUBLE_EQ(peaks[1].intensity, 100.0);
+    EXPECT_LT(peaks[0].intensity, 20.0);
+
+    // Same result on one thread
+    options.threads = 1;
+    std::vector<XrdPeak> serial = simulateXrd(nacl, factors, options);
+    ASSERT_EQ(serial.size(), peaks.size());
+    for (size_t i = 0; i < peaks.size(); ++i)
+        EXPECT_NEAR(serial[i].intensity, peaks[i].intensity, 1e-9);
+
+    std::vector<double> pattern = broadenPattern(peaks, 5.0, 90.0, 0.02, 0.1);
+    ASSERT_EQ(pattern.size(), 4251u);
+    const size_t top = std::max_element(pattern.begin(), pattern.end()) - pattern.begin();
+    EXPECT_NEAR(5.0 + top * 0.02, peaks[1].two_theta, 0.011);
+}